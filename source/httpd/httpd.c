@@ -7,12 +7,14 @@
 #define mem_free free
 #define mem_malloc malloc
 #else
+#include <stdlib.h>
 #include "lwip/debug.h"
 #include "lwip/stats.h"
 #include "lwip/tcp.h"
 #endif
 
 #include "httpd.h"
+#include "screen.h"
 
 #include "network/network.h"
 #include "vfs.h"
@@ -37,6 +39,8 @@ void httpd_init(struct http_state *http) {
     http->linebuffer_ptr = 0;
     http->std_header_state = 0;
     http->sendbuffer_read = http->sendbuffer_write = 0;
+    http->span = 0;
+    http->span_len = 0;
     http->handler = 0;
 }
 
@@ -52,13 +56,18 @@ void httpd_try_flush_sendbuffer(struct http_state *http) {
     }
 
     http->sendbuffer_read = http->sendbuffer_write;
+
+    if (http->span_len) {
+        write(1, http->span, http->span_len);
+        http->span_len = 0;
+    }
 }
 #else
 
-static int tcp_do_send(struct tcp_pcb *pcb, void *data, int len) {
+static int tcp_do_send(struct tcp_pcb *pcb, void *data, int len, int copy) {
     err_t err;
     do {
-        err = tcp_write(pcb, data, len, 1);
+        err = tcp_write(pcb, data, len, copy);
         if (err == ERR_MEM)
             len /= 2;
     } while (err == ERR_MEM && len > 1);
@@ -81,10 +90,24 @@ send_data(struct tcp_pcb *pcb, struct http_state *http) {
     if (av < a)
         a = av;
 
-    http->sendbuffer_read += tcp_do_send(pcb, http->sendbuffer + http->sendbuffer_read, a);
+    http->sendbuffer_read += tcp_do_send(pcb, http->sendbuffer + http->sendbuffer_read, a, 1);
 
     if (http->sendbuffer_read == SENDBUFFER_LEN)
         http->sendbuffer_read = 0;
+
+    /* spans follow whatever the handler put into the sendbuffer before them */
+    if (http->span_len && (http->sendbuffer_read == http->sendbuffer_write)) {
+        a = tcp_sndbuf(pcb);
+        if (a > SPAN_BUDGET)
+            a = SPAN_BUDGET;
+        if (a > http->span_len)
+            a = http->span_len;
+        if (a) {
+            a = tcp_do_send(pcb, (void*) http->span, a, http->span_copy);
+            http->span += a;
+            http->span_len -= a;
+        }
+    }
 }
 #endif
 
@@ -118,6 +141,15 @@ void httpd_put_sendbuffer_string(struct http_state *http, const char *data) {
     httpd_put_sendbuffer(http, data, strlen(data));
 }
 
+/* send len bytes at data without going through the sendbuffer. with copy == 0
+   lwip references the memory until it is acked, so only do that for memory
+   which outlives the connection. do_data isn't called again before the span is out. */
+void httpd_put_span(struct http_state *http, const void *data, int len, int copy) {
+    http->span = data;
+    http->span_len = len;
+    http->span_copy = copy;
+}
+
 void httpd_get_descr(struct http_state *http) {
     switch (http->code) {
         case 200:
@@ -312,7 +344,9 @@ static void httpd_handle_server(struct http_state *http) {
             case HTTPD_SERVER_DATA:
             {
                 int r = 1;
-                if (http->handler->do_data)
+                if (http->span_len)
+                    busy = 1;
+                else if (http->handler->do_data)
                     r = http->handler->do_data(http);
                 if (r == 0)
                     http->state_server = HTTPD_SERVER_CLOSE;
@@ -331,7 +365,7 @@ static void httpd_handle_server(struct http_state *http) {
         }
 
 #ifdef UNIX		
-        if (http->sendbuffer_read != http->sendbuffer_write)
+        if ((http->sendbuffer_read != http->sendbuffer_write) || http->span_len)
             httpd_try_flush_sendbuffer(http);
 #else
         if (busy)
@@ -605,17 +639,49 @@ static void response_vfs_finish(struct http_state *http) {
     mem_free(priv);
 }
 
+/* ---------- memory dump handler */
+
+/* from psxmem.h */
+extern signed char *psxM, *psxR, *psxH;
+
 struct response_mem_priv_s {
-    void *base;
+    const char *base;
+    char *snapshot;
     int len;
     int ptr, hdr_state;
 };
 
+/* /MEM streams host memory straight out of place, /MEM/ram, /MEM/bios and
+   /MEM/scratch copy the psx region at request time so the dump is consistent */
 static int response_mem_process_request(struct http_state *http, const char *method, const char *url) {
     if (strcmp(method, "GET"))
         return 0;
 
-    if (strcmp(url, "/MEM"))
+    if (strncmp(url, "/MEM", 4))
+        return 0;
+
+    const char *src = 0;
+    int len = 0;
+
+    url += 4;
+    if (!*url) {
+        //	src = (void*) 0x80000200c8000000ULL;
+        //	src = (void*) 0x8000020000000000ULL;
+        len = 512 * 1024 * 1024;
+    } else if (!strcmp(url, "/ram")) {
+        src = (const char*) psxM;
+        len = 0x200000;
+    } else if (!strcmp(url, "/bios")) {
+        src = (const char*) psxR;
+        len = 0x80000;
+    } else if (!strcmp(url, "/scratch")) {
+        src = (const char*) psxH;
+        len = 0x10000;
+    } else
+        return 0;
+
+    /* no game running */
+    if (*url && !src)
         return 0;
 
     http->response_priv = mem_malloc(sizeof (struct response_mem_priv_s));
@@ -623,14 +689,22 @@ static int response_mem_process_request(struct http_state *http, const char *met
         return 0;
     struct response_mem_priv_s *priv = http->response_priv;
 
-    //	priv->base = (void*) 0x80000200c8000000ULL;
-    //	priv->base = (void*) 0x80000200c8000000ULL;
-    //	priv->base = (void*) 0x8000020000000000ULL;
-    priv->base = (void*) 0;
+    priv->snapshot = 0;
+    if (*url) {
+        /* too big for the lwip heap */
+        priv->snapshot = malloc(len);
+        if (!priv->snapshot) {
+            mem_free(priv);
+            return 0;
+        }
+        memcpy(priv->snapshot, src, len);
+        src = priv->snapshot;
+    }
+
+    priv->base = src;
     priv->hdr_state = 0;
     priv->ptr = 0;
-    priv->len = 512 * 1024 * 1024;
-    //	priv->len = 128 * 1024;
+    priv->len = len;
     http->code = 200;
     return 1;
 }
@@ -669,30 +743,20 @@ static int response_mem_do_header(struct http_state *http) {
 static int response_mem_do_data(struct http_state *http) {
     struct response_mem_priv_s *priv = http->response_priv;
 
-    int av = httpd_available_sendbuffer(http);
-
-    if (!av) {
-        printf("no httpd sendbuffer space\n");
-        return 1;
-    }
-
-    if (av > (priv->len - priv->ptr))
-        av = priv->len - priv->ptr;
+    if (priv->ptr == priv->len)
+        return 0;
 
-    while (av) {
-        int maxread = 1024;
-        if (maxread > av)
-            maxread = av;
-        httpd_put_sendbuffer(http, (void*) (priv->base + priv->ptr), maxread);
-        priv->ptr += maxread;
-        av -= maxread;
-    }
+    /* host memory is always there, lwip may point at it. the snapshot goes
+       away in finish, possibly before the last segment got acked */
+    httpd_put_span(http, priv->base + priv->ptr, priv->len - priv->ptr, priv->snapshot != 0);
+    priv->ptr = priv->len;
 
     return 1;
 }
 
 static void response_mem_finish(struct http_state *http) {
     struct response_mem_priv_s *priv = http->response_priv;
+    free(priv->snapshot);
     mem_free(priv);
 }
 
@@ -708,7 +772,6 @@ static int response_fuses_process_request(struct http_state *http, const char *m
     return 1;
 }
 
-unsigned char screenshot_buffer[1280*720*4];
 
 
 static int response_ftp_process_request(struct http_state *http, const char *method, const char *url) {
@@ -725,37 +788,95 @@ static int response_ftp_process_request(struct http_state *http, const char *met
 }
 
 
-static int response_sceenshot_process_request(struct http_state *http, const char *method, const char *url) {
+/* ---------- screenshot handler */
+
+struct response_screen_priv_s {
+    int format, started;
+    unsigned char *data;
+    int len, hdr_state;
+};
+
+static int response_screen_process_request(struct http_state *http, const char *method, const char *url) {
     if (strcmp(method, "GET"))
         return 0;
 
-    if (strcmp(url, "/screen.png"))
+    int format;
+    if (!strcmp(url, "/screen.png"))
+        format = SCREEN_PNG;
+    else if (!strcmp(url, "/screen.qoi"))
+        format = SCREEN_QOI;
+    else
         return 0;
 
-    int len;
-    unsigned char * data;
-    
-    data=screenshot_buffer;
-    
-    cScreenCapture(&data,&len);
-    
-    printf("len... %d\r\n",len);
-    
-    
-    http->code = 200;
-    
-    http->response_priv = mem_malloc(sizeof (struct response_static_priv_s));
+    http->response_priv = mem_malloc(sizeof (struct response_screen_priv_s));
     if (!http->response_priv)
-        return;
-    struct response_static_priv_s *priv = http->response_priv;
-    priv->data = data;
-    priv->ptr = 0;
-    priv->len = len;
-    
-    
+        return 0;
+    struct response_screen_priv_s *priv = http->response_priv;
+    priv->format = format;
+    priv->started = cScreenCaptureAsync(format, priv);
+    priv->data = 0;
+    priv->len = 0;
+    priv->hdr_state = 0;
+    http->code = 200;
     return 1;
 }
 
+static int response_screen_do_header(struct http_state *http) {
+    struct response_screen_priv_s *priv = http->response_priv;
+
+    const char *t = 0, *o = 0;
+    char buf[32];
+    switch (priv->hdr_state) {
+        case 0:
+            /* another request owns the encoder, grab the frame once it's free */
+            if (!priv->started)
+                priv->started = cScreenCaptureAsync(priv->format, priv);
+            if (!priv->started || !cScreenCaptureDone(priv, &priv->data, &priv->len))
+                return 1;
+            t = "Content-Type";
+            o = (priv->format == SCREEN_QOI) ? "image/qoi" : "image/png";
+            break;
+        case 1:
+            t = "Content-Length";
+            sprintf(buf, "%d", priv->len);
+            o = buf;
+            break;
+        case 2:
+            return httpd_do_std_header(http);
+    }
+
+    int av = httpd_available_sendbuffer(http);
+    if (av < (strlen(t) + strlen(o) + 4))
+        return 1;
+
+    httpd_put_sendbuffer_string(http, t);
+    httpd_put_sendbuffer_string(http, ": ");
+    httpd_put_sendbuffer_string(http, o);
+    httpd_put_sendbuffer_string(http, "\r\n");
+    ++priv->hdr_state;
+    return 2;
+}
+
+static int response_screen_do_data(struct http_state *http) {
+    struct response_screen_priv_s *priv = http->response_priv;
+
+    if (!priv->len)
+        return 0;
+
+    httpd_put_span(http, priv->data, priv->len, 1);
+    priv->len = 0;
+    return 1;
+}
+
+static void response_screen_finish(struct http_state *http) {
+    struct response_screen_priv_s *priv = http->response_priv;
+    if (priv->data)
+        free(priv->data);
+    else
+        cScreenCaptureCancel(priv);
+    mem_free(priv);
+}
+
 /* ---------- err400 handler */
 
 static int response_err400_process_request(struct http_state *http, const char *method, const char *url) {
@@ -781,7 +902,7 @@ struct httpd_handler http_handler[] ={
     {response_mem_process_request, 0, 0, response_mem_do_header, response_mem_do_data, 0, response_mem_finish},
 #endif
     {response_ftp_process_request, 0, 0, 0, response_static_do_data, 0, response_static_finish},
-    {response_sceenshot_process_request, 0, 0, 0, response_static_do_data, 0, response_static_finish},
+    {response_screen_process_request, 0, 0, response_screen_do_header, response_screen_do_data, 0, response_screen_finish},
     {response_fuses_process_request, 0, 0, 0, response_static_do_data, 0, response_static_finish},
     {response_vfs_process_request, 0, 0, response_vfs_do_header, response_vfs_do_data, 0, response_vfs_finish},
     {response_err400_process_request, 0, 0, 0, response_static_do_data, 0, response_static_finish},
@@ -812,6 +933,8 @@ conn_err(void *arg, err_t err) {
     struct http_state *http;
 
     http = arg;
+    if (http->handler && http->handler->finish)
+        http->handler->finish(http);
     mem_free(http);
 }
 
@@ -837,14 +960,17 @@ http_poll(void *arg, struct tcp_pcb *pcb) {
         tcp_abort(pcb);
         return ERR_ABRT;
     } else {
-        if (http->handler && (http->sendbuffer_read != http->sendbuffer_write))// (http->state_server != HTTPD_SERVER_IDLE))
+        if (http->handler && ((http->sendbuffer_read != http->sendbuffer_write) || http->span_len))// (http->state_server != HTTPD_SERVER_IDLE))
         {
             ++http->retries;
-            if (http->retries == 4) {
+            if (http->retries == 16) {
                 tcp_abort(pcb);
                 return ERR_ABRT;
             }
             send_data(pcb, http);
+        } else if (http->handler && (http->state_server != HTTPD_SERVER_IDLE)) {
+            /* nothing in flight, the handler waits on a background job */
+            send_data(pcb, http);
         }
     }
 
@@ -859,9 +985,13 @@ http_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
 
     http->retries = 0;
 
-    if ((http->sendbuffer_read != http->sendbuffer_write) || (http->state_server != HTTPD_SERVER_CLOSE))
+    if ((http->sendbuffer_read != http->sendbuffer_write) || http->span_len || (http->state_server != HTTPD_SERVER_CLOSE))
         send_data(pcb, http);
-    else if (http->state_server == HTTPD_SERVER_CLOSE) {
+
+    /* a handler ends on the do_data after its last span, which may be the
+       one just run: then nothing is left in flight to be acked */
+    if ((http->state_server == HTTPD_SERVER_CLOSE) &&
+            (http->sendbuffer_read == http->sendbuffer_write) && !http->span_len) {
         printf("closing connection.\n");
         close_conn(pcb, http);
     }
@@ -880,10 +1010,10 @@ http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
         struct pbuf *q;
         for (q = p; q; q = q->next)
             httpd_receive(http, q->payload, q->len);
-        pbuf_free(p);
 
         /* Inform TCP that we have taken the data. */
         tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
 
         send_data(pcb, http);
     }
@@ -925,7 +1055,8 @@ http_accept(void *arg, struct tcp_pcb *pcb, err_t err) {
     tcp_err(pcb, conn_err);
     tcp_sent(pcb, http_sent);
 
-    tcp_poll(pcb, http_poll, 4);
+    /* every 500ms, so waiting handlers are picked up quickly */
+    tcp_poll(pcb, http_poll, 1);
 
     tcp_accepted(listen_pcb); //lwip 1.3.0
 
@@ -16,6 +16,9 @@
 
 #define SENDBUFFER_LEN 4096
 
+/* most bytes of a span queued per tcp callback, keeps the emulation thread going */
+#define SPAN_BUDGET (32 * 1024)
+
 struct http_state;
 
 extern void httpd_start(void);
@@ -24,6 +27,7 @@ extern int httpd_available_sendbuffer(struct http_state *http);
 extern void httpd_put_sendbuffer(struct http_state *http, const void *data, int len);
 extern void httpd_put_sendbuffer_string(struct http_state *http, const char *data);
 extern int httpd_do_std_header(struct http_state *http);
+extern void httpd_put_span(struct http_state *http, const void *data, int len, int copy);
 
 struct httpd_handler
 {
@@ -51,6 +55,10 @@ struct http_state
 	char sendbuffer[SENDBUFFER_LEN];
 	int sendbuffer_read, sendbuffer_write;
 	int std_header_state;
+	
+	/* handed out by do_data, goes straight to tcp once the sendbuffer drained */
+	const char *span;
+	int span_len, span_copy;
 	int retries;
 	int isserial;
 	
@@ -3,18 +3,25 @@
 #include <sys/time.h>
 #include <time/time.h>
 #include <byteswap.h>
-#include <iostream>
-#include <sstream>
-#include <vector>
-
-static void writeDataCallback(png_structp png_ptr, png_bytep data, png_size_t length)
-{
-    std::vector<uint8_t>& outputBuffer = *(reinterpret_cast<std::vector<uint8_t>* >(png_get_io_ptr(png_ptr)));
-    int prevBufSize = outputBuffer.size();
-    outputBuffer.resize(outputBuffer.size() + length);
-    memcpy(&outputBuffer[prevBufSize], data, length);
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "screen.h"
+
+extern "C" {
+#include "../main/x_thread.h"
 }
 
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+#include <altivec.h>
+#endif
+
+// shared: the cd prefetch and the file browser's directory scan run short
+// jobs on it too, a capture only starts while it is free
+#define SCREEN_THREAD 1
+
+#define lwsync() __asm__ __volatile__("lwsync" : : : "memory")
+
 struct ati_info {
     uint32_t unknown1[4];
     uint32_t base;
@@ -23,45 +30,282 @@ struct ati_info {
     uint32_t height;
 } __attribute__((__packed__));
 
+struct screen_out {
+    unsigned char * data;
+    int len, size; // len -1: out of memory, the image is dropped
+};
+
+static void put_bytes(screen_out * out, const void * data, int length) {
+    if (out->len < 0)
+        return;
+    if (out->len + length > out->size) {
+        int size = (out->len + length) * 2;
+        unsigned char * p = (unsigned char*) realloc(out->data, size);
+        if (!p) {
+            free(out->data);
+            out->data = 0;
+            out->len = -1;
+            return;
+        }
+        out->data = p;
+        out->size = size;
+    }
+    memcpy(out->data + out->len, data, length);
+    out->len += length;
+}
+
+static void writeDataCallback(png_structp png_ptr, png_bytep data, png_size_t length) {
+    put_bytes((screen_out*) png_get_io_ptr(png_ptr), data, length);
+}
 
+////////////////////////////////////////////////////////////////////////
+// detile
+////////////////////////////////////////////////////////////////////////
 
-extern "C" void cScreenCapture(unsigned char ** data, int * len) {
-    std::vector<uint8_t> out;
+// 4 horizontal pixels are always adjacent in a tile, move them as one 16 byte
+// block. a pixel goes from xrgb to rgba: 0xFF | bswap32(p >> 8)
 
+static uint32_t * Detile(int width, int height) {
     struct ati_info *ai = (struct ati_info*) 0xec806100ULL;
+    uint32_t *screen = (uint32_t*) (long) (ai->base | 0x80000000);
+    uint32_t *pixels = (uint32_t*) memalign(128, width * height * 4);
+    int y, x;
 
-    int width = ai->width;
-    int height = ai->height;
-
-    volatile unsigned int *screen = (unsigned int*) (long) (ai->base | 0x80000000);
+    if (!pixels)
+        return 0;
 
-    unsigned int screen2[width * height];
-    png_bytep row_pointers[height];
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+    const vector unsigned char perm = {2, 1, 0, 16, 6, 5, 4, 16, 10, 9, 8, 16, 14, 13, 12, 16};
+    const vector unsigned char ff = vec_splat_u8(-1);
+#endif
 
-    int y, x;
     for (y = 0; y < height; ++y) {
-        for (x = 0; x < width; ++x) {
-            unsigned int base = ((((y & ~31) * width) + (x & ~31)*32) +
-                    (((x & 3) + ((y & 1) << 2) + ((x & 28) << 1) + ((y & 30) << 5)) ^ ((y & 8) << 2)));
-            screen2[y * width + x] = 0xFF | __builtin_bswap32(screen[base] >> 8);
+        uint32_t *dst = pixels + y * width;
+        uint32_t row = (y & ~31) * width;
+        uint32_t in = ((y & 1) << 2) + ((y & 30) << 5);
+        uint32_t flip = (y & 8) << 2;
+
+        for (x = 0; x < width; x += 4, dst += 4) {
+            uint32_t *src = screen + row + (x & ~31)*32 + ((in + ((x & 28) << 1)) ^ flip);
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+            if (!(width & 3)) {
+                vec_st(vec_perm(vec_ld(0, src), ff, perm), 0, dst);
+                continue;
+            }
+#endif
+            int i, n = (width - x < 4) ? width - x : 4;
+            for (i = 0; i < n; i++)
+                dst[i] = 0xFF | __builtin_bswap32(src[i] >> 8);
         }
-        row_pointers[y] = (png_bytep) (screen2 + y * width);
     }
 
-    //FILE *outfp = fopen(filename, "wb");
+    return pixels;
+}
+
+////////////////////////////////////////////////////////////////////////
+// encoders
+////////////////////////////////////////////////////////////////////////
+
+// stored deflate blocks, no filtering: zlib only copies the rows
+static void EncodePng(screen_out * out, uint32_t * pixels, int width, int height) {
+    png_bytep row_pointers[height];
+    int y;
+
+    for (y = 0; y < height; ++y)
+        row_pointers[y] = (png_bytep) (pixels + y * width);
 
     png_structp png_ptr_w = png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
     png_infop info_ptr_w = png_create_info_struct(png_ptr_w);
-    
-    png_set_write_fn (png_ptr_w, &out, &writeDataCallback, NULL);
-    
+
+    png_set_write_fn(png_ptr_w, out, &writeDataCallback, NULL);
+    png_set_compression_level(png_ptr_w, 0);
+    png_set_filter(png_ptr_w, 0, PNG_FILTER_NONE);
+
     png_set_IHDR(png_ptr_w, info_ptr_w, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
     png_set_rows(png_ptr_w, info_ptr_w, row_pointers);
     png_write_png(png_ptr_w, info_ptr_w, PNG_TRANSFORM_IDENTITY, 0);
     png_write_end(png_ptr_w, info_ptr_w);
     png_destroy_write_struct(&png_ptr_w, &info_ptr_w);
+}
+
+// qoiformat.org, pixels are rgba words so channels compare as one u32
+static void EncodeQoi(screen_out * out, uint32_t * pixels, int width, int height) {
+    static const unsigned char end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    uint32_t index[64];
+    uint32_t prev = 0x000000ff;
+    unsigned char *p;
+    int i, n = width * height, run = 0;
+
+    out->size = n * 5 + 14 + 8; // worst case
+    out->data = (unsigned char*) malloc(out->size);
+    if (!out->data)
+        return;
+
+    p = out->data;
+    memcpy(p, "qoif", 4);
+    p[4] = width >> 24;
+    p[5] = width >> 16;
+    p[6] = width >> 8;
+    p[7] = width;
+    p[8] = height >> 24;
+    p[9] = height >> 16;
+    p[10] = height >> 8;
+    p[11] = height;
+    p[12] = 4; // rgba
+    p[13] = 0; // srgb
+    p += 14;
+
+    memset(index, 0, sizeof (index));
+
+    for (i = 0; i < n; i++) {
+        uint32_t px = pixels[i];
+        int r = px >> 24, g = (px >> 16) & 0xff, b = (px >> 8) & 0xff, a = px & 0xff;
+
+        if (px == prev) {
+            if (++run == 62 || i == n - 1) {
+                *p++ = 0xc0 | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run) {
+            *p++ = 0xc0 | (run - 1);
+            run = 0;
+        }
+
+        int h = (r * 3 + g * 5 + b * 7 + a * 11) & 63;
+        if (index[h] == px) {
+            *p++ = h;
+        } else {
+            index[h] = px;
+
+            if (a == (int) (prev & 0xff)) {
+                signed char vr = r - (prev >> 24);
+                signed char vg = g - ((prev >> 16) & 0xff);
+                signed char vb = b - ((prev >> 8) & 0xff);
+                signed char vg_r = vr - vg;
+                signed char vg_b = vb - vg;
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    *p++ = 0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                    *p++ = 0x80 | (vg + 32);
+                    *p++ = (vg_r + 8) << 4 | (vg_b + 8);
+                } else {
+                    *p++ = 0xfe;
+                    *p++ = r;
+                    *p++ = g;
+                    *p++ = b;
+                }
+            } else {
+                *p++ = 0xff;
+                *p++ = r;
+                *p++ = g;
+                *p++ = b;
+                *p++ = a;
+            }
+        }
+        prev = px;
+    }
+
+    memcpy(p, end, 8);
+    out->len = p + 8 - out->data;
+}
+
+////////////////////////////////////////////////////////////////////////
+// background capture
+////////////////////////////////////////////////////////////////////////
+
+#define CAPTURE_IDLE     0
+#define CAPTURE_ENCODING 1
+#define CAPTURE_DONE     2
+
+static struct {
+    void * owner; // 0 once the requester is gone
+    int format, width, height;
+    uint32_t * pixels;
+    screen_out out;
+    volatile int state;
+} capture;
+
+static void CaptureThread() {
+    capture.out.data = 0;
+    capture.out.len = capture.out.size = 0;
+
+    if (capture.format == SCREEN_QOI)
+        EncodeQoi(&capture.out, capture.pixels, capture.width, capture.height);
+    else
+        EncodePng(&capture.out, capture.pixels, capture.width, capture.height);
+
+    free(capture.pixels);
+    capture.pixels = 0;
+    if (capture.out.len < 0)
+        capture.out.len = 0; // no data, an empty reply
+
+    lwsync(); // image complete before the state says so
+    capture.state = CAPTURE_DONE;
+}
 
-    *len=out.size();
-    memcpy(data[0],&out[0],out.size());
+extern "C" int cScreenCaptureAsync(int format, void * owner) {
+    struct ati_info *ai = (struct ati_info*) 0xec806100ULL;
+
+    if (capture.state == CAPTURE_ENCODING)
+        return 0;
+    if (capture.state == CAPTURE_DONE) {
+        if (capture.owner)
+            return 0;
+        free(capture.out.data); // nobody picked it up
+        capture.state = CAPTURE_IDLE;
+    }
+    if (x_thread_busy(SCREEN_THREAD))
+        return 0; // a prefetch or scan job, the request asks again
+
+    // the frame is taken here, on the emulation thread, only the encode is deferred
+    capture.width = ai->width;
+    capture.height = ai->height;
+    capture.pixels = Detile(capture.width, capture.height);
+    if (!capture.pixels) {
+        capture.state = CAPTURE_IDLE;
+        return 0;
+    }
+
+    capture.owner = owner;
+    capture.format = format;
+    capture.state = CAPTURE_ENCODING;
+    lwsync();
+
+    // fails while the last job's taskrunner is still returning
+    if (x_thread_create(SCREEN_THREAD, (void*) CaptureThread)) {
+        free(capture.pixels);
+        capture.pixels = 0;
+        capture.owner = 0;
+        capture.state = CAPTURE_IDLE;
+        return 0;
+    }
+    return 1;
+}
+
+extern "C" int cScreenCaptureDone(void * owner, unsigned char ** data, int * len) {
+    if (capture.owner != owner || capture.state != CAPTURE_DONE)
+        return 0;
+
+    lwsync();
+    *data = capture.out.data;
+    *len = capture.out.len;
+    capture.owner = 0;
+    capture.state = CAPTURE_IDLE;
+    return 1;
+}
+
+extern "C" void cScreenCaptureCancel(void * owner) {
+    if (capture.owner != owner)
+        return;
+
+    capture.owner = 0;
+    if (capture.state == CAPTURE_DONE) {
+        free(capture.out.data);
+        capture.state = CAPTURE_IDLE;
+    }
 }
@@ -0,0 +1,22 @@
+#ifndef __screen_h
+#define __screen_h
+
+#define SCREEN_PNG 0 /* stored, unfiltered png */
+#define SCREEN_QOI 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* detile the front buffer now and encode it on a spare hw thread, 0 while another owner's capture is in flight */
+int cScreenCaptureAsync(int format, void * owner);
+/* 1 once the encode finished, the malloc'ed image is the caller's then */
+int cScreenCaptureDone(void * owner, unsigned char ** data, int * len);
+/* owner went away, drop its capture */
+void cScreenCaptureCancel(void * owner);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
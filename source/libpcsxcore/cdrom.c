@@ -22,6 +22,7 @@
 */
 
 #include "cdrom.h"
+#include "cdrprefetch.h"
 #include "ppf.h"
 #include "psxdma.h"
 
@@ -150,6 +151,10 @@ enum seeked_state {
 
 static struct CdrStat stat;
 
+// a ram snapshot got loaded: cdr.Prev is right, but the sector buffer may
+// hold one read after the snapshot was taken
+static boolean prevStale = FALSE;
+
 extern unsigned int msf2sec(const char *msf);
 extern void sec2msf(unsigned int s, const char *msf);
 
@@ -250,21 +255,53 @@ static void setIrq(void)
 		psxHu32ref(0x1070) |= SWAP32((u32)0x4);
 }
 
-static void adjustTransferIndex(void)
+// the data fifo is a ring over the first bufSize bytes of cdr.Transfer
+static unsigned int transferBufSize(void)
 {
-	unsigned int bufSize = 0;
-	
 	switch (cdr.Mode & (MODE_SIZE_2340|MODE_SIZE_2328)) {
-		case MODE_SIZE_2340: bufSize = 2340; break;
-		case MODE_SIZE_2328: bufSize = 12 + 2328; break;
+		case MODE_SIZE_2340: return 2340;
+		case MODE_SIZE_2328: return 12 + 2328;
 		default:
-		case MODE_SIZE_2048: bufSize = 12 + 2048; break;
+		case MODE_SIZE_2048: return 12 + 2048;
 	}
+}
+
+static void adjustTransferIndex(void)
+{
+	unsigned int bufSize = transferBufSize();
 	
 	if (cdr.transferIndex >= bufSize)
 		cdr.transferIndex -= bufSize;
 }
 
+// same as size times cdrRead2 without the Readed check, one memcpy per
+// contiguous span (two for a sector sized transfer)
+static void copyTransfer(u8 *dst, u32 size)
+{
+	unsigned int bufSize = transferBufSize();
+	u32 n;
+
+	while (size) {
+		// mode shrank the fifo under the index: that byte is still read from where it is
+		if (cdr.transferIndex >= bufSize) {
+			*dst++ = cdr.Transfer[cdr.transferIndex++];
+			adjustTransferIndex();
+			size--;
+			continue;
+		}
+
+		n = bufSize - cdr.transferIndex;
+		if (n > size)
+			n = size;
+
+		memcpy(dst, cdr.Transfer + cdr.transferIndex, n);
+		dst += n;
+		size -= n;
+		cdr.transferIndex += n;
+		adjustTransferIndex();
+	}
+}
+
 // FIXME: do this in SPU instead
 void cdrDecodedBufferInterrupt()
 {
@@ -454,18 +491,19 @@ static void ReadTrack(const u8 *time) {
 	tmp[1] = itob(time[1]);
 	tmp[2] = itob(time[2]);
 
-	if (memcmp(cdr.Prev, tmp, 3) == 0)
+	if (memcmp(cdr.Prev, tmp, 3) == 0 && !prevStale)
 		return;
+	prevStale = FALSE;
 
 	CDR_LOG("ReadTrack *** %02x:%02x:%02x\n", tmp[0], tmp[1], tmp[2]);
 
-	cdr.RErr = CDR_readTrack(tmp);
+	cdr.RErr = cdrPrefetchRead(tmp);
 	memcpy(cdr.Prev, tmp, 3);
 
 	if (CheckSBI(time))
 		return;
 
-	subq = (struct SubQ *)CDR_getBufferSub();
+	subq = (struct SubQ *)cdrPrefetchSub();
 	if (subq != NULL && cdr.CurTrack == 1) {
 		crc = calcCrc((u8 *)subq + 12, 10);
 		if (crc == (((u16)subq->CRC[0] << 8) | subq->CRC[1])) {
@@ -591,7 +629,7 @@ void cdrPlayInterrupt()
 	if (!cdr.Play) return;
 
 	if (CDR_readCDDA && !cdr.Muted) {
-		CDR_readCDDA(cdr.SetSectorPlay[0], cdr.SetSectorPlay[1],
+		cdrPrefetchReadCDDA(cdr.SetSectorPlay[0], cdr.SetSectorPlay[1],
 			cdr.SetSectorPlay[2], cdr.Transfer);
 
 		cdrAttenuate((s16 *)cdr.Transfer, CD_FRAMESIZE_RAW / 4, 1);
@@ -704,6 +742,9 @@ void cdrInterrupt() {
 			ReadTrack(cdr.SetSectorPlay);
 			cdr.TrackChanged = FALSE;
 
+			// audio from here on, have it read before the first CDRMISC_INT
+			cdrPrefetchSeek(cdr.SetSectorPlay, PF_CDDA);
+
 			if (!Config.Cdda)
 				CDR_play(cdr.SetSectorPlay);
 
@@ -997,7 +1038,7 @@ void cdrInterrupt() {
 			// Crusaders of Might and Magic - update getlocl now
 			// - fixes cutscene speech
 			{
-				u8 *buf = CDR_getBuffer();
+				u8 *buf = cdrPrefetchBuffer();
 				if (buf != NULL)
 					memcpy(cdr.Transfer, buf, 8);
 			}
@@ -1080,9 +1121,120 @@ finish:
 	else if (v > 32767) v = 32767; \
 } while (0)
 
-void cdrAttenuate(s16 *buf, int samples, int stereo)
+static void attenuateStereo(s16 *buf, int samples, int ll, int lr, int rl, int rr)
 {
 	int i, l, r;
+
+	for (i = 0; i < samples; i++) {
+		l = buf[i * 2];
+		r = buf[i * 2 + 1];
+		l = (l * ll + r * rl) >> 7;
+		r = (r * rr + l * lr) >> 7;
+		ssat32_to_16(l);
+		ssat32_to_16(r);
+		buf[i * 2] = l;
+		buf[i * 2 + 1] = r;
+	}
+}
+
+static void attenuateMono(s16 *buf, int samples, int k)
+{
+	int i, l;
+
+	for (i = 0; i < samples; i++) {
+		l = buf[i];
+		l = l * k >> 7;
+		//r = r * (rr + lr) >> 7;
+		ssat32_to_16(l);
+		//ssat32_to_16(r);
+		buf[i] = l;
+	}
+}
+
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+#include <altivec.h>
+
+// 32 bit intermediates like the scalar loops (r is mixed with the unsaturated
+// new l), the final pack saturates. Unaligned heads and tails go scalar.
+
+static void attenuateStereoVec(s16 *buf, int samples, int ll, int lr, int rl, int rr)
+{
+	s16 ALIGNED_32 k[8] = { ll, lr, rl, rr };
+	vector signed short kv, vll, vlr, vrl, vrr;
+	const vector unsigned int sh7 = vec_splat_u32(7);
+	const vector unsigned int sh16 = vec_splat_u32(-16); // only the low 5 bits count
+	int head;
+
+	if ((uptr)buf & 3) {
+		attenuateStereo(buf, samples, ll, lr, rl, rr);
+		return;
+	}
+
+	head = (((16 - (uptr)buf) & 15) >> 2);
+	if (head > samples)
+		head = samples;
+	attenuateStereo(buf, head, ll, lr, rl, rr);
+	buf += head * 2;
+	samples -= head;
+
+	kv = vec_ld(0, k);
+	vll = vec_splat(kv, 0);
+	vlr = vec_splat(kv, 1);
+	vrl = vec_splat(kv, 2);
+	vrr = vec_splat(kv, 3);
+
+	for (; samples >= 4; samples -= 4, buf += 8) {
+		vector signed short v = vec_ld(0, buf); // l r l r l r l r
+		vector signed int l, r, llr;
+
+		l = vec_sra(vec_add(vec_mule(v, vll), vec_mulo(v, vrl)), sh7);
+
+		// l * lr needs all 32 bits of l: signed high half, unsigned low half
+		llr = vec_add(vec_sl(vec_mule((vector signed short)l, vlr), sh16),
+				(vector signed int)vec_mulo((vector unsigned short)l, (vector unsigned short)vlr));
+		r = vec_sra(vec_add(vec_mulo(v, vrr), llr), sh7);
+
+		vec_st(vec_packs(vec_mergeh(l, r), vec_mergel(l, r)), 0, buf);
+	}
+
+	attenuateStereo(buf, samples, ll, lr, rl, rr);
+}
+
+static void attenuateMonoVec(s16 *buf, int samples, int k)
+{
+	s16 ALIGNED_32 kk[8] = { k };
+	const vector unsigned int sh7 = vec_splat_u32(7);
+	vector signed short vk;
+	int head;
+
+	if ((uptr)buf & 1) {
+		attenuateMono(buf, samples, k);
+		return;
+	}
+
+	head = (((16 - (uptr)buf) & 15) >> 1);
+	if (head > samples)
+		head = samples;
+	attenuateMono(buf, head, k);
+	buf += head;
+	samples -= head;
+
+	vk = vec_splat(vec_ld(0, kk), 0);
+
+	for (; samples >= 8; samples -= 8, buf += 8) {
+		vector signed short v = vec_ld(0, buf);
+		vector signed int e = vec_sra(vec_mule(v, vk), sh7);
+		vector signed int o = vec_sra(vec_mulo(v, vk), sh7);
+
+		vec_st(vec_packs(vec_mergeh(e, o), vec_mergel(e, o)), 0, buf);
+	}
+
+	attenuateMono(buf, samples, k);
+}
+#endif
+
+void cdrAttenuate(s16 *buf, int samples, int stereo)
+{
 	int ll = cdr.AttenuatorLeftToLeft;
 	int lr = cdr.AttenuatorLeftToRight;
 	int rl = cdr.AttenuatorRightToLeft;
@@ -1094,28 +1246,17 @@ void cdrAttenuate(s16 *buf, int samples, int stereo)
 	if (!stereo && ll == 0x40 && lr == 0x40 && rl == 0x40 && rr == 0x40)
 		return;
 
-	if (stereo) {
-		for (i = 0; i < samples; i++) {
-			l = buf[i * 2];
-			r = buf[i * 2 + 1];
-			l = (l * ll + r * rl) >> 7;
-			r = (r * rr + l * lr) >> 7;
-			ssat32_to_16(l);
-			ssat32_to_16(r);
-			buf[i * 2] = l;
-			buf[i * 2 + 1] = r;
-		}
-	}
-	else {
-		for (i = 0; i < samples; i++) {
-			l = buf[i];
-			l = l * (ll + rl) >> 7;
-			//r = r * (rr + lr) >> 7;
-			ssat32_to_16(l);
-			//ssat32_to_16(r);
-			buf[i] = l;
-		}
-	}
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+	if (stereo)
+		attenuateStereoVec(buf, samples, ll, lr, rl, rr);
+	else
+		attenuateMonoVec(buf, samples, ll + rl);
+#else
+	if (stereo)
+		attenuateStereo(buf, samples, ll, lr, rl, rr);
+	else
+		attenuateMono(buf, samples, ll + rl);
+#endif
 }
 
 void cdrReadInterrupt() {
@@ -1147,7 +1288,7 @@ void cdrReadInterrupt() {
 
 	ReadTrack(cdr.SetSector);
 
-	buf = CDR_getBuffer();
+	buf = cdrPrefetchBuffer();
 	if (buf == NULL)
 		cdr.RErr = -1;
 
@@ -1176,7 +1317,7 @@ void cdrReadInterrupt() {
 		if((cdr.Transfer[4 + 2] & 0x4) &&
 			 (cdr.Transfer[4 + 1] == cdr.Channel) &&
 			 (cdr.Transfer[4 + 0] == cdr.File)) {
-			int ret = xa_decode_sector(&cdr.Xa, cdr.Transfer+4, cdr.FirstSector);
+			int ret = xa_decode_sector_to(&cdr.Xa, cdr.Transfer+4, cdr.FirstSector, cdr.Xa.pcm);
 			if (!ret) {
 				cdrAttenuate(cdr.Xa.pcm, cdr.Xa.nsamples, cdr.Xa.stereo);
 				SPU_playADPCMchannel(&cdr.Xa);
@@ -1319,6 +1460,9 @@ void cdrWrite1(unsigned char rt) {
 
 		memcpy(cdr.SetSector, set_loc, 3);
 		cdr.SetSector[3] = 0;
+
+		// the seek delay is the time we get to read ahead
+		cdrPrefetchSeek(cdr.SetSector, (cdr.Mode & MODE_CDDA) ? PF_CDDA : PF_DATA);
 		break;
 
 	case CdlReadN:
@@ -1441,7 +1585,6 @@ void cdrWrite3(unsigned char rt) {
 
 void psxDma3(u32 madr, u32 bcr, u32 chcr) {
 	u32 cdsize;
-	int i;
 	u8 *ptr;
 
 	CDR_LOG("psxDma3() Log: *** DMA 3 *** %x addr = %x size = %x\n", chcr, madr, bcr);
@@ -1481,11 +1624,7 @@ void psxDma3(u32 madr, u32 bcr, u32 chcr) {
 			- CdlPlay
 			- Spams DMA3 and gets buffer overrun
 			*/
-			for(i = 0; i < cdsize; ++i) {
-				ptr[i] = cdr.Transfer[cdr.transferIndex];
-				cdr.transferIndex++;
-				adjustTransferIndex();
-			}
+			copyTransfer(ptr, cdsize);
 
 			psxCpu->Clear(madr, cdsize / 4);
 
@@ -1528,6 +1667,7 @@ static void getCdInfo(void)
 }
 
 void cdrReset() {
+	cdrPrefetchReset();
 	memset(&cdr, 0, sizeof(cdr));
 	cdr.CurTrack = 1;
 	cdr.File = 1;
@@ -1550,16 +1690,23 @@ void cdrReset() {
 int cdrFreeze(gzFile f, int Mode) {
 	u8 tmpp[3];
 
-	if (Mode == 0 && !Config.Cdda)
+	if (Mode == 0 && !Config.Cdda && f != NULL)
 		CDR_stop();
 	
 	gzfreeze(&cdr, sizeof(cdr));
 	
-	if (Mode == 1)
+	if (Mode == 1 && f != NULL)
 		cdr.ParamP = cdr.ParamC;
 
+	// ram snapshot: same disc, the prefetch window still serves the sectors
+	if (Mode == 0 && f == NULL) {
+		prevStale = TRUE;
+		return 0;
+	}
+
 	if (Mode == 0) {
 		getCdInfo();
+		cdrPrefetchReset();
 
 		// read right sub data
 		memcpy(tmpp, cdr.Prev, 3);
@@ -1577,6 +1724,7 @@ int cdrFreeze(gzFile f, int Mode) {
 }
 
 void LidInterrupt() {
+	cdrPrefetchReset();
 	getCdInfo();
 	StopCdda();
 	cdrLidSeekInterrupt();
@@ -0,0 +1,337 @@
+/***************************************************************************
+ *   CD sector prefetch between cdrom.c and the CDR plugin                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+/*
+ * The plugins read a sector when cdrom.c asks for it, which is when the
+ * emulated drive delivers it, so every seek and every fread stalls the
+ * emu thread. Here a worker reads ahead of the drive into a window of
+ * PF_SECTORS sectors: it starts at the Setloc/Play target while the
+ * emulated seek is still running and keeps the window full while ReadN/
+ * ReadS or CDDA play consume it.
+ *
+ * The window is [start, start + PF_SECTORS), the worker has filled
+ * [start, fetched). Only the emu thread moves start, only the worker moves
+ * fetched, so slots are never shared. The plugin is not thread safe: the
+ * emu thread only calls into it after cdrPrefetchStop().
+ *
+ * The worker leaves the last PF_HISTORY sectors before start alone, so
+ * when run ahead loads a snapshot the drive finds what it reads again
+ * still there; start simply moves back.
+ *
+ * There is no hw thread of its own left, the worker runs as short jobs on
+ * the one the screenshot encoder uses and simply doesn't start while that
+ * is busy. Without LIBXENON each job is a detached pthread.
+ */
+
+#include "psxcommon.h"
+#include "cdrom.h"
+#include "cdrprefetch.h"
+
+#ifdef LIBXENON
+#include <ppc/timebase.h>
+#include "../main/x_thread.h"
+
+// shared with httpd/screen.cpp
+#define PF_THREAD		1
+
+#define pf_ticks()		mftb()
+#define pf_ticks_us		(PPC_TIMEBASE_FREQ / 1000000)
+#define pf_pause()		__asm__ __volatile__("db16cyc")
+#define lwsync()		__asm__ __volatile__("lwsync" : : : "memory")
+#else
+#include <sys/time.h>
+#include <pthread.h>
+#include <sched.h>
+
+static u64 pf_ticks() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+#define pf_ticks_us		1
+#define pf_pause()		sched_yield()
+#define lwsync()		__sync_synchronize()
+#endif
+
+#define PF_SECTORS		64	// ~0.4s at double speed
+#define PF_HISTORY		16	// kept behind start for rereads
+#define PF_REFILL		16	// restart the worker once this much got consumed
+#define PF_LATE			4	// wait for the worker rather than restart it
+
+typedef struct {
+	long err;
+	u8 hasbuf;
+	u8 hassub;
+	u8 data[CD_FRAMESIZE_RAW];	// DATA_SIZE for PF_DATA
+	u8 sub[SUB_FRAMESIZE];
+} PfSector;
+
+static struct {
+	PfSector slot[PF_SECTORS];
+	PfSector cur;			// what cdrPrefetchBuffer/Sub hand out
+	PfSector audio;			// CDDA misses
+	int kind;				// 0: window empty
+	int first;				// no sectors below, the window started here
+	volatile int start;
+	volatile int fetched;
+	volatile int running;
+	volatile int cancel;
+	CdrPrefetchStats stats;
+} pf;
+
+static int msf2lba(u8 m, u8 s, u8 f) {
+	return (m * 60 + s) * 75 + f;
+}
+
+static void ReadSector(int lba, int kind, PfSector *sec) {
+	u8 m = lba / 75 / 60, s = lba / 75 % 60, f = lba % 75;
+	u8 msf[3];
+	u8 *p;
+
+	sec->hassub = 0;
+
+	if (kind == PF_CDDA) {
+		sec->err = CDR_readCDDA(m, s, f, sec->data);
+		sec->hasbuf = 1;
+		return;
+	}
+
+	msf[0] = itob(m);
+	msf[1] = itob(s);
+	msf[2] = itob(f);
+	sec->err = CDR_readTrack(msf);
+
+	p = CDR_getBuffer();
+	sec->hasbuf = (p != NULL);
+	if (p != NULL)
+		memcpy(sec->data, p, DATA_SIZE);
+
+	p = CDR_getBufferSub();
+	sec->hassub = (p != NULL);
+	if (p != NULL)
+		memcpy(sec->sub, p, SUB_FRAMESIZE);
+}
+
+static void PrefetchThread() {
+	while (!pf.cancel && pf.fetched - pf.start < PF_SECTORS - PF_HISTORY) {
+		int lba = pf.fetched;
+
+		ReadSector(lba, pf.kind, &pf.slot[lba % PF_SECTORS]);
+		lwsync(); // sector complete before it is counted
+		pf.fetched = lba + 1;
+	}
+
+	lwsync();
+	pf.running = 0;
+}
+
+#ifdef LIBXENON
+static int StartWorker() {
+	if (x_thread_busy(PF_THREAD))
+		return 0; // screenshot
+
+	// fails while the last job's taskrunner is still returning
+	return x_thread_create(PF_THREAD, (void *)PrefetchThread) == 0;
+}
+#else
+static void *PrefetchJob(void *unused) {
+	PrefetchThread();
+	return NULL;
+}
+
+static int StartWorker() {
+	pthread_t t;
+
+	if (pthread_create(&t, NULL, PrefetchJob, NULL) != 0)
+		return 0;
+	pthread_detach(t);
+	return 1;
+}
+#endif
+
+static void Kick() {
+	if (pf.running || !pf.kind)
+		return;
+	if (pf.fetched - pf.start > PF_SECTORS - PF_HISTORY - PF_REFILL)
+		return;
+
+	pf.running = 1;
+	lwsync();
+	if (!StartWorker())
+		pf.running = 0; // try again on the next read
+}
+
+static void Restart(int lba, int kind) {
+	cdrPrefetchStop();
+
+	if (kind == PF_CDDA && CDR_readCDDA == NULL)
+		kind = 0;
+
+	pf.kind = kind;
+	pf.first = pf.start = pf.fetched = lba;
+	Kick();
+}
+
+// lba is still in its slot, or will be once the worker gets there. Below
+// start - PF_HISTORY the worker may be overwriting it, and once start moved
+// back the history is whatever fetched hasn't overwritten yet.
+static int InWindow(int lba, int kind) {
+	return pf.kind == kind && lba >= pf.first && lba >= pf.start - PF_HISTORY
+		&& lba >= pf.fetched - PF_SECTORS && lba < pf.start + PF_SECTORS - PF_HISTORY;
+}
+
+// slot holding lba, NULL if the emu thread has to read it itself
+static PfSector *Take(int lba, int kind) {
+	if (!InWindow(lba, kind))
+		return NULL;
+
+	if (lba >= pf.fetched) {
+		u64 t;
+
+		if (!pf.running || lba - pf.fetched >= PF_LATE)
+			return NULL;
+
+		t = pf_ticks();
+		while (pf.running && pf.fetched <= lba)
+			pf_pause();
+		pf.stats.stallus += (u32)((pf_ticks() - t) / pf_ticks_us);
+
+		if (pf.fetched <= lba)
+			return NULL;
+		pf.stats.late++;
+	}
+
+	lwsync(); // fetched read before the slot
+	pf.stats.hits++;
+	return &pf.slot[lba % PF_SECTORS];
+}
+
+// done with lba, the slots before the history go back to the worker
+static void Release(int lba) {
+	lwsync();
+	pf.start = lba + 1;
+	Kick();
+}
+
+// the emu thread reads lba itself, the window goes on right behind it
+static void Miss(int lba, int kind, PfSector *sec) {
+	u64 t = pf_ticks();
+
+	cdrPrefetchStop();
+	ReadSector(lba, kind, sec);
+	pf.stats.misses++;
+	pf.stats.stallus += (u32)((pf_ticks() - t) / pf_ticks_us);
+
+	Restart(lba + 1, kind);
+}
+
+void cdrPrefetchSeek(const u8 *time, int kind) {
+	int lba = msf2lba(time[0], time[1], time[2]);
+
+	// short hop inside the window (retries, next sector): keep what we have
+	if (InWindow(lba, kind) && lba <= pf.fetched)
+		return;
+
+	pf.stats.seeks++;
+	Restart(lba, kind);
+}
+
+long cdrPrefetchRead(const u8 *time) {
+	int lba = msf2lba(btoi(time[0]), btoi(time[1]), btoi(time[2]));
+	PfSector *sec = Take(lba, PF_DATA);
+
+	// Play reads the subq where the audio starts: the sector is read on the
+	// side and the audio window carries on
+	if (sec == NULL && InWindow(lba, PF_CDDA)) {
+		u64 t = pf_ticks();
+
+		cdrPrefetchStop();
+		ReadSector(lba, PF_DATA, &pf.cur);
+		pf.stats.misses++;
+		pf.stats.stallus += (u32)((pf_ticks() - t) / pf_ticks_us);
+
+		Kick();
+		return pf.cur.err;
+	}
+
+	if (sec == NULL) {
+		Miss(lba, PF_DATA, &pf.cur);
+		return pf.cur.err;
+	}
+
+	memcpy(&pf.cur, sec, sizeof(PfSector));
+	Release(lba);
+	return pf.cur.err;
+}
+
+u8 *cdrPrefetchBuffer(void) {
+	return pf.cur.hasbuf ? pf.cur.data : NULL;
+}
+
+u8 *cdrPrefetchSub(void) {
+	return pf.cur.hassub ? pf.cur.sub : NULL;
+}
+
+long cdrPrefetchReadCDDA(u8 m, u8 s, u8 f, u8 *buffer) {
+	int lba = msf2lba(m, s, f);
+	PfSector *sec = Take(lba, PF_CDDA);
+	long err;
+
+	if (sec == NULL) {
+		Miss(lba, PF_CDDA, &pf.audio);
+		memcpy(buffer, pf.audio.data, CD_FRAMESIZE_RAW);
+		return pf.audio.err;
+	}
+
+	memcpy(buffer, sec->data, CD_FRAMESIZE_RAW);
+	err = sec->err;
+	Release(lba);
+	return err;
+}
+
+void cdrPrefetchStop(void) {
+	if (!pf.running)
+		return;
+
+	pf.cancel = 1;
+	while (pf.running)
+		pf_pause();
+	pf.cancel = 0;
+	lwsync(); // worker is done with the plugin
+}
+
+void cdrPrefetchReset(void) {
+	cdrPrefetchStop();
+	pf.kind = 0;
+	pf.first = pf.start = pf.fetched = 0;
+	pf.cur.hasbuf = pf.cur.hassub = 0;
+}
+
+void cdrPrefetchGetStats(CdrPrefetchStats *stats) {
+	*stats = pf.stats;
+}
+
+void cdrPrefetchReport(void) {
+	u32 total = pf.stats.hits + pf.stats.misses;
+
+	SysPrintf("CD prefetch: %u hits (%u late), %u misses (%u%% hit), %u seeks, %u us stalled\n",
+		pf.stats.hits, pf.stats.late, pf.stats.misses,
+		total ? pf.stats.hits * 100 / total : 0,
+		pf.stats.seeks, pf.stats.stallus);
+}
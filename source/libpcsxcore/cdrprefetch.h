@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   CD sector prefetch between cdrom.c and the CDR plugin                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#ifndef __CDRPREFETCH_H__
+#define __CDRPREFETCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psxcommon.h"
+
+#define PF_DATA		1	// CDR_readTrack sectors
+#define PF_CDDA		2	// CDR_readCDDA sectors
+
+typedef struct {
+	u32 hits;		// sector was waiting in the window
+	u32 late;		// ... after waiting for the worker to finish it
+	u32 misses;		// read by the emu thread itself
+	u32 seeks;		// window restarted somewhere else
+	u32 stallus;	// emu thread time spent in misses and late hits
+} CdrPrefetchStats;
+
+// time is binary msf, kind is what the drive is expected to do there
+void cdrPrefetchSeek(const u8 *time, int kind);
+
+// drop in replacements for CDR_readTrack/CDR_getBuffer/CDR_getBufferSub,
+// a read inside an audio window leaves that window alone
+long cdrPrefetchRead(const u8 *time);
+u8 *cdrPrefetchBuffer(void);
+u8 *cdrPrefetchSub(void);
+
+// drop in replacement for CDR_readCDDA
+long cdrPrefetchReadCDDA(u8 m, u8 s, u8 f, u8 *buffer);
+
+// the worker is off the plugin once these return
+void cdrPrefetchStop(void);
+void cdrPrefetchReset(void);
+
+void cdrPrefetchGetStats(CdrPrefetchStats *stats);
+void cdrPrefetchReport(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
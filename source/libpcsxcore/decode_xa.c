@@ -122,14 +122,125 @@ static __inline void ADPCM_DecodeBlock16( ADPCM_Decode_t *decp, u8 filter_range,
 static int headtable[4] = {0,2,8,10};
 
 //===========================================
-static void xa_decode_data( xa_decode_t *xdp, unsigned char *srcp ) {
+// 4 bit sound groups, batch version: unpack all 8 sound units of a group at
+// once (sample r of unit 2i/2i+1 is the low/high nibble of byte 4r+i), then
+// run the IIR per unit. Same arithmetic as ADPCM_DecodeBlock16.
+
+#define XA_ROWS 28
+#define XA_UNITS 8
+
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+#include <altivec.h>
+
+static void xa_unpack_group( const u8 *datap, const u8 *headp, s16 nib[XA_ROWS][XA_UNITS] ) {
+	static const vector unsigned char perm[4] = {
+		{  0,16, 0,16, 1,16, 1,16, 2,16, 2,16, 3,16, 3,16 },
+		{  4,16, 4,16, 5,16, 5,16, 6,16, 6,16, 7,16, 7,16 },
+		{  8,16, 8,16, 9,16, 9,16,10,16,10,16,11,16,11,16 },
+		{ 12,16,12,16,13,16,13,16,14,16,14,16,15,16,15,16 }
+	};
+	const vector unsigned short nibshift = { 4,0,4,0,4,0,4,0 };
+	const vector unsigned short nibmask = vec_sl(vec_splat_u16(15), vec_splat_u16(12)); // 0xf000
+	const vector unsigned char zero = vec_splat_u8(0);
+	vector unsigned short range;
+	vector unsigned char lo, hi, al, v;
+	s16 ALIGNED_32 r[XA_UNITS];
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		r[i * 2 + 0] = headp[headtable[i] + 0] & 0x0f;
+		r[i * 2 + 1] = headp[headtable[i] + 1] & 0x0f;
+	}
+	range = (vector unsigned short)vec_ld(0, r);
+
+	// the rows as a stream of aligned loads: each step takes the next block,
+	// not the one holding datap + 15, which is the same one when datap is
+	// aligned. The last load reads into the group after, or the 20 bytes of
+	// the sector after the last group, never past it.
+	al = vec_lvsl(0, datap);
+	hi = vec_ld(0, datap);
+
+	for (j = 0; j < XA_ROWS; j += 4, datap += 16) {
+		lo = hi;
+		hi = vec_ld(16, datap);
+		v = vec_perm(lo, hi, al); // 4 rows
+
+		for (i = 0; i < 4; i++) {
+			vector unsigned short x = (vector unsigned short)vec_perm(v, zero, perm[i]);
+			x = vec_and(vec_sl(x, nibshift), nibmask);
+			vec_st(vec_sra((vector signed short)x, range), 0, nib[j + i]);
+		}
+	}
+}
+#else
+static void xa_unpack_group( const u8 *datap, const u8 *headp, s16 nib[XA_ROWS][XA_UNITS] ) {
+	int range[XA_UNITS];
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		range[i * 2 + 0] = headp[headtable[i] + 0] & 0x0f;
+		range[i * 2 + 1] = headp[headtable[i] + 1] & 0x0f;
+	}
+
+	for (j = 0; j < XA_ROWS; j++, datap += 4) {
+		for (i = 0; i < 4; i++) {
+			nib[j][i * 2 + 0] = (short)((datap[i] & 0x0f) << 12) >> range[i * 2 + 0];
+			nib[j][i * 2 + 1] = (short)((datap[i] & 0xf0) <<  8) >> range[i * 2 + 1];
+		}
+	}
+}
+#endif
+
+static __inline void xa_filter_unit( ADPCM_Decode_t *decp, u8 filter_range, const s16 *nibp, short *destp, int inc ) {
+	int filterid = (filter_range >> 4) & 0x0f;
+	s32 k0 = IK0(filterid), k1 = IK1(filterid);
+	s32 fy0 = decp->y0, fy1 = decp->y1;
+	int j;
+
+	for (j = XA_ROWS; j; --j, nibp += XA_UNITS) {
+		s32 x = (s32)*nibp << SH;
+
+		x -= (k0 * fy0 + k1 * fy1) >> SHC; fy1 = fy0; fy0 = x;
+
+		XACLAMP( x, -32768<<SH, 32767<<SH ); *destp = x >> SH; destp += inc;
+	}
+
+	decp->y0 = fy0;
+	decp->y1 = fy1;
+}
+
+// decode all 4 bit sound groups of a sector, nbits: unit pairs per group
+static void xa_decode_groups4( xa_decode_t *xdp, unsigned char *srcp, short *destp, int nbits ) {
+	s16 ALIGNED_32 nib[XA_ROWS][XA_UNITS];
+	const u8 *sound_groupsp;
+	int i, j;
+
+	for (j = 0; j < 18; j++) {
+		sound_groupsp = srcp + j * 128;		// sound groups header
+
+		xa_unpack_group( sound_groupsp + 16, sound_groupsp, nib );
+
+		for (i = 0; i < nbits; i++) {
+			if (xdp->stereo) {
+				xa_filter_unit( &xdp->left,  sound_groupsp[headtable[i]+0], &nib[0][i * 2 + 0], destp+0, 2 );
+				xa_filter_unit( &xdp->right, sound_groupsp[headtable[i]+1], &nib[0][i * 2 + 1], destp+1, 2 );
+			} else {
+				xa_filter_unit( &xdp->left,  sound_groupsp[headtable[i]+0], &nib[0][i * 2 + 0], destp, 1 );
+				xa_filter_unit( &xdp->left,  sound_groupsp[headtable[i]+1], &nib[0][i * 2 + 1], destp+28, 1 );
+			}
+			destp += 28*2;
+		}
+	}
+}
+
+
+//===========================================
+static void xa_decode_data( xa_decode_t *xdp, unsigned char *srcp, short *destp ) {
 	const u8    *sound_groupsp;
 	const u8    *sound_datap, *sound_datap2;
 	int         i, j, k, nbits;
 	u16			data[4096], *datap;
-	short		*destp;
 
-	destp = xdp->pcm;
 	nbits = xdp->nbits == 4 ? 4 : 2;
 
 	if (xdp->stereo) { // stereo
@@ -163,37 +274,7 @@ static void xa_decode_data( xa_decode_t *xdp, unsigned char *srcp ) {
 				}
     		}
 		} else { // level B/C
-			for (j=0; j < 18; j++) {
-				sound_groupsp = srcp + j * 128;		// sound groups header
-				sound_datap = sound_groupsp + 16;	// sound data just after the header
-
-				for (i=0; i < nbits; i++) {
-	    			datap = data;
-	    			sound_datap2 = sound_datap + i;
-
-        			for (k=0; k < 7; k++, sound_datap2 += 16) {
-           					*(datap++) = (u16)(sound_datap2[ 0] & 0x0f) |
-                       				    ((u16)(sound_datap2[ 4] & 0x0f) <<  4) |
-                       				    ((u16)(sound_datap2[ 8] & 0x0f) <<  8) |
-                       				    ((u16)(sound_datap2[12] & 0x0f) << 12);
-					}
-	    			ADPCM_DecodeBlock16( &xdp->left,  sound_groupsp[headtable[i]+0], data,
-                   				    destp+0, 2 );
-
-	        		datap = data;
-	        		sound_datap2 = sound_datap + i;
-        			for (k=0; k < 7; k++, sound_datap2 += 16) {
-           					*(datap++) = (u16)(sound_datap2[ 0] >> 4) |
-                       	    			((u16)(sound_datap2[ 4] >> 4) <<  4) |
-                       				    ((u16)(sound_datap2[ 8] >> 4) <<  8) |
-                       				    ((u16)(sound_datap2[12] >> 4) << 12);
-					}
-					ADPCM_DecodeBlock16( &xdp->right,  sound_groupsp[headtable[i]+1], data,
-                           			    destp+1, 2 );
-
-	        		destp += 28*2;
-				}
-	    	}
+			xa_decode_groups4( xdp, srcp, destp, nbits );
 		}
 	} else { // mono
 		if ((xdp->nbits == 8) && (xdp->freq == 37800)) { // level A
@@ -226,38 +307,7 @@ static void xa_decode_data( xa_decode_t *xdp, unsigned char *srcp ) {
 				}
 	    	}
 		} else { // level B/C
-			for (j=0; j < 18; j++) {
-	    		sound_groupsp = srcp + j * 128;		// sound groups header
-	    		sound_datap = sound_groupsp + 16;	// sound data just after the header
-
-	    		for (i=0; i < nbits; i++) {
-	        		datap = data;
-	        		sound_datap2 = sound_datap + i;
-        			for (k=0; k < 7; k++, sound_datap2 += 16) {
-           					*(datap++) = (u16)(sound_datap2[ 0] & 0x0f) |
-                       				    ((u16)(sound_datap2[ 4] & 0x0f) <<  4) |
-                       				    ((u16)(sound_datap2[ 8] & 0x0f) <<  8) |
-                       				    ((u16)(sound_datap2[12] & 0x0f) << 12);
-					}
-	        		ADPCM_DecodeBlock16( &xdp->left,  sound_groupsp[headtable[i]+0], data,
-                           			    destp, 1 );
-
-	        		destp += 28;
-
-	        		datap = data;
-	        		sound_datap2 = sound_datap + i;
-        			for (k=0; k < 7; k++, sound_datap2 += 16) {
-            				*(datap++) = (u16)(sound_datap2[ 0] >> 4) |
-                       	    		    ((u16)(sound_datap2[ 4] >> 4) <<  4) |
-                        				((u16)(sound_datap2[ 8] >> 4) <<  8) |
-                        				((u16)(sound_datap2[12] >> 4) << 12);
-        			}
-	       			ADPCM_DecodeBlock16( &xdp->left,  sound_groupsp[headtable[i]+1], data,
-                           			    destp, 1 );
-
-					destp += 28;
-				}
-    		}
+			xa_decode_groups4( xdp, srcp, destp, nbits );
 		}
 	}
 }
@@ -299,7 +349,8 @@ u8  coding2;
 static int parse_xa_audio_sector( xa_decode_t *xdp, 
 								  xa_subheader_t *subheadp,
 								  unsigned char *sectorp,
-								  int is_first_sector ) {
+								  int is_first_sector,
+								  short *pcm ) {
     if ( is_first_sector ) {
 		switch ( AUDIO_CODING_GET_FREQ(subheadp->coding) ) {
 			case 0: xdp->freq = 37800;   break;
@@ -326,7 +377,7 @@ static int parse_xa_audio_sector( xa_decode_t *xdp,
 		xdp->nsamples = 18 * 28 * 8;
 		if (xdp->stereo == 1) xdp->nsamples /= 2;
     }
-	xa_decode_data( xdp, sectorp );
+	xa_decode_data( xdp, sectorp, pcm );
 
 	return 0;
 }
@@ -342,7 +393,16 @@ static int parse_xa_audio_sector( xa_decode_t *xdp,
 //================================================================
 s32 xa_decode_sector( xa_decode_t *xdp,
 					   unsigned char *sectorp, int is_first_sector ) {
-	if (parse_xa_audio_sector(xdp, (xa_subheader_t *)sectorp, sectorp + sizeof(xa_subheader_t), is_first_sector))
+	return xa_decode_sector_to( xdp, sectorp, is_first_sector, xdp->pcm );
+}
+
+//================================================================
+//=== same, but the whole sector goes to pcm (xdp->nsamples frames),
+//=== e.g. an aligned buffer the caller streams from
+//================================================================
+s32 xa_decode_sector_to( xa_decode_t *xdp,
+					   unsigned char *sectorp, int is_first_sector, short *pcm ) {
+	if (parse_xa_audio_sector(xdp, (xa_subheader_t *)sectorp, sectorp + sizeof(xa_subheader_t), is_first_sector, pcm))
 		return -1;
 
 	return 0;
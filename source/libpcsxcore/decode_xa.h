@@ -42,6 +42,10 @@ typedef struct {
 s32 xa_decode_sector( xa_decode_t *xdp,
 					   unsigned char *sectorp,
 					   int is_first_sector );
+s32 xa_decode_sector_to( xa_decode_t *xdp,
+					   unsigned char *sectorp,
+					   int is_first_sector,
+					   short *pcm );
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,517 @@
+/***************************************************************************
+ *   Copyright (C) 2007 Ryan Schultz, PCSX-df Team, PCSX team              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+/*
+* GPU command-stream recorder and replayer.
+*/
+
+#include <sys/time.h>
+
+#include "plugins.h"
+#include "psxmem.h"
+#include "gpurec.h"
+
+static const char GpuRecMagic[8] = "PSXGPUT";
+
+static FILE *recFile = NULL;
+static char *recBuf = NULL;
+
+// the real plugin entry points while recording
+static GPUwriteStatus   rec_writeStatus;
+static GPUwriteData     rec_writeData;
+static GPUwriteDataMem  rec_writeDataMem;
+static GPUreadData      rec_readData;
+static GPUreadDataMem   rec_readDataMem;
+static GPUdmaChain      rec_dmaChain;
+static GPUupdateLace    rec_updateLace;
+static GPUvBlank        rec_vBlank;
+
+static void recPut8(u8 v) {
+	fputc(v, recFile);
+}
+
+static void recPut32(u32 v) {
+	u8 b[4];
+
+	b[0] = v; b[1] = v >> 8; b[2] = v >> 16; b[3] = v >> 24;
+	fwrite(b, 1, 4, recFile);
+}
+
+// FALSE when the trace ends first
+static boolean recGet32(FILE *f, u32 *v) {
+	u8 b[4];
+
+	if (fread(b, 1, 4, f) != 4) return FALSE;
+	*v = b[0] | (b[1] << 8) | (b[2] << 16) | ((u32)b[3] << 24);
+	return TRUE;
+}
+
+static void recPutData(u32 *ptr, int size) {
+	recPut8(GPUREC_WRITEDATAMEM);
+	recPut32(size);
+	fwrite(ptr, 4, size, recFile);
+}
+
+static void CALLBACK recWriteStatus(uint32_t data) {
+	recPut8(GPUREC_WRITESTATUS);
+	recPut32(data);
+	rec_writeStatus(data);
+}
+
+static void CALLBACK recWriteData(uint32_t data) {
+	recPut8(GPUREC_WRITEDATA);
+	recPut32(data);
+	rec_writeData(data);
+}
+
+static void CALLBACK recWriteDataMem(uint32_t *ptr, int size) {
+	recPutData(ptr, size);
+	rec_writeDataMem(ptr, size);
+}
+
+static uint32_t CALLBACK recReadData(void) {
+	recPut8(GPUREC_READDATA);
+	return rec_readData();
+}
+
+static void CALLBACK recReadDataMem(uint32_t *ptr, int size) {
+	recPut8(GPUREC_READDATAMEM);
+	recPut32(size);
+	rec_readDataMem(ptr, size);
+}
+
+// The chain lives in PSX RAM, which the replayer does not have: flatten it
+// into one writeDataMem record per packet, the same way the plugins walk it.
+static long CALLBACK recDmaChain(uint32_t *baseAddrL, uint32_t addr) {
+	u8 *baseAddrB = (u8 *)baseAddrL;
+	u32 used[3] = { 0xffffff, 0xffffff, 0xffffff };
+	u32 DMACommandCounter = 0;
+	u32 start = addr;
+	u32 count;
+
+	do {
+		addr &= 0x1ffffc;
+
+		if (DMACommandCounter++ > 2000000) break;
+		if (addr == used[1] || addr == used[2]) break;
+		if (addr < used[0]) used[1] = addr;
+		else used[2] = addr;
+		used[0] = addr;
+
+		count = baseAddrB[addr + 3];
+		if (count > 0) recPutData(&baseAddrL[(addr + 4) >> 2], count);
+
+		addr = SWAPu32(baseAddrL[addr >> 2]) & 0xffffff;
+	} while (addr != 0xffffff);
+
+	return rec_dmaChain(baseAddrL, start);
+}
+
+static void CALLBACK recUpdateLace(void) {
+	recPut8(GPUREC_UPDATELACE);
+	rec_updateLace();
+}
+
+static void CALLBACK recVBlank(int val) {
+	recPut8(GPUREC_VBLANK);
+	recPut32(val);
+	rec_vBlank(val);
+}
+
+boolean GPUrec_Active() {
+	return recFile != NULL;
+}
+
+int GPUrec_Start(const char *filename) {
+	GPUFreeze_t *gpufP;
+	u32 i;
+
+	if (recFile != NULL) GPUrec_Stop();
+
+	recFile = fopen(filename, "wb");
+	if (recFile == NULL) {
+		SysPrintf(_("Could not open GPU trace %s\n"), filename);
+		return -1;
+	}
+	recBuf = (char *)malloc(1024 * 1024);
+	if (recBuf != NULL) setvbuf(recFile, recBuf, _IOFBF, 1024 * 1024);
+
+	fwrite(GpuRecMagic, 1, 8, recFile);
+	recPut32(GPUREC_VERSION);
+
+	gpufP = (GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	if (gpufP == NULL) {
+		fclose(recFile);
+		recFile = NULL;
+		free(recBuf);
+		recBuf = NULL;
+		return -1;
+	}
+	gpufP->ulFreezeVersion = 1;
+	GPU_freeze(1, gpufP);
+	recPut32(gpufP->ulFreezeVersion);
+	recPut32(gpufP->ulStatus);
+	for (i = 0; i < 256; i++) recPut32(gpufP->ulControl[i]);
+	fwrite(gpufP->psxVRam, 1, sizeof(gpufP->psxVRam), recFile);
+	free(gpufP);
+
+	rec_writeStatus = GPU_writeStatus;   GPU_writeStatus = recWriteStatus;
+	rec_writeData = GPU_writeData;       GPU_writeData = recWriteData;
+	rec_writeDataMem = GPU_writeDataMem; GPU_writeDataMem = recWriteDataMem;
+	rec_readData = GPU_readData;         GPU_readData = recReadData;
+	rec_readDataMem = GPU_readDataMem;   GPU_readDataMem = recReadDataMem;
+	rec_dmaChain = GPU_dmaChain;         GPU_dmaChain = recDmaChain;
+	rec_updateLace = GPU_updateLace;     GPU_updateLace = recUpdateLace;
+	rec_vBlank = GPU_vBlank;             GPU_vBlank = recVBlank;
+
+	SysPrintf(_("GPU trace recording to %s\n"), filename);
+	return 0;
+}
+
+void GPUrec_Stop() {
+	if (recFile == NULL) return;
+
+	GPU_writeStatus = rec_writeStatus;
+	GPU_writeData = rec_writeData;
+	GPU_writeDataMem = rec_writeDataMem;
+	GPU_readData = rec_readData;
+	GPU_readDataMem = rec_readDataMem;
+	GPU_dmaChain = rec_dmaChain;
+	GPU_updateLace = rec_updateLace;
+	GPU_vBlank = rec_vBlank;
+
+	recPut8(GPUREC_END);
+	fclose(recFile);
+	recFile = NULL;
+	free(recBuf);
+	recBuf = NULL;
+}
+
+/*
+* Replay side: a small GP0 packet parser, only used for statistics.
+*/
+
+typedef struct {
+	u32 cmd[16];
+	int len;		// words collected for the current packet
+	int need;		// words the packet needs (0 = idle)
+	int poly;		// polyline in progress
+	u32 skip;		// VRAM upload data words still to come
+	u32 prims;
+	u64 pixels;
+} GP0Parser;
+
+static inline int vtxX(u32 w) { return ((s32)w << 21) >> 21; }
+static inline int vtxY(u32 w) { return ((s32)(w >> 16) << 21) >> 21; }
+
+static u32 triArea(u32 a, u32 b, u32 c) {
+	s32 area = (vtxX(b) - vtxX(a)) * (vtxY(c) - vtxY(a)) -
+		(vtxX(c) - vtxX(a)) * (vtxY(b) - vtxY(a));
+
+	return (area < 0 ? -area : area) / 2;
+}
+
+static u32 lineLen(u32 a, u32 b) {
+	int dx = abs(vtxX(b) - vtxX(a));
+	int dy = abs(vtxY(b) - vtxY(a));
+
+	return (dx > dy ? dx : dy) + 1;
+}
+
+static int gp0Length(u32 cmd) {
+	u32 op = cmd >> 24;
+	int tex = (op & 0x04) ? 1 : 0;
+	int gouraud = (op & 0x10) ? 1 : 0;
+	int verts;
+
+	switch (op >> 5) {
+		case 0: return op == 0x02 ? 3 : 1;
+		case 1: // polygon
+			verts = (op & 0x08) ? 4 : 3;
+			return 1 + verts * (1 + tex) + (gouraud ? verts - 1 : 0);
+		case 2: // line
+			return gouraud ? 4 : 3;
+		case 3: // rectangle
+			return 2 + tex + (((op >> 3) & 3) == 0 ? 1 : 0);
+		case 4: return 4;
+		case 5:
+		case 6: return 3;
+		default: return 1;
+	}
+}
+
+static void gp0Finish(GP0Parser *p) {
+	u32 *c = p->cmd;
+	u32 op = c[0] >> 24;
+	int tex = (op & 0x04) ? 1 : 0;
+	int gouraud = (op & 0x10) ? 1 : 0;
+	int step = 1 + tex + gouraud;
+	u32 w, h;
+
+	switch (op >> 5) {
+		case 0:
+			if (op == 0x02) {
+				p->prims++;
+				p->pixels += (c[2] & 0x3ff) * ((c[2] >> 16) & 0x1ff);
+			}
+			break;
+		case 1:
+			// vertex words sit at 1, 1 + step, 1 + 2 * step... (gouraud color precedes all but the first)
+			p->prims++;
+			p->pixels += triArea(c[1], c[1 + step], c[1 + 2 * step]);
+			if (op & 0x08) p->pixels += triArea(c[1 + step], c[1 + 2 * step], c[1 + 3 * step]);
+			break;
+		case 2:
+			p->prims++;
+			p->pixels += lineLen(c[1], c[gouraud ? 3 : 2]);
+			break;
+		case 3:
+			p->prims++;
+			switch ((op >> 3) & 3) {
+				case 0: w = c[2 + tex] & 0x3ff; h = (c[2 + tex] >> 16) & 0x1ff; break;
+				case 1: w = h = 1; break;
+				case 2: w = h = 8; break;
+				default: w = h = 16; break;
+			}
+			p->pixels += w * h;
+			break;
+		case 4:
+			p->prims++;
+			p->pixels += (c[3] & 0xffff) * (c[3] >> 16);
+			break;
+		case 5:
+			w = c[2] & 0xffff; h = c[2] >> 16;
+			p->pixels += w * h;
+			p->skip = (w * h + 1) / 2;
+			break;
+	}
+}
+
+static void gp0Feed(GP0Parser *p, const u32 *data, u32 size) {
+	u32 w, n;
+
+	while (size) {
+		if (p->skip) {
+			n = p->skip < size ? p->skip : size;
+			p->skip -= n; data += n; size -= n;
+			continue;
+		}
+
+		w = SWAPu32(*data); data++; size--;
+
+		if (p->poly) {
+			if ((w & 0xf000f000) == 0x50005000) { p->poly = 0; continue; }
+			// gouraud polylines interleave colors, only count the vertices
+			if ((p->cmd[0] >> 24) & 0x10) {
+				if (++p->len & 1) continue;
+			}
+			p->prims++;
+			p->pixels += lineLen(p->cmd[1], w);
+			p->cmd[1] = w;
+			continue;
+		}
+
+		if (p->need == 0) {
+			p->need = gp0Length(w);
+			p->len = 0;
+		}
+		p->cmd[p->len++] = w;
+		if (p->len < p->need) continue;
+
+		p->need = 0;
+		if ((p->cmd[0] >> 29) == 2 && (p->cmd[0] & 0x08000000)) {
+			// polyline: first segment is complete, the rest streams in until the terminator
+			gp0Finish(p);
+			p->cmd[1] = p->cmd[p->len - 1];
+			p->poly = 1;
+			p->len = 0;
+			continue;
+		}
+		gp0Finish(p);
+	}
+}
+
+static u32 vramChecksum(GPUFreeze_t *gpufP) {
+	GPU_freeze(1, gpufP);
+	return crc32(0, gpufP->psxVRam, sizeof(gpufP->psxVRam));
+}
+
+// room for count data words, FALSE when there is none
+static boolean dataRoom(u32 **data, u32 *datasize, u32 count) {
+	u32 *p;
+
+	if (count <= *datasize) return TRUE;
+
+	p = (u32 *)realloc(*data, count * 4);
+	if (p == NULL) return FALSE;
+
+	*data = p;
+	*datasize = count;
+	return TRUE;
+}
+
+static u64 usecNow() {
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+int GPUrec_Replay(const char *filename, boolean verbose, GPUrecStats *stats) {
+	GP0Parser p;
+	GPUFreeze_t *gpufP;
+	u32 *data = NULL, datasize = 0;
+	u32 frameprims = 0;
+	u64 start, framepixels = 0;
+	char magic[8];
+	FILE *f;
+	int type, i, ret = 0;
+	boolean ok, cut = FALSE;
+	u32 v, w;
+
+	f = fopen(filename, "rb");
+	if (f == NULL) return -1;
+
+	if (fread(magic, 1, 8, f) != 8 || memcmp(magic, GpuRecMagic, 8) != 0 ||
+		!recGet32(f, &v) || v != GPUREC_VERSION) {
+		SysPrintf(_("%s is not a GPU trace\n"), filename);
+		fclose(f);
+		return -1;
+	}
+
+	gpufP = (GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	if (gpufP == NULL) {
+		fclose(f);
+		return -1;
+	}
+	ok = recGet32(f, &v);
+	gpufP->ulFreezeVersion = v;
+	ok = ok && recGet32(f, &v);
+	gpufP->ulStatus = v;
+	for (i = 0; i < 256 && ok; i++) {
+		ok = recGet32(f, &v);
+		gpufP->ulControl[i] = v;
+	}
+	if (!ok || fread(gpufP->psxVRam, 1, sizeof(gpufP->psxVRam), f) != sizeof(gpufP->psxVRam)) {
+		SysPrintf(_("%s is not a GPU trace\n"), filename);
+		free(gpufP);
+		fclose(f);
+		return -1;
+	}
+	GPU_freeze(0, gpufP);
+
+	memset(&p, 0, sizeof(p));
+	memset(stats, 0, sizeof(GPUrecStats));
+	start = usecNow();
+
+	while ((type = fgetc(f)) != EOF && type != GPUREC_END) {
+		switch (type) {
+			case GPUREC_WRITESTATUS:
+				if (!recGet32(f, &v)) { cut = TRUE; break; }
+				GPU_writeStatus(v);
+				break;
+
+			case GPUREC_WRITEDATA:
+				// the plugin gets the value, the parser takes psx order like the data from memory
+				if (!recGet32(f, &v)) { cut = TRUE; break; }
+				w = SWAPu32(v);
+				gp0Feed(&p, &w, 1);
+				GPU_writeData(v);
+				stats->words++;
+				break;
+
+			case GPUREC_WRITEDATAMEM:
+				if (!recGet32(f, &v)) { cut = TRUE; break; }
+				if (!dataRoom(&data, &datasize, v)) {
+					SysPrintf(_("No memory for %u words of GPU trace data\n"), v);
+					ret = -1;
+					type = GPUREC_END;
+					break;
+				}
+				if (fread(data, 4, v, f) != v) { cut = TRUE; break; }
+				gp0Feed(&p, data, v);
+				GPU_writeDataMem(data, v);
+				stats->words += v;
+				break;
+
+			case GPUREC_READDATA:
+				GPU_readData();
+				break;
+
+			case GPUREC_READDATAMEM:
+				if (!recGet32(f, &v)) { cut = TRUE; break; }
+				if (!dataRoom(&data, &datasize, v)) {
+					SysPrintf(_("No memory for %u words of GPU trace data\n"), v);
+					ret = -1;
+					type = GPUREC_END;
+					break;
+				}
+				GPU_readDataMem(data, v);
+				break;
+
+			case GPUREC_UPDATELACE:
+				GPU_updateLace();
+				if (verbose) {
+					SysPrintf("frame %u: %u prims, %llu pixels, vram %08x\n", stats->frames,
+						p.prims - frameprims, (unsigned long long)(p.pixels - framepixels), vramChecksum(gpufP));
+				}
+				frameprims = p.prims;
+				framepixels = p.pixels;
+				stats->frames++;
+				break;
+
+			case GPUREC_VBLANK:
+				if (!recGet32(f, &v)) { cut = TRUE; break; }
+				GPU_vBlank(v);
+				break;
+
+			default:
+				SysPrintf(_("Corrupt GPU trace record %d\n"), type);
+				ret = -1;
+				type = GPUREC_END;
+				break;
+		}
+		if (cut) {
+			SysPrintf(_("GPU trace ends in the middle of a record\n"));
+			ret = -1;
+			break;
+		}
+		if (type == GPUREC_END) break;
+	}
+	if (type == EOF) {
+		SysPrintf(_("GPU trace ends without its end record\n"));
+		ret = -1;
+	}
+
+	stats->usec = usecNow() - start;
+	stats->prims = p.prims;
+	stats->pixels = p.pixels;
+
+	if (stats->usec) {
+		SysPrintf("GPU replay: %u frames, %u prims (%.0f/s), %llu pixels (%.0f/s), vram %08x\n",
+			stats->frames, stats->prims, (double)stats->prims * 1000000.0 / stats->usec,
+			(unsigned long long)stats->pixels, (double)stats->pixels * 1000000.0 / stats->usec,
+			vramChecksum(gpufP));
+	}
+
+	free(data);
+	free(gpufP);
+	fclose(f);
+	return ret;
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Copyright (C) 2007 Ryan Schultz, PCSX-df Team, PCSX team              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#ifndef __GPUREC_H__
+#define __GPUREC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psxcommon.h"
+
+/*
+ * GPU command-stream trace.
+ *
+ * File layout (all header fields little endian):
+ *   "PSXGPUT\0", u32 version, GPUFreeze_t snapshot (as returned by GPUfreeze)
+ *   records: u8 type, followed by the type's payload
+ *
+ * Data words are stored exactly as the core hands them to the plugin
+ * (PSX memory order). The snapshot's VRAM is the plugin's image, which the
+ * soft and the hw gpu both keep in psx order (PUTLE16/GETLE16), so with
+ * either of them a trace replays on any host. A record cut short ends the
+ * replay with an error.
+ */
+
+#define GPUREC_VERSION			1
+
+enum {
+	GPUREC_END = 0,
+	GPUREC_WRITESTATUS,		// u32 value
+	GPUREC_WRITEDATA,		// u32 value
+	GPUREC_WRITEDATAMEM,	// u32 count, count * u32
+	GPUREC_READDATA,		// -
+	GPUREC_READDATAMEM,		// u32 count
+	GPUREC_UPDATELACE,		// - (frame boundary)
+	GPUREC_VBLANK,			// u32 value
+};
+
+typedef struct {
+	u32 frames;
+	u32 prims;
+	u64 pixels;
+	u64 words;
+	u64 usec;
+} GPUrecStats;
+
+int GPUrec_Start(const char *filename);
+void GPUrec_Stop();
+boolean GPUrec_Active();
+
+// Drive the loaded GPU plugin from a trace as fast as possible.
+// Prints per-frame primitive/pixel counts and a VRAM checksum when verbose.
+// -1 when the trace can't be read to its end.
+int GPUrec_Replay(const char *filename, boolean verbose, GPUrecStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -23,6 +23,8 @@
 
 #include "misc.h"
 #include "cdrom.h"
+#include "cdrprefetch.h"
+#include "movie.h"
 #include "mdec.h"
 #include "ppf.h"
 
@@ -89,6 +91,7 @@ void mmssdd( char *b, char *p )
 	time[0] = itob(time[0]); time[1] = itob(time[1]); time[2] = itob(time[2]);
 
 #define READTRACK() \
+	cdrPrefetchStop(); \
 	if (CDR_readTrack(time) == -1) return -1; \
 	buf = CDR_getBuffer(); \
 	if (buf == NULL) return -1; else CheckPPFCache(buf, time[0], time[1], time[2]);
@@ -501,6 +504,16 @@ static const char PcsxrHeader[32] = "STv4 PCSXR v" PACKAGE_VERSION;
 // If you make changes to the savestate version, please increment the value below.
 static const u32 SaveVersion = 0x8b410008;
 
+// mode 2 only fills in the header: name, version and the size a freeze takes
+static u32 SPUFreezeSize() {
+	u8 header[offsetof(SPUFreeze_t, SPUPorts)];
+	u32 size;
+
+	SPU_freeze(2, (SPUFreeze_t *)header);
+	memcpy(&size, header + offsetof(SPUFreeze_t, Size), sizeof(size));
+	return size;
+}
+
 int SaveState(const char *file) {
 	gzFile f;
 	GPUFreeze_t *gpufP;
@@ -537,10 +550,7 @@ int SaveState(const char *file) {
 	free(gpufP);
 
 	// spu
-	spufP = (SPUFreeze_t *) malloc(16);
-	SPU_freeze(2, spufP);
-	Size = spufP->Size; gzwrite(f, &Size, 4);
-	free(spufP);
+	Size = SPUFreezeSize(); gzwrite(f, &Size, 4);
 	spufP = (SPUFreeze_t *) malloc(Size);
 	SPU_freeze(1, spufP);
 	gzwrite(f, spufP, Size);
@@ -578,6 +588,9 @@ int LoadState(const char *file) {
 		return -1;
 	}
 
+	// the movie input doesn't fit this state
+	Movie_Stop();
+
 	psxCpu->Reset();
 	gzseek(f, 128 * 96 * 3, SEEK_CUR);
 
@@ -634,6 +647,125 @@ int CheckState(const char *file) {
 	return 0;
 }
 
+// RAM SNAPSHOTS
+//
+// The same data as a state file, copied raw to and from memory, cheap
+// enough to take every frame. The freeze functions get no file and go
+// through freezeMem instead.
+
+#define SNAP_PAGE	0x1000
+
+u8 *freezeMem;
+
+static struct {
+	u8 *ram;
+	u8 *rom;		// HLE bios state lives in there
+	u8 *hw;
+	u8 *core;		// sio, cdr, hw, rcnt and mdec
+	GPUFreeze_t *gpu;
+	SPUFreeze_t *spu;
+	psxRegisters regs;
+} snap;
+
+static void FreezeCore(int Mode) {
+	gzFile f = NULL;
+
+	sioFreeze(f, Mode);
+	cdrFreeze(f, Mode);
+	psxHwFreeze(f, Mode);
+	psxRcntFreeze(f, Mode);
+	mdecFreeze(f, Mode);
+}
+
+static int AllocSnapshot() {
+	u32 size, spuSize;
+
+	// a pass that only counts
+	freezeMem = NULL;
+	FreezeCore(2);
+	size = (u32)(uintptr_t)freezeMem;
+
+	spuSize = SPUFreezeSize();
+
+	snap.ram = (u8 *)malloc(0x00200000);
+	snap.rom = (u8 *)malloc(0x00080000);
+	snap.hw = (u8 *)malloc(0x00010000);
+	snap.core = (u8 *)malloc(size);
+	snap.gpu = (GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	snap.spu = (SPUFreeze_t *)malloc(spuSize);
+
+	if (snap.ram == NULL || snap.rom == NULL || snap.hw == NULL ||
+		snap.core == NULL || snap.gpu == NULL || snap.spu == NULL) {
+		FreeSnapshot();
+		return -1;
+	}
+
+	return 0;
+}
+
+void FreeSnapshot() {
+	free(snap.ram);
+	free(snap.rom);
+	free(snap.hw);
+	free(snap.core);
+	free(snap.gpu);
+	free(snap.spu);
+	memset(&snap, 0, sizeof(snap));
+}
+
+int SaveSnapshot() {
+	if (snap.ram == NULL && AllocSnapshot() < 0)
+		return -1;
+
+	if (Config.HLE) {
+		psxBiosFreeze(1);
+		memcpy(snap.rom, psxR, 0x00080000);
+	}
+
+	memcpy(snap.ram, psxM, 0x00200000);
+	memcpy(snap.hw, psxH, 0x00010000);
+	snap.regs = psxRegs;
+
+	snap.gpu->ulFreezeVersion = 1;
+	GPU_freeze(1, snap.gpu);
+	SPU_freeze(1, snap.spu);
+
+	freezeMem = snap.core;
+	FreezeCore(1);
+
+	return 0;
+}
+
+int LoadSnapshot() {
+	u32 i;
+
+	if (snap.ram == NULL)
+		return -1;
+
+	// only the pages that changed, and the recompiler drops their code
+	for (i = 0; i < 0x00200000; i += SNAP_PAGE) {
+		if (memcmp(psxM + i, snap.ram + i, SNAP_PAGE) != 0) {
+			memcpy(psxM + i, snap.ram + i, SNAP_PAGE);
+			psxCpu->Clear(i, SNAP_PAGE / 4);
+		}
+	}
+	memcpy(psxH, snap.hw, 0x00010000);
+	psxRegs = snap.regs;
+
+	if (Config.HLE) {
+		memcpy(psxR, snap.rom, 0x00080000);
+		psxBiosFreeze(0);
+	}
+
+	GPU_freeze(0, snap.gpu);
+	SPU_freeze(0, snap.spu);
+
+	freezeMem = snap.core;
+	FreezeCore(0);
+
+	return 0;
+}
+
 // NET Function Helpers
 
 int SendPcsxInfo() {
@@ -65,6 +65,10 @@ int SaveState(const char *file);
 int LoadState(const char *file);
 int CheckState(const char *file);
 
+int SaveSnapshot();
+int LoadSnapshot();
+void FreeSnapshot();
+
 int SendPcsxInfo();
 int RecvPcsxInfo();
 
@@ -0,0 +1,419 @@
+/***************************************************************************
+ *   Input movies: pad input recorded per poll and played back             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+/*
+ * The pad plugins are swapped for stand-ins the way gpurec.c swaps the gpu:
+ * while recording they pass every startPoll/poll on to the real plugin and
+ * log the answers, while playing they answer from the movie and the real
+ * pads are not asked at all. Everything else about the emulation has to be
+ * deterministic for the game to poll the same way again; every
+ * MOVIE_HASH_FRAMES frames a hash of the psx state checks that it is.
+ * A spu that mixes on its own thread raises its irq on host time, so games
+ * that wait for it may not replay: use a spu timed by SPUasync for movies.
+ */
+
+#include <sys/time.h>
+
+#include "r3000a.h"
+#include "psxmem.h"
+#include "plugins.h"
+#include "misc.h"
+#include "movie.h"
+
+#define MOVIE_HASH_FRAMES	60
+
+static const char MovieMagic[8] = "PSXMOVI";
+
+enum {
+	MOVIE_OFF = 0,
+	MOVIE_RECORDING,
+	MOVIE_PLAYING,
+};
+
+static struct {
+	int mode;
+	FILE *f;
+	char *fbuf;
+	u32 interval;
+	u32 frame;
+	u64 start;
+
+	// the poll being answered, recorded once the next one starts
+	u8 port;
+	u32 pollFrame;
+	u8 data[256];
+	int count, pos;
+
+	// playing: the record up next
+	int type;
+	u32 nextFrame;
+	u8 nextPort;
+	u32 nextHash;
+	u8 nextCount;
+	u8 next[256];
+
+	MovieStats stats;
+} mv;
+
+// the real plugin entry points
+static PADstartPoll mv_startPoll1, mv_startPoll2;
+static PADpoll      mv_poll1, mv_poll2;
+
+static void mvPut8(u8 v) {
+	fputc(v, mv.f);
+}
+
+static void mvPut32(u32 v) {
+	u8 b[4];
+
+	b[0] = v; b[1] = v >> 8; b[2] = v >> 16; b[3] = v >> 24;
+	fwrite(b, 1, 4, mv.f);
+}
+
+static u32 mvGet32() {
+	u8 b[4];
+
+	if (fread(b, 1, 4, mv.f) != 4) return 0;
+	return b[0] | (b[1] << 8) | (b[2] << 16) | ((u32)b[3] << 24);
+}
+
+static u64 usecNow() {
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// psx memory is little endian on every host, the registers are swapped to it
+static u32 stateHash() {
+	u32 regs[34 + 32 + 32 + 32 + 2];
+	u32 crc, i, n = 0;
+
+	for (i = 0; i < 34; i++) regs[n++] = SWAPu32(psxRegs.GPR.r[i]);
+	for (i = 0; i < 32; i++) regs[n++] = SWAPu32(psxRegs.CP0.r[i]);
+	for (i = 0; i < 32; i++) regs[n++] = SWAPu32(psxRegs.CP2D.r[i]);
+	for (i = 0; i < 32; i++) regs[n++] = SWAPu32(psxRegs.CP2C.r[i]);
+	regs[n++] = SWAPu32(psxRegs.pc);
+	regs[n++] = SWAPu32(psxRegs.cycle);
+
+	crc = crc32(0, (Bytef *)psxM, 0x00200000);
+	crc = crc32(crc, (Bytef *)psxH, 0x00010000);
+	return crc32(crc, (Bytef *)regs, sizeof(regs));
+}
+
+static void StateFilename(char *out, const char *filename) {
+	snprintf(out, MAXPATHLEN, "%s.sta", filename);
+}
+
+static int Anchor(const char *filename, int anchor, boolean save) {
+	char state[MAXPATHLEN];
+
+	StateFilename(state, filename);
+
+	if (anchor == MOVIE_STATE)
+		return save ? SaveState(state) : LoadState(state);
+
+	EmuReset();
+	CheckCdrom();
+	LoadCdrom();
+	return 0;
+}
+
+/*
+ * Recording
+ */
+
+static void recFlush() {
+	if (mv.count == 0) return;
+
+	mvPut8(MOVIE_POLL);
+	mvPut32(mv.pollFrame);
+	mvPut8(mv.port);
+	mvPut8(mv.count);
+	fwrite(mv.data, 1, mv.count, mv.f);
+
+	mv.stats.polls++;
+	mv.count = 0;
+}
+
+static unsigned char recBegin(u8 port, unsigned char value) {
+	recFlush();
+	mv.pollFrame = mv.frame;
+	mv.port = port;
+	mv.data[mv.count++] = value;
+	return value;
+}
+
+static unsigned char recNext(unsigned char value) {
+	if (mv.count > 0 && mv.count < 255) mv.data[mv.count++] = value;
+	return value;
+}
+
+static unsigned char CALLBACK recStartPoll1(int pad) {
+	return recBegin(1, mv_startPoll1(pad));
+}
+
+static unsigned char CALLBACK recStartPoll2(int pad) {
+	return recBegin(2, mv_startPoll2(pad));
+}
+
+static unsigned char CALLBACK recPoll1(unsigned char value) {
+	return recNext(mv_poll1(value));
+}
+
+static unsigned char CALLBACK recPoll2(unsigned char value) {
+	return recNext(mv_poll2(value));
+}
+
+/*
+ * Playback
+ */
+
+static void playRead() {
+	int type = fgetc(mv.f);
+
+	switch (type) {
+		case MOVIE_POLL:
+			mv.nextFrame = mvGet32();
+			mv.nextPort = fgetc(mv.f);
+			mv.nextCount = fgetc(mv.f);
+			if (fread(mv.next, 1, mv.nextCount, mv.f) != mv.nextCount) type = MOVIE_END;
+			break;
+
+		case MOVIE_HASH:
+			mv.nextFrame = mvGet32();
+			mv.nextHash = mvGet32();
+			break;
+
+		default:
+			type = MOVIE_END;
+			break;
+	}
+	mv.type = feof(mv.f) ? MOVIE_END : type;
+}
+
+static void playDesync(const char *what) {
+	SysPrintf(_("Movie desync at frame %u: %s, playback stopped\n"), mv.frame, what);
+	if (mv.stats.desyncs++ == 0) mv.stats.firstDesync = mv.frame;
+	Movie_Stop();
+}
+
+static unsigned char playBegin(u8 port) {
+	if (mv.type != MOVIE_POLL || mv.nextPort != port || mv.nextFrame != mv.frame) {
+		playDesync("poll not in the movie");
+		return 0xff;
+	}
+
+	memcpy(mv.data, mv.next, mv.nextCount);
+	mv.count = mv.nextCount;
+	mv.pos = 1;
+	mv.stats.polls++;
+	playRead();
+
+	return mv.data[0];
+}
+
+static unsigned char CALLBACK playStartPoll1(int pad) {
+	return playBegin(1);
+}
+
+static unsigned char CALLBACK playStartPoll2(int pad) {
+	return playBegin(2);
+}
+
+// past the recorded answer a pad says 0, like _PADpoll
+static unsigned char CALLBACK playPoll(unsigned char value) {
+	if (mv.pos >= mv.count) return 0;
+	return mv.data[mv.pos++];
+}
+
+/*
+ * Both
+ */
+
+static int Open(const char *filename, const char *mode) {
+	mv.f = fopen(filename, mode);
+	if (mv.f == NULL) {
+		SysPrintf(_("Could not open movie %s\n"), filename);
+		return -1;
+	}
+	mv.fbuf = (char *)malloc(64 * 1024);
+	if (mv.fbuf != NULL) setvbuf(mv.f, mv.fbuf, _IOFBF, 64 * 1024);
+	return 0;
+}
+
+static void Close() {
+	fclose(mv.f);
+	mv.f = NULL;
+	free(mv.fbuf);
+	mv.fbuf = NULL;
+}
+
+static void Begin(int mode) {
+	mv_startPoll1 = PAD1_startPoll;
+	mv_startPoll2 = PAD2_startPoll;
+	mv_poll1 = PAD1_poll;
+	mv_poll2 = PAD2_poll;
+
+	if (mode == MOVIE_RECORDING) {
+		PAD1_startPoll = recStartPoll1; PAD1_poll = recPoll1;
+		PAD2_startPoll = recStartPoll2; PAD2_poll = recPoll2;
+	} else {
+		PAD1_startPoll = playStartPoll1; PAD1_poll = playPoll;
+		PAD2_startPoll = playStartPoll2; PAD2_poll = playPoll;
+	}
+
+	memset(&mv.stats, 0, sizeof(mv.stats));
+	mv.mode = mode;
+	mv.frame = 0;
+	mv.count = mv.pos = 0;
+	mv.start = usecNow();
+}
+
+int Movie_Record(const char *filename, int anchor) {
+	Movie_Stop();
+
+	if (Open(filename, "wb") < 0) return -1;
+
+	if (Anchor(filename, anchor, TRUE) < 0) {
+		SysPrintf(_("Could not save the movie start %s.sta\n"), filename);
+		Close();
+		return -1;
+	}
+
+	fwrite(MovieMagic, 1, 8, mv.f);
+	mvPut32(MOVIE_VERSION);
+	mvPut32(anchor);
+	fwrite(CdromId, 1, 10, mv.f);
+	mv.interval = MOVIE_HASH_FRAMES;
+	mvPut32(mv.interval);
+
+	Begin(MOVIE_RECORDING);
+
+	SysPrintf(_("Movie recording to %s\n"), filename);
+	return 0;
+}
+
+int Movie_Play(const char *filename) {
+	char magic[8], id[10];
+	u32 anchor;
+
+	Movie_Stop();
+
+	if (Open(filename, "rb") < 0) return -1;
+
+	if (fread(magic, 1, 8, mv.f) != 8 || memcmp(magic, MovieMagic, 8) != 0 ||
+		mvGet32() != MOVIE_VERSION) {
+		SysPrintf(_("%s is not a movie\n"), filename);
+		Close();
+		return -1;
+	}
+	anchor = mvGet32();
+	fread(id, 1, 10, mv.f);
+	mv.interval = mvGet32();
+
+	if (strncmp(id, CdromId, 10) != 0)
+		SysPrintf(_("Movie %s was recorded with %.10s, not %.10s\n"), filename, id, CdromId);
+
+	if (Anchor(filename, anchor, FALSE) < 0) {
+		SysPrintf(_("Could not load the movie start %s.sta\n"), filename);
+		Close();
+		return -1;
+	}
+
+	Begin(MOVIE_PLAYING);
+	playRead();
+
+	SysPrintf(_("Movie playing from %s\n"), filename);
+	return 0;
+}
+
+void Movie_Stop() {
+	MovieStats *s = &mv.stats;
+
+	if (mv.mode == MOVIE_OFF || mv.f == NULL) return;
+
+	PAD1_startPoll = mv_startPoll1;
+	PAD2_startPoll = mv_startPoll2;
+	PAD1_poll = mv_poll1;
+	PAD2_poll = mv_poll2;
+
+	if (mv.mode == MOVIE_RECORDING) {
+		recFlush();
+		mvPut8(MOVIE_END);
+	}
+	Close();
+
+	s->frames = mv.frame;
+	s->usec = usecNow() - mv.start;
+
+	SysPrintf("Movie %s: %u frames in %u ms (%.1f fps), %u polls, %u hashes, %u desyncs",
+		mv.mode == MOVIE_RECORDING ? "recorded" : "played", s->frames, (u32)(s->usec / 1000),
+		s->usec ? (double)s->frames * 1000000.0 / s->usec : 0.0, s->polls, s->hashes, s->desyncs);
+	if (s->desyncs) SysPrintf(" (first at frame %u)", s->firstDesync);
+	SysPrintf("\n");
+
+	mv.mode = MOVIE_OFF;
+}
+
+boolean Movie_Active() {
+	return mv.mode != MOVIE_OFF;
+}
+
+void Movie_VSync() {
+	if (mv.mode == MOVIE_OFF) return;
+
+	mv.frame++;
+
+	if (mv.mode == MOVIE_RECORDING) {
+		if (mv.frame % mv.interval == 0) {
+			recFlush();
+			mvPut8(MOVIE_HASH);
+			mvPut32(mv.frame);
+			mvPut32(stateHash());
+			mv.stats.hashes++;
+			fflush(mv.f);	// complete up to here, should the console just be switched off
+		}
+		return;
+	}
+
+	// a poll of the movie the game didn't do
+	if (mv.type == MOVIE_POLL && mv.nextFrame < mv.frame) {
+		playDesync("poll in the movie not done");
+		return;
+	}
+
+	if (mv.type == MOVIE_HASH && mv.nextFrame == mv.frame) {
+		mv.stats.hashes++;
+		if (mv.nextHash != stateHash()) {
+			SysPrintf(_("Movie desync at frame %u: state hash differs\n"), mv.frame);
+			if (mv.stats.desyncs++ == 0) mv.stats.firstDesync = mv.frame;
+		}
+		playRead();
+	}
+
+	if (mv.type == MOVIE_END) {
+		SysPrintf(_("Movie finished\n"));
+		Movie_Stop();
+	}
+}
+
+void Movie_GetStats(MovieStats *stats) {
+	*stats = mv.stats;
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Input movies: pad input recorded per poll and played back             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#ifndef __MOVIE_H__
+#define __MOVIE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psxcommon.h"
+
+/*
+ * Input movie.
+ *
+ * File layout (all fields little endian):
+ *   "PSXMOVI\0", u32 version, u32 anchor, char CdromId[10],
+ *   u32 frames between state hashes
+ *   records: u8 type, followed by the type's payload
+ *
+ * A poll record holds what the pad answered to one startPoll and the polls
+ * after it, so it replays the same whatever pad plugin was recorded. With
+ * MOVIE_STATE the movie starts from a save state kept next to it, in
+ * <file>.sta.
+ */
+
+#define MOVIE_VERSION			1
+
+#define MOVIE_POWERON			0	// starts with a reset
+#define MOVIE_STATE				1	// starts with loading <file>.sta
+
+enum {
+	MOVIE_END = 0,
+	MOVIE_POLL,				// u32 frame, u8 port, u8 count, count * u8
+	MOVIE_HASH,				// u32 frame, u32 crc32 of ram, hw and cpu state
+};
+
+typedef struct {
+	u32 frames;
+	u32 polls;
+	u32 hashes;		// checked while playing, written while recording
+	u32 desyncs;	// hashes that didn't match
+	u32 firstDesync;	// frame of the first one
+	u64 usec;
+} MovieStats;
+
+int Movie_Record(const char *filename, int anchor);
+
+// Replaces the pad plugins by the movie until it ends, then the pads are
+// live again. Desyncs are reported, a movie that doesn't fit the game's
+// polls any more stops.
+int Movie_Play(const char *filename);
+
+void Movie_Stop();
+boolean Movie_Active();
+
+// psx vsync, from EmuUpdate
+void Movie_VSync();
+
+void Movie_GetStats(MovieStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
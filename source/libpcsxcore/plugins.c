@@ -23,6 +23,9 @@
 
 #include "plugins.h"
 #include "cdriso.h"
+#include "cdrprefetch.h"
+#include "gpurec.h"
+#include "movie.h"
 
 static char IsoFile[MAXPATHLEN] = "";
 static s64 cdOpenCaseTime = 0;
@@ -54,6 +57,8 @@ GPUvBlank             GPU_vBlank;
 GPUvisualVibration    GPU_visualVibration;
 GPUcursor             GPU_cursor;
 GPUaddVertex          GPU_addVertex;
+GPUsetSpeed           GPU_setSpeed;
+GPUsetOutput          GPU_setOutput;
 
 CDRinit               CDR_init;
 CDRshutdown           CDR_shutdown;
@@ -94,6 +99,8 @@ SPUfreeze             SPU_freeze;
 SPUregisterCallback   SPU_registerCallback;
 SPUasync              SPU_async;
 SPUplayCDDAchannel    SPU_playCDDAchannel;
+SPUsetSpeed           SPU_setSpeed;
+SPUsetOutput          SPU_setOutput;
 
 PADconfigure          PAD1_configure;
 PADabout              PAD1_about;
@@ -213,6 +220,8 @@ void CALLBACK GPU__vBlank(int val) {}
 void CALLBACK GPU__visualVibration(unsigned long iSmall, unsigned long iBig) {}
 void CALLBACK GPU__cursor(int player, int x, int y) {}
 void CALLBACK GPU__addVertex(short sx,short sy,s64 fx,s64 fy,s64 fz) {}
+void CALLBACK GPU__setSpeed(float speed) {}
+void CALLBACK GPU__setOutput(int on) {}
 
 #define LoadGpuSym1(dest, name) \
 	LoadSym(GPU_##dest, GPU##dest, name, TRUE);
@@ -257,6 +266,8 @@ static int LoadGPUplugin(const char *GPUdll) {
     LoadGpuSym0(visualVibration, "GPUvisualVibration");
     LoadGpuSym0(cursor, "GPUcursor");
 	LoadGpuSym0(addVertex, "GPUaddVertex");
+	LoadGpuSym0(setSpeed, "GPUsetSpeed");
+	LoadGpuSym0(setOutput, "GPUsetOutput");
 	LoadGpuSym0(configure, "GPUconfigure");
 	LoadGpuSym0(test, "GPUtest");
 	LoadGpuSym0(about, "GPUabout");
@@ -336,6 +347,8 @@ void *hSPUDriver = NULL;
 long CALLBACK SPU__configure(void) { return 0; }
 void CALLBACK SPU__about(void) {}
 long CALLBACK SPU__test(void) { return 0; }
+void CALLBACK SPU__setSpeed(float speed) {}
+void CALLBACK SPU__setOutput(int on) {}
 
 #define LoadSpuSym1(dest, name) \
 	LoadSym(SPU_##dest, SPU##dest, name, TRUE);
@@ -374,6 +387,8 @@ static int LoadSPUplugin(const char *SPUdll) {
 	LoadSpuSym1(registerCallback, "SPUregisterCallback");
 	LoadSpuSymN(async, "SPUasync");
 	LoadSpuSymN(playCDDAchannel, "SPUplayCDDAchannel");
+	LoadSpuSym0(setSpeed, "SPUsetSpeed");
+	LoadSpuSym0(setOutput, "SPUsetOutput");
 
 	return 0;
 }
@@ -791,6 +806,10 @@ void ReleasePlugins() {
 	}
 	NetOpened = FALSE;
 
+	GPUrec_Stop();
+	Movie_Stop();
+	cdrPrefetchReset();
+
 	if (hCDRDriver != NULL || cdrIsoActive()) CDR_shutdown();
 	if (hGPUDriver != NULL) GPU_shutdown();
 	if (hSPUDriver != NULL) SPU_shutdown();
@@ -98,6 +98,8 @@ typedef void (CALLBACK* GPUvBlank)(int);
 typedef void (CALLBACK* GPUvisualVibration)(uint32_t, uint32_t);
 typedef void (CALLBACK* GPUcursor)(int, int, int);
 typedef void (CALLBACK* GPUaddVertex)(short,short,s64,s64,s64);
+typedef void (CALLBACK* GPUsetSpeed)(float);
+typedef void (CALLBACK* GPUsetOutput)(int);
 
 // GPU function pointers
 extern GPUupdateLace    GPU_updateLace;
@@ -127,6 +129,8 @@ extern GPUvBlank        GPU_vBlank;
 extern GPUvisualVibration GPU_visualVibration;
 extern GPUcursor        GPU_cursor;
 extern GPUaddVertex     GPU_addVertex;
+extern GPUsetSpeed      GPU_setSpeed;
+extern GPUsetOutput     GPU_setOutput;
 
 // CD-ROM Functions
 typedef long (CALLBACK* CDRinit)(void);
@@ -214,6 +218,8 @@ typedef struct {
 typedef long (CALLBACK* SPUfreeze)(uint32_t, SPUFreeze_t *);
 typedef void (CALLBACK* SPUasync)(uint32_t);
 typedef void (CALLBACK* SPUplayCDDAchannel)(short *, int);
+typedef void (CALLBACK* SPUsetSpeed)(float);
+typedef void (CALLBACK* SPUsetOutput)(int);
 
 // SPU function pointers
 extern SPUconfigure        SPU_configure;
@@ -235,6 +241,8 @@ extern SPUfreeze           SPU_freeze;
 extern SPUregisterCallback SPU_registerCallback;
 extern SPUasync            SPU_async;
 extern SPUplayCDDAchannel  SPU_playCDDAchannel;
+extern SPUsetSpeed         SPU_setSpeed;
+extern SPUsetOutput        SPU_setOutput;
 
 // PAD Functions
 typedef long (CALLBACK* PADconfigure)(void);
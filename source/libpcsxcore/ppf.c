@@ -1,4 +1,4 @@
-/*  PPF/SBI Support for PCSX-Reloaded
+/*  PPF/IPS/BPS/SBI Support for PCSX-Reloaded
  *  Copyright (c) 2009, Wei Mingzhi <whistler_wmz@users.sf.net>.
  *  Copyright (c) 2010, shalma.
  *
@@ -24,202 +24,240 @@
 #include "ppf.h"
 #include "cdrom.h"
 
+// Patches of all formats end up as per sector records. They are appended
+// while loading, sorted once, and overlapping records of a sector are merged
+// (later records win), so CheckPPFCache only has to binary search a sector.
+
+#define PPF_NOUNDO		0xffffffff
+
 typedef struct tagPPF_DATA {
-	s32					addr;
-	s32					pos;
-	s32					anz;
-	struct tagPPF_DATA	*pNext;
+	s32					addr;	// sector
+	s32					pos;	// byte offset in the raw sector
+	s32					anz;	// byte count
+	s32					seq;	// load order
+	u32					data;	// patch bytes in ppfPool
+	u32					undo;	// original bytes in ppfPool (PPF3 undo data) or PPF_NOUNDO
 } PPF_DATA;
 
 typedef struct tagPPF_CACHE {
 	s32					addr;
-	struct tagPPF_DATA	*pNext;
+	s32					first;	// first record of the sector
+	s32					count;
 } PPF_CACHE;
 
 static PPF_CACHE		*ppfCache = NULL;
-static PPF_DATA			*ppfHead = NULL, *ppfLast = NULL;
 static int				iPPFNum = 0;
 
-// using a linked data list, and address array
-static void FillPPFCache() {
-	PPF_DATA		*p;
-	PPF_CACHE		*pc;
-	s32				lastaddr;
+static PPF_DATA			*ppfData = NULL;
+static int				iPPFData = 0, iPPFDataMax = 0;
 
-	p = ppfHead;
-	lastaddr = -1;
-	iPPFNum = 0;
+static u8				*ppfPool = NULL;
+static u32				iPPFPool = 0, iPPFPoolMax = 0;
+
+static boolean			ppfUndoWarned = FALSE;
+
+// the records and the pool only grow while loading; out of memory, the
+// arrays are left as they were and the caller drops the whole patch
 
-	while (p != NULL) {
-		if (p->addr != lastaddr) iPPFNum++;
-		lastaddr = p->addr;
-		p = p->pNext;
+static boolean PoolAdd(const u8 *mem, u32 len, u32 *at) {
+	if (iPPFPool + len > iPPFPoolMax) {
+		u32 max = iPPFPoolMax * 2 + len + 4096;
+		u8 *pool = (u8 *)realloc(ppfPool, max);
+
+		if (pool == NULL) return FALSE;
+		ppfPool = pool;
+		iPPFPoolMax = max;
 	}
 
-	if (iPPFNum <= 0) return;
+	*at = iPPFPool;
+	memcpy(ppfPool + iPPFPool, mem, len);
+	iPPFPool += len;
 
-	pc = ppfCache = (PPF_CACHE *)malloc(iPPFNum * sizeof(PPF_CACHE));
+	return TRUE;
+}
 
-	iPPFNum--;
-	p = ppfHead;
-	lastaddr = -1;
+static int AddToPPF(s32 ladr, s32 pos, s32 anz, const u8 *ppfmem, const u8 *undomem) {
+	PPF_DATA *p;
 
-	while (p != NULL) {
-		if (p->addr != lastaddr) {
-			pc->addr = p->addr;
-			pc->pNext = p;
-			pc++;
-		}
-		lastaddr = p->addr;
-		p = p->pNext;
+	if (anz <= 0) return 0;
+
+	if (iPPFData == iPPFDataMax) {
+		int max = iPPFDataMax * 2 + 256;
+		PPF_DATA *data = (PPF_DATA *)realloc(ppfData, max * sizeof(PPF_DATA));
+
+		if (data == NULL) return -1;
+		ppfData = data;
+		iPPFDataMax = max;
 	}
+
+	p = &ppfData[iPPFData];
+	p->addr = ladr;
+	p->pos = pos;
+	p->anz = anz;
+	p->seq = iPPFData;
+	p->undo = PPF_NOUNDO;
+	if (!PoolAdd(ppfmem, anz, &p->data)) return -1;
+	if (undomem != NULL && !PoolAdd(undomem, anz, &p->undo)) return -1;
+	iPPFData++;
+
+	return 0;
 }
 
-void FreePPFCache() {
-	PPF_DATA *p = ppfHead;
-	void *pn;
+// split a patch at a raw image offset into sector records
+static int AddPatchBytes(u32 offset, const u8 *mem, u32 len, const u8 *undo) {
+	while (len != 0) {
+		s32 ladr = offset / CD_FRAMESIZE_RAW;
+		s32 off = offset % CD_FRAMESIZE_RAW;
+		u32 n = CD_FRAMESIZE_RAW - off;
+
+		if (n > len) n = len;
+
+		if (AddToPPF(ladr, off, n, mem, undo) != 0) return -1;
 
-	while (p != NULL) {
-		pn = p->pNext;
-		free(p);
-		p = (PPF_DATA *)pn;
+		offset += n;
+		mem += n;
+		if (undo != NULL) undo += n;
+		len -= n;
 	}
-	ppfHead = NULL;
-	ppfLast = NULL;
 
-	if (ppfCache != NULL) free(ppfCache);
-	ppfCache = NULL;
+	return 0;
 }
 
-void CheckPPFCache(unsigned char *pB, unsigned char m, unsigned char s, unsigned char f) {
-	PPF_CACHE *pcstart, *pcend, *pcpos;
-	int addr = MSF2SECT(btoi(m), btoi(s), btoi(f)), pos, anz, start;
+static int PPFCompare(const void *a, const void *b) {
+	const PPF_DATA *pa = (const PPF_DATA *)a, *pb = (const PPF_DATA *)b;
 
-	if (ppfCache == NULL) return;
+	if (pa->addr != pb->addr) return (pa->addr < pb->addr ? -1 : 1);
+	return pa->seq - pb->seq;
+}
 
-	pcstart = ppfCache;
-	if (addr < pcstart->addr) return;
-	pcend = ppfCache + iPPFNum;
-	if (addr > pcend->addr) return;
+// sort the records, merge them per sector and build the sector array
+static int FillPPFCache() {
+	u8				sect[CD_FRAMESIZE_RAW], orig[CD_FRAMESIZE_RAW];
+	u8				mask[CD_FRAMESIZE_RAW]; // 1: patched, 2: original known
+	PPF_DATA		*in = ppfData, *out;
+	u8				*inpool = ppfPool;
+	int				nin = iPPFData, i, j, k, e, sectors;
 
-	while (1) {
-		if (addr == pcend->addr) { pcpos = pcend; break; }
+	if (nin <= 0) return 0;
 
-		pcpos = pcstart + (pcend - pcstart) / 2;
-		if (pcpos == pcstart) break;
-		if (addr < pcpos->addr) {
-			pcend = pcpos;
-			continue;
-		}
-		if (addr > pcpos->addr) {
-			pcstart = pcpos;
-			continue;
-		}
-		break;
-	}
+	qsort(in, nin, sizeof(PPF_DATA), PPFCompare);
 
-	if (addr == pcpos->addr) {
-		PPF_DATA *p = pcpos->pNext;
-		while (p != NULL && p->addr == addr) {
-			pos = p->pos - (CD_FRAMESIZE_RAW - DATA_SIZE);
-			anz = p->anz;
-			if (pos < 0) { start = -pos; pos = 0; anz -= start; }
-			else start = 0;
-			memcpy(pB + pos, (unsigned char *)(p + 1) + start, anz);
-			p = p->pNext;
-		}
-	}
-}
+	sectors = 1;
+	for (i = 1; i < nin; i++)
+		if (in[i].addr != in[i - 1].addr) sectors++;
 
-static void AddToPPF(s32 ladr, s32 pos, s32 anz, unsigned char *ppfmem) {
-	if (ppfHead == NULL) {
-		ppfHead = (PPF_DATA *)malloc(sizeof(PPF_DATA) + anz);
-		ppfHead->addr = ladr;
-		ppfHead->pNext = NULL;
-		ppfHead->pos = pos;
-		ppfHead->anz = anz;
-		memcpy(ppfHead + 1, ppfmem, anz);
-		iPPFNum = 1;
-		ppfLast = ppfHead;
-	} else {
-		PPF_DATA *p = ppfHead;
-		PPF_DATA *plast = NULL;
-		PPF_DATA *padd;
-
-		if (ladr > ppfLast->addr || (ladr == ppfLast->addr && pos > ppfLast->pos)) {
-			p = NULL;
-			plast = ppfLast;
-		} else {
-			while (p != NULL) {
-				if (ladr < p->addr) break;
-				if (ladr == p->addr) {
-					while (p && ladr == p->addr && pos > p->pos) {
-						plast = p;
-						p = p->pNext;
-					}
-					break;
+	ppfCache = (PPF_CACHE *)malloc(sectors * sizeof(PPF_CACHE));
+	iPPFNum = 0;
+	if (ppfCache == NULL) return -1;
+
+	ppfData = NULL;
+	iPPFData = iPPFDataMax = 0;
+	ppfPool = NULL;
+	iPPFPool = iPPFPoolMax = 0;
+
+	for (i = 0; i < nin; i = j) {
+		memset(mask, 0, sizeof(mask));
+
+		for (j = i; j < nin && in[j].addr == in[i].addr; j++) {
+			PPF_DATA *p = &in[j];
+
+			memcpy(sect + p->pos, inpool + p->data, p->anz);
+			for (k = 0; k < p->anz; k++) {
+				if (p->undo != PPF_NOUNDO && !(mask[p->pos + k] & 2)) {
+					orig[p->pos + k] = inpool[p->undo + k]; // first patch saw the original
+					mask[p->pos + k] |= 2;
 				}
-				plast = p;
-				p = p->pNext;
+				mask[p->pos + k] |= 1;
 			}
 		}
 
-		padd = (PPF_DATA *)malloc(sizeof(PPF_DATA) + anz);
-		padd->addr = ladr;
-		padd->pNext = p;
-		padd->pos = pos;
-		padd->anz = anz;
-		memcpy(padd + 1, ppfmem, anz);
-		iPPFNum++;
-		if (plast == NULL) ppfHead = padd;
-		else plast->pNext = padd;
+		ppfCache[iPPFNum].addr = in[i].addr;
+		ppfCache[iPPFNum].first = iPPFData;
+
+		for (k = 0; k < CD_FRAMESIZE_RAW; k = e) {
+			if (!mask[k]) { e = k + 1; continue; }
+			for (e = k + 1; e < CD_FRAMESIZE_RAW && mask[e] == mask[k]; e++);
 
-		if (padd->pNext == NULL) ppfLast = padd;
+			if (AddToPPF(in[i].addr, k, e - k, sect + k, (mask[k] & 2) ? orig + k : NULL) != 0) {
+				free(in);
+				free(inpool);
+				return -1;
+			}
+		}
+
+		ppfCache[iPPFNum].count = iPPFData - ppfCache[iPPFNum].first;
+		iPPFNum++;
 	}
+
+	free(in);
+	free(inpool);
+
+	out = (PPF_DATA *)realloc(ppfData, iPPFData * sizeof(PPF_DATA));
+	if (out != NULL) ppfData = out;
+	return 0;
 }
 
-void BuildPPFCache() {
-	FILE			*ppffile;
-	char			buffer[12];
-	char			method, undo = 0, blockcheck = 0;
-	int				dizlen, dizyn;
-	unsigned char	ppfmem[512];
-	char			szPPF[MAXPATHLEN];
-	int				count, seekpos, pos;
-	u32				anz; // use 32-bit to avoid stupid overflows
-	s32				ladr, off, anx;
+void FreePPFCache() {
+	if (ppfData != NULL) free(ppfData);
+	ppfData = NULL;
+	iPPFData = iPPFDataMax = 0;
 
-	FreePPFCache();
+	if (ppfPool != NULL) free(ppfPool);
+	ppfPool = NULL;
+	iPPFPool = iPPFPoolMax = 0;
 
-    if (CdromId[0] == '\0') return;
+	if (ppfCache != NULL) free(ppfCache);
+	ppfCache = NULL;
+	iPPFNum = 0;
 
-	// Generate filename in the format of SLUS_123.45
-	buffer[0] = toupper(CdromId[0]);
-	buffer[1] = toupper(CdromId[1]);
-	buffer[2] = toupper(CdromId[2]);
-	buffer[3] = toupper(CdromId[3]);
-	buffer[4] = '_';
-	buffer[5] = CdromId[4];
-	buffer[6] = CdromId[5];
-	buffer[7] = CdromId[6];
-	buffer[8] = '.';
-	buffer[9] = CdromId[7];
-	buffer[10] = CdromId[8];
-	buffer[11] = '\0';
+	ppfUndoWarned = FALSE;
+}
 
-	sprintf(szPPF, "%s/%s", Config.PatchesDir, buffer);
+void CheckPPFCache(unsigned char *pB, unsigned char m, unsigned char s, unsigned char f) {
+	PPF_CACHE *pc;
+	PPF_DATA *p;
+	int addr = MSF2SECT(btoi(m), btoi(s), btoi(f)), pos, anz, start;
+	int lo, hi, mid, i;
 
-	ppffile = fopen(szPPF, "rb");
-	if (ppffile == NULL) return;
+	if (ppfCache == NULL) return;
+	if (addr < ppfCache[0].addr || addr > ppfCache[iPPFNum - 1].addr) return;
+
+	lo = 0;
+	hi = iPPFNum - 1;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (ppfCache[mid].addr < addr) lo = mid + 1;
+		else hi = mid;
+	}
 
-	memset(buffer, 0, 5);
-	fread(buffer, 3, 1, ppffile);
+	pc = &ppfCache[lo];
+	if (pc->addr != addr) return;
+
+	for (i = 0, p = &ppfData[pc->first]; i < pc->count; i++, p++) {
+		pos = p->pos - (CD_FRAMESIZE_RAW - DATA_SIZE);
+		anz = p->anz;
+		if (pos < 0) { start = -pos; pos = 0; anz -= start; }
+		else start = 0;
+		if (anz <= 0) continue;
+
+		if (p->undo != PPF_NOUNDO && !ppfUndoWarned &&
+			memcmp(pB + pos, ppfPool + p->undo + start, anz) != 0 &&
+			memcmp(pB + pos, ppfPool + p->data + start, anz) != 0) {
+			SysPrintf(_("PPF undo data doesn't match the image (sector %d), wrong patch?\n"), addr);
+			ppfUndoWarned = TRUE;
+		}
 
-	if (strcmp(buffer, "PPF") != 0) {
-		SysPrintf(_("Invalid PPF patch: %s.\n"), szPPF);
-		fclose(ppffile);
-		return;
+		memcpy(pB + pos, ppfPool + p->data + start, anz);
 	}
+}
+
+static int LoadPPF(FILE *ppffile, const char *szPPF) {
+	char			buffer[12];
+	char			method, undo = 0, blockcheck = 0;
+	int				dizlen, dizyn;
+	unsigned char	ppfmem[256], undomem[256];
+	int				count, seekpos, pos;
+	u32				anz; // use 32-bit to avoid stupid overflows
 
 	fseek(ppffile, 5, SEEK_SET);
 	method = fgetc(ppffile);
@@ -291,47 +329,269 @@ void BuildPPFCache() {
 			break;
 
 		default:
-			fclose(ppffile);
 			SysPrintf(_("Unsupported PPF version (%d).\n"), method + 1);
-			return;
+			return -1;
 	}
 
-	// now do the data reading
-	do {                                                
-		fseek(ppffile, seekpos, SEEK_SET);
-		fread(&pos, 4, 1, ppffile);
+	// now do the data reading, records follow each other
+	fseek(ppffile, seekpos, SEEK_SET);
+
+	while (count > 0) {
+		if (fread(&pos, 4, 1, ppffile) != 1) break;
 		pos = SWAP32(pos);
 
 		if (method == 2) fread(buffer, 4, 1, ppffile); // skip 4 bytes on ppf3 (no int64 support here)
 
 		anz = fgetc(ppffile);
-		fread(ppfmem, anz, 1, ppffile);   
-
-		ladr = pos / CD_FRAMESIZE_RAW;
-		off = pos % CD_FRAMESIZE_RAW;
+		if (fread(ppfmem, 1, anz, ppffile) != anz) break;
+		if (method == 2 && undo && fread(undomem, 1, anz, ppffile) != anz) break;
 
-		if (off + anz > CD_FRAMESIZE_RAW) {
-			anx = off + anz - CD_FRAMESIZE_RAW;
-			anz -= (unsigned char)anx;
-			AddToPPF(ladr + 1, 0, anx, &ppfmem[anz]);
+		if (AddPatchBytes(pos, ppfmem, anz, (method == 2 && undo) ? undomem : NULL) != 0) {
+			SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+			return -1;
 		}
 
-		AddToPPF(ladr, off, anz, ppfmem); // add to link list
-
 		if (method == 2) {
 			if (undo) anz += anz;
 			anz += 4;
 		}
 
-		seekpos = seekpos + 5 + anz;
 		count = count - 5 - anz;
-	} while (count != 0); // loop til end
+	}
+
+	SysPrintf(_("Loaded PPF %d.0 patch: %s.\n"), method + 1, szPPF);
+	return 0;
+}
+
+// IPS: 24-bit big endian offsets, so only the first 16MB of the image
+static int LoadIPS(FILE *ipsfile, const char *szPPF) {
+	unsigned char	rec[5];
+	unsigned char	*mem;
+	u32				offset, size;
+	int				ret = -1;
+
+	mem = (unsigned char *)malloc(0x10000);
+	if (mem == NULL) {
+		SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+		return -1;
+	}
+
+	fseek(ipsfile, 5, SEEK_SET);
+
+	while (fread(rec, 1, 3, ipsfile) == 3) {
+		if (memcmp(rec, "EOF", 3) == 0) { ret = 0; break; }
+
+		offset = (rec[0] << 16) | (rec[1] << 8) | rec[2];
+
+		if (fread(rec, 1, 2, ipsfile) != 2) break;
+		size = (rec[0] << 8) | rec[1];
+
+		if (size == 0) { // rle
+			if (fread(rec, 1, 3, ipsfile) != 3) break;
+			size = (rec[0] << 8) | rec[1];
+			memset(mem, rec[2], size);
+		} else if (fread(mem, 1, size, ipsfile) != size) break;
+
+		if (AddPatchBytes(offset, mem, size, NULL) != 0) { ret = -2; break; }
+	}
+
+	free(mem);
+
+	if (ret == 0) SysPrintf(_("Loaded IPS patch: %s.\n"), szPPF);
+	else if (ret == -2) SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+	else SysPrintf(_("Invalid IPS patch: %s.\n"), szPPF);
+	return ret;
+}
+
+static u32 BPSNumber(const u8 **p, const u8 *end) {
+	u32 data = 0, shift = 1;
+
+	while (*p < end) {
+		u8 x = *(*p)++;
+		data += (x & 0x7f) * shift;
+		if (x & 0x80) break;
+		shift <<= 7;
+		data += shift;
+	}
+
+	return data;
+}
+
+// byte of the patched image that an earlier record produced
+static boolean PPFFetch(u32 offset, u8 *v) {
+	s32 ladr = offset / CD_FRAMESIZE_RAW, off = offset % CD_FRAMESIZE_RAW;
+	int lo = 0, hi = iPPFData - 1, mid;
+
+	// bps output is sequential, so the records are still in offset order here
+	while (lo <= hi) {
+		PPF_DATA *p;
+
+		mid = (lo + hi) / 2;
+		p = &ppfData[mid];
+
+		if (p->addr < ladr || (p->addr == ladr && p->pos + p->anz <= off)) lo = mid + 1;
+		else if (p->addr > ladr || p->pos > off) hi = mid - 1;
+		else {
+			*v = ppfPool[p->data + off - p->pos];
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+// BPS: only the target side is stored, so source copies must be in place
+static int LoadBPS(FILE *bpsfile, const char *szPPF) {
+	u8				*patch, *tmp;
+	const u8		*p, *end;
+	u32				len, outoff = 0, srcrel = 0, tgtrel = 0, data, length, i;
+	int				ret = -1;
+
+	fseek(bpsfile, 0, SEEK_END);
+	len = ftell(bpsfile);
+	fseek(bpsfile, 0, SEEK_SET);
+
+	if (len < 16) {
+		SysPrintf(_("Invalid BPS patch: %s.\n"), szPPF);
+		return -1;
+	}
+
+	patch = (u8 *)malloc(len);
+	if (patch == NULL) {
+		SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+		return -1;
+	}
+	if (fread(patch, 1, len, bpsfile) != len ||
+		crc32(0L, patch, len - 4) != (uLong)(patch[len - 4] | (patch[len - 3] << 8) | (patch[len - 2] << 16) | ((u32)patch[len - 1] << 24))) {
+		SysPrintf(_("Invalid BPS patch: %s.\n"), szPPF);
+		free(patch);
+		return -1;
+	}
+
+	p = patch + 4;
+	end = patch + len - 12;
+
+	BPSNumber(&p, end); // source size
+	BPSNumber(&p, end); // target size
+	p += BPSNumber(&p, end); // metadata
+
+	while (p < end) {
+		data = BPSNumber(&p, end);
+		length = (data >> 2) + 1;
+
+		switch (data & 3) {
+			case 0: // source read: unchanged bytes
+				break;
+
+			case 1: // target read
+				if (p + length > end) goto fail;
+				if (AddPatchBytes(outoff, p, length, NULL) != 0) goto nomem;
+				p += length;
+				break;
+
+			case 2: // source copy
+				data = BPSNumber(&p, end);
+				srcrel += (data & 1) ? -(s32)(data >> 1) : (s32)(data >> 1);
+				if (srcrel != outoff) {
+					SysPrintf(_("Unsupported BPS patch (moves source data): %s.\n"), szPPF);
+					goto fail;
+				}
+				srcrel += length;
+				break;
+
+			case 3: // target copy, may overlap the bytes it produces
+				data = BPSNumber(&p, end);
+				tgtrel += (data & 1) ? -(s32)(data >> 1) : (s32)(data >> 1);
+
+				tmp = (u8 *)malloc(length);
+				if (tmp == NULL) goto nomem;
+				for (i = 0; i < length; i++, tgtrel++) {
+					if (tgtrel >= outoff && tgtrel < outoff + i) tmp[i] = tmp[tgtrel - outoff];
+					else if (!PPFFetch(tgtrel, &tmp[i])) {
+						free(tmp);
+						SysPrintf(_("Unsupported BPS patch (copies unpatched data): %s.\n"), szPPF);
+						goto fail;
+					}
+				}
+				if (AddPatchBytes(outoff, tmp, length, NULL) != 0) {
+					free(tmp);
+					goto nomem;
+				}
+				free(tmp);
+				break;
+		}
+
+		outoff += length;
+	}
+
+	ret = 0;
+	SysPrintf(_("Loaded BPS patch: %s.\n"), szPPF);
+	goto fail;
+
+nomem:
+	SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+
+fail:
+	free(patch);
+	return ret;
+}
+
+void BuildPPFCache() {
+	FILE			*ppffile;
+	char			buffer[12];
+	char			szPPF[MAXPATHLEN];
+	char			magic[5];
+	int				i, ret;
+	static const char *ext[] = { "", ".ppf", ".ips", ".bps", NULL };
+
+	FreePPFCache();
+
+    if (CdromId[0] == '\0') return;
+
+	// Generate filename in the format of SLUS_123.45
+	buffer[0] = toupper(CdromId[0]);
+	buffer[1] = toupper(CdromId[1]);
+	buffer[2] = toupper(CdromId[2]);
+	buffer[3] = toupper(CdromId[3]);
+	buffer[4] = '_';
+	buffer[5] = CdromId[4];
+	buffer[6] = CdromId[5];
+	buffer[7] = CdromId[6];
+	buffer[8] = '.';
+	buffer[9] = CdromId[7];
+	buffer[10] = CdromId[8];
+	buffer[11] = '\0';
+
+	ppffile = NULL;
+	for (i = 0; ext[i] != NULL && ppffile == NULL; i++) {
+		snprintf(szPPF, sizeof(szPPF), "%s/%s%s", Config.PatchesDir, buffer, ext[i]);
+		ppffile = fopen(szPPF, "rb");
+	}
+	if (ppffile == NULL) return;
+
+	memset(magic, 0, sizeof(magic));
+	fread(magic, 1, 5, ppffile);
+
+	if (memcmp(magic, "PPF", 3) == 0) ret = LoadPPF(ppffile, szPPF);
+	else if (memcmp(magic, "PATCH", 5) == 0) ret = LoadIPS(ppffile, szPPF);
+	else if (memcmp(magic, "BPS1", 4) == 0) ret = LoadBPS(ppffile, szPPF);
+	else {
+		SysPrintf(_("Invalid PPF patch: %s.\n"), szPPF);
+		ret = -1;
+	}
 
 	fclose(ppffile);
 
-	FillPPFCache(); // build address array
+	if (ret != 0) {
+		FreePPFCache();
+		return;
+	}
 
-	SysPrintf(_("Loaded PPF %d.0 patch: %s.\n"), method + 1, szPPF);
+	// sort, merge and build the sector array
+	if (FillPPFCache() != 0) {
+		SysPrintf(_("Out of memory loading patch: %s.\n"), szPPF);
+		FreePPFCache();
+	}
 }
 
 // redump.org SBI files
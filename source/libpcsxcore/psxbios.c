@@ -381,6 +381,140 @@ void psxBios_longjmp() { // 0x14
 	v0 = a1; pc0 = ra;
 }
 
+/* bulk memory access for the string and memory functions below */
+
+// keep the rom's memmove/bcmp off by one behaviour (see the BUG notes)
+#define PSXBIOS_QUIRKS
+
+// instructions per byte of the rom's copy/fill/compare loops
+#define BIOS_BYTE_OPS 6
+
+static inline void biosCharge(u32 n) {
+	psxRegs.cycle += n * BIOS_BYTE_OPS * BIAS;
+}
+
+static inline void biosWritten(u32 addr, u8 *p, u32 n) {
+#ifdef PSXREC
+	if (p >= (u8 *)psxM && p < (u8 *)psxM + 0x200000)
+		psxCpu->Clear(addr & ~3, ((addr & 3) + n + 3) >> 2);
+#endif
+}
+
+static inline char biosByte(u32 addr) {
+	char *p = (char *)PSXM(addr);
+	return p != NULL ? *p : 0;
+}
+
+// forward copy, same result as the rom's byte loop for any overlap
+static void biosCopy(u32 dst, u32 src, u32 n) {
+	u32 ds, ss, len, i;
+	u8 *d, *s;
+
+	biosCharge(n);
+
+	while (n != 0) {
+		d = psxMemSpan(dst, n, &ds);
+		s = psxMemSpan(src, n, &ss);
+		if (d == NULL || s == NULL) break;
+
+		len = ds < ss ? ds : ss;
+		if (d > s && d < s + len) {
+			for (i = 0; i < len; i++) d[i] = s[i]; // smears the source
+		} else {
+			memmove(d, s, len);
+		}
+		biosWritten(dst, d, len);
+
+		dst += len; src += len; n -= len;
+	}
+}
+
+// backward copy of an overlapping move
+static void biosCopyBack(u32 dst, u32 src, u32 n) {
+	u32 ds, ss;
+	u8 *d, *s;
+
+	biosCharge(n);
+
+	d = psxMemSpan(dst, n, &ds);
+	s = psxMemSpan(src, n, &ss);
+	if (d != NULL && s != NULL && ds == n && ss == n) {
+		memmove(d, s, n);
+		biosWritten(dst, d, n);
+		return;
+	}
+
+	// straddles a mirror, not worth more than the byte loop
+	while (n-- != 0) {
+		d = PSXM(dst + n);
+		s = PSXM(src + n);
+		if (d == NULL || s == NULL) continue;
+		*d = *s;
+		biosWritten(dst + n, d, 1);
+	}
+}
+
+static void biosFill(u32 dst, u8 c, u32 n) {
+	u32 len;
+	u8 *d;
+
+	biosCharge(n);
+
+	while (n != 0) {
+		d = psxMemSpan(dst, n, &len);
+		if (d == NULL) break;
+
+		memset(d, c, len);
+		biosWritten(dst, d, len);
+
+		dst += len; n -= len;
+	}
+}
+
+// offset of the first differing byte, n if there is none
+static u32 biosCompare(u32 a, u32 b, u32 n) {
+	u32 as, bs, len, i, off = 0;
+	u8 *pa, *pb;
+
+	while (off < n) {
+		pa = psxMemSpan(a + off, n - off, &as);
+		pb = psxMemSpan(b + off, n - off, &bs);
+		if (pa == NULL || pb == NULL) break;
+
+		len = as < bs ? as : bs;
+		if (memcmp(pa, pb, len) != 0) {
+			for (i = 0; pa[i] == pb[i]; i++);
+			biosCharge(off + i);
+			return off + i;
+		}
+		off += len;
+	}
+
+	biosCharge(n);
+	return n;
+}
+
+// unmapped memory ends the string
+static u32 biosStrlen(u32 addr) {
+	u32 span, len = 0;
+	u8 *p, *z;
+
+	for (;;) {
+		p = psxMemSpan(addr + len, 0xffffffff, &span);
+		if (p == NULL) break;
+
+		z = memchr(p, 0, span);
+		if (z != NULL) {
+			len += z - p;
+			break;
+		}
+		len += span;
+	}
+
+	biosCharge(len);
+	return len;
+}
+
 void psxBios_strcat() { // 0x15
 	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
 
@@ -416,21 +550,17 @@ void psxBios_strncat() { // 0x16
 }
 
 void psxBios_strcmp() { // 0x17
-	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
+	u32 n, i;
 
 #ifdef PSXBIOS_LOG
 	PSXBIOS_LOG("psxBios_%s: %s (%x), %s (%x)\n", biosA0n[0x17], Ra0, a0, Ra1, a1);
 #endif
 
-	while (*p1 == *p2++) {
-		if (*p1++ == '\0') {
-			v0 = 0;
-			pc0 = ra;
-			return;
-		}
-	}
+	// up to and including the terminator of the first string
+	n = biosStrlen(a0) + 1;
+	i = biosCompare(a0, a1, n);
 
-	v0 = (*p1 - *--p2);
+	v0 = (i < n ? biosByte(a0 + i) - biosByte(a1 + i) : 0);
 	pc0 = ra;
 }
 
@@ -455,8 +585,7 @@ void psxBios_strncmp() { // 0x18
 }
 
 void psxBios_strcpy() { // 0x19
-	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
-	while ((*p1++ = *p2++) != '\0');
+	biosCopy(a0, a1, biosStrlen(a1) + 1);
 
 	v0 = a0; pc0 = ra;
 }
@@ -479,9 +608,7 @@ void psxBios_strncpy() { // 0x1a
 }
 
 void psxBios_strlen() { // 0x1b
-	char *p = (char *)Ra0;
-	v0 = 0;
-	while (*p++) v0++;
+	v0 = biosStrlen(a0);
 	pc0 = ra;
 }
 
@@ -605,45 +732,43 @@ void psxBios_tolower() { // 0x26
 }
 
 void psxBios_bcopy() { // 0x27
-	char *p1 = (char *)Ra1, *p2 = (char *)Ra0;
-	while (a2-- > 0) *p1++ = *p2++;
+	biosCopy(a1, a0, a2);
 
 	pc0 = ra;
 }
 
 void psxBios_bzero() { // 0x28
-	char *p = (char *)Ra0;
-	while (a1-- > 0) *p++ = '\0';
+	biosFill(a0, 0, a1);
 
 	pc0 = ra;
 }
 
 void psxBios_bcmp() { // 0x29
-	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
+	u32 i;
 
 	if (a0 == 0 || a1 == 0) { v0 = 0; pc0 = ra; return; }
 
-	while (a2-- > 0) {
-		if (*p1++ != *p2++) {
-			v0 = *p1 - *p2; // BUG: compare the NEXT byte
-			pc0 = ra;
-			return;
-		}
+	i = biosCompare(a0, a1, a2);
+	if (i < a2) {
+#ifdef PSXBIOS_QUIRKS
+		i++; // BUG: compare the NEXT byte
+#endif
+		v0 = biosByte(a0 + i) - biosByte(a1 + i);
+		pc0 = ra;
+		return;
 	}
 
 	v0 = 0; pc0 = ra;
 }
 
 void psxBios_memcpy() { // 0x2a
-	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
-	while (a2-- > 0) *p1++ = *p2++;
+	biosCopy(a0, a1, a2);
 
 	v0 = a0; pc0 = ra;
 }
 
 void psxBios_memset() { // 0x2b
-	char *p = (char *)Ra0;
-	while (a2-- > 0) *p++ = (char)a1;
+	biosFill(a0, (u8)a1, a2);
 
 	v0 = a0; pc0 = ra;
 }
@@ -652,12 +777,13 @@ void psxBios_memmove() { // 0x2c
 	char *p1 = (char *)Ra0, *p2 = (char *)Ra1;
 
 	if (p2 <= p1 && p2 + a2 > p1) {
-		a2++; // BUG: copy one more byte here
-		p1 += a2;
-		p2 += a2;
-		while (a2-- > 0) *--p1 = *--p2;
+#ifdef PSXBIOS_QUIRKS
+		biosCopyBack(a0, a1, a2 + 1); // BUG: copy one more byte here
+#else
+		biosCopyBack(a0, a1, a2);
+#endif
 	} else {
-		while (a2-- > 0) *p1++ = *p2++;
+		biosCopy(a0, a1, a2);
 	}
 
 	v0 = a0; pc0 = ra;
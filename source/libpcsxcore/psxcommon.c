@@ -23,6 +23,8 @@
 
 #include "cheat.h"
 #include "ppf.h"
+#include "runahead.h"
+#include "movie.h"
 
 PcsxConfig Config;
 boolean NetOpened = FALSE;
@@ -35,6 +37,7 @@ int EmuInit() {
 }
 
 void EmuReset() {
+	Movie_Stop();
 	FreeCheatSearchResults();
 	FreeCheatSearchMem();
 
@@ -57,6 +60,21 @@ void EmuUpdate() {
 		SysUpdate();
 
 	ApplyCheats();
+	Movie_VSync();
+	RunAheadVSync();
+}
+
+// the plugins drop the work nobody sees or hears at that speed
+void EmuSetFastForward(boolean on) {
+	static boolean active = FALSE;
+	float speed = on ? (float)Config.FastForward : 1.0f;
+
+	if (on == active)
+		return;
+	active = on;
+
+	GPU_setSpeed(speed);
+	SPU_setSpeed(speed);
 }
 
 void __Log(char *fmt, ...) {
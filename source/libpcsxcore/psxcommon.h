@@ -59,6 +59,10 @@ typedef uintptr_t uptr;
 
 typedef uint8_t boolean;
 
+#ifndef ALIGNED_32
+#define ALIGNED_32 __attribute__((aligned(32)))
+#endif
+
 #ifndef TRUE
 #define TRUE 1
 #endif
@@ -158,16 +162,28 @@ typedef struct {
 #endif
 	// Global settings
 	int UseFrameLimit;
+	int FrameLatency; // soft gpu: emulate each frame as late as the frame limit allows
 	int GpuFilter;
 	int use_experimental_dr;
+	int FastForward; // speed while fast forwarding, 0: unlimited
+	int RunAhead; // frames shown ahead of the emulation, 0: off
 } PcsxConfig;
 
 extern PcsxConfig Config;
 extern boolean NetOpened;
 
+// ram snapshots (misc.c) pass no file, the data goes through freezeMem
+extern u8 *freezeMem;
+
 #define gzfreeze(ptr, size) { \
-	if (Mode == 1) gzwrite(f, ptr, size); \
-	if (Mode == 0) gzread(f, ptr, size); \
+	if (f == NULL) { \
+		if (Mode == 1) memcpy(freezeMem, ptr, size); \
+		if (Mode == 0) memcpy(ptr, freezeMem, size); \
+		freezeMem += size; \
+	} else { \
+		if (Mode == 1) gzwrite(f, ptr, size); \
+		if (Mode == 0) gzread(f, ptr, size); \
+	} \
 }
 
 // Make the timing events trigger faster as we are currently assuming everything
@@ -190,6 +206,7 @@ int EmuInit();
 void EmuReset();
 void EmuShutdown();
 void EmuUpdate();
+void EmuSetFastForward(boolean on);
 
 #ifdef __cplusplus
 }
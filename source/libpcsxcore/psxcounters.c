@@ -76,6 +76,9 @@ static const s32 VerboseLevel     = 0;
 
 static Rcnt rcnts[ CounterQuantity ];
 
+// 0xffffffff / rate, kept outside Rcnt so save states keep their layout.
+static u32 rcntInv[ CounterQuantity ];
+
 static u32 hSyncCount = 0;
 static u32 spuSyncCount = 0;
 
@@ -108,6 +111,30 @@ void verboseLog( s32 level, const char *str, ... )
 
 /******************************************************************************/
 
+static inline
+void setRate( u32 index, u32 rate )
+{
+    rcnts[index].rate = rate;
+    rcntInv[index] = 0xffffffff / rate;
+}
+
+// delta / rate without a divide, the estimate is at most a little low.
+static inline
+u32 rcntDiv( u32 index, u32 delta )
+{
+    u32 rate = rcnts[index].rate;
+    u32 q = (u32)(((u64)delta * rcntInv[index]) >> 32);
+    u32 r = delta - q * rate;
+
+    while( r >= rate )
+    {
+        q++;
+        r -= rate;
+    }
+
+    return q;
+}
+
 static inline
 void _psxRcntWcount( u32 index, u32 value )
 {
@@ -138,9 +165,7 @@ u32 _psxRcntRcount( u32 index )
 {
     u32 count;
 
-    count  = psxRegs.cycle;
-    count -= rcnts[index].cycleStart;
-    count /= rcnts[index].rate;
+    count = rcntDiv( index, psxRegs.cycle - rcnts[index].cycleStart );
 
     if( count > 0xffff )
     {
@@ -190,9 +215,7 @@ void psxRcntReset( u32 index )
     {
         if( rcnts[index].mode & RcCountToTarget )
         {
-            count  = psxRegs.cycle;
-            count -= rcnts[index].cycleStart;
-            count /= rcnts[index].rate;
+            count  = rcntDiv( index, psxRegs.cycle - rcnts[index].cycleStart );
             count -= rcnts[index].target;
         }
         else
@@ -216,9 +239,7 @@ void psxRcntReset( u32 index )
     }
     else if( rcnts[index].counterState == CountToOverflow )
     {
-        count  = psxRegs.cycle;
-        count -= rcnts[index].cycleStart;
-        count /= rcnts[index].rate;
+        count  = rcntDiv( index, psxRegs.cycle - rcnts[index].cycleStart );
         count -= 0xffff;
 
         _psxRcntWcount( index, count );
@@ -241,6 +262,73 @@ void psxRcntReset( u32 index )
     psxRcntSet();
 }
 
+/*
+ * The base counter (rcnt 3) counts scanlines. Most lines only feed GPU_hSync,
+ * so it is scheduled for the next line where something can be seen: an spu
+ * update, vblank start or the end of the frame. The lines in between are
+ * played back in one go when it fires.
+ */
+
+static
+u32 hSyncLinesToEvent()
+{
+    u32 total = Config.VSyncWA ? HSyncTotal[Config.PsxType] / BIAS : HSyncTotal[Config.PsxType];
+    u32 lines = hSyncCount < total ? total - hSyncCount : 1;
+
+    if( SPU_async && SpuUpdInterval[Config.PsxType] - spuSyncCount < lines )
+    {
+        lines = SpuUpdInterval[Config.PsxType] - spuSyncCount;
+    }
+
+    if( hSyncCount < VBlankStart[Config.PsxType] && VBlankStart[Config.PsxType] - hSyncCount < lines )
+    {
+        lines = VBlankStart[Config.PsxType] - hSyncCount;
+    }
+
+    return lines;
+}
+
+static
+void hSyncLine()
+{
+    GPU_hSync(hSyncCount);
+
+    spuSyncCount++;
+    hSyncCount++;
+
+    // Update spu.
+    if( spuSyncCount >= SpuUpdInterval[Config.PsxType] )
+    {
+        spuSyncCount = 0;
+
+        if( SPU_async )
+        {
+            SPU_async( SpuUpdInterval[Config.PsxType] * rcnts[3].target );
+        }
+    }
+
+    // VSync irq.
+    if( hSyncCount == VBlankStart[Config.PsxType] )
+    {
+        GPU_vBlank( 1 );
+
+        // For the best times. :D
+        //setIrq( 0x01 );
+    }
+
+    // Update lace. (with InuYasha fix)
+    if( hSyncCount >= (Config.VSyncWA ? HSyncTotal[Config.PsxType] / BIAS : HSyncTotal[Config.PsxType]) )
+    {
+        hSyncCount = 0;
+
+        GPU_vBlank( 0 );
+        setIrq( 0x01 );
+
+        GPU_updateLace();
+        EmuUpdate();
+    }
+}
+
 void psxRcntUpdate()
 {
     u32 cycle;
@@ -268,44 +356,14 @@ void psxRcntUpdate()
     // rcnt base.
     if( cycle - rcnts[3].cycleStart >= rcnts[3].cycle )
     {
-        psxRcntReset( 3 );
-
-        GPU_hSync(hSyncCount);
-
-        spuSyncCount++;
-        hSyncCount++;
-
-        // Update spu.
-        if( spuSyncCount >= SpuUpdInterval[Config.PsxType] )
-        {
-            spuSyncCount = 0;
-
-            if( SPU_async )
-            {
-                SPU_async( SpuUpdInterval[Config.PsxType] * rcnts[3].target );
-            }
-        }
-
-        // VSync irq.
-        if( hSyncCount == VBlankStart[Config.PsxType] )
+        while( cycle - rcnts[3].cycleStart >= rcnts[3].target )
         {
-            GPU_vBlank( 1 );
-
-            // For the best times. :D
-            //setIrq( 0x01 );
+            rcnts[3].cycleStart += rcnts[3].target;
+            hSyncLine();
         }
 
-        // Update lace. (with InuYasha fix)
-        if( hSyncCount >= (Config.VSyncWA ? HSyncTotal[Config.PsxType] / BIAS : HSyncTotal[Config.PsxType]) )
-        {
-            hSyncCount = 0;
-
-            GPU_vBlank( 0 );
-            setIrq( 0x01 );
-
-            GPU_updateLace();
-            EmuUpdate();
-        }
+        rcnts[3].cycle = hSyncLinesToEvent() * rcnts[3].target;
+        psxRcntSet();
     }
 
     DebugVSync();
@@ -337,37 +395,37 @@ void psxRcntWmode( u32 index, u32 value )
         case 0:
             if( value & Rc0PixelClock )
             {
-                rcnts[index].rate = 5;
+                setRate( index, 5 );
             }
             else
             {
-                rcnts[index].rate = 1;
+                setRate( index, 1 );
             }
         break;
         case 1:
             if( value & Rc1HSyncClock )
             {
-                rcnts[index].rate = (PSXCLK / (FrameRate[Config.PsxType] * HSyncTotal[Config.PsxType]));
+                setRate( index, (PSXCLK / (FrameRate[Config.PsxType] * HSyncTotal[Config.PsxType])) );
             }
             else
             {
-                rcnts[index].rate = 1;
+                setRate( index, 1 );
             }
         break;
         case 2:
             if( value & Rc2OneEighthClock )
             {
-                rcnts[index].rate = 8;
+                setRate( index, 8 );
             }
             else
             {
-                rcnts[index].rate = 1;
+                setRate( index, 1 );
             }
 
             // TODO: wcount must work.
             if( value & Rc2Disable )
             {
-                rcnts[index].rate = 0xffffffff;
+                setRate( index, 0xffffffff );
             }
         break;
     }
@@ -443,19 +501,19 @@ void psxRcntInit()
     s32 i;
 
     // rcnt 0.
-    rcnts[0].rate   = 1;
+    setRate( 0, 1 );
     rcnts[0].irq    = 0x10;
 
     // rcnt 1.
-    rcnts[1].rate   = 1;
+    setRate( 1, 1 );
     rcnts[1].irq    = 0x20;
 
     // rcnt 2.
-    rcnts[2].rate   = 1;
+    setRate( 2, 1 );
     rcnts[2].irq    = 0x40;
 
     // rcnt base.
-    rcnts[3].rate   = 1;
+    setRate( 3, 1 );
     rcnts[3].mode   = RcCountToTarget;
     rcnts[3].target = (PSXCLK / (FrameRate[Config.PsxType] * HSyncTotal[Config.PsxType]));
 
@@ -467,6 +525,8 @@ void psxRcntInit()
     hSyncCount = 0;
     spuSyncCount = 0;
 
+    rcnts[3].cycle = hSyncLinesToEvent() * rcnts[3].target;
+
     psxRcntSet();
 }
 
@@ -480,6 +540,16 @@ s32 psxRcntFreeze( gzFile f, s32 Mode )
     gzfreeze( &psxNextCounter, sizeof(psxNextCounter) );
     gzfreeze( &psxNextsCounter, sizeof(psxNextsCounter) );
 
+    if( Mode == 0 )
+    {
+        u32 i;
+
+        for( i = 0; i < CounterQuantity; ++i )
+        {
+            setRate( i, rcnts[i].rate );
+        }
+    }
+
     return 0;
 }
 
@@ -37,467 +37,189 @@ void psxHwReset() {
 	psxRcntInit();
 }
 
-u8 psxHwRead8(u32 add) {
-	unsigned char hard;
+/*
+* Registers with side effects have a handler in the per-width tables below,
+* indexed by the offset into the io page 0x1f801000-0x1f801fff. Everything
+* else is plain storage in psxH. Misaligned 16/32 bit accesses fault on the
+* real cpu, they skip the tables (the spu still gets them, as it always did).
+*/
 
-	switch (add) {
-		case 0x1f801040: hard = sioRead8();break; 
-#ifdef ENABLE_SIO1API
-		case 0x1f801050: hard = SIO1_readData8(); break;
-#endif
-		case 0x1f801800: hard = cdrRead0(); break;
-		case 0x1f801801: hard = cdrRead1(); break;
-		case 0x1f801802: hard = cdrRead2(); break;
-		case 0x1f801803: hard = cdrRead3(); break;
-		default:
-			hard = psxHu8(add); 
-#ifdef PSXHW_LOG
-			PSXHW_LOG("*Unkwnown 8bit read at address %x\n", add);
-#endif
-			return hard;
-	}
+#define SPU_RANGE(add) ((add) >= 0x1f801c00 && (add) < 0x1f801e00)
 
-#ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 8bit read at address %x value %x\n", add, hard);
-#endif
-	return hard;
-}
+#define R8(a)	[(a) & 0xfff]
+#define R16(a)	[((a) & 0xfff) >> 1]
+#define R32(a)	[((a) & 0xfff) >> 2]
 
-u16 psxHwRead16(u32 add) {
-	unsigned short hard;
+/* - reads - */
 
-	switch (add) {
-#ifdef PSXHW_LOG
-		case 0x1f801070: PSXHW_LOG("IREG 16bit read %x\n", psxHu16(0x1070));
-			return psxHu16(0x1070);
-#endif
-#ifdef PSXHW_LOG
-		case 0x1f801074: PSXHW_LOG("IMASK 16bit read %x\n", psxHu16(0x1074));
-			return psxHu16(0x1074);
-#endif
-
-		case 0x1f801040:
-			hard = sioRead8();
-			hard|= sioRead8() << 8;
-#ifdef PAD_LOG
-			PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
-#endif
-			return hard;
-		case 0x1f801044:
-			hard = sioReadStat16();
-#ifdef PAD_LOG
-			PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
-#endif
-			return hard;
-		case 0x1f801048:
-			hard = sioReadMode16();
-#ifdef PAD_LOG
-			PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
-#endif
-			return hard;
-		case 0x1f80104a:
-			hard = sioReadCtrl16();
-#ifdef PAD_LOG
-			PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
-#endif
-			return hard;
-		case 0x1f80104e:
-			hard = sioReadBaud16();
-#ifdef PAD_LOG
-			PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
-#endif
-			return hard;
+static u8 hwRead8Sio(u32 add) { return sioRead8(); }
 #ifdef ENABLE_SIO1API
-		case 0x1f801050:
-			hard = SIO1_readData16();
-			return hard;
-		case 0x1f801054:
-			hard = SIO1_readStat16();
-			return hard;
-		case 0x1f80105a:
-			hard = SIO1_readCtrl16();
-			return hard;
-		case 0x1f80105e:
-			hard = SIO1_readBaud16();
-			return hard;
-#endif
-		case 0x1f801100:
-			hard = psxRcntRcount(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 count read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801104:
-			hard = psxRcntRmode(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 mode read16: %x\n", hard);
+static u8 hwRead8Sio1(u32 add) { return SIO1_readData8(); }
 #endif
-			return hard;
-		case 0x1f801108:
-			hard = psxRcntRtarget(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 target read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801110:
-			hard = psxRcntRcount(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 count read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801114:
-			hard = psxRcntRmode(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 mode read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801118:
-			hard = psxRcntRtarget(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 target read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801120:
-			hard = psxRcntRcount(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 count read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801124:
-			hard = psxRcntRmode(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 mode read16: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801128:
-			hard = psxRcntRtarget(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 target read16: %x\n", hard);
-#endif
-			return hard;
+static u8 hwRead8Cdr0(u32 add) { return cdrRead0(); }
+static u8 hwRead8Cdr1(u32 add) { return cdrRead1(); }
+static u8 hwRead8Cdr2(u32 add) { return cdrRead2(); }
+static u8 hwRead8Cdr3(u32 add) { return cdrRead3(); }
 
-		//case 0x1f802030: hard =   //int_2000????
-		//case 0x1f802040: hard =//dip switches...??
+static u16 hwRead16Sio(u32 add) {
+	u16 hard;
 
-		default:
-			if (add >= 0x1f801c00 && add < 0x1f801e00) {
-            	hard = SPU_readRegister(add);
-			} else {
-				hard = psxHu16(add); 
-#ifdef PSXHW_LOG
-				PSXHW_LOG("*Unkwnown 16bit read at address %x\n", add);
-#endif
-			}
-            return hard;
-	}
-	
-#ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 16bit read at address %x value %x\n", add, hard);
+	hard = sioRead8();
+	hard|= sioRead8() << 8;
+#ifdef PAD_LOG
+	PAD_LOG("sio read16 %x; ret = %x\n", add&0xf, hard);
 #endif
 	return hard;
 }
 
-u32 psxHwRead32(u32 add) {
-	u32 hard;
-
-	switch (add) {
-		case 0x1f801040:
-			hard = sioRead8();
-			hard |= sioRead8() << 8;
-			hard |= sioRead8() << 16;
-			hard |= sioRead8() << 24;
-#ifdef PAD_LOG
-			PAD_LOG("sio read32 ;ret = %x\n", hard);
-#endif
-			return hard;
+static u16 hwRead16SioStat(u32 add) { return sioReadStat16(); }
+static u16 hwRead16SioMode(u32 add) { return sioReadMode16(); }
+static u16 hwRead16SioCtrl(u32 add) { return sioReadCtrl16(); }
+static u16 hwRead16SioBaud(u32 add) { return sioReadBaud16(); }
 #ifdef ENABLE_SIO1API
-		case 0x1f801050:
-			hard = SIO1_readData32();
-			return hard;
-#endif
-#ifdef PSXHW_LOG
-		case 0x1f801060:
-			PSXHW_LOG("RAM size read %x\n", psxHu32(0x1060));
-			return psxHu32(0x1060);
-#endif
-#ifdef PSXHW_LOG
-		case 0x1f801070: PSXHW_LOG("IREG 32bit read %x\n", psxHu32(0x1070));
-			return psxHu32(0x1070);
-#endif
-#ifdef PSXHW_LOG
-		case 0x1f801074: PSXHW_LOG("IMASK 32bit read %x\n", psxHu32(0x1074));
-			return psxHu32(0x1074);
-#endif
-
-		case 0x1f801810:
-			hard = GPU_readData();
-#ifdef PSXHW_LOG
-			PSXHW_LOG("GPU DATA 32bit read %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801814:
-			hard = gpuReadStatus();
-#ifdef PSXHW_LOG
-			PSXHW_LOG("GPU STATUS 32bit read %x\n", hard);
-#endif
-			return hard;
-
-		case 0x1f801820: hard = mdecRead0(); break;
-		case 0x1f801824: hard = mdecRead1(); break;
-
-#ifdef PSXHW_LOG
-		case 0x1f8010a0:
-			PSXHW_LOG("DMA2 MADR 32bit read %x\n", psxHu32(0x10a0));
-			return SWAPu32(HW_DMA2_MADR);
-		case 0x1f8010a4:
-			PSXHW_LOG("DMA2 BCR 32bit read %x\n", psxHu32(0x10a4));
-			return SWAPu32(HW_DMA2_BCR);
-		case 0x1f8010a8:
-			PSXHW_LOG("DMA2 CHCR 32bit read %x\n", psxHu32(0x10a8));
-			return SWAPu32(HW_DMA2_CHCR);
-#endif
-
-#ifdef PSXHW_LOG
-		case 0x1f8010b0:
-			PSXHW_LOG("DMA3 MADR 32bit read %x\n", psxHu32(0x10b0));
-			return SWAPu32(HW_DMA3_MADR);
-		case 0x1f8010b4:
-			PSXHW_LOG("DMA3 BCR 32bit read %x\n", psxHu32(0x10b4));
-			return SWAPu32(HW_DMA3_BCR);
-		case 0x1f8010b8:
-			PSXHW_LOG("DMA3 CHCR 32bit read %x\n", psxHu32(0x10b8));
-			return SWAPu32(HW_DMA3_CHCR);
+static u16 hwRead16Sio1Data(u32 add) { return SIO1_readData16(); }
+static u16 hwRead16Sio1Stat(u32 add) { return SIO1_readStat16(); }
+static u16 hwRead16Sio1Ctrl(u32 add) { return SIO1_readCtrl16(); }
+static u16 hwRead16Sio1Baud(u32 add) { return SIO1_readBaud16(); }
 #endif
+static u16 hwRead16Count(u32 add) { return psxRcntRcount((add >> 4) & 3); }
+static u16 hwRead16Mode(u32 add) { return psxRcntRmode((add >> 4) & 3); }
+static u16 hwRead16Target(u32 add) { return psxRcntRtarget((add >> 4) & 3); }
+static u16 hwRead16Spu(u32 add) { return SPU_readRegister(add); }
 
-#ifdef PSXHW_LOG
-/*		case 0x1f8010f0:
-			PSXHW_LOG("DMA PCR 32bit read %x\n", psxHu32(0x10f0));
-			return SWAPu32(HW_DMA_PCR); // dma rest channel
-		case 0x1f8010f4:
-			PSXHW_LOG("DMA ICR 32bit read %x\n", psxHu32(0x10f4));
-			return SWAPu32(HW_DMA_ICR); // interrupt enabler?*/
-#endif
-
-		// time for rootcounters :)
-		case 0x1f801100:
-			hard = psxRcntRcount(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 count read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801104:
-			hard = psxRcntRmode(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 mode read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801108:
-			hard = psxRcntRtarget(0);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T0 target read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801110:
-			hard = psxRcntRcount(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 count read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801114:
-			hard = psxRcntRmode(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 mode read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801118:
-			hard = psxRcntRtarget(1);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T1 target read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801120:
-			hard = psxRcntRcount(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 count read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801124:
-			hard = psxRcntRmode(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 mode read32: %x\n", hard);
-#endif
-			return hard;
-		case 0x1f801128:
-			hard = psxRcntRtarget(2);
-#ifdef PSXHW_LOG
-			PSXHW_LOG("T2 target read32: %x\n", hard);
-#endif
-			return hard;
+static u32 hwRead32Sio(u32 add) {
+	u32 hard;
 
-		default:
-			hard = psxHu32(add); 
-#ifdef PSXHW_LOG
-			PSXHW_LOG("*Unkwnown 32bit read at address %x\n", add);
-#endif
-			return hard;
-	}
-#ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 32bit read at address %x\n", add);
+	hard = sioRead8();
+	hard |= sioRead8() << 8;
+	hard |= sioRead8() << 16;
+	hard |= sioRead8() << 24;
+#ifdef PAD_LOG
+	PAD_LOG("sio read32 ;ret = %x\n", hard);
 #endif
 	return hard;
 }
 
-void psxHwWrite8(u32 add, u8 value) {
-	switch (add) {
-		case 0x1f801040: sioWrite8(value); break;
 #ifdef ENABLE_SIO1API
-		case 0x1f801050: SIO1_writeData8(value); break;
+static u32 hwRead32Sio1(u32 add) { return SIO1_readData32(); }
+#endif
+static u32 hwRead32GpuData(u32 add) { return GPU_readData(); }
+static u32 hwRead32GpuStatus(u32 add) { return gpuReadStatus(); }
+static u32 hwRead32Mdec0(u32 add) { return mdecRead0(); }
+static u32 hwRead32Mdec1(u32 add) { return mdecRead1(); }
+static u32 hwRead32Count(u32 add) { return psxRcntRcount((add >> 4) & 3); }
+static u32 hwRead32Mode(u32 add) { return psxRcntRmode((add >> 4) & 3); }
+static u32 hwRead32Target(u32 add) { return psxRcntRtarget((add >> 4) & 3); }
+
+u8 (*const psxHwRead8Tbl[0x1000])(u32 add) = {
+	R8(0x1f801040) = hwRead8Sio,
+#ifdef ENABLE_SIO1API
+	R8(0x1f801050) = hwRead8Sio1,
+#endif
+	R8(0x1f801800) = hwRead8Cdr0,
+	R8(0x1f801801) = hwRead8Cdr1,
+	R8(0x1f801802) = hwRead8Cdr2,
+	R8(0x1f801803) = hwRead8Cdr3,
+};
+
+u16 (*const psxHwRead16Tbl[0x800])(u32 add) = {
+	R16(0x1f801040) = hwRead16Sio,
+	R16(0x1f801044) = hwRead16SioStat,
+	R16(0x1f801048) = hwRead16SioMode,
+	R16(0x1f80104a) = hwRead16SioCtrl,
+	R16(0x1f80104e) = hwRead16SioBaud,
+#ifdef ENABLE_SIO1API
+	R16(0x1f801050) = hwRead16Sio1Data,
+	R16(0x1f801054) = hwRead16Sio1Stat,
+	R16(0x1f80105a) = hwRead16Sio1Ctrl,
+	R16(0x1f80105e) = hwRead16Sio1Baud,
+#endif
+	R16(0x1f801100) = hwRead16Count, R16(0x1f801104) = hwRead16Mode, R16(0x1f801108) = hwRead16Target,
+	R16(0x1f801110) = hwRead16Count, R16(0x1f801114) = hwRead16Mode, R16(0x1f801118) = hwRead16Target,
+	R16(0x1f801120) = hwRead16Count, R16(0x1f801124) = hwRead16Mode, R16(0x1f801128) = hwRead16Target,
+	[(0xc00 >> 1) ... (0xdfe >> 1)] = hwRead16Spu, // 0x1f801c00-0x1f801dff
+};
+
+u32 (*const psxHwRead32Tbl[0x400])(u32 add) = {
+	R32(0x1f801040) = hwRead32Sio,
+#ifdef ENABLE_SIO1API
+	R32(0x1f801050) = hwRead32Sio1,
 #endif
-		case 0x1f801800: cdrWrite0(value); break;
-		case 0x1f801801: cdrWrite1(value); break;
-		case 0x1f801802: cdrWrite2(value); break;
-		case 0x1f801803: cdrWrite3(value); break;
+	R32(0x1f801100) = hwRead32Count, R32(0x1f801104) = hwRead32Mode, R32(0x1f801108) = hwRead32Target,
+	R32(0x1f801110) = hwRead32Count, R32(0x1f801114) = hwRead32Mode, R32(0x1f801118) = hwRead32Target,
+	R32(0x1f801120) = hwRead32Count, R32(0x1f801124) = hwRead32Mode, R32(0x1f801128) = hwRead32Target,
+	R32(0x1f801810) = hwRead32GpuData,
+	R32(0x1f801814) = hwRead32GpuStatus,
+	R32(0x1f801820) = hwRead32Mdec0,
+	R32(0x1f801824) = hwRead32Mdec1,
+};
 
-		default:
-			psxHu8ref(add) = value;
-#ifdef PSXHW_LOG
-			PSXHW_LOG("*Unknown 8bit write at address %x value %x\n", add, value);
-#endif
-			return;
-	}
-	psxHu8ref(add) = value;
-#ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 8bit write at address %x value %x\n", add, value);
-#endif
-}
+/* - writes - */
 
-void psxHwWrite16(u32 add, u16 value) {
-	switch (add) {
-		case 0x1f801040:
-			sioWrite8((unsigned char)value);
-			sioWrite8((unsigned char)(value>>8));
-#ifdef PAD_LOG
-			PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
-#endif
-			return;
-		case 0x1f801044:
-			sioWriteStat16(value);
-#ifdef PAD_LOG
-			PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
-#endif
-			return;
-		case 0x1f801048:
-            sioWriteMode16(value);
-#ifdef PAD_LOG
-			PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
-#endif
-			return;
-		case 0x1f80104a: // control register
-			sioWriteCtrl16(value);
-#ifdef PAD_LOG
-			PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
+// the 8 bit registers also keep the written value in psxH
+static void hwWrite8Sio(u32 add, u8 value) { sioWrite8(value); psxHu8ref(add) = value; }
+#ifdef ENABLE_SIO1API
+static void hwWrite8Sio1(u32 add, u8 value) { SIO1_writeData8(value); psxHu8ref(add) = value; }
 #endif
-			return;
-		case 0x1f80104e: // baudrate register
-            sioWriteBaud16(value);
+static void hwWrite8Cdr0(u32 add, u8 value) { cdrWrite0(value); psxHu8ref(add) = value; }
+static void hwWrite8Cdr1(u32 add, u8 value) { cdrWrite1(value); psxHu8ref(add) = value; }
+static void hwWrite8Cdr2(u32 add, u8 value) { cdrWrite2(value); psxHu8ref(add) = value; }
+static void hwWrite8Cdr3(u32 add, u8 value) { cdrWrite3(value); psxHu8ref(add) = value; }
+
+static void hwWrite16Sio(u32 add, u16 value) {
+	sioWrite8((unsigned char)value);
+	sioWrite8((unsigned char)(value>>8));
 #ifdef PAD_LOG
-			PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
+	PAD_LOG ("sio write16 %x, %x\n", add&0xf, value);
 #endif
-			return;
+}
+
+static void hwWrite16SioStat(u32 add, u16 value) { sioWriteStat16(value); }
+static void hwWrite16SioMode(u32 add, u16 value) { sioWriteMode16(value); }
+static void hwWrite16SioCtrl(u32 add, u16 value) { sioWriteCtrl16(value); }
+static void hwWrite16SioBaud(u32 add, u16 value) { sioWriteBaud16(value); }
 #ifdef ENABLE_SIO1API
-		case 0x1f801050:
-			SIO1_writeData16(value);
-			return;
-		case 0x1f801054:
-			SIO1_writeStat16(value);
-			return;
-		case 0x1f80105a:
-			SIO1_writeCtrl16(value);
-			return;
-		case 0x1f80105e:
-			SIO1_writeBaud16(value);
-			return;
+static void hwWrite16Sio1Data(u32 add, u16 value) { SIO1_writeData16(value); }
+static void hwWrite16Sio1Stat(u32 add, u16 value) { SIO1_writeStat16(value); }
+static void hwWrite16Sio1Ctrl(u32 add, u16 value) { SIO1_writeCtrl16(value); }
+static void hwWrite16Sio1Baud(u32 add, u16 value) { SIO1_writeBaud16(value); }
 #endif
-		case 0x1f801070: 
-#ifdef PSXHW_LOG
-			PSXHW_LOG("IREG 16bit write %x\n", value);
-#endif
-			if (Config.Sio) psxHu16ref(0x1070) |= SWAPu16(0x80);
-			if (Config.SpuIrq) psxHu16ref(0x1070) |= SWAPu16(0x200);
-			psxHu16ref(0x1070) &= SWAPu16(value);
-			return;
 
-		case 0x1f801074:
+static void hwWrite16Ireg(u32 add, u16 value) {
 #ifdef PSXHW_LOG
-			PSXHW_LOG("IMASK 16bit write %x\n", value);
+	PSXHW_LOG("IREG 16bit write %x\n", value);
 #endif
-			psxHu16ref(0x1074) = SWAPu16(value);
-			return;
+	if (Config.Sio) psxHu16ref(0x1070) |= SWAPu16(0x80);
+	if (Config.SpuIrq) psxHu16ref(0x1070) |= SWAPu16(0x200);
+	psxHu16ref(0x1070) &= SWAPu16(value);
+}
 
-		case 0x1f801100:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 COUNT 16bit write %x\n", value);
-#endif
-			psxRcntWcount(0, value); return;
-		case 0x1f801104:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 MODE 16bit write %x\n", value);
-#endif
-			psxRcntWmode(0, value); return;
-		case 0x1f801108:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 TARGET 16bit write %x\n", value);
-#endif
-			psxRcntWtarget(0, value); return;
+static void hwWrite16Count(u32 add, u16 value) { psxRcntWcount((add >> 4) & 3, value); }
+static void hwWrite16Mode(u32 add, u16 value) { psxRcntWmode((add >> 4) & 3, value); }
+static void hwWrite16Target(u32 add, u16 value) { psxRcntWtarget((add >> 4) & 3, value); }
+static void hwWrite16Spu(u32 add, u16 value) { SPU_writeRegister(add, value); }
 
-		case 0x1f801110:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 COUNT 16bit write %x\n", value);
-#endif
-			psxRcntWcount(1, value); return;
-		case 0x1f801114:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 MODE 16bit write %x\n", value);
-#endif
-			psxRcntWmode(1, value); return;
-		case 0x1f801118:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 TARGET 16bit write %x\n", value);
+static void hwWrite32Sio(u32 add, u32 value) {
+	sioWrite8((unsigned char)value);
+	sioWrite8((unsigned char)((value&0xff) >>  8));
+	sioWrite8((unsigned char)((value&0xff) >> 16));
+	sioWrite8((unsigned char)((value&0xff) >> 24));
+#ifdef PAD_LOG
+	PAD_LOG("sio write32 %x\n", value);
 #endif
-			psxRcntWtarget(1, value); return;
+}
 
-		case 0x1f801120:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 COUNT 16bit write %x\n", value);
-#endif
-			psxRcntWcount(2, value); return;
-		case 0x1f801124:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 MODE 16bit write %x\n", value);
-#endif
-			psxRcntWmode(2, value); return;
-		case 0x1f801128:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 TARGET 16bit write %x\n", value);
+#ifdef ENABLE_SIO1API
+static void hwWrite32Sio1(u32 add, u32 value) { SIO1_writeData32(value); }
 #endif
-			psxRcntWtarget(2, value); return;
-
-		default:
-			if (add>=0x1f801c00 && add<0x1f801e00) {
-            	SPU_writeRegister(add, value);
-				return;
-			}
 
-			psxHu16ref(add) = SWAPu16(value);
+static void hwWrite32Ireg(u32 add, u32 value) {
 #ifdef PSXHW_LOG
-			PSXHW_LOG("*Unknown 16bit write at address %x value %x\n", add, value);
-#endif
-			return;
-	}
-	psxHu16ref(add) = SWAPu16(value);
-#ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 16bit write at address %x value %x\n", add, value);
+	PSXHW_LOG("IREG 32bit write %x\n", value);
 #endif
+	if (Config.Sio) psxHu32ref(0x1070) |= SWAPu32(0x80);
+	if (Config.SpuIrq) psxHu32ref(0x1070) |= SWAPu32(0x200);
+	psxHu32ref(0x1070) &= SWAPu32(value);
 }
 
 #define DmaExec(n) { \
@@ -508,245 +230,174 @@ void psxHwWrite16(u32 add, u16 value) {
 	} \
 }
 
-void psxHwWrite32(u32 add, u32 value) {
-	switch (add) {
-	    case 0x1f801040:
-			sioWrite8((unsigned char)value);
-			sioWrite8((unsigned char)((value&0xff) >>  8));
-			sioWrite8((unsigned char)((value&0xff) >> 16));
-			sioWrite8((unsigned char)((value&0xff) >> 24));
-#ifdef PAD_LOG
-			PAD_LOG("sio write32 %x\n", value);
-#endif
-			return;
-#ifdef ENABLE_SIO1API
-		case 0x1f801050:
-			SIO1_writeData32(value);
-			return;
-#endif
-#ifdef PSXHW_LOG
-		case 0x1f801060:
-			PSXHW_LOG("RAM size write %x\n", value);
-			psxHu32ref(add) = SWAPu32(value);
-			return; // Ram size
-#endif
+static void hwWrite32Dma0(u32 add, u32 value) DmaExec(0)	// MDEC in DMA
+static void hwWrite32Dma1(u32 add, u32 value) DmaExec(1)	// MDEC out DMA
+static void hwWrite32Dma2(u32 add, u32 value) DmaExec(2)	// GPU DMA
+static void hwWrite32Dma3(u32 add, u32 value) DmaExec(3)	// CDROM DMA
+static void hwWrite32Dma4(u32 add, u32 value) DmaExec(4)	// SPU DMA
+static void hwWrite32Dma6(u32 add, u32 value) DmaExec(6)	// OT clear
 
-		case 0x1f801070: 
-#ifdef PSXHW_LOG
-			PSXHW_LOG("IREG 32bit write %x\n", value);
-#endif
-			if (Config.Sio) psxHu32ref(0x1070) |= SWAPu32(0x80);
-			if (Config.SpuIrq) psxHu32ref(0x1070) |= SWAPu32(0x200);
-			psxHu32ref(0x1070) &= SWAPu32(value);
-			return;
-		case 0x1f801074:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("IMASK 32bit write %x\n", value);
-#endif
-			psxHu32ref(0x1074) = SWAPu32(value);
-			return;
+static void hwWrite32DmaIcr(u32 add, u32 value) {
+	u32 tmp = (~value) & SWAPu32(HW_DMA_ICR);
+	HW_DMA_ICR = SWAPu32(((tmp ^ value) & 0xffffff) ^ tmp);
+}
 
-#ifdef PSXHW_LOG
-		case 0x1f801080:
-			PSXHW_LOG("DMA0 MADR 32bit write %x\n", value);
-			HW_DMA0_MADR = SWAPu32(value); return; // DMA0 madr
-		case 0x1f801084:
-			PSXHW_LOG("DMA0 BCR 32bit write %x\n", value);
-			HW_DMA0_BCR  = SWAPu32(value); return; // DMA0 bcr
-#endif
-		case 0x1f801088:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA0 CHCR 32bit write %x\n", value);
-#endif
-			DmaExec(0);	                 // DMA0 chcr (MDEC in DMA)
-			return;
+static void hwWrite32GpuData(u32 add, u32 value) { GPU_writeData(value); }
+static void hwWrite32GpuStatus(u32 add, u32 value) { GPU_writeStatus(value); }
+static void hwWrite32Mdec0(u32 add, u32 value) { mdecWrite0(value); psxHu32ref(add) = SWAPu32(value); }
+static void hwWrite32Mdec1(u32 add, u32 value) { mdecWrite1(value); psxHu32ref(add) = SWAPu32(value); }
+static void hwWrite32Count(u32 add, u32 value) { psxRcntWcount((add >> 4) & 3, value & 0xffff); }
+static void hwWrite32Mode(u32 add, u32 value) { psxRcntWmode((add >> 4) & 3, value); }
+static void hwWrite32Target(u32 add, u32 value) { psxRcntWtarget((add >> 4) & 3, value & 0xffff); }
+
+// Dukes of Hazard 2 - car engine noise
+static void hwWrite32Spu(u32 add, u32 value) {
+	SPU_writeRegister(add, value&0xffff);
+	SPU_writeRegister(add + 2, value >> 16);
+}
 
-#ifdef PSXHW_LOG
-		case 0x1f801090:
-			PSXHW_LOG("DMA1 MADR 32bit write %x\n", value);
-			HW_DMA1_MADR = SWAPu32(value); return; // DMA1 madr
-		case 0x1f801094:
-			PSXHW_LOG("DMA1 BCR 32bit write %x\n", value);
-			HW_DMA1_BCR  = SWAPu32(value); return; // DMA1 bcr
-#endif
-		case 0x1f801098:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA1 CHCR 32bit write %x\n", value);
-#endif
-			DmaExec(1);                  // DMA1 chcr (MDEC out DMA)
-			return;
+void (*const psxHwWrite8Tbl[0x1000])(u32 add, u8 value) = {
+	R8(0x1f801040) = hwWrite8Sio,
+#ifdef ENABLE_SIO1API
+	R8(0x1f801050) = hwWrite8Sio1,
+#endif
+	R8(0x1f801800) = hwWrite8Cdr0,
+	R8(0x1f801801) = hwWrite8Cdr1,
+	R8(0x1f801802) = hwWrite8Cdr2,
+	R8(0x1f801803) = hwWrite8Cdr3,
+};
+
+void (*const psxHwWrite16Tbl[0x800])(u32 add, u16 value) = {
+	R16(0x1f801040) = hwWrite16Sio,
+	R16(0x1f801044) = hwWrite16SioStat,
+	R16(0x1f801048) = hwWrite16SioMode,
+	R16(0x1f80104a) = hwWrite16SioCtrl,
+	R16(0x1f80104e) = hwWrite16SioBaud,
+#ifdef ENABLE_SIO1API
+	R16(0x1f801050) = hwWrite16Sio1Data,
+	R16(0x1f801054) = hwWrite16Sio1Stat,
+	R16(0x1f80105a) = hwWrite16Sio1Ctrl,
+	R16(0x1f80105e) = hwWrite16Sio1Baud,
+#endif
+	R16(0x1f801070) = hwWrite16Ireg,
+	R16(0x1f801100) = hwWrite16Count, R16(0x1f801104) = hwWrite16Mode, R16(0x1f801108) = hwWrite16Target,
+	R16(0x1f801110) = hwWrite16Count, R16(0x1f801114) = hwWrite16Mode, R16(0x1f801118) = hwWrite16Target,
+	R16(0x1f801120) = hwWrite16Count, R16(0x1f801124) = hwWrite16Mode, R16(0x1f801128) = hwWrite16Target,
+	[(0xc00 >> 1) ... (0xdfe >> 1)] = hwWrite16Spu,
+};
+
+void (*const psxHwWrite32Tbl[0x400])(u32 add, u32 value) = {
+	R32(0x1f801040) = hwWrite32Sio,
+#ifdef ENABLE_SIO1API
+	R32(0x1f801050) = hwWrite32Sio1,
+#endif
+	R32(0x1f801070) = hwWrite32Ireg,
+	R32(0x1f801088) = hwWrite32Dma0,
+	R32(0x1f801098) = hwWrite32Dma1,
+	R32(0x1f8010a8) = hwWrite32Dma2,
+	R32(0x1f8010b8) = hwWrite32Dma3,
+	R32(0x1f8010c8) = hwWrite32Dma4,
+	R32(0x1f8010e8) = hwWrite32Dma6,
+	R32(0x1f8010f4) = hwWrite32DmaIcr,
+	R32(0x1f801100) = hwWrite32Count, R32(0x1f801104) = hwWrite32Mode, R32(0x1f801108) = hwWrite32Target,
+	R32(0x1f801110) = hwWrite32Count, R32(0x1f801114) = hwWrite32Mode, R32(0x1f801118) = hwWrite32Target,
+	R32(0x1f801120) = hwWrite32Count, R32(0x1f801124) = hwWrite32Mode, R32(0x1f801128) = hwWrite32Target,
+	R32(0x1f801810) = hwWrite32GpuData,
+	R32(0x1f801814) = hwWrite32GpuStatus,
+	R32(0x1f801820) = hwWrite32Mdec0,
+	R32(0x1f801824) = hwWrite32Mdec1,
+	[(0xc00 >> 2) ... (0xdfc >> 2)] = hwWrite32Spu,
+};
+
+/* - dispatch - */
 
-#ifdef PSXHW_LOG
-		case 0x1f8010a0:
-			PSXHW_LOG("DMA2 MADR 32bit write %x\n", value);
-			HW_DMA2_MADR = SWAPu32(value); return; // DMA2 madr
-		case 0x1f8010a4:
-			PSXHW_LOG("DMA2 BCR 32bit write %x\n", value);
-			HW_DMA2_BCR  = SWAPu32(value); return; // DMA2 bcr
-#endif
-		case 0x1f8010a8:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA2 CHCR 32bit write %x\n", value);
-#endif
-			DmaExec(2);                  // DMA2 chcr (GPU DMA)
-			return;
+u8 psxHwRead8(u32 add) {
+	u8 (*h)(u32) = PSXHW_IO8(add) ? psxHwRead8Tbl[add & 0xfff] : NULL;
 
-#ifdef PSXHW_LOG
-		case 0x1f8010b0:
-			PSXHW_LOG("DMA3 MADR 32bit write %x\n", value);
-			HW_DMA3_MADR = SWAPu32(value); return; // DMA3 madr
-		case 0x1f8010b4:
-			PSXHW_LOG("DMA3 BCR 32bit write %x\n", value);
-			HW_DMA3_BCR  = SWAPu32(value); return; // DMA3 bcr
-#endif
-		case 0x1f8010b8:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA3 CHCR 32bit write %x\n", value);
-#endif
-			DmaExec(3);                  // DMA3 chcr (CDROM DMA)
-			
-			return;
+	if (h)
+		return h(add);
 
 #ifdef PSXHW_LOG
-		case 0x1f8010c0:
-			PSXHW_LOG("DMA4 MADR 32bit write %x\n", value);
-			HW_DMA4_MADR = SWAPu32(value); return; // DMA4 madr
-		case 0x1f8010c4:
-			PSXHW_LOG("DMA4 BCR 32bit write %x\n", value);
-			HW_DMA4_BCR  = SWAPu32(value); return; // DMA4 bcr
-#endif
-		case 0x1f8010c8:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA4 CHCR 32bit write %x\n", value);
+	PSXHW_LOG("*Unkwnown 8bit read at address %x\n", add);
 #endif
-			DmaExec(4);                  // DMA4 chcr (SPU DMA)
-			return;
+	return psxHu8(add);
+}
 
-#if 0
-		case 0x1f8010d0: break; //DMA5write_madr();
-		case 0x1f8010d4: break; //DMA5write_bcr();
-		case 0x1f8010d8: break; //DMA5write_chcr(); // Not needed
-#endif
+u16 psxHwRead16(u32 add) {
+	if (PSXHW_IO16(add)) {
+		u16 (*h)(u32) = psxHwRead16Tbl[(add & 0xfff) >> 1];
+		if (h)
+			return h(add);
+	} else if (SPU_RANGE(add))
+		return SPU_readRegister(add);
 
 #ifdef PSXHW_LOG
-		case 0x1f8010e0:
-			PSXHW_LOG("DMA6 MADR 32bit write %x\n", value);
-			HW_DMA6_MADR = SWAPu32(value); return; // DMA6 bcr
-		case 0x1f8010e4:
-			PSXHW_LOG("DMA6 BCR 32bit write %x\n", value);
-			HW_DMA6_BCR  = SWAPu32(value); return; // DMA6 bcr
+	PSXHW_LOG("*Unkwnown 16bit read at address %x\n", add);
 #endif
-		case 0x1f8010e8:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA6 CHCR 32bit write %x\n", value);
-#endif
-			DmaExec(6);                   // DMA6 chcr (OT clear)
-			return;
+	return psxHu16(add);
+}
 
-#ifdef PSXHW_LOG
-		case 0x1f8010f0:
-			PSXHW_LOG("DMA PCR 32bit write %x\n", value);
-			HW_DMA_PCR = SWAPu32(value);
-			return;
-#endif
+u32 psxHwRead32(u32 add) {
+	u32 (*h)(u32) = PSXHW_IO32(add) ? psxHwRead32Tbl[(add & 0xfff) >> 2] : NULL;
 
-		case 0x1f8010f4:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("DMA ICR 32bit write %x\n", value);
-#endif
-		{
-			u32 tmp = (~value) & SWAPu32(HW_DMA_ICR);
-			HW_DMA_ICR = SWAPu32(((tmp ^ value) & 0xffffff) ^ tmp);
-			return;
-		}
+	if (h)
+		return h(add);
 
-		case 0x1f801810:
 #ifdef PSXHW_LOG
-			PSXHW_LOG("GPU DATA 32bit write %x\n", value);
+	PSXHW_LOG("*Unkwnown 32bit read at address %x\n", add);
 #endif
-			GPU_writeData(value); return;
-		case 0x1f801814:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("GPU STATUS 32bit write %x\n", value);
-#endif
-			GPU_writeStatus(value); return;
-
-		case 0x1f801820:
-			mdecWrite0(value); break;
-		case 0x1f801824:
-			mdecWrite1(value); break;
+	return psxHu32(add);
+}
 
-		case 0x1f801100:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 COUNT 32bit write %x\n", value);
-#endif
-			psxRcntWcount(0, value & 0xffff); return;
-		case 0x1f801104:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 MODE 32bit write %x\n", value);
-#endif
-			psxRcntWmode(0, value); return;
-		case 0x1f801108:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 0 TARGET 32bit write %x\n", value);
-#endif
-			psxRcntWtarget(0, value & 0xffff); return; //  HW_DMA_ICR&= SWAP32((~value)&0xff000000);
+void psxHwWrite8(u32 add, u8 value) {
+	void (*h)(u32, u8) = PSXHW_IO8(add) ? psxHwWrite8Tbl[add & 0xfff] : NULL;
 
-		case 0x1f801110:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 COUNT 32bit write %x\n", value);
-#endif
-			psxRcntWcount(1, value & 0xffff); return;
-		case 0x1f801114:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 MODE 32bit write %x\n", value);
-#endif
-			psxRcntWmode(1, value); return;
-		case 0x1f801118:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 1 TARGET 32bit write %x\n", value);
-#endif
-			psxRcntWtarget(1, value & 0xffff); return;
+	if (h) {
+		h(add, value);
+		return;
+	}
 
-		case 0x1f801120:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 COUNT 32bit write %x\n", value);
-#endif
-			psxRcntWcount(2, value & 0xffff); return;
-		case 0x1f801124:
-#ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 MODE 32bit write %x\n", value);
-#endif
-			psxRcntWmode(2, value); return;
-		case 0x1f801128:
+	psxHu8ref(add) = value;
 #ifdef PSXHW_LOG
-			PSXHW_LOG("COUNTER 2 TARGET 32bit write %x\n", value);
+	PSXHW_LOG("*Unknown 8bit write at address %x value %x\n", add, value);
 #endif
-			psxRcntWtarget(2, value & 0xffff); return;
-
-		default:
-			// Dukes of Hazard 2 - car engine noise
-			if (add>=0x1f801c00 && add<0x1f801e00) {
-        SPU_writeRegister(add, value&0xffff);
-				
-				add += 2;
-				value >>= 16;
-
-				if (add>=0x1f801c00 && add<0x1f801e00)
-					SPU_writeRegister(add, value&0xffff);
-				return;
-			}
+}
 
+void psxHwWrite16(u32 add, u16 value) {
+	if (PSXHW_IO16(add)) {
+		void (*h)(u32, u16) = psxHwWrite16Tbl[(add & 0xfff) >> 1];
+		if (h) {
+			h(add, value);
+			return;
+		}
+	} else if (SPU_RANGE(add)) {
+		SPU_writeRegister(add, value);
+		return;
+	}
 
-			psxHu32ref(add) = SWAPu32(value);
+	psxHu16ref(add) = SWAPu16(value);
 #ifdef PSXHW_LOG
-			PSXHW_LOG("*Unknown 32bit write at address %x value %x\n", add, value);
+	PSXHW_LOG("*Unknown 16bit write at address %x value %x\n", add, value);
 #endif
+}
+
+void psxHwWrite32(u32 add, u32 value) {
+	if (PSXHW_IO32(add)) {
+		void (*h)(u32, u32) = psxHwWrite32Tbl[(add & 0xfff) >> 2];
+		if (h) {
+			h(add, value);
 			return;
+		}
+	} else if (SPU_RANGE(add)) {
+		SPU_writeRegister(add, value&0xffff);
+		if (SPU_RANGE(add + 2))
+			SPU_writeRegister(add + 2, value >> 16);
+		return;
 	}
+
 	psxHu32ref(add) = SWAPu32(value);
 #ifdef PSXHW_LOG
-	PSXHW_LOG("*Known 32bit write at address %x value %x\n", add, value);
+	PSXHW_LOG("*Unknown 32bit write at address %x value %x\n", add, value);
 #endif
 }
 
@@ -63,6 +63,19 @@ extern "C" {
 		psxHu32ref(0x1070) |= SWAP32(8);            \
 	}
 
+// io page 0x1f801000-0x1f801fff, naturally aligned
+#define PSXHW_IO8(add)	(((add) & 0xfffff000) == 0x1f801000)
+#define PSXHW_IO16(add)	(((add) & 0xfffff001) == 0x1f801000)
+#define PSXHW_IO32(add)	(((add) & 0xfffff003) == 0x1f801000)
+
+// register handlers by (add & 0xfff) / width, NULL for plain psxH storage
+extern u8 (*const psxHwRead8Tbl[0x1000])(u32 add);
+extern u16 (*const psxHwRead16Tbl[0x800])(u32 add);
+extern u32 (*const psxHwRead32Tbl[0x400])(u32 add);
+extern void (*const psxHwWrite8Tbl[0x1000])(u32 add, u8 value);
+extern void (*const psxHwWrite16Tbl[0x800])(u32 add, u16 value);
+extern void (*const psxHwWrite32Tbl[0x400])(u32 add, u32 value);
+
 void psxHwReset();
 u8 psxHwRead8(u32 add);
 u16 psxHwRead16(u32 add);
@@ -386,3 +386,27 @@ void *psxMemPointer(u32 mem) {
 		return NULL;
 	}
 }
+
+// Host pointer for mem and how many of the next len bytes follow it
+// contiguously in host memory (mirrors and region ends break a span).
+// Goes through the read LUT like PSXM(), NULL if mem is unmapped.
+u8 *psxMemSpan(u32 mem, u32 len, u32 *span) {
+	u8 *p;
+	u32 t, n;
+
+	if (psxMemRLUT[mem >> 16] == NULL) {
+		*span = 0;
+		return NULL;
+	}
+
+	p = psxMemRLUT[mem >> 16] + (mem & 0xffff);
+	n = 0x10000 - (mem & 0xffff);
+
+	for (t = (mem >> 16) + 1; n < len && t < 0x10000; t++) {
+		if (psxMemRLUT[t] != p + n) break;
+		n += 0x10000;
+	}
+
+	*span = n < len ? n : len;
+	return p;
+}
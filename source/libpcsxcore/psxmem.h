@@ -138,6 +138,7 @@ void psxMemWrite8 (u32 mem, u8 value);
 void psxMemWrite16(u32 mem, u16 value);
 void psxMemWrite32(u32 mem, u32 value);
 void *psxMemPointer(u32 mem);
+u8 *psxMemSpan(u32 mem, u32 len, u32 *span);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Run ahead: show frames the emulation has not reached yet              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+/*
+ * Games react to a button a frame or two after they read it. With run
+ * ahead the emulator takes a ram snapshot at every vsync, emulates the
+ * next Config.RunAhead frames with the input just read, shows the last of
+ * them and goes back to the snapshot. The frames that are really kept run
+ * with the gpu output off and the spu on, so what is seen is always
+ * Config.RunAhead frames ahead of what is heard and of the psx itself.
+ *
+ * The cpu is stopped at the vsync and the frames are run from the top, on
+ * the same stack as psxCpu->Execute(), never from inside recompiled code:
+ * the frontends call Execute() again for as long as RunAheadFrame() says
+ * the cpu was only stopped for it.
+ * A frame ends with the next vsync; when the cpu stops for anything else
+ * (the gui) the run ahead is given up for that frame.
+ */
+
+#include "psxcommon.h"
+#include "r3000a.h"
+#include "plugins.h"
+#include "misc.h"
+#include "movie.h"
+#include "runahead.h"
+
+#ifdef LIBXENON
+#include <ppc/timebase.h>
+
+#define ra_ticks()		mftb()
+#define ra_ticks_us		(PPC_TIMEBASE_FREQ / 1000000)
+#else
+#include <sys/time.h>
+
+static u64 ra_ticks() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+#define ra_ticks_us		1
+#endif
+
+static struct {
+	boolean due;		// the cpu got stopped at a vsync for a run ahead
+	boolean inside;		// emulating frames that get thrown away
+	boolean hidden;		// gpu output is off, the kept frames are not shown
+	u32 vsyncs;
+
+	RunAheadStats stats;
+} ra;
+
+void RunAheadVSync(void) {
+	if (ra.inside) {
+		ra.vsyncs++;
+		cpuRunning = 0;
+		return;
+	}
+
+	// a movie would see the polls of the frames thrown away
+	if (Config.RunAhead <= 0 || Movie_Active()) {
+		if (ra.hidden) {
+			ra.hidden = FALSE;
+			GPU_setOutput(1);
+		}
+		return;
+	}
+
+	ra.due = TRUE;
+	cpuRunning = 0;
+}
+
+boolean RunAheadFrame(void) {
+	u64 start, saved, ran;
+	boolean stopped = FALSE;
+	int i;
+
+	if (!ra.due)
+		return FALSE;
+	ra.due = FALSE;
+
+	start = ra_ticks();
+
+	SPU_setOutput(0);
+	if (SaveSnapshot() < 0) {
+		SysPrintf("Run ahead: no memory for the snapshot, disabled\n");
+		Config.RunAhead = 0;
+		SPU_setOutput(1);
+		RunAheadReset();
+		return TRUE;
+	}
+	saved = ra_ticks();
+
+	ra.inside = TRUE;
+	for (i = 0; i < Config.RunAhead; i++) {
+		u32 vsyncs = ra.vsyncs;
+
+		// only the last one is shown
+		if (i == Config.RunAhead - 1)
+			GPU_setOutput(1);
+
+		cpuRunning = 1;
+		psxCpu->Execute();
+
+		// stopped for the gui, which gets its turn after the load
+		if (ra.vsyncs == vsyncs) {
+			ra.stats.aborted++;
+			stopped = TRUE;
+			break;
+		}
+		ra.stats.hidden++;
+	}
+	ra.inside = FALSE;
+	ran = ra_ticks();
+
+	GPU_setOutput(0);
+	LoadSnapshot();
+	SPU_setOutput(1);
+	ra.hidden = TRUE;
+
+	ra.stats.frames++;
+	ra.stats.snapus += (u32)((saved - start + ra_ticks() - ran) / ra_ticks_us);
+	ra.stats.runus += (u32)((ran - saved) / ra_ticks_us);
+	return !stopped;
+}
+
+void RunAheadReset(void) {
+	ra.due = FALSE;
+
+	if (ra.hidden) {
+		ra.hidden = FALSE;
+		GPU_setOutput(1);
+	}
+
+	FreeSnapshot();
+}
+
+void RunAheadGetStats(RunAheadStats *stats) {
+	*stats = ra.stats;
+}
+
+void RunAheadReport(void) {
+	u32 frames = ra.stats.frames;
+
+	if (frames == 0)
+		return;
+
+	SysPrintf("Run ahead: %u frames, %u thrown away (%u aborted), %u us/frame snapshots, %u us/frame ahead\n",
+		frames, ra.stats.hidden, ra.stats.aborted,
+		ra.stats.snapus / frames, ra.stats.runus / frames);
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+ *   Run ahead: show frames the emulation has not reached yet              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#ifndef __RUNAHEAD_H__
+#define __RUNAHEAD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psxcommon.h"
+
+typedef struct {
+	u32 frames;		// real frames a run ahead was done for
+	u32 hidden;		// frames emulated and thrown away again
+	u32 aborted;	// run aheads cut short, by the gui or a reset
+	u32 snapus;		// time spent taking and loading snapshots
+	u32 runus;		// time spent in the frames thrown away
+} RunAheadStats;
+
+// psx vsync, from EmuUpdate: stops the cpu when a run ahead is due
+void RunAheadVSync(void);
+
+// once psxCpu->Execute() returned: does the run ahead if one is due. TRUE
+// when the cpu only stopped for it and the caller goes on with the
+// emulation, FALSE when it stopped for something else
+boolean RunAheadFrame(void);
+
+// shows the real frames again, before the plugins get closed
+void RunAheadReset(void);
+
+void RunAheadGetStats(RunAheadStats *stats);
+void RunAheadReport(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
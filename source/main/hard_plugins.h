@@ -150,6 +150,8 @@ extern "C" {
 	void CALLBACK XRAUDIO_SPUwriteRegister(unsigned long reg, unsigned short val);
 	unsigned short CALLBACK XRAUDIO_SPUreadRegister(unsigned long reg);
 	long CALLBACK XRAUDIO_SPUfreeze(unsigned long ulFreezeMode, SPUFreeze_t * pF);
+	void CALLBACK XRAUDIO_SPUsetSpeed(float speed);
+	void CALLBACK XRAUDIO_SPUsetOutput(int on);
 
 	/* CDR */
 	long CDR__open(void);
@@ -196,6 +198,8 @@ extern "C" {
 	void PEOPS_GPUmakeSnapshot(void);
 	void PEOPS_GPUcursor(int iPlayer, int x, int y);
 	void PEOPS_GPUaddVertex(short sx, short sy, s64 fx, s64 fy, s64 fz);
+	void PEOPS_GPUsetSpeed(float speed);
+	void PEOPS_GPUsetOutput(int on);
 
 	/* hw gpu plugins */
 	long HW_GPUopen(unsigned long *, char *, char *);
@@ -217,6 +221,8 @@ extern "C" {
 	void HW_GPUmakeSnapshot(void);
 	void HW_GPUcursor(int iPlayer, int x, int y);
 	void HW_GPUaddVertex(short sx, short sy, s64 fx, s64 fy, s64 fz);
+	void HW_GPUsetSpeed(float speed);
+	void HW_GPUsetOutput(int on);
 
 	//dfinput
 	char *INPUT_PSEgetLibName(void);
@@ -374,7 +380,7 @@ PEOPS_SPUasync} \
 	
 #define SPU_XENON_PLUGIN \
 { "/SPU",      \
-21,         \
+22,         \
 { { "SPUinit",  \
 XRAUDIO_SPUinit }, \
 { "SPUshutdown",	\
@@ -414,12 +420,16 @@ XRAUDIO_SPUasync}, \
 { "SPUupdate", \
 XRAUDIO_SPUupdate}, \
 { "SPUplayCDDAchannel", \
-XRAUDIO_SPUplayCDDAchannel} \
+XRAUDIO_SPUplayCDDAchannel}, \
+{ "SPUsetSpeed", \
+XRAUDIO_SPUsetSpeed}, \
+{ "SPUsetOutput", \
+XRAUDIO_SPUsetOutput} \
 } }
 
 #define GPU_PEOPS_PLUGIN \
 { "/GPUSW",      \
-18,         \
+20,         \
 { { "GPUinit",  \
 PEOPS_GPUinit }, \
 { "GPUshutdown",	\
@@ -455,13 +465,17 @@ PEOPS_GPUvisualVibration}, \
 { "GPUcursor", \
 PEOPS_GPUcursor}, \
 { "GPUupdateLace", \
-PEOPS_GPUupdateLace} \
+PEOPS_GPUupdateLace}, \
+{ "GPUsetSpeed", \
+PEOPS_GPUsetSpeed}, \
+{ "GPUsetOutput", \
+PEOPS_GPUsetOutput} \
 } }
 
 	// HW GPU
 #define GPU_HW_PEOPS_PLUGIN \
 { "/GPUHW",      \
-18,         \
+20,         \
 { { "GPUinit",  \
 HW_GPUinit }, \
 { "GPUshutdown",	\
@@ -496,6 +510,10 @@ HW_GPUvisualVibration}, \
 HW_GPUcursor}, \
 { "GPUupdateLace", \
 HW_GPUupdateLace}, \
+{ "GPUsetSpeed", \
+HW_GPUsetSpeed}, \
+{ "GPUsetOutput", \
+HW_GPUsetOutput}, \
 { "GPUaddVertex", \
 HW_GPUaddVertex}, \
 { "GPUvBlank", \
@@ -11,6 +11,8 @@
 #include "debug.h"
 #include "sio.h"
 #include "misc.h"
+#include "runahead.h"
+#include "movie.h"
 #include "hard_plugins.h"
 
 
@@ -48,6 +50,10 @@ extern PluginTable plugins[];
 #define cdfile "uda0:/Soul Blade (USA) (v1.0).bin"
 #define cdfile "sda0:/DEVKIT/pcsxr/Bloody Roar II (USA)/Bloody Roar II (USA).bin"
 
+// input movie from power-on: played back when it exists, recorded with MOVIE_RECORD
+#define moviefile "sda0:/devkit/pcsxr/movie.pxm"
+//#define MOVIE_RECORD
+
 static void printConfigInfo() {
 
 }
@@ -148,6 +154,8 @@ int cmain_loop() {
 	strcpy(Config.PatchesDir, "sda0:/devkit/pcsxr/patches_/");
 
 	Config.PsxAuto = 1; // autodetect system
+	Config.FastForward = 4; // R3 on the first pad
+	Config.RunAhead = 0; // 1-3: frames shown ahead of the emulation
 	
 	Config.Cpu = CPU_DYNAREC;
 	//Config.Cpu =  CPU_INTERPRETER;
@@ -182,7 +190,19 @@ int cmain_loop() {
 			CheckCdrom();
 			LoadCdrom();
 
-			psxCpu->Execute();
+#ifdef MOVIE_RECORD
+			Movie_Record(moviefile, MOVIE_POWERON);
+#else
+			struct stat st;
+			if (stat(moviefile, &st) == 0)
+				Movie_Play(moviefile);
+#endif
+
+			// with run ahead the cpu stops at every vsync
+			do {
+				cpuRunning = 1;
+				psxCpu->Execute();
+			} while (RunAheadFrame());
 		}
 	}
 
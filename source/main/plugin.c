@@ -18,6 +18,8 @@
 
 #include <stdio.h>
 #include "plugins.h"
+#include "cdrprefetch.h"
+#include "runahead.h"
 #include <time.h>
 #include <stdio.h>
 #include "r3000a.h"
@@ -125,6 +127,14 @@ void ClosePlugins() {
     PAD1_close();
     PAD2_close();
 
+    // nothing may read from the image while it gets closed
+    cdrPrefetchReset();
+    cdrPrefetchReport();
+
+    // the gpu shows the real frames again
+    RunAheadReset();
+    RunAheadReport();
+
     ret = CDR_close();
     if (ret < 0) {
         SysMessage(_("Error Closing CDR Plugin"));
@@ -149,6 +159,7 @@ void ClosePlugins() {
 void ResetPlugins() {
     int ret;
 
+    cdrPrefetchReset();
     CDR_shutdown();
     GPU_shutdown();
     SPU_shutdown();
@@ -54,6 +54,15 @@ int x_thread_wait(int thread){
     return 0;
 }
 
+// non blocking version of x_thread_wait, for threads that are shared
+int x_thread_busy(int thread){
+    int busy;
+    lock(&thread_states[thread].lock);
+    busy = thread_states[thread].states;
+    unlock(&thread_states[thread].lock);
+    return busy;
+}
+
 int x_thread_cancel(int thread){
     
     // put thread to sleep
@@ -69,8 +78,13 @@ int x_thread_cancel(int thread){
 }
 
 int x_thread_create(int thread,void *task){
+    int ret;
+
     thread_states[thread].func = task;
-    thread_states[thread].states = 0;
+    thread_states[thread].states = 1; // busy until taskrunner is done, not only once it started
 
-    return xenon_run_thread_task(thread,&thread_stack[thread][sizeof(thread_stack[thread])-0x100],taskrunner);
+    ret = xenon_run_thread_task(thread,&thread_stack[thread][sizeof(thread_stack[thread])-0x100],taskrunner);
+    if (ret)
+        thread_states[thread].states = 0; // never started, nobody would clear it
+    return ret;
 }
\ No newline at end of file
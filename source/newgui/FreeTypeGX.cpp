@@ -99,8 +99,6 @@ wchar_t* charToWideChar(const char* strChar) {
         return strWChar;
 }
 
-uint8_t * glyphData = NULL; //tmp buffer
-
 /**
  * Default constructor for the FreeTypeGX class.
  *
@@ -111,9 +109,6 @@ FreeTypeGX::FreeTypeGX(FT_UInt pixelSize, uint8_t vertexIndex) {
         this->setCompatibilityMode(FTGX_COMPATIBILITY_DEFAULT_TEVOP_GX_PASSCLR | FTGX_COMPATIBILITY_DEFAULT_VTXDESC_GX_NONE);
         this->ftPointSize = pixelSize;
         this->ftKerningEnabled = FT_HAS_KERNING(ftFace);
-
-        if (glyphData == NULL)
-                glyphData = (uint8_t *) malloc(256 * 256 * 4);
 }
 
 /**
@@ -207,14 +202,12 @@ void FreeTypeGX::setDefaultMode() {
  * This routine clears all members of the font map structure and frees all allocated memory back to the system.
  */
 void FreeTypeGX::unloadFont() {
-        if (this->fontData.size() == 0)
-                return;
-        for (std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.begin(), iEnd = this->fontData.end(); i != iEnd; ++i)
-                //free(i->second.glyphDataTexture);
-                if (i->second.glyphDataTexture) {
-                        Xe_DestroyTexture(g_pVideoDevice, i->second.glyphDataTexture);
-                }
+        for (size_t i = 0; i < this->atlas.size(); i++)
+                Xe_DestroyTexture(g_pVideoDevice, this->atlas[i].texture);
+        this->atlas.clear();
+        this->bmpData.clear();
         this->fontData.clear();
+        this->layouts.clear();
 }
 
 /* Finds next power of two for n. If n itself
@@ -250,61 +243,81 @@ uint16_t FreeTypeGX::adjustTextureHeight(uint16_t textureHeight) {
 /**
  * Caches the given font glyph in the instance font texture buffer.
  *
- * This routine renders and stores the requested glyph's bitmap and relevant information into its own quickly addressible
- * structure within an instance-specific map.
+ * This routine renders the requested glyph's bitmap into an atlas page and stores the relevant information into
+ * the supplied structure.
  *
  * @param charCode	The requested glyph's character code.
- * @return A pointer to the allocated font structure.
+ * @param charData	Structure to fill.
+ * @return false if the font has nothing to render for the character.
  */
-ftgxCharData *FreeTypeGX::cacheGlyphData(wchar_t charCode) {
+bool FreeTypeGX::cacheGlyphData(wchar_t charCode, ftgxCharData *charData) {
         FT_UInt gIndex;
-        uint16_t textureWidth = 0, textureHeight = 0;
 
         gIndex = FT_Get_Char_Index(ftFace, charCode);
-        if (!FT_Load_Glyph(ftFace, gIndex, FT_LOAD_DEFAULT | FT_LOAD_RENDER)) {
-                if (ftSlot->format == FT_GLYPH_FORMAT_BITMAP) {
-                        FT_Bitmap *glyphBitmap = &ftSlot->bitmap;
-
-                        textureWidth = adjustTextureWidth(glyphBitmap->width);
-                        textureHeight = adjustTextureHeight(glyphBitmap->rows);
-
-                        //            textureWidth = (glyphBitmap->width);
-                        //            textureHeight = (glyphBitmap->rows);
-
-                        this->fontData[charCode] = (ftgxCharData){
-                                ftSlot->bitmap_left,
-                                //                ftSlot->advance.x >> 6,
-                                ftSlot->advance.x >> 6,
-                                gIndex,
-                                textureWidth,
-                                textureHeight,
-                                ftSlot->bitmap_top,
-                                ftSlot->bitmap_top,
-                                glyphBitmap->rows - ftSlot->bitmap_top,
-                                NULL,
-                                ftSlot->metrics,
-                                ftSlot->bitmap_top,
-                        };
-                        this->loadGlyphData(glyphBitmap, &this->fontData[charCode]);
-
-                        return &this->fontData[charCode];
-                }
+        if (FT_Load_Glyph(ftFace, gIndex, FT_LOAD_DEFAULT | FT_LOAD_RENDER) || ftSlot->format != FT_GLYPH_FORMAT_BITMAP)
+                return false;
+
+        FT_Bitmap *glyphBitmap = &ftSlot->bitmap;
+
+        charData->renderOffsetX = ftSlot->bitmap_left;
+        charData->glyphAdvanceX = ftSlot->advance.x >> 6;
+        charData->glyphIndex = gIndex;
+        charData->textureWidth = adjustTextureWidth(glyphBitmap->width);
+        charData->textureHeight = adjustTextureHeight(glyphBitmap->rows);
+        charData->renderOffsetY = ftSlot->bitmap_top;
+        charData->renderOffsetMax = ftSlot->bitmap_top;
+        charData->renderOffsetMin = glyphBitmap->rows - ftSlot->bitmap_top;
+        charData->atlasPage = -1;
+        charData->atlasX = 0;
+        charData->atlasY = 0;
+        charData->be = ftSlot->metrics;
+        charData->bitmap_top = ftSlot->bitmap_top;
+
+        this->loadGlyphData(glyphBitmap, charData);
+        return true;
+}
+
+/**
+ * Looks up the glyph data of a character, caching the glyph on first use.
+ *
+ * Characters of the basic multilingual plane are found by direct indexing, this includes remembering that the
+ * font has no glyph for one.
+ *
+ * @param charCode	The requested glyph's character code.
+ * @return A pointer to the glyph data, NULL if the font has no glyph.
+ */
+ftgxCharData *FreeTypeGX::getGlyphData(wchar_t charCode) {
+        enum { GLYPH_UNKNOWN, GLYPH_CACHED, GLYPH_MISSING };
+
+        uint8_t *state = this->bmpData.state(charCode);
+        if (state) {
+                if (*state == GLYPH_UNKNOWN)
+                        *state = this->cacheGlyphData(charCode, this->bmpData.data(charCode)) ? GLYPH_CACHED : GLYPH_MISSING;
+                return *state == GLYPH_CACHED ? this->bmpData.data(charCode) : NULL;
         }
-        return NULL;
+
+        std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.find(charCode);
+        if (i != this->fontData.end())
+                return &i->second;
+
+        ftgxCharData charData;
+        if (!this->cacheGlyphData(charCode, &charData))
+                return NULL;
+        return &(this->fontData[charCode] = charData);
 }
 
 /**
  * Locates each character in this wrapper's configured font face and proccess them.
  *
  * This routine locates each character in the configured font face and renders the glyph's bitmap.
- * Each bitmap and relevant information is loaded into its own quickly addressible structure within an instance-specific map.
+ * Each bitmap and relevant information is loaded into its own quickly addressible structure.
  */
 uint16_t FreeTypeGX::cacheGlyphDataComplete() {
         uint32_t i = 0;
         FT_UInt gIndex;
         FT_ULong charCode = FT_Get_First_Char(ftFace, &gIndex);
         while (gIndex != 0) {
-                if (this->cacheGlyphData(charCode) != NULL)
+                if (this->getGlyphData(charCode) != NULL)
                         ++i;
                 charCode = FT_Get_Next_Char(ftFace, charCode, &gIndex);
         }
@@ -312,101 +325,71 @@ uint16_t FreeTypeGX::cacheGlyphDataComplete() {
 }
 
 /**
- * Loads the rendered bitmap into the relevant structure's data buffer.
+ * Creates an empty atlas page.
  *
- * This routine does a simple byte-wise copy of the glyph's rendered 8-bit grayscale bitmap into the structure's buffer.
- * Each byte is converted from the bitmap's intensity value into the a uint32_t RGBA value.
+ * @return The index of the new page, -1 if the texture could not be created.
+ */
+int16_t FreeTypeGX::addAtlasPage() {
+        ftgxAtlasPage page;
+
+        page.texture = Xe_CreateTexture(g_pVideoDevice, FTGX_ATLAS_SIZE, FTGX_ATLAS_SIZE, 0, XE_FMT_8, 0);
+        if (!page.texture)
+                return -1;
+
+        // point sampling, glyphs are drawn 1:1
+        page.texture->use_filtering = 0;
+        page.texture->u_addressing = XE_TEXADDR_CLAMP;
+        page.texture->v_addressing = XE_TEXADDR_CLAMP;
+
+        uint8_t * surfbuf = (uint8_t*) Xe_Surface_LockRect(g_pVideoDevice, page.texture, 0, 0, 0, 0, XE_LOCK_WRITE);
+        memset(surfbuf, 0, page.texture->hpitch * page.texture->wpitch);
+        Xe_Surface_Unlock(g_pVideoDevice, page.texture);
+
+        page.packer.reset(FTGX_ATLAS_SIZE, FTGX_ATLAS_SIZE);
+        this->atlas.push_back(page);
+        return this->atlas.size() - 1;
+}
+
+/**
+ * Loads the rendered bitmap into a free spot of an atlas page.
+ *
+ * This routine does a simple byte-wise copy of the glyph's rendered 8-bit grayscale bitmap into the page texture.
+ * Glyphs keep one pixel of space to their right and bottom neighbours.
  *
  * @param bmp	A pointer to the most recently rendered glyph's bitmap.
  * @param charData	A pointer to an allocated ftgxCharData structure whose data represent that of the last rendered glyph.
- *
- * Optimized for RGBA8 use by Dimok.
  */
 void FreeTypeGX::loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData) {
-        int w, h, length;
+        uint16_t x, y;
+        int16_t page;
+        int row;
 
         if ((charData->textureWidth == 0) || (charData->textureHeight == 0))
                 return;
-
-        if (!glyphData)
+        if (charData->textureWidth >= FTGX_ATLAS_SIZE || charData->textureHeight >= FTGX_ATLAS_SIZE)
                 return;
 
-        //    w = (charData->textureWidth < 32) ? 32 : charData->textureWidth;
-        //    h = (charData->textureHeight < 32) ? 32 : charData->textureHeight;
+        for (page = 0; page < (int16_t) this->atlas.size(); page++)
+                if (this->atlas[page].packer.insert(charData->textureWidth + 1, charData->textureHeight + 1, &x, &y))
+                        break;
 
-        w = charData->textureWidth;
-        h = charData->textureHeight;
-
-        length = w * h * 4;
-
-        if (charData->glyphDataTexture) {
-                Xe_DestroyTexture(g_pVideoDevice, charData->glyphDataTexture);
+        if (page == (int16_t) this->atlas.size()) {
+                page = this->addAtlasPage();
+                if (page < 0 || !this->atlas[page].packer.insert(charData->textureWidth + 1, charData->textureHeight + 1, &x, &y))
+                        return;
         }
 
-        charData->glyphDataTexture = Xe_CreateTexture(g_pVideoDevice, (w + 31) &~31, (h + 31) &~31, 0, XE_FMT_8, 0);
-        charData->glyphDataTexture->use_filtering = 1;
-        charData->glyphDataTexture->u_addressing = XE_TEXADDR_CLAMP;
-        charData->glyphDataTexture->v_addressing = XE_TEXADDR_CLAMP;
-
-        memset(glyphData, 0x00, length);
-
-        uint8_t *src = (uint8_t *) bmp->buffer;
-
-        uint8_t * surfbuf = (uint8_t*) Xe_Surface_LockRect(g_pVideoDevice, charData->glyphDataTexture, 0, 0, 0, 0, XE_LOCK_WRITE);
-        memset(surfbuf, 0, charData->glyphDataTexture->hpitch * charData->glyphDataTexture->wpitch);
-
-        //    uint32_t * surfbuf = (uint32_t *)glyphData;
-        //    uint32_t * dst = (uint32_t *) surfbuf;
-
-        uint8_t * dst = (uint8_t *) surfbuf;
+        XenosSurface * surf = this->atlas[page].texture;
 
-        uint8_t * dst_limit = (uint8_t *) surfbuf + ((charData->glyphDataTexture->hpitch) * (charData->glyphDataTexture->wpitch));
-        int hpitch = 0;
-        int wpitch = 0;
-        //int y_offset = (h-(charData->textureHeight-charData->renderOffsetY));
-        //    int y_offset = 0;
+        // only untouched texels get written, quads already queued from this page stay valid
+        uint8_t * surfbuf = (uint8_t*) Xe_Surface_LockRect(g_pVideoDevice, surf, 0, 0, 0, 0, XE_LOCK_WRITE);
+        for (row = 0; row < (int) bmp->rows; row++)
+                memcpy(surfbuf + (y + row) * surf->wpitch + x, bmp->buffer + row * bmp->pitch, bmp->width);
+        Xe_Surface_Unlock(g_pVideoDevice, surf);
 
-
-        //    for (hpitch = 0; hpitch < charData->glyphDataTexture->hpitch; hpitch += charData->glyphDataTexture->height) {
-        //        //        for (int y = 0; y < bmp->rows; y++)
-        //        int y = 0;
-        //        int y_offset = 0;
-        //        int dsty = 0;
-        //        for (y = 0, dsty = y_offset; y < (bmp->rows); y++, dsty++) {
-        //            for (wpitch = 0; wpitch < charData->glyphDataTexture->wpitch; wpitch += charData->glyphDataTexture->width) {
-        //                src = (uint8_t *) bmp->buffer + ((y) * bmp->pitch);
-        //                dst = (uint8_t *) surfbuf + ((dsty + hpitch) * (charData->glyphDataTexture->wpitch)) + wpitch;
-        //                for (int x = 0; x < bmp->width; x++) {
-        //                    if (dst < dst_limit)
-        //                        *dst++ = *src++;
-        //                }
-        //            }
-        //        }
-        //    }
-
-        for (hpitch = 0; hpitch < charData->glyphDataTexture->hpitch; hpitch += charData->glyphDataTexture->height) {
-                //        for (int y = 0; y < bmp->rows; y++)
-                int y, dsty = 0;
-                //        int y_offset = charData->glyphDataTexture->height;
-                int y_offset = 0;
-
-                for (y = 0, dsty = y_offset; y < (bmp->rows); y++, dsty++) {
-                        //        for (y = 0, dsty = y_offset; y < (bmp->rows); y++, dsty--) {
-                        for (wpitch = 0; wpitch < charData->glyphDataTexture->wpitch; wpitch += charData->glyphDataTexture->width) {
-                                src = (uint8_t *) bmp->buffer + ((y) * bmp->pitch);
-                                dst = (uint8_t *) surfbuf + ((dsty + hpitch) * (charData->glyphDataTexture->wpitch)) + wpitch;
-                                for (int x = 0; x < bmp->width; x++) {
-                                        if (dst < dst_limit)
-                                                *dst++ = *src++;
-                                }
-                        }
-                }
-        }
-
-        // remove filtering
-        charData->glyphDataTexture->use_filtering = 0;
-        
-        Xe_Surface_Unlock(g_pVideoDevice, charData->glyphDataTexture);
+        charData->atlasPage = page;
+        charData->atlasX = x;
+        charData->atlasY = y;
 }
 
 /**
@@ -462,6 +445,110 @@ int16_t FreeTypeGX::getStyleOffsetHeight(ftgxDataOffset *offset, uint16_t format
         return 0;
 }
 
+/**
+ * Lays out the supplied string, or finds it in the layout cache.
+ *
+ * Width, offsets and glyph quads (relative to the string origin) only depend on the string and the font size of
+ * this instance, so they are worked out once. Justification and alignment are applied when drawing. The cache
+ * is dropped as a whole once it holds FTGX_LAYOUT_CACHE strings, scrolling text creates a lot of them.
+ *
+ * @param text	NULL terminated string to lay out.
+ * @return The layout of the string, valid until the next call.
+ */
+const ftgxTextLayout *FreeTypeGX::getLayout(const wchar_t *text) {
+        uint32_t hash = 2166136261u; // fnv-1a
+        size_t len;
+
+        for (len = 0; text[len]; len++)
+                hash = (hash ^ (uint32_t) text[len]) * 16777619u;
+
+        std::map<uint32_t, ftgxTextLayout>::iterator it = this->layouts.find(hash);
+        if (it != this->layouts.end()) {
+                if (it->second.text.compare(0, std::wstring::npos, text, len) == 0)
+                        return &it->second;
+                // collision, the slot gets the new string
+        } else {
+                if (this->layouts.size() >= FTGX_LAYOUT_CACHE)
+                        this->layouts.clear();
+                it = this->layouts.insert(std::make_pair(hash, ftgxTextLayout())).first;
+        }
+
+        ftgxTextLayout &layout = it->second;
+        std::vector<TexQuad> quads;
+        std::vector<int16_t> pages;
+        FT_Vector pairDelta;
+        FT_UInt prevIndex = 0;
+        int16_t strMax = 0, strMin = 9999;
+        int x_pos = 0;
+
+        layout.text.assign(text, len);
+        layout.printed = 0;
+
+        for (size_t i = 0; i < len; i++) {
+                ftgxCharData* glyphData = this->getGlyphData(text[i]);
+
+                if (glyphData == NULL) {
+                        prevIndex = 0;
+                        continue;
+                }
+
+                if (this->ftKerningEnabled && i > 0) {
+                        FT_Get_Kerning(ftFace, prevIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
+                        x_pos += pairDelta.x >> 6;
+                }
+
+                if (glyphData->atlasPage >= 0) {
+                        TexQuad q;
+
+                        q.x = x_pos + glyphData->renderOffsetX;
+                        q.y = -(glyphData->be.horiBearingY >> 6);
+                        q.width = glyphData->textureWidth;
+                        q.height = glyphData->textureHeight;
+                        q.u0 = (f32) glyphData->atlasX / FTGX_ATLAS_SIZE;
+                        q.v0 = (f32) glyphData->atlasY / FTGX_ATLAS_SIZE;
+                        q.u1 = (f32) (glyphData->atlasX + glyphData->textureWidth) / FTGX_ATLAS_SIZE;
+                        q.v1 = (f32) (glyphData->atlasY + glyphData->textureHeight) / FTGX_ATLAS_SIZE;
+
+                        quads.push_back(q);
+                        pages.push_back(glyphData->atlasPage);
+                }
+
+                x_pos += glyphData->glyphAdvanceX;
+
+                strMax = glyphData->renderOffsetMax > strMax ? glyphData->renderOffsetMax : strMax;
+                strMin = glyphData->renderOffsetMin < strMin ? glyphData->renderOffsetMin : strMin;
+
+                prevIndex = glyphData->glyphIndex;
+                ++layout.printed;
+        }
+
+        layout.width = x_pos;
+
+        layout.offset.ascender = ftFace->size->metrics.ascender >> 6;
+        layout.offset.descender = ftFace->size->metrics.descender >> 6;
+        layout.offset.max = strMax;
+        layout.offset.min = strMin;
+
+        // group the quads by page, a string rarely spans more than one
+        layout.quads.clear();
+        layout.runs.clear();
+        for (int16_t page = 0; page < (int16_t) this->atlas.size(); page++) {
+                uint16_t count = 0;
+
+                for (size_t i = 0; i < quads.size(); i++) {
+                        if (pages[i] == page) {
+                                layout.quads.push_back(quads[i]);
+                                ++count;
+                        }
+                }
+
+                if (count)
+                        layout.runs.push_back(std::make_pair(page, count));
+        }
+
+        return &layout;
+}
+
 /**
  * Processes the supplied text string and prints the results at the specified coordinates.
  *
@@ -476,60 +563,42 @@ int16_t FreeTypeGX::getStyleOffsetHeight(ftgxDataOffset *offset, uint16_t format
  * @return The number of characters printed.
  */
 uint16_t FreeTypeGX::drawText(int16_t x, int16_t y, wchar_t *text, GXColor color, uint16_t textStyle) {
-        //printf("Disabled !!\r\n");
-        //return 0;
-        uint16_t x_pos = x, printed = 0;
-        uint16_t x_offset = 0, y_offset = 0;
-
-        //GXTexObj glyphTexture;
-        FT_Vector pairDelta;
+        static std::vector<TexQuad> batch;
+        int16_t x_offset = 0, y_offset = 0;
         ftgxDataOffset offset;
+        size_t first = 0;
+
+        const ftgxTextLayout *layout = this->getLayout(text);
+        offset = layout->offset;
 
         if (textStyle & FTGX_JUSTIFY_MASK) {
-                x_offset = this->getStyleOffsetWidth(this->getWidth(text), textStyle);
+                x_offset = this->getStyleOffsetWidth(layout->width, textStyle);
         }
+
         if (textStyle & FTGX_ALIGN_MASK) {
-                this->getOffset(text, &offset);
                 y_offset = this->getStyleOffsetHeight(&offset, textStyle);
         }
 
-        int i = 0;
-        while (text[i]) {
-                ftgxCharData* glyphData = NULL;
-                if (this->fontData.find(text[i]) != this->fontData.end()) {
-                        glyphData = &this->fontData[text[i]];
-                } else {
-                        glyphData = this->cacheGlyphData(text[i]);
-                }
-
-                if (glyphData != NULL) {
-                        if (this->ftKerningEnabled && i) {
-                                FT_Get_Kerning(ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
-                                x_pos += pairDelta.x >> 6;
-                        }
-
-                        //GX_InitTexObj(&glyphTexture, glyphData->glyphDataTexture, glyphData->textureWidth, glyphData->textureHeight, GX_TF_RGBA8, GX_CLAMP, GX_CLAMP, GX_FALSE);
+        // one draw per atlas page
+        for (size_t r = 0; r < layout->runs.size(); r++) {
+                uint16_t count = layout->runs[r].second;
 
-                        //this->copyTextureToFramebuffer(&glyphTexture, glyphData->textureWidth, glyphData->textureHeight, x_pos + glyphData->renderOffsetX + x_offset, y - glyphData->renderOffsetY + y_offset, color);
-                        if (glyphData->glyphDataTexture) {
-                                int RenderOffsetY = glyphData->be.horiBearingY >> 6;
-                                int RenderOffsetX = glyphData->renderOffsetX; // - dx;
-
-                                Menu_T(glyphData->glyphDataTexture, glyphData->glyphDataTexture->width, glyphData->glyphDataTexture->height, x_pos + RenderOffsetX + x_offset, y - RenderOffsetY + y_offset, color);
-
-                        }
-                        x_pos += (glyphData->glyphAdvanceX);
-                        ++printed;
+                batch.resize(count);
+                for (uint16_t i = 0; i < count; i++) {
+                        batch[i] = layout->quads[first + i];
+                        batch[i].x += x + x_offset;
+                        batch[i].y += y + y_offset;
                 }
-                ++i;
+
+                Menu_TBatch(this->atlas[layout->runs[r].first].texture, &batch[0], count, color);
+                first += count;
         }
 
         if (textStyle & FTGX_STYLE_MASK) {
-                this->getOffset(text, &offset);
-                this->drawTextFeature(x + x_offset, y + y_offset, this->getWidth(text), &offset, textStyle, color);
+                this->drawTextFeature(x + x_offset, y + y_offset, layout->width, &offset, textStyle, color);
         }
 
-        return printed;
+        return layout->printed;
 }
 
 /**
@@ -559,31 +628,7 @@ void FreeTypeGX::drawTextFeature(int16_t x, int16_t y, uint16_t width, ftgxDataO
  * @return The width of the text string in pixels.
  */
 uint16_t FreeTypeGX::getWidth(wchar_t *text) {
-        uint16_t strWidth = 0;
-        FT_Vector pairDelta;
-
-        int i = 0;
-        while (text[i]) {
-                ftgxCharData* glyphData = NULL;
-                if (this->fontData.find(text[i]) != this->fontData.end()) {
-                        glyphData = &this->fontData[text[i]];
-                } else {
-                        glyphData = this->cacheGlyphData(text[i]);
-                }
-
-                if (glyphData != NULL) {
-                        if (this->ftKerningEnabled && (i > 0)) {
-                                FT_Get_Kerning(ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
-                                //                strWidth += pairDelta.x >> 6;
-                                strWidth += pairDelta.x >> 6;
-                        }
-
-                        strWidth += glyphData->glyphAdvanceX;
-                        //            strWidth += (glyphData->glyphAdvanceX)*2;
-                }
-                ++i;
-        }
-        return strWidth;
+        return this->getLayout(text)->width;
 }
 
 /**
@@ -628,27 +673,7 @@ uint16_t FreeTypeGX::getHeight(wchar_t const *text) {
  *
  */
 void FreeTypeGX::getOffset(wchar_t *text, ftgxDataOffset* offset) {
-        int16_t strMax = 0, strMin = 9999;
-
-        int i = 0;
-        while (text[i]) {
-                ftgxCharData* glyphData = NULL;
-                if (this->fontData.find(text[i]) != this->fontData.end()) {
-                        glyphData = &this->fontData[text[i]];
-                } else {
-                        glyphData = this->cacheGlyphData(text[i]);
-                }
-
-                if (glyphData != NULL) {
-                        strMax = glyphData->renderOffsetMax > strMax ? glyphData->renderOffsetMax : strMax;
-                        strMin = glyphData->renderOffsetMin < strMin ? glyphData->renderOffsetMin : strMin;
-                }
-                ++i;
-        }
-        offset->ascender = ftFace->size->metrics.ascender >> 6;
-        offset->descender = ftFace->size->metrics.descender >> 6;
-        offset->max = strMax;
-        offset->min = strMin;
+        *offset = this->getLayout(text)->offset;
 }
 
 /**
@@ -656,7 +681,7 @@ void FreeTypeGX::getOffset(wchar_t *text, ftgxDataOffset* offset) {
  * \overload
  */
 void FreeTypeGX::getOffset(wchar_t const *text, ftgxDataOffset* offset) {
-        this->getOffset(text, offset);
+        this->getOffset((wchar_t *)text, offset);
 }
 
 /**
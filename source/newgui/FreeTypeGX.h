@@ -32,9 +32,15 @@
 #include <string.h>
 #include <wchar.h>
 #include <map>
+#include <string>
+#include <vector>
+#include "GlyphAtlas.h"
 
 #define MAX_FONT_SIZE 100
 
+#define FTGX_ATLAS_SIZE 512 /**< Width and height of a glyph atlas page. */
+#define FTGX_LAYOUT_CACHE 512 /**< Strings whose layout is kept per font size. */
+
 /*! \struct ftgxCharData_
  *
  * Font face character glyph relevant data structure.
@@ -51,9 +57,10 @@ typedef struct ftgxCharData_ {
     int16_t renderOffsetMax; /**< Texture Y axis bearing maximum value. */
     int16_t renderOffsetMin; /**< Texture Y axis bearing minimum value. */
 
-    //uint32_t* glyphDataTexture; /**< Glyph texture bitmap data buffer. */
-    XenosSurface * glyphDataTexture;
-    
+    int16_t atlasPage; /**< Atlas page holding the glyph bitmap, -1 if there is nothing to draw. */
+    uint16_t atlasX; /**< Glyph bitmap X position in the atlas page. */
+    uint16_t atlasY; /**< Glyph bitmap Y position in the atlas page. */
+
     FT_Glyph_Metrics be;
     uint16_t bitmap_top;
 } ftgxCharData;
@@ -69,6 +76,28 @@ typedef struct ftgxDataOffset_ {
     int16_t min; /**< Minimum data offset. */
 } ftgxDataOffset;
 
+/*! \struct ftgxAtlasPage_
+ *
+ * Texture shared by many glyphs and what is still free in it.
+ */
+typedef struct ftgxAtlasPage_ {
+    XenosSurface * texture; /**< 8 bit glyph coverage. */
+    SkylinePacker packer;
+} ftgxAtlasPage;
+
+/*! \struct ftgxTextLayout_
+ *
+ * Measurements and glyph quads of a string, relative to the string origin.
+ */
+typedef struct ftgxTextLayout_ {
+    std::wstring text; /**< The string, the cache is keyed by its hash. */
+    uint16_t width; /**< getWidth result. */
+    uint16_t printed; /**< Characters with a glyph. */
+    ftgxDataOffset offset; /**< getOffset result. */
+    std::vector<TexQuad> quads; /**< Glyph quads, grouped by atlas page. */
+    std::vector<std::pair<int16_t, uint16_t> > runs; /**< Atlas page and quad count of each group. */
+} ftgxTextLayout;
+
 typedef struct ftgxCharData_ ftgxCharData;
 typedef struct ftgxDataOffset_ ftgxDataOffset;
 
@@ -132,7 +161,10 @@ private:
     bool ftKerningEnabled; /**< Flag indicating the availability of font kerning data. */
     uint8_t vertexIndex; /**< Vertex format descriptor index. */
     uint32_t compatibilityMode; /**< Compatibility mode for default tev operations and vertex descriptors. */
-    std::map<wchar_t, ftgxCharData> fontData; /**< Map which holds the glyph data structures for the corresponding characters. */
+    BmpTable<ftgxCharData> bmpData; /**< Glyph data of the basic multilingual plane, direct mapped. */
+    std::map<wchar_t, ftgxCharData> fontData; /**< Map which holds the glyph data structures for the characters outside of it. */
+    std::vector<ftgxAtlasPage> atlas; /**< Atlas pages holding the glyph bitmaps. */
+    std::map<uint32_t, ftgxTextLayout> layouts; /**< Layout cache, keyed by string hash. */
 
     static uint16_t adjustTextureWidth(uint16_t textureWidth);
     static uint16_t adjustTextureHeight(uint16_t textureHeight);
@@ -141,9 +173,12 @@ private:
     static int16_t getStyleOffsetHeight(ftgxDataOffset *offset, uint16_t format);
 
     void unloadFont();
-    ftgxCharData *cacheGlyphData(wchar_t charCode);
+    ftgxCharData *getGlyphData(wchar_t charCode);
+    bool cacheGlyphData(wchar_t charCode, ftgxCharData *charData);
     uint16_t cacheGlyphDataComplete();
     void loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData);
+    int16_t addAtlasPage();
+    const ftgxTextLayout *getLayout(const wchar_t *text);
 
     void setDefaultMode();
 
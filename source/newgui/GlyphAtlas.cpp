@@ -0,0 +1,116 @@
+/****************************************************************************
+ * Glyph atlas helpers for FreeTypeGX
+ *
+ * GlyphAtlas.cpp
+ * Skyline packer for the atlas pages
+ ***************************************************************************/
+
+#include "GlyphAtlas.h"
+
+SkylinePacker::SkylinePacker(uint16_t width, uint16_t height) {
+        this->reset(width, height);
+}
+
+void SkylinePacker::reset(uint16_t width, uint16_t height) {
+        Node n = {0, 0, width};
+
+        this->width = width;
+        this->height = height;
+        this->skyline.clear();
+        this->skyline.push_back(n);
+}
+
+/**
+ * Lowest y a w*h rectangle can sit at when its left edge is on skyline node index, -1 if it doesn't fit.
+ */
+int SkylinePacker::fit(size_t index, uint16_t w, uint16_t h) {
+        int x = this->skyline[index].x;
+        int left = w;
+        int y = 0;
+
+        if (x + w > this->width)
+                return -1;
+
+        for (size_t i = index; left > 0; i++) {
+                if (i == this->skyline.size())
+                        return -1;
+                if (this->skyline[i].y > y)
+                        y = this->skyline[i].y;
+                if (y + h > this->height)
+                        return -1;
+                left -= this->skyline[i].width;
+        }
+
+        return y;
+}
+
+void SkylinePacker::merge() {
+        for (size_t i = 0; i + 1 < this->skyline.size();) {
+                if (this->skyline[i].y == this->skyline[i + 1].y) {
+                        this->skyline[i].width += this->skyline[i + 1].width;
+                        this->skyline.erase(this->skyline.begin() + i + 1);
+                } else {
+                        i++;
+                }
+        }
+}
+
+/**
+ * Places a w*h rectangle.
+ *
+ * @param x	Left edge of the placed rectangle.
+ * @param y	Top edge of the placed rectangle.
+ * @return false if the page has no room left for it.
+ */
+bool SkylinePacker::insert(uint16_t w, uint16_t h, uint16_t *x, uint16_t *y) {
+        int bestTop = this->height + 1, bestWidth = this->width + 1;
+        size_t best = this->skyline.size();
+        size_t i;
+
+        if (w == 0 || h == 0)
+                return false;
+
+        for (i = 0; i < this->skyline.size(); i++) {
+                int top = this->fit(i, w, h);
+
+                if (top < 0)
+                        continue;
+
+                top += h;
+                if (top < bestTop || (top == bestTop && this->skyline[i].width < bestWidth)) {
+                        best = i;
+                        bestTop = top;
+                        bestWidth = this->skyline[i].width;
+                }
+        }
+
+        if (best == this->skyline.size())
+                return false;
+
+        Node n = {this->skyline[best].x, (uint16_t) bestTop, w};
+        *x = n.x;
+        *y = bestTop - h;
+
+        this->skyline.insert(this->skyline.begin() + best, n);
+
+        // cut away what the new node covers
+        for (i = best + 1; i < this->skyline.size();) {
+                Node &c = this->skyline[i];
+                int end = n.x + n.width;
+
+                if (c.x >= end)
+                        break;
+
+                if (c.x + c.width <= end) {
+                        this->skyline.erase(this->skyline.begin() + i);
+                        continue;
+                }
+
+                c.width -= end - c.x;
+                c.x = end;
+                break;
+        }
+
+        this->merge();
+        return true;
+}
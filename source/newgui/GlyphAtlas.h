@@ -0,0 +1,94 @@
+/****************************************************************************
+ * Glyph atlas helpers for FreeTypeGX
+ *
+ * GlyphAtlas.h
+ * Renderer independent parts: atlas page packing and the BMP glyph table
+ ***************************************************************************/
+
+#ifndef GLYPHATLAS_H_
+#define GLYPHATLAS_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <vector>
+
+/*! \class SkylinePacker
+ * \brief Bottom-left skyline rectangle packer for one atlas page.
+ *
+ * The skyline is the list of top edges of everything placed so far. A new
+ * rectangle goes where its top ends up lowest; rectangles are never freed.
+ */
+class SkylinePacker {
+private:
+    struct Node {
+        uint16_t x, y, width;
+    };
+
+    uint16_t width, height;
+    std::vector<Node> skyline;
+
+    int fit(size_t index, uint16_t w, uint16_t h);
+    void merge();
+
+public:
+    SkylinePacker(uint16_t width = 0, uint16_t height = 0);
+
+    void reset(uint16_t width, uint16_t height);
+    bool insert(uint16_t w, uint16_t h, uint16_t *x, uint16_t *y);
+};
+
+/*! \class BmpTable
+ * \brief Direct mapped table for the basic multilingual plane.
+ *
+ * Entries live in blocks of 256 characters which are only allocated once a
+ * character of the block is asked for, so latin text costs a single block.
+ */
+template <class T>
+class BmpTable {
+private:
+    struct Block {
+        uint8_t state[256];
+        T data[256];
+    };
+
+    Block *blocks[256];
+
+public:
+    BmpTable() {
+        for (int i = 0; i < 256; i++)
+            blocks[i] = NULL;
+    }
+
+    ~BmpTable() {
+        clear();
+    }
+
+    static bool covers(wchar_t c) {
+        return (uint32_t) c < 0x10000;
+    }
+
+    /* state of c, 0 until set; NULL when c is outside the BMP or out of memory */
+    uint8_t *state(wchar_t c) {
+        Block *&b = blocks[((uint32_t) c >> 8) & 0xff];
+
+        if (!covers(c))
+            return NULL;
+        if (!b)
+            b = (Block *) calloc(1, sizeof (Block));
+        return b ? &b->state[c & 0xff] : NULL;
+    }
+
+    T *data(wchar_t c) {
+        return &blocks[((uint32_t) c >> 8) & 0xff]->data[c & 0xff];
+    }
+
+    void clear() {
+        for (int i = 0; i < 256; i++) {
+            free(blocks[i]);
+            blocks[i] = NULL;
+        }
+    }
+};
+
+#endif /* GLYPHATLAS_H_ */
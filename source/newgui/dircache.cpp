@@ -0,0 +1,410 @@
+/****************************************************************************
+ * PCSXR Xenon
+ *
+ * dircache.cpp
+ *
+ * Per directory listing cache and disc image info
+ *
+ * The cache of a directory holds its sorted listing, without "..", and the
+ * info read from the disc images in it. The browsed devices are left alone:
+ * all caches live in DIRCACHE_DIR of the emulator's own directory, named
+ * after a hash of the directory path, and start with the path itself in
+ * case two hash the same. Each is stamped with the directory mtime.
+ ***************************************************************************/
+
+#include <xetypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+#include "dircache.h"
+
+#define DIRCACHE_MAGIC 0x50444332 // PDC2
+
+extern "C" const char *PcsxrDir;
+
+// followed by pathlen bytes of directory path
+typedef struct {
+        u32 magic;
+        u32 count;
+        u64 dirtime;
+        u32 pathlen;
+} DirCacheHeader;
+
+// followed by namelen bytes of file name
+typedef struct {
+        u64 mtime;
+        u32 length;
+        u8 isdir;
+        s8 region;
+        u8 tracks;
+        u8 namelen;
+        char gameid[16];
+} DirCacheRecord;
+
+/**
+ * The cache file of dir, FNV-1a of the path. Returns false when there is no
+ * place for caches, they are simply not used then.
+ */
+static bool CachePath(char *path, const char *dir) {
+        u64 hash = 0xcbf29ce484222325ULL;
+
+        if (PcsxrDir == NULL || PcsxrDir[0] == 0)
+                return false;
+
+        for (const char *p = dir; *p; p++)
+                hash = (hash ^ (u8) *p) * 0x100000001b3ULL;
+
+        snprintf(path, MAXPATHLEN, "%s%s%016llx", PcsxrDir, DIRCACHE_DIR, (unsigned long long) hash);
+        return true;
+}
+
+/****************************************************************************
+ * DirCacheLoad
+ *
+ * Reads the cached listing of dir, sorted. dirtime is the directory mtime
+ * the listing is valid for.
+ ***************************************************************************/
+bool DirCacheLoad(const char *dir, std::vector<BROWSERENTRY> &list, time_t *dirtime) {
+        char path[MAXPATHLEN + 1];
+        DirCacheHeader hdr;
+        DirCacheRecord rec;
+        BROWSERENTRY entry;
+        bool ok = true;
+
+        list.clear();
+        if (!CachePath(path, dir))
+                return false;
+
+        FILE *f = fopen(path, "rb");
+        if (!f)
+                return false;
+
+        if (fread(&hdr, 1, sizeof (hdr), f) != sizeof (hdr) || hdr.magic != DIRCACHE_MAGIC
+                || hdr.count >= MAX_BROWSER_SIZE || hdr.pathlen != strlen(dir)
+                || fread(path, 1, hdr.pathlen, f) != hdr.pathlen || memcmp(path, dir, hdr.pathlen) != 0) {
+                fclose(f);
+                return false;
+        }
+
+        list.reserve(hdr.count);
+        for (u32 i = 0; i < hdr.count; i++) {
+                memset(&entry, 0, sizeof (entry));
+
+                if (fread(&rec, 1, sizeof (rec), f) != sizeof (rec)
+                        || fread(entry.filename, 1, rec.namelen, f) != rec.namelen) {
+                        ok = false;
+                        break;
+                }
+
+                strcpy(entry.displayname, entry.filename);
+                entry.isdir = rec.isdir;
+                entry.icon = rec.isdir ? ICON_FOLDER : ICON_NONE;
+                entry.length = rec.length;
+                entry.mtime = rec.mtime;
+                entry.region = rec.region;
+                entry.tracks = rec.tracks;
+                memcpy(entry.gameid, rec.gameid, sizeof (entry.gameid));
+                entry.gameid[sizeof (entry.gameid) - 1] = 0;
+
+                list.push_back(entry);
+        }
+
+        fclose(f);
+
+        if (!ok) {
+                list.clear();
+                return false;
+        }
+
+        *dirtime = hdr.dirtime;
+        return true;
+}
+
+/****************************************************************************
+ * DirCacheSave
+ *
+ * Writes the sorted listing of dir. Fails quietly when the emulator's
+ * directory is read only or missing.
+ ***************************************************************************/
+bool DirCacheSave(const char *dir, const std::vector<BROWSERENTRY> &list) {
+        char path[MAXPATHLEN + 1];
+        struct stat st;
+        DirCacheHeader hdr;
+        DirCacheRecord rec;
+        bool ok = true;
+
+        if (stat(dir, &st) < 0)
+                return false;
+
+        if (!CachePath(path, dir))
+                return false;
+
+        FILE *f = fopen(path, "wb");
+        if (!f) {
+                char cachedir[MAXPATHLEN + 1];
+
+                // first cache written
+                snprintf(cachedir, MAXPATHLEN, "%s%s", PcsxrDir, DIRCACHE_DIR);
+                mkdir(cachedir, 0777);
+
+                f = fopen(path, "wb");
+                if (!f)
+                        return false;
+        }
+
+        memset(&hdr, 0, sizeof (hdr));
+        hdr.magic = DIRCACHE_MAGIC;
+        hdr.count = list.size();
+        hdr.dirtime = st.st_mtime;
+        hdr.pathlen = strlen(dir);
+        ok = fwrite(&hdr, 1, sizeof (hdr), f) == sizeof (hdr)
+                && fwrite(dir, 1, hdr.pathlen, f) == hdr.pathlen;
+
+        for (size_t i = 0; ok && i < list.size(); i++) {
+                const BROWSERENTRY &entry = list[i];
+
+                memset(&rec, 0, sizeof (rec));
+                rec.mtime = entry.mtime;
+                rec.length = entry.length;
+                rec.isdir = entry.isdir;
+                rec.region = entry.region;
+                rec.tracks = entry.tracks;
+                rec.namelen = strlen(entry.filename);
+                memcpy(rec.gameid, entry.gameid, sizeof (rec.gameid));
+
+                ok = fwrite(&rec, 1, sizeof (rec), f) == sizeof (rec)
+                        && fwrite(entry.filename, 1, rec.namelen, f) == rec.namelen;
+        }
+
+        fclose(f);
+
+        if (!ok)
+                remove(path);
+        return ok;
+}
+
+bool IsDiscImage(const char *filename) {
+        const char *ext = strrchr(filename, '.');
+
+        if (ext == NULL)
+                return false;
+
+        return strcasecmp(ext, ".iso") == 0 ||
+                strcasecmp(ext, ".bin") == 0 ||
+                strcasecmp(ext, ".nrg") == 0 ||
+                strcasecmp(ext, ".ccd") == 0 ||
+                strcasecmp(ext, ".cue") == 0;
+}
+
+/****************************************************************************
+ * StatDiscImage
+ *
+ * Fills in length and mtime, enough to tell whether cached info is stale.
+ ***************************************************************************/
+bool StatDiscImage(const char *dir, BROWSERENTRY *entry) {
+        char path[MAXPATHLEN + 1];
+        struct stat st;
+
+        snprintf(path, MAXPATHLEN, "%s%s", dir, entry->filename);
+
+        if (stat(path, &st) < 0)
+                return false;
+
+        entry->length = st.st_size;
+        entry->mtime = st.st_mtime;
+        return true;
+}
+
+/**
+ * Counts the tracks of a cue sheet and returns the file name of its first
+ * image, the directories in it are dropped, the image has to be next to it.
+ */
+static bool ReadCue(const char *path, char *image, int *tracks) {
+        char line[512];
+
+        FILE *f = fopen(path, "r");
+        if (!f)
+                return false;
+
+        image[0] = 0;
+        *tracks = 0;
+
+        while (fgets(line, sizeof (line), f)) {
+                char *p = line;
+
+                while (*p == ' ' || *p == '\t')
+                        p++;
+
+                if (strncasecmp(p, "TRACK", 5) == 0) {
+                        (*tracks)++;
+                } else if (image[0] == 0 && strncasecmp(p, "FILE", 4) == 0) {
+                        char *name = p + 4, *end;
+
+                        while (*name == ' ' || *name == '\t')
+                                name++;
+
+                        if (*name == '"')
+                                end = strchr(++name, '"');
+                        else
+                                end = strpbrk(name, " \t\r\n");
+
+                        if (end)
+                                *end = 0;
+
+                        for (char *s = name; *s; s++) {
+                                if (*s == '/' || *s == '\\')
+                                        name = s + 1;
+                        }
+
+                        snprintf(image, MAXJOLIET + 1, "%s", name);
+                }
+        }
+
+        fclose(f);
+        return image[0] != 0;
+}
+
+static u32 ReadLE32(const u8 *p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32) p[3] << 24);
+}
+
+/**
+ * Reads the 2048 bytes of user data of sector lba. raw is the offset of the
+ * user data in a 2352 byte sector, 0 for a 2048 byte sector image.
+ */
+static bool ReadIsoSector(FILE *f, int raw, u32 lba, u8 *buf) {
+        off_t pos = raw ? (off_t) lba * 2352 + raw : (off_t) lba * 2048;
+
+        if (fseeko(f, pos, SEEK_SET) != 0)
+                return false;
+
+        return fread(buf, 1, 2048, f) == 2048;
+}
+
+// BOOT = cdrom:\SLUS_007.07;1
+static void ParseBoot(char *cnf, char *gameid) {
+        for (char *line = strtok(cnf, "\r\n"); line; line = strtok(NULL, "\r\n")) {
+                char *name;
+                int n;
+
+                while (*line == ' ' || *line == '\t')
+                        line++;
+
+                if (strncasecmp(line, "BOOT", 4) != 0 || (name = strchr(line, '=')) == NULL)
+                        continue;
+
+                name++;
+                for (char *s = name; *s && *s != ';'; s++) {
+                        if (*s == ':' || *s == '\\' || *s == '/')
+                                name = s + 1;
+                }
+
+                while (*name == ' ' || *name == '\t')
+                        name++;
+
+                for (n = 0; n < 15 && name[n] && name[n] != ';' && name[n] != ' ' && name[n] != '\t'; n++)
+                        gameid[n] = name[n];
+                gameid[n] = 0;
+                return;
+        }
+}
+
+// finds SYSTEM.CNF in the root directory of the ISO9660 file system
+static bool ReadSystemCnf(FILE *f, char *gameid) {
+        static const u8 sync[12] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+        u8 buf[2048 + 1];
+        u32 root, size, cnf = 0;
+        int raw = 0;
+
+        // raw sectors start with the sync pattern, the mode tells where the user data is
+        if (fread(buf, 1, 16, f) == 16 && memcmp(buf, sync, sizeof (sync)) == 0)
+                raw = buf[15] == 2 ? 24 : 16;
+
+        // primary volume descriptor
+        if (!ReadIsoSector(f, raw, 16, buf) || buf[0] != 1 || memcmp(buf + 1, "CD001", 5) != 0)
+                return false;
+
+        root = ReadLE32(buf + 156 + 2);
+        size = ReadLE32(buf + 156 + 10);
+
+        for (u32 s = 0; s < (size + 2047) / 2048 && s < 4 && cnf == 0; s++) {
+                if (!ReadIsoSector(f, raw, root + s, buf))
+                        return false;
+
+                for (int pos = 0; pos + 33 <= 2048 && buf[pos] != 0; pos += buf[pos]) {
+                        const u8 *rec = buf + pos;
+                        int n = rec[32];
+
+                        if (pos + 33 + n > 2048)
+                                break;
+
+                        if (n >= 10 && strncasecmp((const char *) rec + 33, "SYSTEM.CNF", 10) == 0
+                                && (n == 10 || rec[33 + 10] == ';')) {
+                                cnf = ReadLE32(rec + 2);
+                                break;
+                        }
+                }
+        }
+
+        if (cnf == 0 || !ReadIsoSector(f, raw, cnf, buf))
+                return false;
+
+        buf[2048] = 0;
+        ParseBoot((char *) buf, gameid);
+        return gameid[0] != 0;
+}
+
+static char GameRegion(const char *gameid) {
+        if (strlen(gameid) < 4)
+                return 0;
+
+        // SLUS, SCES, SLPM...
+        switch (toupper(gameid[2])) {
+                case 'U':
+                        return 'U';
+                case 'E':
+                        return 'E';
+                case 'P':
+                        return 'J';
+        }
+        return 0;
+}
+
+/****************************************************************************
+ * ReadDiscInfo
+ *
+ * Game id, region and, for cue sheets, the track count of a disc image.
+ * Whatever can't be read is left empty.
+ ***************************************************************************/
+void ReadDiscInfo(const char *dir, BROWSERENTRY *entry) {
+        char path[MAXPATHLEN + 1];
+        const char *ext = strrchr(entry->filename, '.');
+
+        entry->gameid[0] = 0;
+        entry->region = 0;
+        entry->tracks = 0;
+
+        snprintf(path, MAXPATHLEN, "%s%s", dir, entry->filename);
+
+        if (ext && strcasecmp(ext, ".cue") == 0) {
+                char image[MAXJOLIET + 1];
+
+                if (!ReadCue(path, image, &entry->tracks))
+                        return;
+
+                snprintf(path, MAXPATHLEN, "%s%s", dir, image);
+        }
+
+        FILE *f = fopen(path, "rb");
+        if (!f)
+                return;
+
+        if (ReadSystemCnf(f, entry->gameid))
+                entry->region = GameRegion(entry->gameid);
+
+        fclose(f);
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ * PCSXR Xenon
+ *
+ * dircache.h
+ *
+ * Per directory listing cache and disc image info
+ ***************************************************************************/
+
+#ifndef _DIRCACHE_H_
+#define _DIRCACHE_H_
+
+#include <time.h>
+#include <vector>
+#include "filebrowser.h"
+
+// under PcsxrDir, one file per directory, named after a hash of its path
+#define DIRCACHE_DIR "dircache/"
+
+bool DirCacheLoad(const char *dir, std::vector<BROWSERENTRY> &list, time_t *dirtime);
+bool DirCacheSave(const char *dir, const std::vector<BROWSERENTRY> &list);
+bool IsDiscImage(const char *filename);
+bool StatDiscImage(const char *dir, BROWSERENTRY *entry);
+void ReadDiscInfo(const char *dir, BROWSERENTRY *entry);
+
+#endif
@@ -19,6 +19,7 @@
 #include "debug.h"
 #include "sio.h"
 #include "misc.h"
+#include "runahead.h"
 
 #include <unistd.h>
 #include <libgen.h>
@@ -105,6 +106,7 @@ void SEMUInterface::Step() {
 	cpuRunning = 1;
 	emulationRunning = 1;
 	psxCpu->Execute();
+	RunAheadFrame();
 }
 
 int SEMUInterface::Start(const char * filename) {
@@ -137,6 +139,9 @@ int SEMUInterface::Start(const char * filename) {
 	
 	// Gpu plugin options	
 	Config.UseFrameLimit = EMUSettings.framelimit;
+	Config.FrameLatency = EMUSettings.framelatency;
+	Config.FastForward = EMUSettings.fastforward;
+	Config.RunAhead = EMUSettings.runahead;
 	if (EMUSettings.use_gpu_soft_plugin) {
 		strcpy(Config.Gpu, "GPUSW");
 		Config.GpuFilter = EMUSettings.sw_filter;
@@ -172,6 +177,7 @@ int SEMUInterface::Start(const char * filename) {
 			LoadCdrom();
 
 			psxCpu->Execute();
+			RunAheadFrame();
 			//SysReset();
 			return 1;
 		}
@@ -105,6 +105,9 @@ struct SEMUSettings{
 	int hw_filter;
 	int sw_filter;
 	int framelimit;	
+	int framelatency;
+	int fastforward;
+	int runahead;
 	int use_experimental_dr;
 };
 
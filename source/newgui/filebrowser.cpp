@@ -35,6 +35,7 @@
 
 BROWSERINFO browser;
 BROWSERENTRY * browserList = NULL; // list of files/folders in browser
+static int browserAlloc = 0; // # of entries browserList has room for
 DEVICES_INFO devsinfo;
 
 char pathPrefix[STD_MAX][8];
@@ -76,9 +77,38 @@ void ResetBrowser()
 	browser.size = 0;
 }
 
+/****************************************************************************
+ * ReserveBrowserEntries()
+ * Grows browserList to hold at least entries, doubling, up to
+ * MAX_BROWSER_SIZE. It keeps its size for the next directory.
+ ***************************************************************************/
+bool ReserveBrowserEntries(int entries)
+{
+	BROWSERENTRY * list;
+	int alloc = browserAlloc > 0 ? browserAlloc : 64;
+
+	if(entries <= browserAlloc)
+		return true;
+	if(entries > MAX_BROWSER_SIZE)
+		return false;
+
+	while(alloc < entries)
+		alloc *= 2;
+	if(alloc > MAX_BROWSER_SIZE)
+		alloc = MAX_BROWSER_SIZE;
+
+	list = (BROWSERENTRY *)realloc(browserList, sizeof(BROWSERENTRY) * alloc);
+	if(list == NULL)
+		return false;
+
+	browserList = list;
+	browserAlloc = alloc;
+	return true;
+}
+
 bool AddBrowserEntry()
 {
-	if(browser.size >= MAX_BROWSER_SIZE)
+	if(!ReserveBrowserEntries(browser.size + 1))
 	{
 		ErrorPrompt("Out of memory: too many files!");
 		return false; // out of space
@@ -356,6 +386,8 @@ int BrowserLoadFile()
 		return 0;
 	}
 
+	HaltParseThread(); // halt parsing
+
 	// check that this is a valid ROM
 	if(!IsValidROM())
 		goto done;
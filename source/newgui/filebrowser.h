@@ -16,9 +16,12 @@
 
 #include <unistd.h>
 #include <xetypes.h>
+#include <time.h>
 
 #define MAXJOLIET 255
-#define MAX_BROWSER_SIZE	1000
+#ifndef MAX_BROWSER_SIZE
+#define MAX_BROWSER_SIZE	10000
+#endif
 
 typedef struct {
 	struct {		
@@ -44,6 +47,10 @@ typedef struct
 	char displayname[MAXJOLIET + 1]; // name for browser display
 	int filenum; // file # (for 7z support)
 	int icon; // icon to display
+	time_t mtime; // disc images only, to check cached disc info
+	char gameid[16]; // boot file of the disc (SLUS_007.07), empty if unknown
+	char region; // 'U', 'E', 'J' from the game id, 0 if unknown
+	int tracks; // tracks in the cue sheet, 0 if unknown
 } BROWSERENTRY;
 
 extern BROWSERINFO browser;
@@ -72,6 +79,7 @@ int FileSortCallback(const void *f1, const void *f2);
 void StripExt(char* returnstring, char * inputstring);
 bool IsSz();
 void ResetBrowser();
+bool ReserveBrowserEntries(int entries);
 bool AddBrowserEntry();
 bool IsDeviceRoot(char * path);
 int BrowserLoadSz();
@@ -29,14 +29,27 @@
 #include <debug.h>
 
 #include <libxtaf/xtaf.h>
+#include <map>
+#include <string>
+#include <vector>
 #include "emu.h"
 #include "fileop.h"
 #include "menu.h"
 #include "filebrowser.h"
+#include "dircache.h"
 #include "gui/gui.h"
 
+extern "C" {
+#include "../main/x_thread.h"
+}
+
 #define THREAD_SLEEP 100
 
+// shared with the screenshot encoder and the CD prefetch, no game runs while browsing
+#define PARSE_THREAD 1
+// the first batch fills a page, later ones grow with the list so merging stays linear
+#define PARSE_BATCH_MAX 4096
+
 unsigned char *savebuffer = NULL;
 //static mutex_t bufferLock = LWP_MUTEX_NULL;
 FILE * file; // file pointer - the only one we should ever use!
@@ -56,18 +69,23 @@ bool isMounted[7] = {false, false, false, false, false, false, false};
 // folder parsing thread
 //static lwp_t parsethread = LWP_THREAD_NULL;
 static DIR *dir = NULL;
-static bool parseHalt = true;
+static char parseDir[MAXPATHLEN + 1];
+static volatile bool parseHalt = true;
 static bool parseFilter = true;
-static bool ParseDirEntries();
+static bool parseActive = false; // gui side, until UpdateParseThread saw the end
+static bool parseFull = false; // gui side, entries got dropped
 int selectLoadedFile = 0;
 
+// what the parse thread hands over, under _file_lock
+static std::vector<BROWSERENTRY> parseReady; // sorted batch
+static bool parseReset = false; // drop what was merged so far before parseReady
+static bool parseDone = true; // nothing follows parseReady
+
 // device thread
 //static lwp_t devicethread = LWP_THREAD_NULL;
 static bool deviceHalt = true;
 
-static unsigned char xenon_thread_stack[6 * 0x10000];
 static unsigned int __attribute__((aligned(128))) _file_lock = 0;
-static int _parse_thread_suspended = 0;
 
 /****************************************************************************
  * ResumeDeviceThread
@@ -90,31 +108,22 @@ HaltDeviceThread() {
 /****************************************************************************
  * HaltParseThread
  *
- * Signals the parse thread to stop.
+ * Signals the parse thread to stop, and waits for it to let go of the
+ * device. What it found so far stays in browserList.
  ***************************************************************************/
 void
 HaltParseThread() {
-}
-
-static void *
-parsecallback(void *arg) {
-        int parse = 0;
-        while (exitThreads==0) {
-
-                lock(&_file_lock);
-                if (_parse_thread_suspended == 0) {
-			while(ParseDirEntries())
-				usleep(THREAD_SLEEP);
-                }
-                _parse_thread_suspended = 1;
-                unlock(&_file_lock);
+        if (!parseActive)
+                return;
 
+        parseHalt = true;
+        x_thread_wait(PARSE_THREAD);
+        parseActive = false;
 
-                //while(ParseDirEntries())
-                //	usleep(THREAD_SLEEP);
-                //LWP_SuspendThread(parsethread);
-        }
-        return NULL;
+        lock(&_file_lock);
+        parseReady.clear();
+        parseReset = false;
+        unlock(&_file_lock);
 }
 
 /****************************************************************************
@@ -254,24 +263,79 @@ bool GetFileSize(int i) {
         return true;
 }
 
-static bool ParseDirEntries() {
-        if (!dir)
+/**
+ * Hands pending over to the gui once it took the previous batch. Returns
+ * false if it didn't yet, pending then just keeps growing.
+ */
+static bool PublishEntries(std::vector<BROWSERENTRY> &pending, bool reset) {
+        bool busy;
+
+        lock(&_file_lock);
+        busy = !parseReady.empty() || parseReset;
+        unlock(&_file_lock);
+
+        if (busy)
                 return false;
 
-        char *ext;
-        struct dirent *entry = NULL;
-        int isdir;
+        // only this thread fills parseReady, so it stays empty meanwhile
+        if (!pending.empty())
+                qsort(&pending[0], pending.size(), sizeof (BROWSERENTRY), FileSortCallback);
 
-        int i = 0;
-		
-		AddBrowserEntry();
-		sprintf(browserList[browser.numEntries + i].displayname, "Up One Level");
-		snprintf(browserList[browser.numEntries + i].filename, MAXJOLIET, "..");
-		browserList[browser.numEntries + i].icon = ICON_FOLDER;
-		browserList[browser.numEntries + i].isdir = 1;
-		i++;
-
-        while (1) {
+        lock(&_file_lock);
+        parseReady.swap(pending);
+        parseReset = reset;
+        unlock(&_file_lock);
+
+        pending.clear();
+        return true;
+}
+
+static void FlushEntries(std::vector<BROWSERENTRY> &pending, bool reset) {
+        while (!parseHalt && !PublishEntries(pending, reset))
+                usleep(THREAD_SLEEP);
+}
+
+static bool SameEntries(const std::vector<BROWSERENTRY> &a, const std::vector<BROWSERENTRY> &b) {
+        if (a.size() != b.size())
+                return false;
+
+        for (size_t i = 0; i < a.size(); i++) {
+                if (a[i].isdir != b[i].isdir || strcmp(a[i].filename, b[i].filename) != 0)
+                        return false;
+        }
+        return true;
+}
+
+/**
+ * Reads dir into sorted batches for the gui.
+ *
+ * If the directory mtime matches its cache the cached listing goes out
+ * first. The directory is still read, FAT doesn't update directory mtimes,
+ * and replaces it if it turns out different. Disc info is only read for
+ * images that are not in the cache or changed since.
+ */
+static void ParseThread() {
+        std::vector<BROWSERENTRY> cached, found, pending;
+        std::map<std::string, const BROWSERENTRY *> known;
+        std::map<std::string, const BROWSERENTRY *>::iterator it;
+        struct dirent *entry;
+        struct stat st;
+        time_t cachetime;
+        size_t target = FILE_PAGESIZE, published = 0;
+        bool fromCache = false;
+
+        if (DirCacheLoad(parseDir, cached, &cachetime)) {
+                for (size_t i = 0; i < cached.size(); i++)
+                        known[cached[i].filename] = &cached[i];
+
+                if (stat(parseDir, &st) == 0 && st.st_mtime == cachetime) {
+                        pending = cached;
+                        FlushEntries(pending, false);
+                        fromCache = true;
+                }
+        }
+
+        while (!parseHalt && found.size() < MAX_BROWSER_SIZE - 1) {
                 entry = readdir(dir);
 
                 if (entry == NULL)
@@ -280,78 +344,191 @@ static bool ParseDirEntries() {
                 if (entry->d_name[0] == '.' && entry->d_name[1] != '.')
                         continue;
 
-                if (strcmp(entry->d_name, "..") == 0) {
+                if (strcmp(entry->d_name, "..") == 0)
                         continue;
-                } else {
-                        if (entry->d_type == DT_DIR)
-                                isdir = 1;
-                        else
-                                isdir = 0;
-                }
 
-                if (!AddBrowserEntry()) {
-                        parseHalt = true;
-                        break;
+                BROWSERENTRY e;
+                memset(&e, 0, sizeof (e));
+
+                snprintf(e.filename, MAXJOLIET, "%s", entry->d_name);
+                strcpy(e.displayname, e.filename);
+                e.isdir = (entry->d_type == DT_DIR); // flag this as a dir
+
+                if (e.isdir) {
+                        e.icon = ICON_FOLDER;
+                } else if (IsDiscImage(e.filename)) {
+                        it = known.find(e.filename);
+
+                        if (fromCache && it != known.end()) {
+                                e = *it->second;
+                        } else if (StatDiscImage(parseDir, &e)) {
+                                if (it != known.end() && it->second->length == e.length && it->second->mtime == e.mtime)
+                                        e = *it->second;
+                                else
+                                        ReadDiscInfo(parseDir, &e);
+                        }
                 }
 
-                snprintf(browserList[browser.numEntries + i].filename, MAXJOLIET, "%s", entry->d_name);
-                browserList[browser.numEntries + i].isdir = isdir; // flag this as a dir
-
-                if (isdir) {
-                        if (strcmp(entry->d_name, "..") == 0)
-                                sprintf(browserList[browser.numEntries + i].displayname, "Up One Level");
-                        else
-                                snprintf(browserList[browser.numEntries + i].displayname, MAXJOLIET, "%s", browserList[browser.numEntries + i].filename);
-                        browserList[browser.numEntries + i].icon = ICON_FOLDER;
-                } else {
-                        strcpy(browserList[browser.numEntries + i].displayname, browserList[browser.numEntries + i].filename);
+                found.push_back(e);
+
+                if (!fromCache) {
+                        pending.push_back(e);
+
+                        if (pending.size() >= target) {
+                                size_t count = pending.size();
+
+                                if (PublishEntries(pending, false)) {
+                                        published += count;
+                                        target = published < PARSE_BATCH_MAX ? published : PARSE_BATCH_MAX;
+                                }
+                        }
                 }
-                i++;
         }
 
+        closedir(dir);
+        dir = NULL;
+
         if (!parseHalt) {
-                // Sort the file list
-                if (i >= 0)
-                        qsort(browserList, browser.numEntries + i, sizeof (BROWSERENTRY), FileSortCallback);
+                if (!found.empty())
+                        qsort(&found[0], found.size(), sizeof (BROWSERENTRY), FileSortCallback);
+
+                if (!fromCache) {
+                        FlushEntries(pending, false);
+                        DirCacheSave(parseDir, found);
+                } else if (!SameEntries(found, cached)) {
+                        pending = found;
+                        FlushEntries(pending, true);
+                        DirCacheSave(parseDir, found);
+                }
+        }
+
+        lock(&_file_lock);
+        parseDone = true;
+        unlock(&_file_lock);
+}
 
-                browser.numEntries += i;
+/**
+ * Merges a sorted batch into the sorted browserList, from the back so
+ * nothing needs to move twice.
+ */
+static void MergeEntries(const BROWSERENTRY *batch, int count) {
+        int i = browser.numEntries - 1;
+        int j;
+
+        if (count > MAX_BROWSER_SIZE - browser.numEntries) {
+                count = MAX_BROWSER_SIZE - browser.numEntries;
+                parseFull = true;
         }
 
-        if (entry == NULL || parseHalt) {
-                closedir(dir); // close directory
-                dir = NULL;
+        if (!ReserveBrowserEntries(browser.numEntries + count)) {
+                parseFull = true;
+                return;
+        }
 
-                // try to find and select the last loaded file
-                if (selectLoadedFile == 1 && !parseHalt && loadedFile[0] != 0 && browser.dir[0] != 0) {
-                        int indexFound = -1;
+        j = count - 1;
+        for (int w = browser.numEntries + count - 1; j >= 0; w--) {
+                if (i >= 0 && FileSortCallback(&browserList[i], &batch[j]) > 0)
+                        browserList[w] = browserList[i--];
+                else
+                        browserList[w] = batch[j--];
+        }
 
-                        for (int j = 1; j < browser.numEntries; j++) {
-                                if (strcmp(browserList[j].filename, loadedFile) == 0) {
-                                        indexFound = j;
-                                        break;
-                                }
-                        }
+        browser.numEntries += count;
+        browser.size = browser.numEntries;
+}
 
-                        // move to this file
-                        if (indexFound > 0) {
-                                if (indexFound >= FILE_PAGESIZE) {
-                                        int newIndex = (floor(indexFound / (float) FILE_PAGESIZE)) * FILE_PAGESIZE;
+// the list is sorted, look the last loaded file up rather than walk it
+static void SelectLoadedFile() {
+        BROWSERENTRY key;
+        int indexFound = -1;
 
-                                        if (newIndex + FILE_PAGESIZE > browser.numEntries)
-                                                newIndex = browser.numEntries - FILE_PAGESIZE;
+        if (selectLoadedFile != 1 || loadedFile[0] == 0 || browser.dir[0] == 0)
+                return;
 
-                                        if (newIndex < 0)
-                                                newIndex = 0;
+        memset(&key, 0, sizeof (key));
+        snprintf(key.filename, MAXJOLIET, "%s", loadedFile);
 
-                                        browser.pageIndex = newIndex;
-                                }
-                                browser.selIndex = indexFound;
+        BROWSERENTRY *match = (BROWSERENTRY *) bsearch(&key, browserList + 1, browser.numEntries - 1,
+                sizeof (BROWSERENTRY), FileSortCallback);
+
+        if (match != NULL) {
+                int j = match - browserList;
+
+                // names only differing in case compare equal
+                while (j > 1 && FileSortCallback(&browserList[j - 1], &key) == 0)
+                        j--;
+
+                for (; j < browser.numEntries && FileSortCallback(&browserList[j], &key) == 0; j++) {
+                        if (strcmp(browserList[j].filename, loadedFile) == 0) {
+                                indexFound = j;
+                                break;
                         }
-                        selectLoadedFile = 2; // selecting done
                 }
-                return false; // no more entries
         }
-        return true; // more entries
+
+        // move to this file
+        if (indexFound > 0) {
+                if (indexFound >= FILE_PAGESIZE) {
+                        int newIndex = (floor(indexFound / (float) FILE_PAGESIZE)) * FILE_PAGESIZE;
+
+                        if (newIndex + FILE_PAGESIZE > browser.numEntries)
+                                newIndex = browser.numEntries - FILE_PAGESIZE;
+
+                        if (newIndex < 0)
+                                newIndex = 0;
+
+                        browser.pageIndex = newIndex;
+                }
+                browser.selIndex = indexFound;
+        }
+        selectLoadedFile = 2; // selecting done
+}
+
+/****************************************************************************
+ * UpdateParseThread
+ *
+ * Merges what the parse thread found since the last call into browserList.
+ * Called from the gui loop, returns false once the directory is complete.
+ ***************************************************************************/
+bool
+UpdateParseThread() {
+        static std::vector<BROWSERENTRY> batch;
+        bool reset, done;
+
+        if (!parseActive)
+                return false;
+
+        lock(&_file_lock);
+        batch.swap(parseReady);
+        reset = parseReset;
+        done = parseDone;
+        parseReset = false;
+        unlock(&_file_lock);
+
+        if (reset) {
+                // keep Up One Level
+                browser.numEntries = browser.size = 1;
+                parseFull = false;
+                browser.selIndex = 0;
+                browser.pageIndex = 0;
+        }
+
+        if (!batch.empty()) {
+                MergeEntries(&batch[0], batch.size());
+                batch.clear();
+        }
+
+        if (!done)
+                return true;
+
+        x_thread_wait(PARSE_THREAD); // ParseThread returned, taskrunner may not have yet
+        parseActive = false;
+
+        if (parseFull)
+                ErrorPrompt("Out of memory: too many files!");
+
+        SelectLoadedFile();
+        return false;
 }
 
 /***************************************************************************
@@ -363,6 +540,7 @@ ParseDirectory(bool waitParse, bool filter) {
 	bool mounted = false;
 	parseFilter = filter;
 
+	HaltParseThread();
 	ResetBrowser(); // reset browser
 
 	// add trailing slash
@@ -399,12 +577,34 @@ ParseDirectory(bool waitParse, bool filter) {
 
 	if (dir == NULL)
 		return -1;
-		
+
+	// the rest gets sorted in behind it
+	AddBrowserEntry();
+	sprintf(browserList[0].displayname, "Up One Level");
+	snprintf(browserList[0].filename, MAXJOLIET, "..");
+	browserList[0].icon = ICON_FOLDER;
+	browserList[0].isdir = 1;
+	browser.numEntries = 1;
+
+	snprintf(parseDir, MAXPATHLEN, "%s", browser.dir);
+	parseReady.clear();
+	parseReset = false;
+	parseDone = false;
 	parseHalt = false;
-	
-	// wait
-	while(ParseDirEntries());
-	
+	parseFull = false;
+
+	x_thread_wait(PARSE_THREAD); // a screenshot may still be encoding
+	if (x_thread_create(PARSE_THREAD, (void *) ParseThread) != 0) {
+		closedir(dir);
+		dir = NULL;
+		return -1;
+	}
+	parseActive = true;
+
+	// wait for everything, or for a first page
+	while (UpdateParseThread() && (waitParse || browser.numEntries == 1))
+		usleep(THREAD_SLEEP);
+
 	return browser.numEntries;
 }
 
@@ -26,6 +26,7 @@ void InitDeviceThread();
 void ResumeDeviceThread();
 void HaltDeviceThread();
 void HaltParseThread();
+bool UpdateParseThread();
 void MountAllFAT();
 void UnmountAllFAT();
 bool FindDevice(char * filepath, int * device);
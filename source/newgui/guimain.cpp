@@ -102,7 +102,6 @@ int main(int argc, char *argv[])
 	InitFreeType((u8*)font_ttf, font_ttf_size); // Initialize font system
 	
 	savebuffer = (unsigned char *)malloc(SAVEBUFFERSIZE);
-	browserList = (BROWSERENTRY *)malloc(sizeof(BROWSERENTRY)*MAX_BROWSER_SIZE);
 	
 	InitGUIThreads();
 	LoadLanguage();
@@ -1009,6 +1009,9 @@ static int MenuGameSelection() {
 		UGUI();
 		usleep(THREAD_SLEEP);
 
+		// merge what the parse thread found meanwhile
+		UpdateParseThread();
+
 		if (selectLoadedFile == 2) {
 			selectLoadedFile = 0;
 			mainWindow->ChangeFocus(&gameBrowser);
@@ -2560,6 +2563,9 @@ enum {
 	SETTING_CPU,
 	SETTING_GPU,
 	SETIING_FRAMELIMIT,
+	SETTING_FRAMELATENCY,
+	SETTING_FASTFORWARD,
+	SETTING_RUNAHEAD,
 	SETTING_HW_FILTER,
 	SETTING_SW_FILTER,
 	SETTING_MAX,
@@ -2575,6 +2581,9 @@ static int MenuSettingsMenu() {
 	sprintf(options.name[SETTING_EXIT_ACTION], "Exit Action");
 	sprintf(options.name[SETTING_CPU], "CPU Mode");
 	sprintf(options.name[SETIING_FRAMELIMIT], "Framelimit");
+	sprintf(options.name[SETTING_FRAMELATENCY], "Low Latency (Soft GPU)");
+	sprintf(options.name[SETTING_FASTFORWARD], "Fast Forward (R3)");
+	sprintf(options.name[SETTING_RUNAHEAD], "Run Ahead");
 	sprintf(options.name[SETTING_GPU], "GPU Plugin");
 	sprintf(options.name[SETTING_HW_FILTER], "HARDWARE GPU Filter");
 	sprintf(options.name[SETTING_SW_FILTER], "SOFT GPU Filter");
@@ -2684,6 +2693,33 @@ static int MenuSettingsMenu() {
 					EMUSettings.framelimit = 0;
 
 				break;
+
+			case SETTING_FRAMELATENCY:
+				EMUSettings.framelatency++;
+
+				if (EMUSettings.framelatency > 1)
+					EMUSettings.framelatency = 0;
+
+				break;
+
+			case SETTING_FASTFORWARD:
+				// 2x, 4x, 8x, unlimited
+				if (EMUSettings.fastforward == 0)
+					EMUSettings.fastforward = 2;
+				else if (EMUSettings.fastforward < 8)
+					EMUSettings.fastforward *= 2;
+				else
+					EMUSettings.fastforward = 0;
+
+				break;
+
+			case SETTING_RUNAHEAD:
+				EMUSettings.runahead++;
+
+				if (EMUSettings.runahead > 3)
+					EMUSettings.runahead = 0;
+
+				break;
 		}
 
 		if (ret >= 0 || firstRun) {
@@ -2738,6 +2774,21 @@ static int MenuSettingsMenu() {
 				sprintf(options.value[SETIING_FRAMELIMIT], "Enabled");
 			else
 				sprintf(options.value[SETIING_FRAMELIMIT], "Disabled");
+
+			if (EMUSettings.framelatency == 1)
+				sprintf(options.value[SETTING_FRAMELATENCY], "Enabled");
+			else
+				sprintf(options.value[SETTING_FRAMELATENCY], "Disabled");
+
+			if (EMUSettings.fastforward > 0)
+				sprintf(options.value[SETTING_FASTFORWARD], "%dx", EMUSettings.fastforward);
+			else
+				sprintf(options.value[SETTING_FASTFORWARD], "Unlimited");
+
+			if (EMUSettings.runahead > 0)
+				sprintf(options.value[SETTING_RUNAHEAD], "%d frame%s", EMUSettings.runahead, EMUSettings.runahead > 1 ? "s" : "");
+			else
+				sprintf(options.value[SETTING_RUNAHEAD], "Disabled");
 				
 			if (EMUSettings.hw_filter == 1)
 				sprintf(options.value[SETTING_HW_FILTER], "2xSai");
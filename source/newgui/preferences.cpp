@@ -94,6 +94,7 @@ LoadPrefsFromMethod (char * path)
 static void DefaultSettings() {
 	memset(&EMUSettings, 0, sizeof(SEMUSettings));
 	EMUSettings.framelimit = 1;
+	EMUSettings.fastforward = 4;
 	EMUSettings.sw_filter = 1; // XBR
 	EMUSettings.hw_filter = 1; // 2xSai
 }
@@ -536,6 +536,76 @@ void Menu_T(XenosSurface * surf, f32 texWidth, f32 texHeight, int16_t screenX, i
         Draw();
 }
 
+/****************************************************************************
+ * Menu_TBatch
+ *
+ * Draws many rectangles out of one texture (font atlas page) with a single
+ * draw call. Vertices are already in screen space, the matrix is identity.
+ ***************************************************************************/
+void Menu_TBatch(XenosSurface * surf, const TexQuad * quads, int count, GXColor color) {
+        int i, bytes;
+
+        if (surf == NULL || count <= 0)
+                return;
+
+        // rectlist: 3 vertices per rectangle, the 4th corner is implied
+        bytes = count * 3 * sizeof (DrawVerticeFormats);
+        if (nb_vertices + bytes > MAX_VERTEX_COUNT * (int) sizeof (DrawVerticeFormats))
+                return;
+
+        XeColor _color;
+
+        _color.a = color.a;
+        _color.r = color.r;
+        _color.g = color.g;
+        _color.b = color.b;
+
+        DrawVerticeFormats* Rect = (DrawVerticeFormats*) Xe_VB_Lock(g_pVideoDevice, vb, nb_vertices, bytes, XE_LOCK_WRITE);
+        for (i = 0; i < count; i++, Rect += 3) {
+                // same placement as Menu_T
+                float x = (quads[i].x / ((float) screenwidth / 2.f)) - 1.f;
+                float y = (quads[i].y / ((float) screenheight / 2.f)) - 1.f;
+                float w = 2.f * quads[i].width / (float) screenwidth;
+                float h = 2.f * quads[i].height / (float) screenheight;
+
+                // bottom left
+                Rect[0].x = x;
+                Rect[0].y = y + h;
+                Rect[0].u = quads[i].u0;
+                Rect[0].v = quads[i].v1;
+
+                // bottom right
+                Rect[1].x = x + w;
+                Rect[1].y = y + h;
+                Rect[1].u = quads[i].u1;
+                Rect[1].v = quads[i].v1;
+
+                // top right
+                Rect[2].x = x + w;
+                Rect[2].y = y;
+                Rect[2].u = quads[i].u1;
+                Rect[2].v = quads[i].v0;
+
+                for (int j = 0; j < 3; j++) {
+                        Rect[j].z = 0.0;
+                        Rect[j].w = 1.0;
+                        Rect[j].color = _color.lcol;
+                }
+        }
+        Xe_VB_Unlock(g_pVideoDevice, vb);
+
+        Xe_SetTexture(g_pVideoDevice, 0, surf);
+
+        UpdatesMatrices(0, 0, 0, 0, 0, 1, 1);
+
+        Xe_SetShader(g_pVideoDevice, SHADER_TYPE_PIXEL, g_pPixelTexturedShader, 0);
+        Xe_SetShader(g_pVideoDevice, SHADER_TYPE_VERTEX, g_pVertexShader, 0);
+
+        SetRS();
+        Xe_DrawPrimitive(g_pVideoDevice, XE_PRIMTYPE_RECTLIST, 0, count);
+        nb_vertices += (bytes + 511) & ~511; // same alignment as Draw
+}
+
 /****************************************************************************
  * Update Video
  ***************************************************************************/
@@ -51,6 +51,14 @@ void Menu_Render();
 void Menu_DrawImg(f32 xpos, f32 ypos, u16 width, u16 height, XenosSurface * data, f32 degrees, f32 scaleX, f32 scaleY, u8 alphaF);
 void Menu_DrawRectangle(f32 x, f32 y, f32 width, f32 height, GXColor color, u8 filled);
 void Menu_T(XenosSurface * surf, f32 texWidth, f32 texHeight, int16_t screenX, int16_t screenY, GXColor color);
+
+// a screen rectangle and the part of the texture that goes into it
+typedef struct {
+    f32 x, y, width, height;
+    f32 u0, v0, u1, v1;
+} TexQuad;
+
+void Menu_TBatch(XenosSurface * surf, const TexQuad * quads, int count, GXColor color);
 void Menu_TD(XenosSurface * surf, f32 texWidth, f32 texHeight, int16_t screenX, int16_t screenY, GXColor color);
 void Menu_TD2(XenosSurface * surf, f32 texWidth, f32 texHeight, int16_t screenX, int16_t screenY, GXColor color);
 
@@ -0,0 +1,266 @@
+/***************************************************************************
+                          cmd_ring.cpp  -  description
+                             -------------------
+    single producer / single consumer command ring (emu -> gpu thread)
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "cmd_ring.h"
+
+#ifdef LIBXENON
+#include <ppc/timebase.h>
+
+// no futex here: waiting threads drop their smt priority and poll with db16cyc.
+// Indices are read and written plainly, lwsync orders them against the slots.
+#define ring_ticks()    mftb()
+#define ring_ticks_us   (PPC_TIMEBASE_FREQ / 1000000)
+#define ring_low()      __asm__ __volatile__("or 1,1,1")
+#define ring_medium()   __asm__ __volatile__("or 2,2,2")
+#define ring_get(x)     (x)
+#define ring_set(x, v)  ((x) = (v))
+#define ring_acquire()  __asm__ __volatile__("lwsync" : : : "memory")
+#define ring_release()  __asm__ __volatile__("lwsync" : : : "memory")
+#define ring_wait(p, seen, waiters, us) __asm__ __volatile__("db16cyc")
+#define ring_wake(p, waiters)
+#else
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// host (linux): indices are relaxed atomics behind acquire/release fences,
+// a waiting side sleeps on the index it waits for and is woken when it moves
+
+static uint64_t ring_ticks() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#define ring_ticks_us   1
+#define ring_low()
+#define ring_medium()
+#define ring_get(x)     __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define ring_set(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#define ring_acquire()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define ring_release()  __atomic_thread_fence(__ATOMIC_RELEASE)
+
+// yields before a wait goes to sleep: a futex round trip costs more than
+// most waits between two busy threads last
+#define CMDRING_YIELDS 64
+
+// yields a while, then sleeps while *p is still seen, at most us microseconds
+static void ring_wait(volatile uint32_t * p, uint32_t seen, volatile uint32_t * waiters, uint64_t us) {
+    struct timespec ts;
+    int i;
+
+    for (i = 0; i < CMDRING_YIELDS; i++) {
+        if (__atomic_load_n(p, __ATOMIC_RELAXED) != seen) return;
+        sched_yield();
+    }
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+
+    __atomic_fetch_add(waiters, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(p, __ATOMIC_SEQ_CST) == seen)
+        syscall(SYS_futex, p, FUTEX_WAIT_PRIVATE, seen, &ts, NULL, 0);
+    __atomic_fetch_sub(waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+// after *p moved: the waiter either sees the new value or gets woken
+static void ring_wake(volatile uint32_t * p, volatile uint32_t * waiters) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED))
+        syscall(SYS_futex, p, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#endif
+
+// polls before a waiting side drops to low priority
+#define CMDRING_SPIN 256
+
+// longest producer sleep, a lost wakeup costs no more than this
+#define CMDRING_NAP_US 10000
+
+////////////////////////////////////////////////////////////////////////
+
+void CmdRingInit(CmdRing * r, uint32_t * buf, uint32_t words) {
+    memset(r, 0, sizeof (CmdRing));
+    r->buf = buf;
+    r->size = words;
+    r->mask = words - 1;
+    r->maxpacket = words / 8; // keeps the consumer busy while a batch is built
+}
+
+////////////////////////////////////////////////////////////////////////
+// producer
+////////////////////////////////////////////////////////////////////////
+
+static void WaitSpace(CmdRing * r, uint32_t count) {
+    uint64_t start;
+    uint32_t tail;
+    int i;
+
+    if (r->size - (r->wpos - ring_get(r->tail)) >= count) {
+        ring_acquire(); // tail read before we overwrite the slots behind it
+        return;
+    }
+
+    r->stalls++;
+    start = ring_ticks();
+
+    for (i = 0; i < CMDRING_SPIN; i++)
+        if (r->size - (r->wpos - ring_get(r->tail)) >= count) goto done;
+
+    ring_low();
+    while (r->size - (r->wpos - (tail = ring_get(r->tail))) < count)
+        ring_wait(&r->tail, tail, &r->tailwait, CMDRING_NAP_US);
+    ring_medium();
+
+done:
+    r->stallticks += ring_ticks() - start;
+    ring_acquire();
+}
+
+void CmdRingBegin(CmdRing * r, uint32_t type) {
+    WaitSpace(r, 1);
+    r->open = r->wpos++;
+    r->opentype = type;
+    r->isopen = 1;
+}
+
+void CmdRingCommit(CmdRing * r) {
+    uint32_t inflight;
+
+    if (!r->isopen) return;
+    r->isopen = 0;
+
+    r->buf[r->open & r->mask] = CMDRING_HDR(r->opentype, r->wpos - r->open - 1);
+    r->packets++;
+
+    ring_release(); // payload and header visible before the new head
+    ring_set(r->head, r->wpos);
+    ring_wake(&r->head, &r->headwait);
+
+    inflight = r->wpos - ring_get(r->tail);
+    if (inflight > r->highwater) r->highwater = inflight;
+}
+
+void CmdRingAppend(CmdRing * r, const uint32_t * data, uint32_t count) {
+    while (count) {
+        uint32_t len = r->wpos - r->open - 1;
+        uint32_t n, w, first;
+
+        if (len >= r->maxpacket) { // batch is big enough, hand it over
+            uint32_t type = r->opentype;
+            CmdRingCommit(r);
+            CmdRingBegin(r, type);
+            len = 0;
+        }
+
+        n = r->maxpacket - len;
+        if (n > count) n = count;
+
+        WaitSpace(r, n);
+
+        w = r->wpos & r->mask;
+        first = r->size - w;
+        if (first > n) first = n;
+
+        memcpy(&r->buf[w], data, first * 4);
+        if (n > first) memcpy(r->buf, data + first, (n - first) * 4);
+
+        r->wpos += n;
+        data += n;
+        count -= n;
+    }
+}
+
+void CmdRingPush(CmdRing * r, uint32_t type, const uint32_t * data, uint32_t count) {
+    CmdRingBegin(r, type);
+    CmdRingAppend(r, data, count);
+    CmdRingCommit(r);
+}
+
+void CmdRingDrain(CmdRing * r) {
+    uint32_t tail;
+    int i;
+
+    CmdRingCommit(r);
+
+    for (i = 0; i < CMDRING_SPIN; i++)
+        if (ring_get(r->tail) == r->head) goto done;
+
+    ring_low();
+    while ((tail = ring_get(r->tail)) != r->head)
+        ring_wait(&r->tail, tail, &r->tailwait, CMDRING_NAP_US);
+    ring_medium();
+
+done:
+    ring_acquire();
+}
+
+////////////////////////////////////////////////////////////////////////
+// consumer
+////////////////////////////////////////////////////////////////////////
+
+int CmdRingWaitData(CmdRing * r, uint64_t maxticks, uint32_t * hdr) {
+    uint32_t tail = r->tail;
+    uint64_t end;
+    int64_t left;
+    int i;
+
+    for (i = 0; i < CMDRING_SPIN; i++)
+        if (ring_get(r->head) != tail) goto got;
+
+    // nothing to do: park, but come back now and then to let the owner stop us
+    r->parks++;
+    end = ring_ticks() + maxticks;
+
+    ring_low();
+    while (ring_get(r->head) == tail && (left = (int64_t) (end - ring_ticks())) > 0)
+        ring_wait(&r->head, tail, &r->headwait, left / ring_ticks_us);
+    ring_medium();
+
+    if (ring_get(r->head) == tail) return 0;
+
+got:
+    ring_acquire(); // head read before the packet behind it
+    *hdr = r->buf[tail & r->mask];
+    return 1;
+}
+
+// contiguous part of the current packet, starting 'off' words after its header
+
+uint32_t CmdRingSpan(CmdRing * r, uint32_t off, uint32_t count, uint32_t ** p) {
+    uint32_t pos = (r->tail + 1 + off) & r->mask;
+    uint32_t n = r->size - pos;
+
+    *p = &r->buf[pos];
+    return n < count ? n : count;
+}
+
+void CmdRingRetire(CmdRing * r, uint32_t hdr) {
+    ring_release(); // done reading before the slots are handed back
+    ring_set(r->tail, r->tail + 1 + CMDRING_LEN(hdr));
+    ring_wake(&r->tail, &r->tailwait);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void CmdRingReport(CmdRing * r, const char * name) {
+    printf("%s: %u packets, %u stalls (%u us), high water %u/%u words, %u parks\n",
+            name, r->packets, r->stalls, (uint32_t) (r->stallticks / ring_ticks_us),
+            r->highwater, r->size, r->parks);
+}
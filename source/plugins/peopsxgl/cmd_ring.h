@@ -0,0 +1,72 @@
+/***************************************************************************
+                          cmd_ring.h  -  description
+                             -------------------
+    single producer / single consumer command ring (emu -> gpu thread)
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef _CMD_RING_H_
+#define _CMD_RING_H_
+
+#include <stdint.h>
+
+// Packets are a header word ((type << 24) | payload length) followed by the
+// payload. A packet may wrap around the end of the buffer, the consumer gets
+// it in (at most) two contiguous spans.
+// Indices run freely and wrap at 2^32, the buffer size is a power of two.
+
+#define CMDRING_HDR(type, len)  (((uint32_t)(type) << 24) | (len))
+#define CMDRING_TYPE(hdr)       ((hdr) >> 24)
+#define CMDRING_LEN(hdr)        ((hdr) & 0xffffff)
+
+typedef struct {
+    volatile uint32_t head __attribute__((aligned(128))); // published by the producer
+    volatile uint32_t headwait; // consumer asleep on head (host only)
+    volatile uint32_t tail __attribute__((aligned(128))); // retired by the consumer
+    volatile uint32_t tailwait; // producer asleep on tail (host only)
+
+    // producer side
+    uint32_t wpos __attribute__((aligned(128))); // write cursor (head + open packet)
+    uint32_t open; // header position of the open packet
+    uint32_t opentype;
+    int      isopen;
+
+    uint32_t * buf;
+    uint32_t size;
+    uint32_t mask;
+    uint32_t maxpacket;
+
+    // backpressure statistics
+    uint32_t packets;
+    uint32_t stalls; // producer had to wait for space
+    uint64_t stallticks;
+    uint32_t highwater; // max words in flight
+    uint32_t parks; // consumer went to low priority
+} CmdRing;
+
+void     CmdRingInit(CmdRing * r, uint32_t * buf, uint32_t words);
+
+// producer
+void     CmdRingBegin(CmdRing * r, uint32_t type);
+void     CmdRingAppend(CmdRing * r, const uint32_t * data, uint32_t count);
+void     CmdRingCommit(CmdRing * r);
+void     CmdRingPush(CmdRing * r, uint32_t type, const uint32_t * data, uint32_t count);
+void     CmdRingDrain(CmdRing * r); // wait until the consumer retired everything
+
+// consumer
+int      CmdRingWaitData(CmdRing * r, uint64_t maxticks, uint32_t * hdr);
+uint32_t CmdRingSpan(CmdRing * r, uint32_t off, uint32_t count, uint32_t ** p);
+void     CmdRingRetire(CmdRing * r, uint32_t hdr);
+
+void     CmdRingReport(CmdRing * r, const char * name);
+
+#endif // _CMD_RING_H_
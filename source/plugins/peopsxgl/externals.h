@@ -226,7 +226,7 @@ uint32_t  l;
 typedef union EXLongTag
 {
     struct{
-#if 0
+#ifndef LIBXENON // little endian, as in swap.h: _0 is the low byte of l
         unsigned char _0;
         unsigned char _1;
         unsigned char _2;
@@ -426,6 +426,8 @@ extern BOOL           bUseFrameSkip;
 extern float          fFrameRateHz;
 extern float          fps_skip;
 extern float          fps_cur;
+extern float          fSpeed;
+extern BOOL           bOutput;
 
 #endif
 
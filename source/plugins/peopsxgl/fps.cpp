@@ -49,11 +49,24 @@ namespace xegpu {
     float fps_skip = 0;
     float fps_cur = 0;
 
+    ////////////////////////////////////////////////////////////////////////
+    // fast forward: 1 normal speed, 0 unlimited
+    ////////////////////////////////////////////////////////////////////////
+
+    float fSpeed = 1.0f;
+
+    ////////////////////////////////////////////////////////////////////////
+    // run ahead: frames of discarded emulation are not shown, nor paced
+    ////////////////////////////////////////////////////////////////////////
+
+    BOOL bOutput = TRUE;
+
 }
 
 using namespace xegpu;
 
 #define TIMEBASE 100000
+#define HOSTREFRESHHZ 60
 
 unsigned long timeGetTime() {
 	return mftb()/(PPC_TIMEBASE_FREQ/100000);
@@ -325,8 +338,50 @@ void InitFrameCap(void) {
 void ReInitFrameCap(void) {
 }
 
+////////////////////////////////////////////////////////////////////////
+// fast forward: vsyncs come fSpeed times as fast as on the psx, or as
+// fast as we can with fSpeed 0, and the tv only gets the frames it can
+// show, one per host refresh
+////////////////////////////////////////////////////////////////////////
+
+static void FastForwardCap(void) {
+    static unsigned long nextticks;
+    unsigned long curticks = timeGetTime();
+    unsigned long ticks = (unsigned long) (TIMEBASE / (fFrameRateHz * fSpeed));
+
+    if (bInitCap || (long) (curticks - nextticks) > (long) (MAXLACE * ticks)) {
+        bInitCap = FALSE; // -> first time or way behind: start over, don't race to catch up
+        nextticks = curticks + ticks;
+        return;
+    }
+
+    while ((long) (nextticks - curticks) > 0)
+        curticks = timeGetTime();
+
+    nextticks += ticks;
+}
+
+void FastForwardSkip(void) // called in updatedisplay, decides about the next frame
+{
+    static unsigned long lastticks;
+    unsigned long curticks = timeGetTime();
+
+    if (curticks - lastticks >= TIMEBASE / HOSTREFRESHHZ) {
+        lastticks = curticks;
+        bSkipNextFrame = FALSE;
+    } else bSkipNextFrame = TRUE;
+}
+
 void CheckFrameRate(void) // called in updatelace (on every emulated psx vsync)
 {
+    if (!bOutput) return; // -> hidden frame, nobody waits for it
+
+    if (fSpeed != 1.0f) // fast forward?
+    {
+        if (fSpeed > 0.0f) FastForwardCap();
+        return;
+    }
+
     if (peops_cfg.bUseFrameSkip) {
         if (!(peops_cfg.dwActFixes & 0x100)) {
             dwLaceCnt++; // -> and store cnt of vsync between frames
@@ -358,3 +413,9 @@ void CALLBACK GPUsetframelimit(unsigned long option) // new EPSXE interface func
         peops_cfg.bUseFrameLimit = FALSE;
     }
 }
+
+EXTERN void CALLBACK GPUsetSpeed(float speed) // main emu: fast forward with speed (0: unlimited), or back to 1
+{
+    bInitCap = TRUE;
+    fSpeed = speed;
+}
@@ -24,6 +24,7 @@ void FrameSkip(void);
 void CheckFrameRate(void);
 void ReInitFrameCap(void);
 void SetAutoFrameCap(void);
+void FastForwardSkip(void);
 
 #ifndef _WINDOWS
 unsigned long timeGetTime();
@@ -22,46 +22,127 @@
 #include "externals.h"
 
 //BOOL bGteAccuracy = TRUE;
-//float ***gteCoords = NULL;
 
-typedef float (*gteCoords_t)[0x800 * 2][2];
-static gteCoords_t gteCoords = NULL;
-// TODO: use malloc and pointer to the array's center.
-// 08000000
+// Sparse, frame-scoped store of the sub-pixel GTE vertices.
+// Open addressed on (sx,sy), every slot is tagged with the frame generation
+// it was written in: bumping the generation empties the whole table.
+// Vertices of the previous frame stay visible, since the GPU thread may
+// still be drawing it while the GTE already works on the next one.
+
+#define GTE_VTX_BITS	14
+#define GTE_VTX_SIZE	(1 << GTE_VTX_BITS)
+#define GTE_VTX_MASK	(GTE_VTX_SIZE - 1)
+#define GTE_VTX_PROBE	16
+
+typedef struct {
+	unsigned int gen;
+	unsigned int key;
+	float x, y;
+} gteVertex_t;
+
+static gteVertex_t *gteVertices = NULL;
+static unsigned int gteGen = 1;
+
+static inline unsigned int gteKey(short sx, short sy) {
+	return (unsigned short) sx | ((unsigned int) (unsigned short) sy << 16);
+}
+
+static inline unsigned int gteSlot(unsigned int key) {
+	return (key * 0x9e3779b1) >> (32 - GTE_VTX_BITS);
+}
+
+static inline bool gteLive(const gteVertex_t *v) {
+	return v->gen == gteGen || v->gen == gteGen - 1;
+}
 
 using namespace xegpu;
 
 EXTERN void CALLBACK GPUaddVertex(short sx, short sy, long long fx, long long fy, long long fz) {
-	if (peops_cfg.bGteAccuracy) {
+	if (peops_cfg.bGteAccuracy && gteVertices) {
 		if (sx >= -0x800 && sx <= 0x7ff &&
 				sy >= -0x800 && sy <= 0x7ff) {
-			gteCoords[sy + 0x800][sx + 0x800][0] = fx / 65536.0f;
-			gteCoords[sy + 0x800][sx + 0x800][1] = fy / 65536.0f;
+			unsigned int key = gteKey(sx, sy);
+			unsigned int slot = gteSlot(key);
+			gteVertex_t *v = NULL, *old = NULL;
+			int i;
+
+			// same spot written again: take it, else the first free slot of the
+			// chain, else evict a vertex of the previous frame before one of
+			// this frame. An empty slot ends the chain.
+			for (i = 0; i < GTE_VTX_PROBE; i++) {
+				gteVertex_t *p = &gteVertices[(slot + i) & GTE_VTX_MASK];
+
+				if (p->gen != 0 && gteLive(p)) {
+					if (p->key == key) {
+						v = p;
+						break;
+					}
+					if (old == NULL && p->gen != gteGen)
+						old = p;
+				} else {
+					if (v == NULL)
+						v = p;
+					if (p->gen == 0)
+						break;
+				}
+			}
+			if (v == NULL)
+				v = old ? old : &gteVertices[slot];
+
+			v->key = key;
+			v->x = fx / 65536.0f;
+			v->y = fy / 65536.0f;
+			v->gen = gteGen;
 		}
 	}
 }
 
 void resetGteVertices() {
 	if (peops_cfg.bGteAccuracy) {
-		if (gteCoords == NULL)
-			gteCoords = (gteCoords_t) malloc(0x8000000);
-		memset(gteCoords, 0x00, 0x8000000);
+		if (gteVertices == NULL) {
+			gteVertices = (gteVertex_t *) malloc(GTE_VTX_SIZE * sizeof (gteVertex_t));
+			if (gteVertices == NULL)
+				return; // no sub-pixel vertices, getGteVertex() always misses
+			memset(gteVertices, 0x00, GTE_VTX_SIZE * sizeof (gteVertex_t));
+			gteGen = 1;
+		}
+		gteGen += 2; // both live generations expire
 	}
 }
 
+// frame boundary: drop everything older than the frame just drawn
+void nextGteFrame() {
+	gteGen++;
+}
+
 int getGteVertex(short sx, short sy, float *fx, float *fy) {
-	if (peops_cfg.bGteAccuracy) {
+	if (peops_cfg.bGteAccuracy && gteVertices) {
 		if (sx >= -0x800 && sx <= 0x7ff &&
 				sy >= -0x800 && sy <= 0x7ff) {
-			if ((fabsf(gteCoords[sy + 0x800][sx + 0x800][0] - sx) < 1.0) &&
-					(fabsf(gteCoords[sy + 0x800][sx + 0x800][1] - sy) < 1.0)) {
-				*fx = gteCoords[sy + 0x800][sx + 0x800][0];
-				*fy = gteCoords[sy + 0x800][sx + 0x800][1];
+			unsigned int key = gteKey(sx, sy);
+			unsigned int slot = gteSlot(key);
+			int i;
+
+			for (i = 0; i < GTE_VTX_PROBE; i++) {
+				const gteVertex_t *v = &gteVertices[(slot + i) & GTE_VTX_MASK];
+
+				// expired slots may sit in front of live ones, only an empty one ends the chain
+				if (v->gen == 0)
+					break;
+				if (!gteLive(v) || v->key != key)
+					continue;
 
-				return 1;
+				if ((fabsf(v->x - sx) < 1.0) &&
+						(fabsf(v->y - sy) < 1.0)) {
+					*fx = v->x;
+					*fy = v->y;
+
+					return 1;
+				}
+				break;
 			}
 		}
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -21,6 +21,7 @@
 #define _GTE_ACCURACY_H_
 
 extern void resetGteVertices();
+extern void nextGteFrame();
 extern int getGteVertex(short sx, short sy, float *fx, float *fy);
 
 #endif // _GTE_ACCURACY_H_
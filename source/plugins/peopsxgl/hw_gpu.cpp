@@ -38,6 +38,7 @@ using namespace xegpu;
 #include "psemu_plugin_defs.h"
 #include "texture.h"
 #include "gte_accuracy.h"
+#include "cmd_ring.h"
 #include "GpuRenderer.h"
 
 #ifdef ENABLE_NLS
@@ -116,6 +117,7 @@ namespace xegpu {
 	int lClearOnSwap;
 	int lClearOnSwapColor;
 	BOOL bSkipNextFrame = FALSE;
+	static BOOL bPresent = TRUE; // gpu thread copy of bOutput
 	int iWinSize;
 
 	// possible psx display widths
@@ -471,7 +473,7 @@ void _updateDisplay(void) // UPDATE DISPLAY
 
 	if (peops_cfg.dwActFixes & 128) // special FPS limitation mode?
 	{
-		if (peops_cfg.bUseFrameLimit) PCFrameCap(); // -> ok, do it
+		if (peops_cfg.bUseFrameLimit && bPresent) PCFrameCap(); // -> ok, do it
 		if (peops_cfg.bUseFrameSkip)
 			PCcalcfps();
 	}
@@ -483,7 +485,15 @@ void _updateDisplay(void) // UPDATE DISPLAY
 	//----------------------------------------------------//
 	// main buffer swapping (well, or skip it)
 
-	if (peops_cfg.bUseFrameSkip) // frame skipping active ?
+	if (!bPresent) // run ahead frame ? drawn, never shown
+	{
+		bSkipNextFrame = FALSE;
+	} else if (fSpeed != 1.0f) // fast forward ?
+	{
+		if (!bSkipNextFrame && iDrawnSomething)
+			DoBufferSwap();
+		FastForwardSkip();
+	} else if (peops_cfg.bUseFrameSkip) // frame skipping active ?
 	{
 		if (!bSkipNextFrame) {
 			if (iDrawnSomething)
@@ -501,9 +511,11 @@ void _updateDisplay(void) // UPDATE DISPLAY
 		if (iDrawnSomething)
 			DoBufferSwap();
 
+		bSkipNextFrame = FALSE; // -> left over from fast forward
 	}
 
 	iDrawnSomething = 0;
+	nextGteFrame(); // gte vertices older than this frame are stale now
 
 	//----------------------------------------------------//
 
@@ -587,7 +599,7 @@ void _updateFrontDisplay(void) {
 	bFakeFrontBuffer = FALSE;
 	bRenderFrontBuffer = FALSE;
 
-	if (iDrawnSomething) {
+	if (iDrawnSomething && bPresent) {
 		DoBufferSwap();
 	}
 }
@@ -1835,7 +1847,9 @@ ENDVRAM:
 
 			if (gpuDataP == gpuDataC) {
 				gpuDataC = gpuDataP = 0;
-				primTableJ[gpuCommand]((unsigned char *) gpuDataM);
+				if (bSkipNextFrame && fSpeed != 1.0f) // fast forward: vram transfers and state only
+					primTableSkip[gpuCommand]((unsigned char *) gpuDataM);
+				else primTableJ[gpuCommand]((unsigned char *) gpuDataM);
 
 				if (dwEmuFixes & 0x0001 || peops_cfg.dwActFixes & 0x20000) // hack for emulating "gpu busy" in some games
 					iFakePrimBusy = 4;
@@ -1908,22 +1922,23 @@ static volatile bool running=false;
 
 #define TW_RING_MAX_COUNT (128*1024)
 
-#define tw_ring_count(str) ((u32)abs((str[1]%TW_RING_MAX_COUNT)-(str[0]%TW_RING_MAX_COUNT)))
-#define tw_read_idx tw_idx[0]
-#define tw_write_idx tw_idx[1]
+// packet types on the gpu thread ring
+#define TW_DATA 0 // gpu data words, same order as GPUwriteDataMem gets them
+#define TW_CALL 1 // function to run on the gpu thread, in stream order
 
-static __attribute__((aligned(65536))) u32 tw_ring[TW_RING_MAX_COUNT];
+#define TW_PARK_TICKS (PPC_TIMEBASE_FREQ / 10000) // idle gpu thread rechecks 'running' every 100us
 
-static volatile  __attribute__((aligned(128)))  u64 tw_idx[2] = {0,0};
+static __attribute__((aligned(65536))) u32 tw_ring_buf[TW_RING_MAX_COUNT];
 
-static volatile bool tw_working=false;
-static volatile bool call_pending=false;
+static CmdRing tw_ring;
 
-static volatile void (*call_function)()=NULL;
+static volatile u32 tw_calls_queued = 0;
+static volatile u32 tw_calls_done = 0;
 
 static  __attribute__((aligned(256)))  u8 thread_stack[0x100000];
 
 #include <ppc/register.h>
+#include <ppc/timebase.h>
 #include <xenon_soc/xenon_power.h>
 #include "3DMath.h"
 
@@ -1933,44 +1948,54 @@ static void WaitForGpuThread(bool wait_tw_working) {
 	
     if(threaded_gpu)
     {
-        while(call_pending) asm volatile("db16cyc");
-        
         if(wait_tw_working)
-            while(tw_working||tw_ring_count(tw_idx)>0) asm volatile("db16cyc");
+            CmdRingDrain(&tw_ring); // everything queued so far is done, calls included
+        else
+            while(tw_calls_done!=tw_calls_queued) asm volatile("db16cyc");
     }
 }
 
 static void GpuThread() {
 	
-    u64  __attribute__((aligned(128))) lidx[2];
-    vector float vt;
+    u32 hdr,len,off,n;
+    u32 * p;
     
 	while(running)
 	{
-        LOAD_ALIGNED_VECTOR(vt,tw_idx); // for atomicness
-        STORE_ALIGNED_VECTOR(vt,lidx);
+        if(!CmdRingWaitData(&tw_ring,TW_PARK_TICKS,&hdr))
+            continue;
+
+        len=CMDRING_LEN(hdr);
 
-        if(tw_ring_count(lidx)!=0)
+        switch(CMDRING_TYPE(hdr))
         {
-            u32 ri=lidx[0]%TW_RING_MAX_COUNT;
-            u32 rc=tw_ring_count(lidx);
-            
-            u32 chunk=min(rc,(TW_RING_MAX_COUNT-ri));
-            u32 * chunk_start=&tw_ring[ri];
-			
-            tw_working=true;
-
-            _GPUwriteDataMem(chunk_start,chunk);
-            
-            tw_read_idx+=chunk;
-            
-            tw_working=false;
+            case TW_DATA:
+                for(off=0;off<len;off+=n)
+                {
+                    n=CmdRingSpan(&tw_ring,off,len-off,&p);
+                    _GPUwriteDataMem(p,n);
+                }
+                break;
+
+            case TW_CALL:
+            {
+                u32 w[2]={0,0};
+                void (*call)();
+
+                for(off=0;off<len && off<2;off++)
+                {
+                    CmdRingSpan(&tw_ring,off,1,&p);
+                    w[off]=*p;
+                }
+                memcpy(&call,w,sizeof(call));
+
+                (*call)();
+                tw_calls_done++;
+                break;
+            }
         }
-        else if(call_pending)
-        {
-            (*call_function)();
-            call_pending=false;
-		}
+
+        CmdRingRetire(&tw_ring,hdr);
 	}
 }
 
@@ -1978,11 +2003,17 @@ void endGpuThread() {
 	
 	running=false;
     while(xenon_is_thread_task_running(4));
+
+    if(threaded_gpu)
+        CmdRingReport(&tw_ring,"gpu ring");
 }
 
 void initGpuThread() {
 	
 	running=true;
+
+    CmdRingInit(&tw_ring,tw_ring_buf,TW_RING_MAX_COUNT);
+    tw_calls_queued=tw_calls_done=0;
     
 	if (threaded_gpu)
 		xenon_run_thread_task(4, &thread_stack[sizeof (thread_stack) - 0x1000], (void*)GpuThread);
@@ -2014,12 +2045,22 @@ EXTERN long CALLBACK GPUdmaChain(uint32_t *baseAddrL, uint32_t addr) {
 		dmaMem = addr + 4;
 
 		if (count > 0){
-            GPUwriteDataMem(&baseAddrL[dmaMem >> 2],count);
+            if(threaded_gpu)
+            {
+                // one packet for the whole chain, handed over in CmdRing sized batches
+                if(!tw_ring.isopen) CmdRingBegin(&tw_ring,TW_DATA);
+                CmdRingAppend(&tw_ring,&baseAddrL[dmaMem >> 2],count);
+            }
+            else
+                GPUwriteDataMem(&baseAddrL[dmaMem >> 2],count);
         }
 
 		addr = GETLE32(&baseAddrL[addr >> 2])&0xffffff;
 	} while (addr != 0xffffff);
 
+	if(threaded_gpu)
+		CmdRingCommit(&tw_ring);
+
 	GPUIsIdle;
 
 	return 0;
@@ -2043,29 +2084,27 @@ void updateFrontDisplay(void) {
 #endif	
 }
 
+static void _outputOn(void) {
+	bPresent = TRUE;
+}
+
+static void _outputOff(void) {
+	bPresent = FALSE;
+}
+
+// main emu: run ahead frames are emulated but not shown
+EXTERN void CALLBACK GPUsetOutput(int on) {
+	bOutput = on;
+	GPUthreadedCall(on ? _outputOn : _outputOff);
+}
+
 EXTERN void CALLBACK GPUwriteDataMem(uint32_t *pMem, int iSize){
 	
 //	printf("GPUwriteDataMem sz %d pir %d\n",iSize,mfspr(pir));
 	
 	if(threaded_gpu)
 	{
-        u32 size=iSize;		
-		u32 * lda=pMem;
-        u32 wi=tw_write_idx;
-
-        while(size>TW_RING_MAX_COUNT-tw_ring_count(tw_idx)) asm volatile("db16cyc");
-    
-        while((lda-pMem)<iSize)
-        {
-            u32 * d =&tw_ring[wi%TW_RING_MAX_COUNT];
-			
-			*d=*lda;
-
-            ++wi;
-            ++lda;
-        }
-
-        tw_write_idx+=size;
+        CmdRingPush(&tw_ring,TW_DATA,pMem,iSize);
 	}
 	else
 	{
@@ -2076,12 +2115,18 @@ EXTERN void CALLBACK GPUwriteDataMem(uint32_t *pMem, int iSize){
 
 void GPUthreadedCall(void (*call)())
 {
-	WaitForGpuThread(false);
+	WaitForGpuThread(false); // at most one call in flight, keeps us a frame ahead at most
 	
     if(threaded_gpu)
     {
-        call_function=(volatile void (*)())call;
-        if((void*)call) call_pending=true;
+        if((void*)call)
+        {
+            u32 w[2]={0,0};
+            memcpy(w,&call,sizeof(call));
+
+            tw_calls_queued++;
+            CmdRingPush(&tw_ring,TW_CALL,w,(sizeof(call)+3)/4);
+        }
     }
     else
     {
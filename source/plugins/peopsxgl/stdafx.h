@@ -108,6 +108,8 @@ typedef void GLvoid;
 //new
 #define GPUvBlank               HW_GPUvBlank
 #define GPUvisualVibration      HW_GPUvisualVibration
+#define GPUsetSpeed             HW_GPUsetSpeed
+#define GPUsetOutput            HW_GPUsetOutput
 #endif
 
 
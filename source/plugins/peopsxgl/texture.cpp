@@ -163,6 +163,30 @@ unsigned short CLUTYMASK = 0x1ff;
 unsigned short MAXSORTTEX = 196;
 }
 
+////////////////////////////////////////////////////////////////////////
+// sub cache hints: the slot last used for (texture mode, tpage, clut,
+// texture rect), so a sprite drawn again skips the scan of its list.
+// This is no full index: a miss still walks the list, the cache keeps
+// rewriting ClutID and pos in too many places to keep one exact. Every
+// hint is checked against its slot before use, a stale one just misses.
+////////////////////////////////////////////////////////////////////////
+
+#define SUBSINDEXSIZE 4096
+#define SUBSINDEXMASK (SUBSINDEXSIZE-1)
+
+static textureSubCacheEntryS * pscSubtexIndex[SUBSINDEXSIZE];
+
+static inline textureSubCacheEntryS ** SubSIndexSlot(int TextureMode, int Page, uint32_t ClutID, uint32_t Pos) {
+    uint32_t h = ClutID ^ (Page << 24) ^ (TextureMode << 30);
+    h = (h * 0x9e3779b1) ^ Pos;
+    h *= 0x9e3779b1;
+    return &pscSubtexIndex[(h >> 20) & SUBSINDEXMASK];
+}
+
+static inline void SubSIndexReset(void) {
+    memset(pscSubtexIndex, 0, sizeof (pscSubtexIndex));
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Texture color conversions... all my ASM funcs are removed for easier
 // porting... and honestly: nowadays the speed gain would be pointless
@@ -486,6 +510,7 @@ void InitializeTextureStore() {
     }
 
     memset(vertex, 0, 4 * sizeof (OGLVertex)); // init vertices
+    SubSIndexReset();
 
     gTexName = 0; // init main tex name
 
@@ -605,6 +630,7 @@ void ResetTextureArea(BOOL bDelTex) {
             (tss + SOFFC)->pos.l = 0;
             (tss + SOFFD)->pos.l = 0;
         }
+    SubSIndexReset();
 
     for (i = 0; i < iSortTexCnt; i++) {
         lu = pxSsubtexLeft[i];
@@ -874,6 +900,7 @@ unsigned char * CheckTextureInSubSCache(int TextureMode, uint32_t GivenClutId, u
     EXLong * ul = 0, * uls;
     EXLong rfree;
     unsigned char cXAdj, cYAdj;
+    textureSubCacheEntryS ** pIndex;
 
     npos.l = GETLE32((uint32_t *) & gl_ux[4]);
 
@@ -885,32 +912,44 @@ unsigned char * CheckTextureInSubSCache(int TextureMode, uint32_t GivenClutId, u
 
     iMax = tsg->pos.l;
 
-    if (iMax) {
-        i = iMax;
-        tsb = tsg + 1;
-        do {
-            if (GivenClutId == tsb->ClutID &&
-                    (INCHECK(tsb->pos, npos))) {
-                {
-                    cx = tsb->pos._3 - tsb->posTX;
-                    cy = tsb->pos._1 - tsb->posTY;
-
-                    gl_ux[0] -= cx;
-                    gl_ux[1] -= cx;
-                    gl_ux[2] -= cx;
-                    gl_ux[3] -= cx;
-                    gl_vy[0] -= cy;
-                    gl_vy[1] -= cy;
-                    gl_vy[2] -= cy;
-                    gl_vy[3] -= cy;
-
-                    ubOpaqueDraw = tsb->Opaque;
-                    *pCache = tsb->cTexID;
-                    return NULL;
+    pIndex = SubSIndexSlot(TextureMode, GlobalTexturePage, GivenClutId, npos.l);
+    tsb = *pIndex;
+
+    if (!(tsb && tsb > tsg && tsb <= tsg + iMax && // index hint still in the active list?
+            GivenClutId == tsb->ClutID &&
+            (INCHECK(tsb->pos, npos)))) {
+        tsb = NULL;
+
+        if (iMax) {
+            i = iMax;
+            tsx = tsg + 1;
+            do {
+                if (GivenClutId == tsx->ClutID &&
+                        (INCHECK(tsx->pos, npos))) {
+                    tsb = *pIndex = tsx;
+                    break;
                 }
-            }
-            tsb++;
-        } while (--i);
+                tsx++;
+            } while (--i);
+        }
+    }
+
+    if (tsb) {
+        cx = tsb->pos._3 - tsb->posTX;
+        cy = tsb->pos._1 - tsb->posTY;
+
+        gl_ux[0] -= cx;
+        gl_ux[1] -= cx;
+        gl_ux[2] -= cx;
+        gl_ux[3] -= cx;
+        gl_vy[0] -= cy;
+        gl_vy[1] -= cy;
+        gl_vy[2] -= cy;
+        gl_vy[3] -= cy;
+
+        ubOpaqueDraw = tsb->Opaque;
+        *pCache = tsb->cTexID;
+        return NULL;
     }
     //----------------------------------------------------//
 
@@ -1103,6 +1142,7 @@ ENDLOOP:
                     (tsb + SOFFC)->pos.l = 0;
                     (tsb + SOFFD)->pos.l = 0;
                 }
+            SubSIndexReset();
             for (i = 0; i < iSortTexCnt; i++) {
                 ul = pxSsubtexLeft[i];
                 ul->l = 0;
@@ -1151,6 +1191,7 @@ ENDLOOP:
 
     tsx->ClutID = GivenClutId;
     tsx->posTX = rfree._3;
+    *pIndex = tsx;
     tsx->posTY = rfree._1;
 
     cx = gl_ux[7] - rfree._3;
@@ -0,0 +1,136 @@
+/***************************************************************************
+                          adpcm.c  -  description
+                             -------------------
+    decoded ADPCM block cache
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+//*************************************************************************//
+// Instrument samples get decoded over and over again (every loop, every
+// retrigger). A 16 byte ADPCM block always decodes to the same 28 samples
+// for the same input predictor state, so we keep decoded blocks keyed by
+// (spu ram address, s_1, s_2).
+//
+// Invalidation: every write to spu ram bumps a global stamp and records it
+// for the touched 16 byte blocks. A cache entry is only valid when it got
+// filled after the last write to its block.
+//*************************************************************************//
+
+#include "config.h"
+#include "stdafx.h"
+
+#define _IN_ADPCM
+
+#include "externals.h"
+#include "adpcm.h"
+
+#define CACHE_BITS      12
+#define CACHE_ENTRIES   (1 << CACHE_BITS)
+#define SPU_BLOCKS      (0x80000 >> 4)
+
+typedef struct {
+    unsigned long  stamp;                               // global stamp at fill time, 0 = empty
+    unsigned short block;                               // spu ram address >> 4
+    short          s_1;                                 // predictor state the block was decoded with
+    short          s_2;
+    short          smp[28];
+} ADPCMCacheEntry;
+
+static ADPCMCacheEntry adpcmCache[CACHE_ENTRIES] ALIGNED;
+static unsigned long blockStamp[SPU_BLOCKS];
+static volatile unsigned long ulStamp = 1;
+
+unsigned long ulADPCMCacheHits = 0;
+unsigned long ulADPCMCacheMisses = 0;
+
+static inline unsigned int CacheSlot(unsigned long block, int s_1, int s_2) {
+    unsigned int h = block * 0x9e3779b1 ^ (unsigned short) s_1 * 0x85ebca6b ^ (unsigned short) s_2;
+    return (h >> (32 - CACHE_BITS)) & (CACHE_ENTRIES - 1);
+}
+
+void ADPCMCacheInit(void) {
+    memset(adpcmCache, 0, sizeof (adpcmCache));
+    memset(blockStamp, 0, sizeof (blockStamp));
+    ulStamp = 1;
+    ulADPCMCacheHits = ulADPCMCacheMisses = 0;
+}
+
+void ADPCMCacheInvalidate(unsigned long addr, unsigned long bytes) {
+    unsigned long b, end;
+    unsigned long stamp;
+
+    if (!bytes) return;
+
+    stamp = ++ulStamp;
+    end = ((addr + bytes - 1) & 0x7ffff) >> 4;
+    b = (addr & 0x7ffff) >> 4;
+
+    for (;;) {
+        blockStamp[b] = stamp;
+        if (b == end) break;
+        b = (b + 1) & (SPU_BLOCKS - 1);
+    }
+}
+
+void ADPCMCacheInvalidateAll(void) {
+    unsigned long b, stamp = ++ulStamp;
+
+    for (b = 0; b < SPU_BLOCKS; b++)
+        blockStamp[b] = stamp;
+}
+
+// read before decoding, so a write racing with the decode invalidates the result
+
+unsigned long ADPCMCacheStamp(void) {
+    return ulStamp;
+}
+
+int ADPCMCacheLookup(unsigned long addr, int s_1, int s_2, int * SB) {
+    unsigned long block = (addr & 0x7ffff) >> 4;
+    ADPCMCacheEntry * e = &adpcmCache[CacheSlot(block, s_1, s_2)];
+    int i;
+
+    if (e->stamp == 0 || e->block != block || e->s_1 != s_1 || e->s_2 != s_2 ||
+            e->stamp < blockStamp[block]) {
+        ulADPCMCacheMisses++;
+        return 0;
+    }
+
+    for (i = 0; i < 28; i++)
+        SB[i] = e->smp[i];
+
+    ulADPCMCacheHits++;
+    return 1;
+}
+
+void ADPCMCacheStore(unsigned long addr, int s_1, int s_2, const int * SB, unsigned long stamp) {
+    unsigned long block = (addr & 0x7ffff) >> 4;
+    ADPCMCacheEntry * e = &adpcmCache[CacheSlot(block, s_1, s_2)];
+    int i;
+
+    e->stamp = 0; // entry is being rewritten
+    e->block = block;
+    e->s_1 = s_1;
+    e->s_2 = s_2;
+    for (i = 0; i < 28; i++)
+        e->smp[i] = SB[i];
+    e->stamp = stamp;
+}
+
+void ADPCMCacheReport(void) {
+    unsigned long total = ulADPCMCacheHits + ulADPCMCacheMisses;
+
+    printf("ADPCM cache: %lu hits, %lu misses (%lu%%), %u KB\r\n",
+            ulADPCMCacheHits, ulADPCMCacheMisses,
+            total ? ulADPCMCacheHits * 100 / total : 0,
+            (unsigned int) (sizeof (adpcmCache) + sizeof (blockStamp)) / 1024);
+}
@@ -30,10 +30,12 @@
 
 #include "externals.h"
 #include "registers.h"
+#include "adpcm.h"
 
 
 
 #include <stdio.h>
+#include <string.h>
 extern FILE *fp_spu_log;
 
 
@@ -64,8 +66,27 @@ extern "C" unsigned short CALLBACK SPUreadDMA(void) {
 
 extern void (CALLBACK *irqCallback)(void); // func of main emu, called on spu irq
 
+// the halfword loops called Check_IRQ for every address they touched, the
+// irq address can only match one of them
+
+static void Check_IRQRange(unsigned long addr, unsigned long bytes) {
+    unsigned long irq = pSpuIrq - spuMemC;
+
+    if (irq - addr < bytes && !((irq - addr) & 1))
+        Check_IRQ(irq, 0);
+}
+
+// halfwords a transfer moves before it runs into the end of spu ram
+
+static int DMAClip(int iSize) {
+    int left = spuAddr < 0x80000 ? (0x80000 - spuAddr) >> 1 : 0;
+
+    if (iSize > left) iSize = left;
+    return iSize > 0 ? iSize : 0;
+}
+
 extern "C" void CALLBACK SPUreadDMAMem(unsigned short * pusPSXMem, int iSize) {
-    int i;
+    int n;
     
 
 #ifdef SPU_LOG
@@ -89,21 +110,15 @@ extern "C" void CALLBACK SPUreadDMAMem(unsigned short * pusPSXMem, int iSize) {
     spuStat |= STAT_DATA_BUSY;
 
 
-    for (i = 0; i < iSize; i++) {
-        Check_IRQ(spuAddr, 0);
-
-        // guesswork
-        //if( (spuCtrl & CTRL_DMA_F) == CTRL_DMA_R ) {
-        {
-            *pusPSXMem++ = spuMem[spuAddr >> 1]; // spu addr got by writeregister
-        }
-        spuAddr += 2; // inc spu addr
+    // Guesswork based on Vib Ribbon (dma-w)
+    // - stops at the end of spu ram, creates a dma hang?
+    n = DMAClip(iSize);
 
+    Check_IRQRange(spuAddr, n * 2);
 
-        // Guesswork based on Vib Ribbon (dma-w)
-        // - creates a dma hang?
-        if (spuAddr > 0x7ffff) break;
-    }
+    // both sides hold psx halfwords, nothing to swap
+    memcpy(pusPSXMem, &spuMem[spuAddr >> 1], n * 2);
+    spuAddr += n * 2;
 
     iSpuAsyncWait = 0;
 
@@ -129,6 +144,7 @@ extern "C" void CALLBACK SPUreadDMAMem(unsigned short * pusPSXMem, int iSize) {
 extern "C" void CALLBACK SPUwriteDMA(unsigned short val) {
     
     spuMem[spuAddr >> 1] = val; // spu addr got by writeregister
+    ADPCMCacheInvalidate(spuAddr, 2);
 
     spuAddr += 2; // inc spu addr
     if (spuAddr > 0x7ffff) spuAddr = 0; // wrap
@@ -142,7 +158,7 @@ extern "C" void CALLBACK SPUwriteDMA(unsigned short val) {
 ////////////////////////////////////////////////////////////////////////
 
 extern "C" void CALLBACK SPUwriteDMAMem(unsigned short * pusPSXMem, int iSize) {
-    int i;
+    int n;
     
 
 #ifdef SPU_LOG
@@ -167,20 +183,14 @@ extern "C" void CALLBACK SPUwriteDMAMem(unsigned short * pusPSXMem, int iSize) {
     spuStat |= STAT_DATA_BUSY;
 
 
-    for (i = 0; i < iSize; i++) {
-        Check_IRQ(spuAddr, 0);
-
-        // guesswork
-        //if( (spuCtrl & CTRL_DMA_F) == CTRL_DMA_W ) {
-        {
-            spuMem[spuAddr >> 1] = *pusPSXMem++; // spu addr got by writeregister
-        }
-        spuAddr += 2; // inc spu addr
+    // Vib Ribbon - stop transfer (reverb playback)
+    n = DMAClip(iSize);
 
+    Check_IRQRange(spuAddr, n * 2);
 
-        // Vib Ribbon - stop transfer (reverb playback)
-        if (spuAddr > 0x7ffff) break;
-    }
+    memcpy(&spuMem[spuAddr >> 1], pusPSXMem, n * 2);
+    ADPCMCacheInvalidate(spuAddr, n * 2);
+    spuAddr += n * 2;
 
     iSpuAsyncWait = 0;
 
@@ -43,6 +43,7 @@ email                : BlackDove@addcom.de
 #include "regs.h"
 #include "dsoundoss.h"
 #include "freeze.h"
+#include "adpcm.h"
 
 ////////////////////////////////////////////////////////////////////////
 // freeze structs
@@ -76,7 +77,8 @@ extern "C" long CALLBACK SPUfreeze(unsigned long ulFreezeMode,SPUFreeze_t * pF)
 		
 		if(ulFreezeMode==2) return 1;                       // info mode? ok, bye
 		// save mode:
-		RemoveTimer();                                      // stop timer
+		if(bSpuOutput) RemoveTimer();                       // stop timer
+		else PauseMixer();                                  // run ahead: hold it, the sound goes on
 
 		memcpy(pF->cSPURam,spuMem,0x80000);                 // copy common infos
 		memcpy(pF->cSPUPort,regArea,0x200);
@@ -118,7 +120,8 @@ extern "C" long CALLBACK SPUfreeze(unsigned long ulFreezeMode,SPUFreeze_t * pF)
 				pFO->s_chan[i].pLoop-=(unsigned long)spuMemC;
 		}
 		
-		SetupTimer();                                       // sound processing on again
+		if(bSpuOutput) SetupTimer();                        // sound processing on again
+		else ResumeMixer();
 		
 		return 1;
 		//--------------------------------------------------//
@@ -133,9 +136,11 @@ extern "C" long CALLBACK SPUfreeze(unsigned long ulFreezeMode,SPUFreeze_t * pF)
 		return 0;
 #endif
 	
-	RemoveTimer();                                        // we stop processing while doing the save!
+	if(bSpuOutput) RemoveTimer();                         // we stop processing while doing the save!
+	else PauseMixer();                                    // run ahead: until all is reset below
 	
 	memcpy(spuMem,pF->cSPURam,0x80000);                   // get ram
+	ADPCMCacheInvalidateAll();
 	memcpy(regArea,pF->cSPUPort,0x200);
 
 	if(pF->xaS.nsamples<=4032)                            // start xa again
@@ -174,7 +179,7 @@ extern "C" long CALLBACK SPUfreeze(unsigned long ulFreezeMode,SPUFreeze_t * pF)
 		SPUwriteRegister(0x1f801c0a+(i<<4),regArea[ ((i<<4)+0x0a)>>1 ] );
   }
 	
-	SetupTimer();                                         // start sound processing again
+	if(bSpuOutput) SetupTimer();                          // start sound processing again
 	
 	
 	// stop load crackling
@@ -205,6 +210,7 @@ extern "C" long CALLBACK SPUfreeze(unsigned long ulFreezeMode,SPUFreeze_t * pF)
 	memset( out_gauss_window, 0, 8*4 );
 	memset( xa_gauss_window, 0, 8*4 );
 
+	if(!bSpuOutput) ResumeMixer();                        // run ahead: mixing goes on from here
 	
 	return 1;
 }
@@ -45,6 +45,7 @@ email                : BlackDove@addcom.de
 #include "registers.h"
 #include "regs.h"
 #include "reverb.h"
+#include "adpcm.h"
 
 /*
 // adsr time values (in ms) by James Higgs ... see the end of
@@ -282,6 +283,7 @@ extern "C" void CALLBACK SPUwriteRegister(unsigned long reg, unsigned short val)
 		Check_IRQ( spuAddr, 0 );
 		
 		spuMem[spuAddr>>1] = val;
+		ADPCMCacheInvalidate(spuAddr, 2);
 		spuAddr+=2;
 		
 		
@@ -106,6 +106,7 @@ email 							 : BlackDove@addcom.de
 #include "record.h"
 #include "resource.h"
 #include "registers.h"
+#include "adpcm.h"
 
 
 #include <xenon_soc/xenon_power.h>
@@ -213,6 +214,9 @@ long total_apu_cycles;
 long APU_run = 10;
 
 int framelimiter = 1;
+int bSpuOutput = 1; // 0: run ahead, mixed but not heard
+static volatile int bMixerPause = 0; // emu: the mixer thread has to hold
+static volatile int bMixerParked = 0; // mixer: holding, the spu state is the emu's
 
 
 static unsigned char thread_stack[0x10000];
@@ -1197,6 +1201,24 @@ int iSpuAsyncWait = 0;
 
 extern int old_irq;
 
+// fast forward: 1 normal speed, 0 unlimited
+static float fSpeed = 1.0f;
+static float fDecimatePos = 0.0f;
+
+// keep every fSpeed'th sample of a mixed block, the sound keeps up with the
+// emulation (at a higher pitch) instead of piling up until blocks get dropped
+
+static long DecimateBlock(unsigned char *block, long bytes) {
+    uint32_t *frames = (uint32_t *) block; // 16 bit stereo
+    int count = bytes / output_samplesize, out = 0;
+
+    for (; fDecimatePos < count; fDecimatePos += fSpeed)
+        frames[out++] = frames[(int) fDecimatePos];
+    fDecimatePos -= count;
+
+    return out * output_samplesize;
+}
+
 
 #ifdef _WINDOWS
 static VOID CALLBACK MAINProc(UINT nTimerId, UINT msg, DWORD dwUser, DWORD dwParam1, DWORD dwParam2)
@@ -1213,10 +1235,23 @@ static void *MAINThread(void *arg)
     int bIRQReturn = 0;
     SPUCHAN * pChannel;
     int decoded_voice;
+    int cache_s_1, cache_s_2;
+    unsigned long stamp;
 
 
     while (!bEndThread) // until we are shutting down
     {
+        if (bMixerPause) // emu works on the spu state? wait between two blocks
+        {
+            __sync_synchronize(); // -> what got mixed is visible first
+            bMixerParked = 1;
+            while (bMixerPause && !bEndThread)
+                usleep(100L);
+            bMixerParked = 0;
+            __sync_synchronize();
+            continue;
+        }
+
         //--------------------------------------------------//
         // ok, at the beginning we are looking if there is
         // enuff free place in the dsound/oss buffer to
@@ -1233,9 +1268,9 @@ static void *MAINThread(void *arg)
             } else iSecureStart = 0; // 0: no new channel should start
 
 
-            while (!iSecureStart && !bEndThread && // no new start? no thread end?
-                    // and still enuff data in sound buffer?
-                    (SoundGetBytesBuffered() > SOUNDLEN(5 + LATENCY))) {
+            while (!iSecureStart && !bEndThread && !bMixerPause && // no new start? no thread end? no pause?
+                    // and the output ring is still above its low-water mark?
+                    !SoundLowWater()) {
                 iSecureStart = 0; // reset secure
 
 #ifdef _WINDOWS
@@ -1249,7 +1284,11 @@ static void *MAINThread(void *arg)
                 Sleep(PAUSE_W); // sleep for x ms (win)
 #else
                 if (iUseTimer) return 0; // linux no-thread mode? bye
+#ifdef LIBXENON
+                SoundWaitLowWater(); // else wait for the backend to ask for more
+#else
                 usleep(PAUSE_L); // else sleep for x ms (linux)
+#endif
 #endif
 
                 if (dwNewChannel) iSecureStart = 1; // if a new channel kicks in (or, of course, sound buffer runs low), we will leave the loop
@@ -1446,7 +1485,21 @@ static void *MAINThread(void *arg)
 
                             // -------------------------------------- //
 
-                            for (nSample = 0; nSample < 28; start++) {
+                            // instrument loops: reuse the block if we decoded it from this state before
+                            if (pChannel->iSilent != 2 &&
+                                    ADPCMCacheLookup(start - 2 - spuMemC, s_1, s_2, pChannel->SB)) {
+                                s_1 = pChannel->SB[27];
+                                s_2 = pChannel->SB[26];
+                                start += 14;
+                                nSample = 28;
+                            } else {
+                                stamp = ADPCMCacheStamp();
+                                cache_s_1 = s_1;
+                                cache_s_2 = s_2;
+                                nSample = 0;
+                            }
+
+                            for (; nSample < 28; start++) {
                                 int t1, t2;
 
 
@@ -1500,6 +1553,9 @@ static void *MAINThread(void *arg)
                                 s_2 = s_1;
                                 s_1 = fa;
                                 pChannel->SB[nSample++] = fa;
+
+                                if (nSample == 28)
+                                    ADPCMCacheStore(start - 15 - spuMemC, cache_s_1, cache_s_2, pChannel->SB, stamp);
                             }
 
                             //////////////////////////////////////////// irq check
@@ -2268,6 +2324,7 @@ GOON:
 
         if (iCycle >= UPLOADSIZE) {
             int test;
+            long bytes;
 
             //- zn qsound mixer callback ----------------------//
 
@@ -2286,7 +2343,7 @@ GOON:
             //-------------------------------------------------//
 
             test = SoundGetBytesBuffered();
-            if (framelimiter == 1) {
+            if (framelimiter == 1 && fSpeed == 1.0f && bSpuOutput) { // never waits in fast forward
                 if (iUseTimer == 3) {
                     while (test > SOUNDLEN(13 + LATENCY)) {
 #ifdef _WINDOWS
@@ -2306,11 +2363,13 @@ GOON:
             }
 
 
-            // overflow check - likely fast-forward
-            if (test < TESTMAX)
-                SoundFeedStreamData((unsigned char*) pSpuBuffer,
-                    ((unsigned char *) pS)-
-                    ((unsigned char *) pSpuBuffer));
+            bytes = ((unsigned char *) pS)-((unsigned char *) pSpuBuffer);
+            if (fSpeed > 1.0f)
+                bytes = DecimateBlock((unsigned char *) pSpuBuffer, bytes);
+
+            // overflow check - unlimited fast-forward
+            if (test < TESTMAX && bSpuOutput)
+                SoundFeedStreamData((unsigned char*) pSpuBuffer, bytes);
 #if 0
             else
                 SoundRecordStreamData((unsigned char*) pSpuBuffer,
@@ -2583,6 +2642,27 @@ void RemoveTimer(void) {
     bSpuInit = 0;
 }
 
+////////////////////////////////////////////////////////////////////////
+// PAUSEMIXER: hold the mixer thread without ending it, the output stream
+// and all the spu state stay as they are. For changes of that state from
+// the emu thread that are too big to race with the mixing
+////////////////////////////////////////////////////////////////////////
+
+void PauseMixer(void) {
+    if (iUseTimer || !bSpuInit) return; // -> mixed from SPUasync on the emu thread, or not at all
+
+    bMixerPause = 1;
+    __sync_synchronize();
+    while (!bMixerParked && !bThreadEnded)
+        usleep(100L);
+    __sync_synchronize();
+}
+
+void ResumeMixer(void) {
+    __sync_synchronize(); // -> the new state is visible first
+    bMixerPause = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // SETUPSTREAMS: init most of the spu buffers
 ////////////////////////////////////////////////////////////////////////
@@ -2654,6 +2734,7 @@ extern "C" long CALLBACK SPUinit(void) {
     memset((void *) s_chan, 0, MAXCHAN * sizeof (SPUCHAN));
     memset((void *) &rvb, 0, sizeof (REVERBInfo));
     InitADSR();
+    ADPCMCacheInit();
 
 
 
@@ -2771,6 +2852,7 @@ extern "C" long CALLBACK SPUclose(void) {
     RemoveTimer(); // no more feeding
     RemoveSound(); // no more sound handling
     RemoveStreams(); // no more streaming
+    ADPCMCacheReport();
 
     return 0;
 }
@@ -2853,3 +2935,87 @@ extern "C" void CALLBACK SPUsetframelimit(int option) {
     printf("SPUsetframelimit\r\n");
     framelimiter = option;
 }
+
+extern "C" void CALLBACK SPUsetSpeed(float speed) {
+    fSpeed = speed;
+    fDecimatePos = 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////
+// run ahead: the emu mixes frames it throws away again and reloads the
+// spu from a freeze. Everything already on its way to the speakers (the
+// unfed part of the mixing buffer, the xa/cdda streams) is kept out of
+// that and put back when the output is turned on again.
+////////////////////////////////////////////////////////////////////////
+
+static struct {
+    unsigned char * block;
+    long blockBytes;
+    int cycle;
+    long cpuCycles;
+    unsigned long * xaFeed, * xaPlay;
+    unsigned long xaRepeat, xaLastVal;
+    unsigned int * cddaFeed, * cddaPlay;
+    unsigned long cddaRepeat;
+    xa_decode_t * xap;
+    int xaLC, xaRC, cdLC, cdRC;
+    int outGauss[8], xaGauss[8];
+} spuOut;
+
+extern "C" void CALLBACK SPUsetOutput(int on) {
+    if (!on == !bSpuOutput) return;
+
+    if (!on) {
+        if (!spuOut.block)
+            spuOut.block = (unsigned char *) malloc(44100 * 8); // size of the mixing buffer
+        if (!spuOut.block) return; // -> stays audible
+
+        PauseMixer(); // -> pS, iCycle and the streams stand still while we copy them
+
+        spuOut.blockBytes = ((unsigned char *) pS)-((unsigned char *) pSpuBuffer);
+        memcpy(spuOut.block, pSpuBuffer, spuOut.blockBytes);
+        spuOut.cycle = iCycle;
+        spuOut.cpuCycles = cpu_cycles;
+        spuOut.xaFeed = XAFeed;
+        spuOut.xaPlay = XAPlay;
+        spuOut.xaRepeat = XARepeat;
+        spuOut.xaLastVal = XALastVal;
+        spuOut.cddaFeed = CDDAFeed;
+        spuOut.cddaPlay = CDDAPlay;
+        spuOut.cddaRepeat = CDDARepeat;
+        spuOut.xap = xapGlobal;
+        spuOut.xaLC = lastxa_lc;
+        spuOut.xaRC = lastxa_rc;
+        spuOut.cdLC = lastcd_lc;
+        spuOut.cdRC = lastcd_rc;
+        memcpy(spuOut.outGauss, out_gauss_window, sizeof (spuOut.outGauss));
+        memcpy(spuOut.xaGauss, xa_gauss_window, sizeof (spuOut.xaGauss));
+
+        bSpuOutput = 0;
+        ResumeMixer();
+        return;
+    }
+
+    PauseMixer();
+    memcpy(pSpuBuffer, spuOut.block, spuOut.blockBytes);
+    pS = (short *) (pSpuBuffer + spuOut.blockBytes);
+    iCycle = spuOut.cycle;
+    cpu_cycles = spuOut.cpuCycles;
+    XAFeed = spuOut.xaFeed;
+    XAPlay = spuOut.xaPlay;
+    XARepeat = spuOut.xaRepeat;
+    XALastVal = spuOut.xaLastVal;
+    CDDAFeed = spuOut.cddaFeed;
+    CDDAPlay = spuOut.cddaPlay;
+    CDDARepeat = spuOut.cddaRepeat;
+    xapGlobal = spuOut.xap;
+    lastxa_lc = spuOut.xaLC;
+    lastxa_rc = spuOut.xaRC;
+    lastcd_lc = spuOut.cdLC;
+    lastcd_rc = spuOut.cdRC;
+    memcpy(out_gauss_window, spuOut.outGauss, sizeof (spuOut.outGauss));
+    memcpy(xa_gauss_window, spuOut.xaGauss, sizeof (spuOut.xaGauss));
+
+    bSpuOutput = 1;
+    ResumeMixer();
+}
@@ -0,0 +1,26 @@
+/***************************************************************************
+                          adpcm.h  -  description
+                             -------------------
+    decoded ADPCM block cache
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+void ADPCMCacheInit(void);
+void ADPCMCacheInvalidate(unsigned long addr, unsigned long bytes);
+void ADPCMCacheInvalidateAll(void);
+int  ADPCMCacheLookup(unsigned long addr, int s_1, int s_2, int * SB);
+void ADPCMCacheStore(unsigned long addr, int s_1, int s_2, const int * SB, unsigned long stamp);
+unsigned long ADPCMCacheStamp(void);
+void ADPCMCacheReport(void);
+
+extern unsigned long ulADPCMCacheHits;
+extern unsigned long ulADPCMCacheMisses;
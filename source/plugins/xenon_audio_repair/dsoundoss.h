@@ -31,6 +31,8 @@ void ClearSound(void);
 int SoundGetBytesBuffered(void);
 int SoundGetSamplesBuffered(void);
 void SoundFeedStreamData(unsigned char* pSound,long lBytes);
+int SoundLowWater(void);
+void SoundWaitLowWater(void);
 void ResetSound(void);
 void SoundRecordStreamData(unsigned char* pSound,long lBytes);
 
@@ -379,6 +379,9 @@ extern void (CALLBACK *irqCallback)(void);                  // func of main emu,
 
 extern int out_gauss_window[];
 extern int framelimiter;
+extern int bSpuOutput;
+extern unsigned long ulSoundUnderruns;
+extern unsigned long ulSoundOverruns;
 
 #endif
 
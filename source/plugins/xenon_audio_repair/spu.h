@@ -27,4 +27,6 @@
 
 void SetupTimer(void);
 void RemoveTimer(void);
+void PauseMixer(void);
+void ResumeMixer(void);
 extern "C" void CALLBACK SPUplayADPCMchannel(xa_decode_t *xap);
@@ -62,6 +62,8 @@
 #define SPUreadRegister			XRAUDIO_SPUreadRegister
 #define SPUfreeze				XRAUDIO_SPUfreeze
 #define SPUplayCDDAchannel      XRAUDIO_SPUplayCDDAchannel
+#define SPUsetSpeed             XRAUDIO_SPUsetSpeed
+#define SPUsetOutput            XRAUDIO_SPUsetOutput
 
 
 
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   44.1k -> 48k resamplers of the sound backend (xr_xenonsnd.cpp)        *
+ ***************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include <byteswap.h>
+#include "xr_resample.h"
+
+typedef int16_t s16;
+typedef int32_t s32;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+static s16 prevLastSample[2] = {0, 0};
+static unsigned int lin_pos = 0;                // next output position, in 1/160 input frames
+
+/*
+ * resamples pStereoSamples 
+ * (taken from http://pcsx2.googlecode.com/svn/trunk/plugins/zerospu2/zerospu2.cpp)
+ * output frame i sits between input frames i * 147 / 160 - 1 and the one
+ * after it; the position goes on from one call to the next, so the output
+ * keeps 160 frames for every 147 whatever the chunk size
+ */
+int ResampleLinear(const s16 *pStereoSamples, s32 oldsamples, s16 *pNewSamples) {
+    s32 newsampL, newsampR;
+    s32 i, old, rem, end = oldsamples * 160;
+
+    for (i = 0; lin_pos < (unsigned int) end; ++i, lin_pos += 147) {
+        old = (lin_pos / 160) * 2;
+        rem = lin_pos % 160;
+
+        if (old == 0) {
+            newsampL = prevLastSample[0] * (160 - rem) + pStereoSamples[0] * rem;
+            newsampR = prevLastSample[1] * (160 - rem) + pStereoSamples[1] * rem;
+        } else {
+            newsampL = pStereoSamples[old - 2] * (160 - rem) + pStereoSamples[old] * rem;
+            newsampR = pStereoSamples[old - 1] * (160 - rem) + pStereoSamples[old + 1] * rem;
+        }
+        pNewSamples[2 * i] = newsampL / 160;
+        pNewSamples[2 * i + 1] = newsampR / 160;
+    }
+    lin_pos -= end;
+    prevLastSample[0] = pStereoSamples[oldsamples * 2 - 2];
+    prevLastSample[1] = pStereoSamples[oldsamples * 2 - 1];
+    return i;
+}
+
+////////////////////////////////////////////////////////////////////////
+// polyphase FIR resampler, 44100 -> 48000 = 147 -> 160
+// output frame i sits at input position i * 147 / 160, so phase
+// (i * 147) % 160 selects one of 160 precomputed 16-tap filters
+////////////////////////////////////////////////////////////////////////
+
+#define RS_PHASES   160
+#define RS_STEP     147
+#define RS_TAPS     16
+#define RS_BLOCK    512                         // input frames per inner pass
+
+// taps are stored twice (h0 h0 h1 h1 ...) so they line up with interleaved L/R input
+static s16 rs_coef[RS_PHASES][RS_TAPS * 2] __attribute__ ((aligned(16)));
+static s16 rs_buf[(RS_BLOCK + RS_TAPS + 8) * 2] __attribute__ ((aligned(16)));
+static unsigned int rs_pos = 0;                 // next output position, in 1/160 input frames
+
+void ResampleInit(void) {
+    const double fc = 0.5 * 0.90;               // cutoff relative to 44.1k, ~19.8 kHz
+    double h[RS_TAPS], sum, t, w;
+    int p, k;
+
+    for (p = 0; p < RS_PHASES; p++) {
+        sum = 0;
+        for (k = 0; k < RS_TAPS; k++) {
+            t = k - (RS_TAPS / 2 - 1) - (double) p / RS_PHASES;
+            h[k] = (t == 0) ? 2 * fc : sin(2 * M_PI * fc * t) / (M_PI * t);
+            // blackman window over the tap span
+            w = (t + RS_TAPS / 2) / RS_TAPS;
+            h[k] *= 0.42 - 0.5 * cos(2 * M_PI * w) + 0.08 * cos(4 * M_PI * w);
+            sum += h[k];
+        }
+        for (k = 0; k < RS_TAPS; k++)
+            rs_coef[p][2 * k] = rs_coef[p][2 * k + 1] = (s16) floor(h[k] / sum * 32767.0 + 0.5);
+    }
+
+    memset(rs_buf, 0, sizeof (rs_buf));
+    prevLastSample[0] = prevLastSample[1] = 0;
+    lin_pos = 0;
+    rs_pos = 0;
+}
+
+static inline u32 rs_pack(s32 l, s32 r) {
+    l >>= 15; r >>= 15;
+    if (l > 32767) l = 32767; else if (l < -32768) l = -32768;
+    if (r > 32767) r = 32767; else if (r < -32768) r = -32768;
+    // byte swap for the little endian sound hw fused into the store
+    return bswap_32(((u32) (u16) l << 16) | (u16) r);
+}
+
+#ifdef __ALTIVEC__
+#include <altivec.h>
+
+static inline u32 rs_dot(const s16 *x, const s16 *c) {
+    vector unsigned char perm = vec_lvsl(0, x);
+    vector signed short v0 = vec_ld(0, x), v1 = vec_ld(16, x), v2 = vec_ld(32, x);
+    vector signed short v3 = vec_ld(48, x), v4 = vec_ld(64, x);
+    vector signed short x0 = vec_perm(v0, v1, perm), x1 = vec_perm(v1, v2, perm);
+    vector signed short x2 = vec_perm(v2, v3, perm), x3 = vec_perm(v3, v4, perm);
+    vector signed short c0 = vec_ld(0, c), c1 = vec_ld(16, c), c2 = vec_ld(32, c), c3 = vec_ld(48, c);
+    vector signed int zero = vec_splat_s32(0);
+    vector signed int l, r;
+    s32 out[8] __attribute__ ((aligned(16)));
+
+    // even lanes are left, odd lanes right
+    l = vec_add(vec_add(vec_mule(x0, c0), vec_mule(x1, c1)), vec_add(vec_mule(x2, c2), vec_mule(x3, c3)));
+    r = vec_add(vec_add(vec_mulo(x0, c0), vec_mulo(x1, c1)), vec_add(vec_mulo(x2, c2), vec_mulo(x3, c3)));
+    vec_st(vec_sums(l, zero), 0, out);
+    vec_st(vec_sums(r, zero), 16, out);
+
+    return rs_pack(out[3], out[7]);
+}
+
+#else
+
+static inline u32 rs_dot(const s16 *x, const s16 *c) {
+    s32 l = 0, r = 0;
+    int k;
+
+    for (k = 0; k < RS_TAPS * 2; k += 2) {
+        l += x[k] * c[k];
+        r += x[k + 1] * c[k + 1];
+    }
+    return rs_pack(l, r);
+}
+
+#endif
+
+int ResamplePolyphase(const s16 *in, int n, u32 *out) {
+    int done = 0, count, avail;
+
+    while (n > 0) {
+        count = n > RS_BLOCK ? RS_BLOCK : n;
+
+        // rs_buf = last RS_TAPS - 1 frames of history + new input
+        memcpy(&rs_buf[(RS_TAPS - 1) * 2], in, count * 4);
+        avail = RS_TAPS - 1 + count;
+
+        while ((rs_pos / RS_PHASES) + RS_TAPS <= (unsigned int) avail) {
+            out[done++] = rs_dot(&rs_buf[(rs_pos / RS_PHASES) * 2], rs_coef[rs_pos % RS_PHASES]);
+            rs_pos += RS_STEP;
+        }
+
+        rs_pos -= count * RS_PHASES;
+        memmove(rs_buf, &rs_buf[count * 2], (RS_TAPS - 1) * 4);
+
+        in += count * 2;
+        n -= count;
+    }
+    return done;
+}
@@ -0,0 +1,23 @@
+/***************************************************************************
+ *   44.1k -> 48k resamplers of the sound backend (xr_xenonsnd.cpp), kept  *
+ *   apart from libxenon so they build for the host tests too              *
+ ***************************************************************************/
+
+#ifndef XR_RESAMPLE_H
+#define XR_RESAMPLE_H
+
+#include <stdint.h>
+
+// resets the history of both resamplers and builds the polyphase table
+void ResampleInit(void);
+
+// linear interpolation of oldsamples interleaved stereo frames into
+// pNewSamples, host byte order; returns the number of frames written: 160
+// for every 147 in the long run
+int ResampleLinear(const int16_t *pStereoSamples, int32_t oldsamples, int16_t *pNewSamples);
+
+// resample n interleaved stereo frames into out (already byte swapped),
+// returns the number of frames written: 160 for every 147 in the long run
+int ResamplePolyphase(const int16_t *in, int n, uint32_t *out);
+
+#endif
@@ -6,12 +6,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 #include <xenon_sound/sound.h>
 #include <xenon_soc/xenon_power.h>
 #include <ppc/timebase.h>
 #include <byteswap.h>
 #include <time/time.h>
+#include "xr_resample.h"
 
 int output_channels = 2;
 int output_samplesize = 4;
@@ -20,7 +20,6 @@ int output_samplesize = 4;
 #define BUFFER_SIZE 65536
 
 static char buffer[BUFFER_SIZE];
-static double freq_ratio;
 
 static int buffer_size = 1024;
 
@@ -39,8 +38,6 @@ typedef uintptr_t uptr;
 
 typedef uint8_t boolean;
 
-static s16 prevLastSample[2] = {0, 0};
-
 static void inline play_buffer(void) {
     int i;
     for (i = 0; i < buffer_size / 4; ++i) 
@@ -49,67 +46,177 @@ static void inline play_buffer(void) {
     xenon_sound_submit(buffer, buffer_size);
 }
 
-/*
- * resamples pStereoSamples 
- * (taken from http://pcsx2.googlecode.com/svn/trunk/plugins/zerospu2/zerospu2.cpp)
- */
-static void ResampleLinear(s16* pStereoSamples, s32 oldsamples, s16* pNewSamples, s32 newsamples) {
-    s32 newsampL, newsampR;
-    s32 i;
-    for (i = 0; i < newsamples; ++i) {
-        s32 io = i * oldsamples;
-        s32 old = io / newsamples;
-        s32 rem = io - old * newsamples;
-
-        old *= 2;
-        //printf("%d %d\n",old,oldsamples);
-        if (old == 0) {
-            newsampL = prevLastSample[0] * (newsamples - rem) + pStereoSamples[0] * rem;
-            newsampR = prevLastSample[1] * (newsamples - rem) + pStereoSamples[1] * rem;
-        } else {
-            newsampL = pStereoSamples[old - 2] * (newsamples - rem) + pStereoSamples[old] * rem;
-            newsampR = pStereoSamples[old - 1] * (newsamples - rem) + pStereoSamples[old + 1] * rem;
-        }
-        pNewSamples[2 * i] = newsampL / newsamples;
-        pNewSamples[2 * i + 1] = newsampR / newsamples;
+int iUsePolyphase = 1;                          // 0: old linear interpolation
+
+////////////////////////////////////////////////////////////////////////
+// PCM ring between mixer (MAINThread, producer) and backend (consumer)
+// single producer / single consumer: head is only written by the mixer,
+// tail only by the backend thread, so no lock is needed
+////////////////////////////////////////////////////////////////////////
+
+#define RING_FRAMES   (1 << 15)                 // 44.1k stereo frames, ~740 ms
+#define RING_MASK     (RING_FRAMES - 1)
+#define RING_CHUNK    128                       // frames per backend submit (~3 ms)
+
+#define lwsync() __asm__ __volatile__("lwsync" : : : "memory")
+
+static u32 ring[RING_FRAMES] __attribute__ ((aligned(128)));
+static volatile unsigned int ring_head __attribute__ ((aligned(128))) = 0;
+static volatile unsigned int ring_tail __attribute__ ((aligned(128))) = 0;
+static volatile int ring_low_water = 0;        // raised by the backend when the mixer should run
+
+static volatile int bSoundEnd = 0;
+static volatile int bSoundEnded = 0;
+static int iSoundStarted = 0;
+
+unsigned long ulSoundUnderruns = 0;
+unsigned long ulSoundOverruns = 0;
+
+static unsigned char sound_stack[0x10000];
+
+// total latency = hw fifo + ring, split evenly between the two
+static inline unsigned int SoundTargetBytes(void) {
+    return SOUNDLEN(LATENCY);
+}
+
+static inline unsigned int RingBytes(void) {
+    return (ring_head - ring_tail) * output_samplesize;
+}
+
+static void RingPush(const u32 *frames, unsigned int n) {
+    unsigned int head = ring_head;
+    unsigned int space = RING_FRAMES - (head - ring_tail);
+    unsigned int part;
+
+    if (n > space) {
+        ulSoundOverruns++;
+        n = space;
     }
-    prevLastSample[0] = pStereoSamples[oldsamples * 2 - 2];
-    prevLastSample[1] = pStereoSamples[oldsamples * 2 - 1];
+
+    part = RING_FRAMES - (head & RING_MASK);
+    if (part > n) part = n;
+    memcpy(&ring[head & RING_MASK], frames, part * 4);
+    memcpy(&ring[0], frames + part, (n - part) * 4);
+
+    lwsync(); // data visible before the new head
+    ring_head = head + n;
 }
 
-static void inline add_to_buffer(void* stream, unsigned int length) {
-    unsigned int lengthLeft;
-    unsigned int rlengthLeft;
-    
-    lengthLeft = length >> 2;
-    rlengthLeft = ceil(lengthLeft * freq_ratio);
+// backend: keep the hw fifo at half the target latency, wake the mixer
+// when the ring drops below the other half
 
-//    copy_to_buffer((int *)buffer, stream , rlengthLeft, lengthLeft);
-    ResampleLinear((s16 *) stream, lengthLeft, (s16 *) buffer, rlengthLeft);
-    
-    buffer_size = rlengthLeft << 2;
-    play_buffer();
+static void *SoundThread(void *arg) {
+    unsigned int tail, avail, n;
+    int out;
 
+    while (!bSoundEnd) {
+        // the mixer shares the core: low priority while the fifo is full
+        if ((unsigned int) xenon_sound_get_unplayed() >= SoundTargetBytes() / 2) {
+            __asm__ __volatile__("or 1,1,1");
+            while ((unsigned int) xenon_sound_get_unplayed() >= SoundTargetBytes() / 2 && !bSoundEnd)
+                __asm__ __volatile__("db16cyc");
+            __asm__ __volatile__("or 2,2,2");
+        }
+
+        if ((unsigned int) xenon_sound_get_unplayed() < SoundTargetBytes() / 2) {
+            tail = ring_tail;
+            avail = ring_head - tail;
+            lwsync(); // head read before the data behind it
+
+            if (avail) {
+                n = RING_FRAMES - (tail & RING_MASK);
+                if (n > avail) n = avail;
+                if (n > RING_CHUNK) n = RING_CHUNK;
+
+                if (iUsePolyphase) {
+                    out = ResamplePolyphase((s16 *) & ring[tail & RING_MASK], n, (u32 *) buffer);
+                } else {
+                    out = ResampleLinear((s16 *) & ring[tail & RING_MASK], n, (s16 *) buffer);
+                }
+
+                lwsync(); // done reading before the slot is handed back
+                ring_tail = tail + n;
+                iSoundStarted = 1;
+
+                if (iUsePolyphase)
+                    xenon_sound_submit(buffer, out << 2); // already swapped
+                else {
+                    buffer_size = out << 2;
+                    play_buffer();
+                }
+            } else if (iSoundStarted && xenon_sound_get_unplayed() == 0) {
+                ulSoundUnderruns++;
+                iSoundStarted = 0; // count each dropout once
+            }
+        }
+
+        if (RingBytes() < SoundTargetBytes() / 2)
+            ring_low_water = 1;
+
+        __asm__ __volatile__("db16cyc");
+    }
+
+    bSoundEnded = 1;
+    return 0;
 }
 
 /*
  * SETUP SOUND
  */
 void SetupSound(void) {
-    freq_ratio = 48000.0f / 44100.0f;
+    ResampleInit();
+
+    ring_head = ring_tail = 0;
+    ring_low_water = 1;
+    ulSoundUnderruns = ulSoundOverruns = 0;
+    iSoundStarted = 0;
+    bSoundEnd = 0;
+    bSoundEnded = 0;
+
+    xenon_run_thread_task(3, &sound_stack[sizeof (sound_stack) - 0x100], (void*) SoundThread);
 }
 
 /*
  * REMOVE SOUND
  */
 void RemoveSound(void) {
+    int i = 0;
+
+    bSoundEnd = 1;
+    while (!bSoundEnded && i < 2000) {
+        usleep(1000L);
+        i++;
+    }
+
+    printf("Sound: %lu underruns, %lu overruns\r\n", ulSoundUnderruns, ulSoundOverruns);
 }
 
 /*
  * GET BYTES BUFFERED
  */
 unsigned long SoundGetBytesBuffered(void) {
-    return xenon_sound_get_unplayed();
+    return xenon_sound_get_unplayed() + RingBytes();
+}
+
+/*
+ * LOW WATER: mixer should produce more
+ */
+int SoundLowWater(void) {
+    return RingBytes() < SoundTargetBytes() / 2;
+}
+
+// park the mixer until the backend raises the low-water event; bounded to
+// 1 ms so newly keyed-on voices still get started in time
+
+void SoundWaitLowWater(void) {
+    uint64_t end = mftb() + PPC_TIMEBASE_FREQ / 1000;
+
+    __asm__ __volatile__("or 1,1,1"); // low priority while parked
+    while (!ring_low_water && (int64_t) (end - mftb()) > 0)
+        __asm__ __volatile__("db16cyc");
+    __asm__ __volatile__("or 2,2,2");
+
+    ring_low_water = 0;
 }
 
 /*
@@ -118,7 +225,7 @@ unsigned long SoundGetBytesBuffered(void) {
 void SoundFeedStreamData(unsigned char* pSound, long lBytes) {
     if (lBytes < 0)
         return;
-    add_to_buffer(pSound, lBytes);
+    RingPush((u32 *) pSound, lBytes >> 2);
 }
 
 void ResetSound()
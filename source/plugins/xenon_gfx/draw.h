@@ -29,6 +29,11 @@ void          DisplayPic(void);
 void          ShowGpuPic(void);
 void          ShowTextGpuPic(void);
 
+// v_blit.c: vram to the argb surface, g_pPitch bytes a row
+extern int    g_pPitch;
+void          StartBlitThread(void);
+void          BlitScreen32(unsigned char * surf, int32_t x, int32_t y);
+
 typedef struct {
 #define MWM_HINTS_DECORATIONS   2
   long flags;
@@ -318,6 +318,7 @@ extern long           lSelectedSlot;
 extern BOOL           bInitCap;
 extern DWORD          dwLaceCnt;
 extern uint32_t  lGPUInfoVals[];
+extern uint32_t  ulDrawEnv[];
 extern uint32_t  ulStatusControl[];
 extern uint32_t  vBlank;
 extern int            iRumbleVal;
@@ -362,6 +363,9 @@ extern int            iFrameLimit;
 extern float          fFrameRateHz;
 extern float          fps_skip;
 extern float          fps_cur;
+extern int            iFrameLatency;
+extern float          fSpeed;
+extern BOOL           bOutput;
 #ifdef _WINDOWS
 extern BOOL           IsPerformanceCounter;
 extern int			  iStopSaver;
@@ -27,5 +27,7 @@ void SetAutoFrameCap(void);
 void SetFPSHandler(void);
 void InitFPS(void);
 void CheckFrameRate(void);
+void FrameLatencyDelay(void);
+void FastForwardSkip(void);
 
 #endif // _FPS_INTERNALS_H
@@ -87,6 +87,8 @@
 //new
 #define GPUvBlank               PEOPS_GPUvBlank
 #define GPUvisualVibration      PEOPS_GPUvisualVibration
+#define GPUsetSpeed             PEOPS_GPUsetSpeed
+#define GPUsetOutput            PEOPS_GPUsetOutput
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
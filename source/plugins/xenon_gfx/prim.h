@@ -20,5 +20,6 @@
 
 void UploadScreen (long Position);
 void PrepareFullScreenUpload (long Position);
+void UpdateGlobalTP (unsigned short gdata);
 
 #endif // _PRIMDRAW_H_
@@ -0,0 +1,251 @@
+/***************************************************************************
+                          v_blit.c  -  description
+                             -------------------
+    the soft gpu's output conversion, split out of draw.c
+ ***************************************************************************/
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include <xenon_soc/xenon_power.h>
+
+#include "externals.h"
+#include "gpu.h"
+#include "draw.h"
+#include "swap.h"
+
+#define R(x)    ((x << 19) & 0xf80000)
+#define B(x)    ((x << 6) & 0xf800)
+#define G(x)    ((x >> 7) & 0xf8)
+#define RGB(x)  (R(x)|B(x)|G(x))
+
+#define GCC_SPLIT_BLOCK __asm__ ("");
+#define SIZE_OF_BUFFERS   (512*32)        // 512 cache lines
+
+
+// The frame is converted in horizontal bands: the upper one on the calling
+// thread, the lower one on a helper hardware thread (5 is free while the
+// soft gpu is active). Rows are independent, so no overlap is needed.
+#define BLIT_THREAD     5
+
+static __attribute__((aligned(256))) unsigned char blit_stack[0x10000];
+static volatile int blit_job __attribute__((aligned(128))) = 0;
+static volatile int blit_done __attribute__((aligned(128))) = 0;
+static int blit_running = 0;
+
+static struct {
+    uint8_t * surf;
+    int32_t x, y;
+    int first, last;
+} blit_band;
+
+#define blit_lwsync()   __asm__ __volatile__("lwsync" : : : "memory")
+#define blit_sync()     __asm__ __volatile__("sync" : : : "memory")
+
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+#include <altivec.h>
+
+// 8 little endian 15 bit pixels to 8 argb pixels
+static inline void BlitVec8(const uint16_t * src, uint32_t * dst) {
+    const vector unsigned char swap = vec_splat_u8(1);
+    const vector unsigned int rmask = (vector unsigned int) {0xf80000, 0xf80000, 0xf80000, 0xf80000};
+    const vector unsigned int gmask = (vector unsigned int) {0xf800, 0xf800, 0xf800, 0xf800};
+    const vector unsigned int bmask = (vector unsigned int) {0xf8, 0xf8, 0xf8, 0xf8};
+    const vector unsigned int alpha = (vector unsigned int) {0xff000000, 0xff000000, 0xff000000, 0xff000000};
+    const vector unsigned int s19 = (vector unsigned int) {19, 19, 19, 19};
+    const vector unsigned int s6 = vec_splat_u32(6);
+    const vector unsigned int s7 = vec_splat_u32(7);
+    const vector unsigned short zero = vec_splat_u16(0);
+    vector unsigned char perm;
+    vector unsigned short p;
+    vector unsigned int w0, w1;
+
+    // unaligned load and byte swap in one permute (src is always 2 byte aligned)
+    perm = vec_xor(vec_lvsl(0, src), swap);
+    p = (vector unsigned short) vec_perm(vec_ld(0, src), vec_ld(15, src), perm);
+
+    w0 = (vector unsigned int) vec_mergeh(zero, p);
+    w1 = (vector unsigned int) vec_mergel(zero, p);
+
+    w0 = vec_or(vec_or(vec_and(vec_sl(w0, s19), rmask), vec_and(vec_sl(w0, s6), gmask)),
+            vec_or(vec_and(vec_sr(w0, s7), bmask), alpha));
+    w1 = vec_or(vec_or(vec_and(vec_sl(w1, s19), rmask), vec_and(vec_sl(w1, s6), gmask)),
+            vec_or(vec_and(vec_sr(w1, s7), bmask), alpha));
+
+    vec_st(w0, 0, dst);
+    vec_st(w1, 16, dst);
+}
+#endif
+
+static void BlitRows(uint8_t * __restrict surf, int32_t x, int32_t y, int first, int last) {
+    uint8_t * __restrict pD;
+    uint32_t * __restrict rdest;
+    uint32_t * __restrict destpix;
+
+    uint32_t startxy;
+    uint32_t lu;
+    uint16_t s0, s1, s2, s3, s4, s5, s6, s7;
+    uint32_t d0, d1, d2, d3, d4, d5, d6, d7;
+
+    uint16_t row, column;
+    uint16_t dx = PreviousPSXDisplay.Range.x1;
+
+    if (PSXDisplay.RGB24) {
+        for (column = first; column < last; column++) {
+            startxy = ((1024) * (column + y)) + x;
+            pD = (uint8_t *) &psxVuw[startxy];
+            destpix = (uint32_t *) (surf + (column * g_pPitch));
+            for (row = 0; row < dx; row++) {
+
+                lu = *((uint32_t *) pD);
+                destpix[row] =
+                        0xff000000 | (RED(lu) << 16) | (GREEN(lu) << 8) | (BLUE(lu));
+                pD += 3;
+
+            }
+        }
+        return;
+    }
+
+    for (column = first; column < last; column++) {
+        startxy = (1024 * (column + y)) + x;
+        destpix = (uint32_t *) (surf + (column * g_pPitch));
+
+        // Prefetch to give us a running start on the first 8 sets of cache lines
+        int loop;
+        for(loop=0; loop < 1024; loop += 128)
+            __asm__ __volatile__("dcbt 0,%0" : : "r" (&psxVuw[startxy]+loop));
+
+        __asm__ __volatile__("dcbz 0,%0" : : "r" (destpix));
+
+#if defined(__ALTIVEC__) && defined(__BIG_ENDIAN__)
+        if (((uintptr_t) destpix & 15) == 0) {
+            for (row = 0; row < dx; row += 8, startxy += 8)
+                BlitVec8(&psxVuw[startxy], &destpix[row]);
+            continue;
+        }
+#endif
+
+        for (row = 0; row < dx; row += 8) {
+            rdest = &destpix[row];
+
+            GCC_SPLIT_BLOCK
+
+            s0 = GETLE16(&psxVuw[startxy++]);
+            s1 = GETLE16(&psxVuw[startxy++]);
+            s2 = GETLE16(&psxVuw[startxy++]);
+            s3 = GETLE16(&psxVuw[startxy++]);
+            s4 = GETLE16(&psxVuw[startxy++]);
+            s5 = GETLE16(&psxVuw[startxy++]);
+            s6 = GETLE16(&psxVuw[startxy++]);
+            s7 = GETLE16(&psxVuw[startxy++]);
+
+            GCC_SPLIT_BLOCK
+
+            d0 = RGB(s0) | 0xff000000;
+            d1 = RGB(s1) | 0xff000000;
+            d2 = RGB(s2) | 0xff000000;
+            d3 = RGB(s3) | 0xff000000;
+            d4 = RGB(s4) | 0xff000000;
+            d5 = RGB(s5) | 0xff000000;
+            d6 = RGB(s6) | 0xff000000;
+            d7 = RGB(s7) | 0xff000000;
+
+            GCC_SPLIT_BLOCK
+
+            rdest[0] = d0;
+            rdest[1] = d1;
+            rdest[2] = d2;
+            rdest[3] = d3;
+            rdest[4] = d4;
+            rdest[5] = d5;
+            rdest[6] = d6;
+            rdest[7] = d7;
+        }
+    }
+}
+
+static void BlitThread(void) {
+    int seen = 0;
+
+    while (1) {
+        if (blit_job == seen) {
+            __asm__ __volatile__("or 1,1,1"); // low priority while idle
+            while (blit_job == seen)
+                __asm__ __volatile__("db16cyc");
+            __asm__ __volatile__("or 2,2,2");
+        }
+        seen = blit_job;
+        blit_lwsync(); // band read after the job number
+
+        BlitRows(blit_band.surf, blit_band.x, blit_band.y, blit_band.first, blit_band.last);
+
+        blit_sync(); // pixels out before we say so
+        blit_done = seen;
+    }
+}
+
+void StartBlitThread(void) {
+    if (blit_running)
+        return;
+
+    xenon_run_thread_task(BLIT_THREAD, &blit_stack[sizeof (blit_stack) - 0x100], (void*) BlitThread);
+    blit_running = 1;
+}
+
+void BlitScreen32(unsigned char * _surf, int32_t x, int32_t y) {
+    uint8_t * __restrict  surf = _surf;
+    uint32_t * __restrict destpix;
+
+    uint16_t column;
+    uint16_t dy = PreviousPSXDisplay.DisplayMode.y;
+    int split;
+
+    if (PreviousPSXDisplay.Range.y0) // centering needed?
+    {
+        memset(surf, 0, (PreviousPSXDisplay.Range.y0 >> 1) * g_pPitch);
+
+        dy -= PreviousPSXDisplay.Range.y0;
+        surf += (PreviousPSXDisplay.Range.y0 >> 1) * g_pPitch;
+
+        memset(surf + dy * g_pPitch,
+                0, ((PreviousPSXDisplay.Range.y0 + 1) >> 1) * g_pPitch);
+    }
+
+    if (PreviousPSXDisplay.Range.x0) {
+        for (column = 0; column < dy; column++) {
+            destpix = (uint32_t *) (surf + (column * g_pPitch));
+            memset(destpix, 0, PreviousPSXDisplay.Range.x0 << 2);
+        }
+        surf += PreviousPSXDisplay.Range.x0 << 2;
+    }
+
+    if (!blit_running || dy < 32) {
+        BlitRows(surf, x, y, 0, dy);
+        return;
+    }
+
+    // lower band to the helper, upper band here
+    split = dy >> 1;
+    blit_band.surf = surf;
+    blit_band.x = x;
+    blit_band.y = y;
+    blit_band.first = split;
+    blit_band.last = dy;
+    blit_lwsync();
+    blit_job = blit_job + 1;
+
+    BlitRows(surf, x, y, 0, split);
+
+    while (blit_done != blit_job)
+        __asm__ __volatile__("db16cyc");
+    blit_lwsync();
+}
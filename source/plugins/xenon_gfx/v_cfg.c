@@ -28,6 +28,7 @@
 #include "externals.h"
 #include "cfg.h"
 #include "gpu.h"
+#include "psxcommon.h"
 
 void ReadConfig(void) {
     printf("ReadGpuConfig\r\n");
@@ -38,9 +39,10 @@ void ReadConfig(void) {
     iColDepth = 32;
     iWindowMode = 1;
     iMaintainAspect = 0;
-    UseFrameLimit = 0;
+    UseFrameLimit = Config.UseFrameLimit;
     UseFrameSkip = 0;
     iFrameLimit = 2;
+    iFrameLatency = Config.FrameLatency;
     fFrameRate = 200.0f;
     dwCfgFixes = 0x401;
     iUseFixes = 0;
@@ -38,9 +38,25 @@ float fps_cur = 0;
 unsigned long          ulKeybits=0;
 #define MAXLACE 16
 
+// fast forward: 1 normal speed, 0 unlimited
+float fSpeed = 1.0f;
+
+// run ahead: frames of discarded emulation are not shown, nor paced
+BOOL bOutput = TRUE;
+
+static void FastForwardCap(void);
+
 #if 1
 
 void CheckFrameRate(void) {
+    if (!bOutput) return; // -> hidden frame, nobody waits for it
+
+    if (iFastFwd) // fast forward?
+    {
+        if (fSpeed > 0.0f) FastForwardCap();
+        return;
+    }
+
     if (UseFrameSkip) // skipping mode?
     {
         if (!(dwActFixes & 0x80)) // not old skipping mode?
@@ -61,6 +77,7 @@ void CheckFrameRate(void) {
 }
 
 #define TIMEBASE 100000
+#define HOSTREFRESHHZ 60
 
 unsigned long timeGetTime() {
     /*
@@ -71,42 +88,131 @@ unsigned long timeGetTime() {
     return mftb()/(PPC_TIMEBASE_FREQ/100000);
 }
 
+////////////////////////////////////////////////////////////////////////
+// frame pacer
+////////////////////////////////////////////////////////////////////////
+
+#define PACER_SPIN_TICKS    50                                 // last 0.5 ms are spun, not slept
+#define PACER_LATENCY_SLACK 100                                // 1 ms safety margin in latency mode
+
+int iFrameLatency = 0;                                         // delay emulation (and input polling) to just before the deadline
+
+static unsigned long ulPacerDeadline = 0;                      // presentation deadline of the current frame
+static unsigned long ulPacerFrameStart = 0;                    // time the core got control back from the pacer
+static unsigned long ulEmuTicksAvg = 0;                        // moving average of emulation time per frame (<<3)
+
+// usleep() is a busy udelay() on libxenon, so park the hardware thread at
+// low SMT priority instead: the sibling thread gets the core while we wait
+
+static void PacerSleep(unsigned long ticks) {
+#ifdef __ppc__
+    uint64_t end = mftb() + (uint64_t) ticks * (PPC_TIMEBASE_FREQ / TIMEBASE);
+
+    __asm__ __volatile__("or 1,1,1"); // low priority
+    while ((int64_t) (end - mftb()) > 0)
+        __asm__ __volatile__("db16cyc");
+    __asm__ __volatile__("or 2,2,2"); // back to medium priority
+#else
+    usleep(ticks * (1000000 / TIMEBASE)); // host builds of the tests
+#endif
+}
+
+// sleep until the deadline, spinning only for the final sub-millisecond
+
+static void FrameSleepUntil(unsigned long deadline) {
+    long tickstogo = (long) (deadline - timeGetTime());
+
+    if (tickstogo > PACER_SPIN_TICKS && !(dwActFixes & 16))
+        PacerSleep(tickstogo - PACER_SPIN_TICKS);
+
+    while ((long) (deadline - timeGetTime()) > 0);
+}
+
+// feed the time spent emulating since the pacer last returned into the average
+
+static void PacerSampleEmuTime(unsigned long curticks) {
+    unsigned long emuticks = curticks - ulPacerFrameStart;
+
+    if (emuticks > 4 * dwFrameRateTicks) // pause, menu or load... ignore it
+        return;
+    ulEmuTicksAvg += emuticks - (ulEmuTicksAvg >> 3);
+}
+
 void FrameCap(void) {
-    static unsigned long curticks, lastticks, _ticks_since_last_update;
-    static unsigned int TicksToWait = 0;
-    int overslept = 0, tickstogo = 0;
-    BOOL Waiting = TRUE;
+    unsigned long curticks = timeGetTime();
 
-    {
-        curticks = timeGetTime();
-        _ticks_since_last_update = curticks - lastticks;
+    PacerSampleEmuTime(curticks);
 
-        if ((_ticks_since_last_update > TicksToWait) ||
-                (curticks < lastticks)) {
-            lastticks = curticks;
-            overslept = _ticks_since_last_update - TicksToWait;
-            if ((_ticks_since_last_update - TicksToWait) > dwFrameRateTicks)
-                TicksToWait = 0;
-            else
-                TicksToWait = dwFrameRateTicks - overslept;
-        } else {
-            while (Waiting) {
-                curticks = timeGetTime();
-                _ticks_since_last_update = curticks - lastticks;
-                tickstogo = TicksToWait - _ticks_since_last_update;
-                if ((_ticks_since_last_update > TicksToWait) ||
-                        (curticks < lastticks) || tickstogo < overslept) {
-                    Waiting = FALSE;
-                    lastticks = curticks;
-                    overslept = _ticks_since_last_update - TicksToWait;
-                    TicksToWait = dwFrameRateTicks - overslept;
-                    return;
-                }
-                if (tickstogo >= 200 && !(dwActFixes & 16))
-                    usleep(tickstogo * 10 - 200);
-            }
-        }
+    ulPacerDeadline += dwFrameRateTicks;
+    if ((long) (curticks - ulPacerDeadline) > (long) dwFrameRateTicks ||
+            (long) (ulPacerDeadline - curticks) > (long) (2 * dwFrameRateTicks)) {
+        ulPacerDeadline = curticks; // way too late (or clock jumped): resync, don't try to catch up
+    } else {
+        FrameSleepUntil(ulPacerDeadline);
     }
+
+    ulPacerFrameStart = timeGetTime();
+}
+
+// latency mode: after the frame got presented, sleep away the part of the next
+// frame period we don't need for emulation, so the pad gets polled as late as possible
+
+void FrameLatencyDelay(void) {
+    unsigned long budget;
+
+    if (!iFrameLatency || !UseFrameLimit || UseFrameSkip || iFastFwd || !bOutput || (dwActFixes & 32))
+        return;
+
+    budget = (ulEmuTicksAvg >> 3) + (ulEmuTicksAvg >> 5) + PACER_LATENCY_SLACK; // avg + 25% + slack
+    if (budget >= dwFrameRateTicks)
+        return;
+
+    FrameSleepUntil(ulPacerDeadline + dwFrameRateTicks - budget);
+    ulPacerFrameStart = timeGetTime();
+}
+
+////////////////////////////////////////////////////////////////////////
+// fast forward: vsyncs come fSpeed times as fast as on the psx, or as
+// fast as we can with fSpeed 0, and the tv only gets the frames it can
+// show, one per host refresh
+////////////////////////////////////////////////////////////////////////
+
+static void FastForwardCap(void) {
+    unsigned long curticks = timeGetTime();
+    unsigned long ticks = (unsigned long) (TIMEBASE / (fFrameRateHz * fSpeed));
+
+    ulPacerDeadline += ticks;
+    if (bInitCap || (long) (curticks - ulPacerDeadline) > (long) (MAXLACE * ticks)) {
+        bInitCap = FALSE; // -> first time or way behind: start over, don't race to catch up
+        ulPacerDeadline = curticks;
+    } else {
+        FrameSleepUntil(ulPacerDeadline);
+    }
+
+    ulPacerFrameStart = timeGetTime();
+}
+
+void FastForwardSkip(void) // called in updatedisplay, decides about the next frame
+{
+    static unsigned long lastticks;
+    unsigned long curticks = timeGetTime();
+
+    if (curticks - lastticks >= TIMEBASE / HOSTREFRESHHZ) {
+        lastticks = curticks;
+        bSkipNextFrame = FALSE;
+    } else bSkipNextFrame = TRUE;
+}
+
+void CALLBACK GPUsetSpeed(float speed) // main emu: fast forward with speed (0: unlimited), or back to 1
+{
+    bInitCap = TRUE;
+    fSpeed = speed;
+    iFastFwd = (speed != 1.0f);
+}
+
+void CALLBACK GPUsetOutput(int on) // main emu: run ahead frames are emulated but not shown
+{
+    bOutput = on;
 }
 
 #define MAXSKIP 120
@@ -115,7 +221,8 @@ void FrameSkip(void) {
     static int iNumSkips = 0, iAdditionalSkip = 0; // number of additional frames to skip
     static DWORD dwLastLace = 0; // helper var for frame limitation
     static DWORD curticks, lastticks, _ticks_since_last_update;
-    int tickstogo = 0;
+    static DWORD dwFrameTicksAvg = 0; // moving average of drawn frame time per lace (<<3)
+    DWORD dwPredicted;
     static int overslept = 0;
 
     if (!dwLaceCnt) return; // important: if no updatelace happened, we ignore it completely
@@ -143,15 +250,9 @@ void FrameSkip(void) {
 
                 if (_ticks_since_last_update < dwWaitTime) // -> we were too fast?
                 {
-                    if ((dwWaitTime - _ticks_since_last_update)> // -> some more security, to prevent
+                    if ((dwWaitTime - _ticks_since_last_update) <= // -> some more security, to prevent
                             (60 * dwFrameRateTicks)) //    wrong waiting times
-                        _ticks_since_last_update = dwWaitTime;
-
-                    while (_ticks_since_last_update < dwWaitTime) // -> loop until we have reached the real psx time
-                    { //    (that's the additional limitation, yup)
-                        curticks = timeGetTime();
-                        _ticks_since_last_update = dwT + curticks - lastticks;
-                    }
+                        FrameSleepUntil(lastticks + dwWaitTime - dwT); // -> sleep until we have reached the real psx time
                 } else // we were still too slow ?!!?
                 {
                     if (iAdditionalSkip < MAXSKIP) // -> well, somewhen we really have to stop skipping on very slow systems
@@ -184,32 +285,28 @@ void FrameSkip(void) {
         if (dwWaitTime >= overslept)
             dwWaitTime -= overslept;
 
-        if (_ticks_since_last_update > dwWaitTime) // hey, we needed way too long for that frame...
+        if (dwLaceCnt <= MAXLACE) // feed the per-lace frame time into the moving average
+            dwFrameTicksAvg += _ticks_since_last_update / dwLaceCnt - (dwFrameTicksAvg >> 3);
+        dwPredicted = (dwFrameTicksAvg >> 3) * dwLaceCnt; // what the next frame will probably cost
+
+        if (_ticks_since_last_update > dwWaitTime && // hey, we needed way too long for that frame...
+                (dwPredicted > dwWaitTime || // -> and it's not a one-off spike
+                _ticks_since_last_update > 2 * dwWaitTime)) // -> or it was a really bad one
         {
             if (UseFrameLimit) // if limitation, we skip just next frame,
             { // and decide after, if we need to do more
                 iNumSkips = 0;
             } else {
-                iNumSkips = _ticks_since_last_update / dwWaitTime; // -> calc number of frames to skip to catch up
+                iNumSkips = max(_ticks_since_last_update, dwPredicted) / dwWaitTime; // -> calc number of frames to skip to catch up
                 iNumSkips--; // -> since we already skip next frame, one down
                 if (iNumSkips > MAXSKIP) iNumSkips = MAXSKIP; // -> well, somewhere we have to draw a line
             }
             bSkipNextFrame = TRUE; // -> signal for skipping the next frame
         } else // we were faster than real psx? fine :)
-            if (UseFrameLimit) // frame limit used? so we wait til the 'real psx time' has been reached
+            if (UseFrameLimit && dwLaceCnt <= MAXLACE) // frame limit used? so we wait til the 'real psx time' has been reached
         {
-            if (dwLaceCnt > MAXLACE) // -> security check
-                _ticks_since_last_update = dwWaitTime;
-
-            while (_ticks_since_last_update < dwWaitTime) // -> just do a waiting loop...
-            {
-                curticks = timeGetTime();
-                _ticks_since_last_update = curticks - lastticks;
-
-                tickstogo = dwWaitTime - _ticks_since_last_update;
-                if (tickstogo - overslept >= 200 && !(dwActFixes & 16))
-                    usleep(tickstogo * 10 - 200);
-            }
+            FrameSleepUntil(lastticks + dwWaitTime); // -> sleep, spinning only the last bit
+            _ticks_since_last_update = timeGetTime() - lastticks;
         }
         overslept = _ticks_since_last_update - dwWaitTime;
         if (overslept < 0)
@@ -263,20 +360,13 @@ void calcfps(void) {
 }
 
 void PCFrameCap(void) {
-    static unsigned long curticks, lastticks, _ticks_since_last_update;
+    static unsigned long lastticks;
     static unsigned long TicksToWait = 0;
-    BOOL Waiting = TRUE;
 
-    while (Waiting) {
-        curticks = timeGetTime();
-        _ticks_since_last_update = curticks - lastticks;
-        if ((_ticks_since_last_update > TicksToWait) ||
-                (curticks < lastticks)) {
-            Waiting = FALSE;
-            lastticks = curticks;
-            TicksToWait = (TIMEBASE / (unsigned long) fFrameRateHz);
-        }
-    }
+    if (timeGetTime() - lastticks <= TicksToWait)
+        FrameSleepUntil(lastticks + TicksToWait + 1);
+    lastticks = timeGetTime();
+    TicksToWait = (TIMEBASE / (unsigned long) fFrameRateHz);
 }
 
 void PCcalcfps(void) {
@@ -91,6 +91,7 @@ long lSelectedSlot = 0;
 BOOL bChangeWinMode = FALSE;
 BOOL bDoLazyUpdate = FALSE;
 uint32_t lGPUInfoVals[16];
+uint32_t ulDrawEnv[8]; // last texture page, then the e1-e6 commands, for freezing
 static int iFakePrimBusy = 0;
 uint32_t vBlank = 0;
 int iRumbleVal = 0;
@@ -172,6 +173,7 @@ long CALLBACK GPUinit() // GPU INIT
 
     memset(psxVSecure, 0x00, (iGPUHeight * 2)*1024 + (1024 * 1024));
     memset(lGPUInfoVals, 0x00, 16 * sizeof (uint32_t));
+    memset(ulDrawEnv, 0x00, 8 * sizeof (uint32_t));
 
     SetFPSHandler();
 
@@ -251,6 +253,8 @@ long CALLBACK GPUshutdown() // GPU SHUTDOWN
 
 void updateDisplay(void) // UPDATE DISPLAY
 {
+    if (!bOutput) return; // run ahead frame? -> vram is all there is to it
+
     if (PSXDisplay.Disabled) // disable?
     {
         DoClearFrontBuffer(); // -> clear frontbuffer
@@ -270,15 +274,8 @@ void updateDisplay(void) // UPDATE DISPLAY
 
     if (iFastFwd) // fastfwd ?
     {
-        static int fpscount;
-        UseFrameSkip = 1;
-
         if (!bSkipNextFrame) DoBufferSwap(); // -> to skip or not to skip
-        if (fpscount % 6) // -> skip 6/7 frames
-            bSkipNextFrame = TRUE;
-        else bSkipNextFrame = FALSE;
-        fpscount++;
-        if (fpscount >= (int) fFrameRateHz) fpscount = 0;
+        FastForwardSkip(); // -> one frame per host refresh
         return;
     }
 
@@ -296,6 +293,7 @@ void updateDisplay(void) // UPDATE DISPLAY
     } else // no skip ?
     {
         DoBufferSwap(); // -> swap
+        bSkipNextFrame = FALSE; // -> left over from fast forward
     }
 
 }
@@ -512,6 +510,8 @@ void CALLBACK GPUupdateLace(void) // VSYNC
     }
 
     bDoVSyncUpdate = FALSE; // vsync done
+
+    FrameLatencyDelay(); // latency mode: run the next frame as late as possible
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -563,6 +563,7 @@ void CALLBACK GPUwriteStatus(uint32_t gdata) // WRITE STATUS
             // reset gpu
         case 0x00:
             memset(lGPUInfoVals, 0x00, 16 * sizeof (uint32_t));
+            memset(ulDrawEnv, 0x00, 8 * sizeof (uint32_t));
             lGPUstatusRet = 0x14802000;
             PSXDisplay.Disabled = 1;
             DataWriteMode = DataReadMode = DR_NORMAL;
@@ -1215,6 +1216,9 @@ typedef struct GPUFREEZETAG {
 ////////////////////////////////////////////////////////////////////////
 
 long CALLBACK GPUfreeze(uint32_t ulGetFreezeData, GPUFreeze_t * pF) {
+    uint32_t env[8], gdata;
+    int i;
+
     //----------------------------------------------------//
     if (ulGetFreezeData == 2) // 2: info, which save slot is selected? (just for display)
     {
@@ -1232,6 +1236,7 @@ long CALLBACK GPUfreeze(uint32_t ulGetFreezeData, GPUFreeze_t * pF) {
     {
         pF->ulStatus = lGPUstatusRet;
         memcpy(pF->ulControl, ulStatusControl, 256 * sizeof (uint32_t));
+        memcpy(pF->ulControl + 0xe0, ulDrawEnv, 8 * sizeof (uint32_t)); // as gpulib keeps them
         memcpy(pF->psxVRam, psxVub, 1024 * iGPUHeight * 2);
 
         return 1;
@@ -1242,6 +1247,7 @@ long CALLBACK GPUfreeze(uint32_t ulGetFreezeData, GPUFreeze_t * pF) {
     lGPUstatusRet = pF->ulStatus;
     memcpy(ulStatusControl, pF->ulControl, 256 * sizeof (uint32_t));
     memcpy(psxVub, pF->psxVRam, 1024 * iGPUHeight * 2);
+    memcpy(env, pF->ulControl + 0xe0, 8 * sizeof (uint32_t));
 
     // RESET TEXTURE STORE HERE, IF YOU USE SOMETHING LIKE THAT
 
@@ -1255,6 +1261,16 @@ long CALLBACK GPUfreeze(uint32_t ulGetFreezeData, GPUFreeze_t * pF) {
     GPUwriteStatus(ulStatusControl[5]);
     GPUwriteStatus(ulStatusControl[4]);
 
+    // the reset above cleared the draw environment, the commands that set
+    // it bring it back (states without them leave it reset, as before)
+    for (i = 1; i < 7; i++) {
+        if ((env[i] >> 24) != 0xe0 + i) continue;
+        PUTLE32(&gdata, env[i]);
+        primTableJ[0xe0 + i]((unsigned char *) &gdata);
+    }
+    UpdateGlobalTP((unsigned short) env[0]);
+    lGPUstatusRet = pF->ulStatus;
+
     return 1;
 }
 
@@ -20,6 +20,7 @@
 #include "externals.h"
 #include "gpu.h"
 #include "draw.h"
+#include "prim.h"
 #include "soft.h"
 #include "swap.h"
 
@@ -56,6 +57,8 @@ __inline unsigned short BGR24to16(uint32_t BGR) {
 ////////////////////////////////////////////////////////////////////////
 
 __inline void UpdateGlobalTP(unsigned short gdata) {
+    ulDrawEnv[0] = gdata;
+
     GlobalTextAddrX = (gdata << 6) & 0x3c0; // texture addr
 
     if (iGPUHeight == 1024) {
@@ -313,6 +316,8 @@ static inline  BOOL CheckCoordL(short slx0, short sly0, short slx1, short sly1)
 static inline void cmdSTP(unsigned char * baseAddr) {
     uint32_t gdata = GETLE32(&((uint32_t*) baseAddr)[0]);
 
+    ulDrawEnv[6] = gdata;
+
     lGPUstatusRet &= ~0x1800; // Clear the necessary bits
     lGPUstatusRet |= ((gdata & 0x03) << 11); // Set the necessary bits
 
@@ -335,6 +340,8 @@ static inline void cmdSTP(unsigned char * baseAddr) {
 void cmdTexturePage(unsigned char * baseAddr) {
     uint32_t gdata = GETLE32(&((uint32_t*) baseAddr)[0]);
 
+    ulDrawEnv[1] = gdata;
+
     lGPUstatusRet &= ~0x000007ff;
     lGPUstatusRet |= (gdata & 0x07ff);
 
@@ -353,6 +360,8 @@ void cmdTextureWindow(unsigned char *baseAddr) {
 
     uint32_t YAlign, XAlign;
 
+    ulDrawEnv[2] = gdata;
+
     lGPUInfoVals[INFO_TW] = gdata & 0xFFFFF;
 
     if (gdata & 0x020)
@@ -414,6 +423,8 @@ void cmdTextureWindow(unsigned char *baseAddr) {
 void cmdDrawAreaStart(unsigned char * baseAddr) {
     uint32_t gdata = GETLE32(&((uint32_t*) baseAddr)[0]);
 
+    ulDrawEnv[3] = gdata;
+
     drawX = gdata & 0x3ff; // for soft drawing
 
     if (dwGPUVersion == 2) {
@@ -434,6 +445,8 @@ void cmdDrawAreaStart(unsigned char * baseAddr) {
 void cmdDrawAreaEnd(unsigned char * baseAddr) {
     uint32_t gdata = GETLE32(&((uint32_t*) baseAddr)[0]);
 
+    ulDrawEnv[4] = gdata;
+
     drawW = gdata & 0x3ff; // for soft drawing
 
     if (dwGPUVersion == 2) {
@@ -454,6 +467,8 @@ void cmdDrawAreaEnd(unsigned char * baseAddr) {
 void cmdDrawOffset(unsigned char * baseAddr) {
     uint32_t gdata = GETLE32(&((uint32_t*) baseAddr)[0]);
 
+    ulDrawEnv[5] = gdata;
+
     PSXDisplay.DrawOffset.x = (short) (gdata & 0x7ff);
 
     if (dwGPUVersion == 2) {
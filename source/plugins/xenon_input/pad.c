@@ -22,6 +22,7 @@
 #include <xetypes.h>
 #include "pad.h"
 #include "w_input.h"
+#include "psxcommon.h"
 
 #define STICK_THRESHOLD 12000
 
@@ -49,6 +50,10 @@ void PSxInputReadPort(PadDataS* pad, int port) {
     if (xb_ctrl[port].logo) {
 		SysRunGui();
     }
+
+    // fast forward while R3 of the first pad is held
+    if (port == 0)
+        EmuSetFastForward(xb_ctrl[port].s2_z != 0);
  
     pad->controllerType = g.cfg.PadDef[port].Type; // Standard Pad
 
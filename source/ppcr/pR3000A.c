@@ -32,6 +32,7 @@
 #include "psxhle.h"
 #include "cdrom.h"
 #include "mdec.h"
+#include "psxhw.h"
 
 #include "libxenon_vm.h"
 
@@ -337,6 +338,65 @@ int PutHWReg32(int reg) {
     return UpdateHWRegUsage(iRegs[reg].reg, usage);
 }
 
+/* --- Cop2 data register mapping --- */
+
+// host register caching psxRegs.CP2D.r[n], -1 while it lives in memory.
+// Everything that hands control to gte.c has to FlushCp2Regs() first.
+static int cp2Regs[32];
+
+static void FlushCp2Reg32(int hwreg) {
+    int reg = HWRegisters[hwreg].private;
+
+    if (HWRegisters[hwreg].usage & HWUSAGE_WRITE) {
+        STW(HWRegisters[hwreg].code, OFFSET(&psxRegs, &psxRegs.CP2D.r[reg]), GetHWRegSpecial(PSXREGS));
+    }
+
+    cp2Regs[reg] = -1;
+}
+
+static void MapCp2Reg32(int reg) {
+    int hwreg = GetFreeHWReg();
+    HWRegisters[hwreg].flush = FlushCp2Reg32;
+    HWRegisters[hwreg].private = reg;
+
+    cp2Regs[reg] = hwreg;
+}
+
+static int GetCp2Reg32(int reg) {
+    int usage = HWUSAGE_READ;
+
+    if (cp2Regs[reg] == -1) {
+        usage |= HWUSAGE_INITED;
+        MapCp2Reg32(reg);
+
+        HWRegisters[cp2Regs[reg]].usage |= HWUSAGE_RESERVED;
+        LWZ(HWRegisters[cp2Regs[reg]].code, OFFSET(&psxRegs, &psxRegs.CP2D.r[reg]), GetHWRegSpecial(PSXREGS));
+        HWRegisters[cp2Regs[reg]].usage &= ~HWUSAGE_RESERVED;
+    }
+
+    return UpdateHWRegUsage(cp2Regs[reg], usage);
+}
+
+static int PutCp2Reg32(int reg) {
+    int usage = HWUSAGE_WRITE;
+
+    if (cp2Regs[reg] == -1) {
+        usage |= HWUSAGE_INITED;
+        MapCp2Reg32(reg);
+    }
+
+    return UpdateHWRegUsage(cp2Regs[reg], usage);
+}
+
+static void FlushCp2Regs() {
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        if (cp2Regs[i] != -1)
+            FlushHWReg(cp2Regs[i]);
+    }
+}
+
 /* --- Special register mapping --- */
 
 int GetSpecialIndexFromHWRegs(int which) {
@@ -637,11 +697,13 @@ static void iJump(u32 branchPC) {
 static void iBranch(u32 branchPC, int savectx) {
     HWRegister HWRegistersS[NUM_HW_REGISTERS];
     iRegisters iRegsS[NUM_REGISTERS];
+    int cp2RegsS[32];
     int HWRegUseCountS = 0;
 
     if (savectx) {
         memcpy(iRegsS, iRegs, sizeof (iRegs));
         memcpy(HWRegistersS, HWRegisters, sizeof (HWRegisters));
+        memcpy(cp2RegsS, cp2Regs, sizeof (cp2Regs));
         HWRegUseCountS = HWRegUseCount;
     }
 
@@ -689,6 +751,7 @@ static void iBranch(u32 branchPC, int savectx) {
     if (savectx) {
         memcpy(iRegs, iRegsS, sizeof (iRegs));
         memcpy(HWRegisters, HWRegistersS, sizeof (HWRegisters));
+        memcpy(cp2Regs, cp2RegsS, sizeof (cp2Regs));
         HWRegUseCount = HWRegUseCountS;
     }
 }
@@ -741,20 +804,21 @@ static void rec##f() { \
 	iRet(); \
 }
 
+// gte.c never looks at the cpu registers, so these keep the psx registers
+// cached in the (non volatile) host registers and only hand back cop2 state
 #define CP2_FUNC(f) \
 void gte##f(); \
 static void rec##f() { \
-	iFlushRegs(0); \
+	FlushCp2Regs(); \
 	LIW(0, (u32)psxRegs.code); \
 	STW(0, OFFSET(&psxRegs, &psxRegs.code), GetHWRegSpecial(PSXREGS)); \
-	FlushAllHWReg(); \
 	CALLFunc ((u32)gte##f); \
 }
 
 #define CP2_FUNCNC(f) \
 void gte##f(); \
 static void rec##f() { \
-	iFlushRegs(0); \
+	FlushCp2Regs(); \
 	CALLFunc ((u32)gte##f); \
 /*	branch = 2; */\
 }
@@ -1412,8 +1476,121 @@ static void preMemWrite(int size) {
     InvalidateCPURegs();
 }
 
+// Constant address in the io page: registers without a psxhw handler are
+// plain psxH storage and accessed in place, the others call their handler
+// straight away instead of going through psxMemRead/psxMemWrite. The cycle
+// those charge for each access is charged here too.
+
+static void iHwCycle() {
+    LWZ(3, OFFSET(&psxRegs, &psxRegs.cycle), GetHWRegSpecial(PSXREGS));
+    ADDI(3, 3, 1);
+    STW(3, OFFSET(&psxRegs, &psxRegs.cycle), GetHWRegSpecial(PSXREGS));
+}
+
+static int iHwRead(int width, int sign) {
+    u32 addr;
+    void *h;
+
+    if (!IsConst(_Rs_)) return 0;
+    addr = iRegs[_Rs_].k + _Imm_;
+
+    switch (width) {
+        case 1:
+            if (!PSXHW_IO8(addr)) return 0;
+            h = (void *) psxHwRead8Tbl[addr & 0xfff];
+            break;
+        case 2:
+            if (!PSXHW_IO16(addr)) return 0;
+            h = (void *) psxHwRead16Tbl[(addr & 0xfff) >> 1];
+            break;
+        default:
+            if (!PSXHW_IO32(addr)) return 0;
+            h = (void *) psxHwRead32Tbl[(addr & 0xfff) >> 2];
+            break;
+    }
+
+    iHwCycle();
+
+    if (h) {
+        DisposeHWReg(iRegs[_Rt_].reg);
+        LIW(3, addr);
+        InvalidateCPURegs();
+        CALLFunc((u32) h);
+
+        if (!_Rt_) return 1;
+        if (sign && width == 1) {
+            EXTSB(PutHWReg32(_Rt_), 3);
+        } else if (sign && width == 2) {
+            EXTSH(PutHWReg32(_Rt_), 3);
+        } else {
+            MR(PutHWReg32(_Rt_), 3);
+        }
+        return 1;
+    }
+
+    if (!_Rt_) return 1;
+
+    LIW(PutHWReg32(_Rt_), (u32) & psxH[addr & 0xffff]);
+    switch (width) {
+        case 1:
+            LBZ(PutHWReg32(_Rt_), 0, GetHWReg32(_Rt_));
+            if (sign) EXTSB(PutHWReg32(_Rt_), GetHWReg32(_Rt_));
+            break;
+        case 2:
+            LHBRX(PutHWReg32(_Rt_), 0, GetHWReg32(_Rt_));
+            if (sign) EXTSH(PutHWReg32(_Rt_), GetHWReg32(_Rt_));
+            break;
+        default:
+            LWBRX(PutHWReg32(_Rt_), 0, GetHWReg32(_Rt_));
+            break;
+    }
+    return 1;
+}
+
+static int iHwWrite(int width) {
+    u32 addr;
+    void *h;
+    int rt;
+
+    if (!IsConst(_Rs_)) return 0;
+    addr = iRegs[_Rs_].k + _Imm_;
+
+    switch (width) {
+        case 1:
+            if (!PSXHW_IO8(addr)) return 0;
+            h = (void *) psxHwWrite8Tbl[addr & 0xfff];
+            break;
+        case 2:
+            if (!PSXHW_IO16(addr)) return 0;
+            h = (void *) psxHwWrite16Tbl[(addr & 0xfff) >> 1];
+            break;
+        default:
+            if (!PSXHW_IO32(addr)) return 0;
+            h = (void *) psxHwWrite32Tbl[(addr & 0xfff) >> 2];
+            break;
+    }
+
+    iHwCycle();
+
+    if (h) {
+        preMemWrite(width);
+        CALLFunc((u32) h);
+        return 1;
+    }
+
+    rt = GetHWReg32(_Rt_);
+    LIW(3, (u32) & psxH[addr & 0xffff]);
+    switch (width) {
+        case 1: STB(rt, 0, 3); break;
+        case 2: STHBRX(rt, 0, 3); break;
+        default: STWBRX(rt, 0, 3); break;
+    }
+    return 1;
+}
+
 #if 1
 static void recLB() {
+	if (iHwRead(1, 1)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_LB,_Imm_);
 	} else {
@@ -1426,6 +1603,7 @@ static void recLB() {
 }
 
 static void recLBU() {
+	if (iHwRead(1, 0)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_LBU,_Imm_);
 	} else {
@@ -1439,6 +1617,7 @@ static void recLBU() {
 }
 
 static void recLH() {
+	if (iHwRead(2, 1)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_LH,_Imm_);		
 	} else {
@@ -1451,6 +1630,7 @@ static void recLH() {
 }
 
 static void recLHU() {
+	if (iHwRead(2, 0)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_LHU,_Imm_);
 	} else {
@@ -1463,6 +1643,7 @@ static void recLHU() {
 }
 
 static void recLW() {
+	if (iHwRead(4, 0)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_LW,_Imm_);
 	} else {
@@ -1474,6 +1655,7 @@ static void recLW() {
 	}
 }
 static void recSB() {
+	if (iHwWrite(1)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_SB,_Imm_);
 	} else {
@@ -1483,6 +1665,7 @@ static void recSB() {
 }
 
 static void recSH() {
+	if (iHwWrite(2)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_SH,_Imm_);
 	} else {
@@ -1492,6 +1675,7 @@ static void recSH() {
 }
 
 static void recSW() {
+	if (iHwWrite(4)) return;
 	if(Config.use_experimental_dr) {
 		recCallDynaMemVM(_Rs_,_Rt_,MEM_SW,_Imm_);
 	} else {
@@ -2904,16 +3088,277 @@ static void recCTC0() {
     recMTC0();
 }
 #endif
+/* --- GTE register moves --- */
+
+void gteMFC2();
+void gteSWC2();
+
+// the interpreter path, for the few registers not worth inlining
+static void iCp2Interp(void (*func)()) {
+    iFlushRegs(0);
+    LIW(0, (u32) psxRegs.code);
+    STW(0, OFFSET(&psxRegs, &psxRegs.code), GetHWRegSpecial(PSXREGS));
+    FlushAllHWReg();
+    CALLFunc((u32) func);
+}
+
+// MFC2 side of gte.c: returns the host register holding Cop2->reg,
+// -1 for IRGB/ORGB which are left to gteMFC2()
+static int iCp2Read(int reg) {
+    int hw;
+
+    switch (reg) {
+        case 1: case 3: case 5:
+        case 8: case 9: case 10: case 11:
+            hw = GetCp2Reg32(reg);
+            EXTSH(hw, hw);
+            PutCp2Reg32(reg);
+            return hw;
+
+        case 7:
+        case 16: case 17: case 18: case 19:
+            hw = GetCp2Reg32(reg);
+            RLWINM(hw, hw, 0, 16, 31);
+            PutCp2Reg32(reg);
+            return hw;
+
+        case 15:
+            hw = GetCp2Reg32(14);
+            MR(PutCp2Reg32(15), hw);
+            return GetCp2Reg32(15);
+
+        case 28:
+        case 29:
+            return -1;
+    }
+
+    return GetCp2Reg32(reg);
+}
+
+// MTC2 side of gte.c, src is a host register
+static void iCp2Write(int reg, int src) {
+    int hw;
+
+    switch (reg) {
+        case 15: // push onto the screen xy fifo
+            hw = GetCp2Reg32(13);
+            MR(PutCp2Reg32(12), hw);
+            hw = GetCp2Reg32(14);
+            MR(PutCp2Reg32(13), hw);
+            MR(PutCp2Reg32(14), src);
+            MR(PutCp2Reg32(15), src);
+            break;
+
+        case 28: // IRGB also sets the low halves of IR1-IR3
+            MR(PutCp2Reg32(28), src);
+            RLWINM(0, src, 7, 20, 24); // (src & 0x1f) << 7
+            hw = GetCp2Reg32(9);
+            RLWINM(hw, hw, 0, 0, 15);
+            OR(PutCp2Reg32(9), hw, 0);
+            RLWINM(0, src, 2, 20, 24); // (src & 0x3e0) << 2
+            hw = GetCp2Reg32(10);
+            RLWINM(hw, hw, 0, 0, 15);
+            OR(PutCp2Reg32(10), hw, 0);
+            RLWINM(0, src, 29, 20, 24); // (src & 0x7c00) >> 3
+            hw = GetCp2Reg32(11);
+            RLWINM(hw, hw, 0, 0, 15);
+            OR(PutCp2Reg32(11), hw, 0);
+            break;
+
+        case 30: // LZCR = leading sign bits of LZCS
+            MR(PutCp2Reg32(30), src);
+            SRAWI(0, src, 31);
+            XOR(0, 0, src);
+            CNTLZW(PutCp2Reg32(31), 0);
+            break;
+
+        case 31: // read only
+            break;
+
+        default:
+            MR(PutCp2Reg32(reg), src);
+            break;
+    }
+}
+
+static void recMFC2() {
+    int hw;
+    // Rt = Cop2->Rd
+    if (!_Rt_) return;
+
+    hw = iCp2Read(_Rd_);
+    if (hw == -1) {
+        iCp2Interp(gteMFC2);
+        return;
+    }
+
+    MR(PutHWReg32(_Rt_), hw);
+}
+
+static void recCFC2() {
+    // Rt = Cop2->Rd (control)
+    if (!_Rt_) return;
+
+    if (_Rd_ == 31) {
+        // SUM_FLAG: bit 31 if any of the error bits are set
+        LWZ(3, OFFSET(&psxRegs, &psxRegs.CP2C.r[31]), GetHWRegSpecial(PSXREGS));
+        LIW(4, 0x7f87e000);
+        AND(4, 3, 4);
+        NEG(5, 4);
+        OR(4, 4, 5);
+        RLWINM(4, 4, 0, 0, 0);
+        OR(3, 3, 4);
+        STW(3, OFFSET(&psxRegs, &psxRegs.CP2C.r[31]), GetHWRegSpecial(PSXREGS));
+        MR(PutHWReg32(_Rt_), 3);
+        return;
+    }
+
+    LWZ(PutHWReg32(_Rt_), OFFSET(&psxRegs, &psxRegs.CP2C.r[_Rd_]), GetHWRegSpecial(PSXREGS));
+}
+
+static void recMTC2() {
+    // Cop2->Rd = Rt
+    iCp2Write(_Rd_, GetHWReg32(_Rt_));
+}
+
+static void recCTC2() {
+    // Cop2->Rd = Rt (control)
+    switch (_Rd_) {
+        case 4: case 12: case 20:
+        case 26: case 27: case 29: case 30:
+            EXTSH(0, GetHWReg32(_Rt_));
+            STW(0, OFFSET(&psxRegs, &psxRegs.CP2C.r[_Rd_]), GetHWRegSpecial(PSXREGS));
+            break;
+
+        case 31:
+            RLWINM(0, GetHWReg32(_Rt_), 0, 1, 19); // & 0x7ffff000
+            STW(0, OFFSET(&psxRegs, &psxRegs.CP2C.r[_Rd_]), GetHWRegSpecial(PSXREGS));
+            break;
+
+        default:
+            STW(GetHWReg32(_Rt_), OFFSET(&psxRegs, &psxRegs.CP2C.r[_Rd_]), GetHWRegSpecial(PSXREGS));
+            break;
+    }
+}
+
+static void recLWC2() {
+    // Cop2->Rt = mem[Rs + Im]
+    ADDI(3, GetHWReg32(_Rs_), _Imm_);
+    CALLFunc((u32) psxMemRead32);
+    iCp2Write(_Rt_, 3);
+}
+
+static void recSWC2() {
+    int hw;
+    // mem[Rs + Im] = Cop2->Rt
+    hw = iCp2Read(_Rt_);
+    if (hw == -1) {
+        iCp2Interp(gteSWC2);
+        return;
+    }
+
+    MR(4, hw);
+    ADDI(3, GetHWReg32(_Rs_), _Imm_);
+    CALLFunc((u32) psxMemWrite32);
+}
+
+/* --- GTE commands --- */
+
+// MAC0 = F(hi:lo); leaves the resulting FLAG in r5
+static void iCp2Mac0(int lo, int hi) {
+    SRAWI(3, lo, 31);
+    XOR(3, 3, hi);
+    NEG(4, 3);
+    OR(3, 3, 4);
+    SRAWI(3, 3, 31); // ~0 if hi:lo does not fit into 32 bits
+    SRWI(4, hi, 31);
+    LIS(5, 1);
+    SRW(5, 5, 4); // 1 << 16 above, 1 << 15 below
+    AND(5, 5, 3);
+    MR(PutCp2Reg32(24), lo);
+}
+
+static void recNCLIP() {
+    int i;
+    // MAC0 = SX0 * (SY1 - SY2) + SX1 * (SY2 - SY0) + SX2 * (SY0 - SY1)
+    for (i = 0; i < 3; i++) {
+        int hw = GetCp2Reg32(12 + i);
+        EXTSH(3 + i * 2, hw); // SXn
+        SRAWI(4 + i * 2, hw, 16); // SYn
+    }
+
+    SUB(9, 6, 8);
+    MULLW(10, 3, 9);
+    MULHW(11, 3, 9);
+    SUB(9, 8, 4);
+    MULLW(12, 5, 9);
+    MULHW(9, 5, 9);
+    ADDC(10, 10, 12);
+    ADDE(11, 11, 9);
+    SUB(9, 4, 6);
+    MULLW(12, 7, 9);
+    MULHW(9, 7, 9);
+    ADDC(10, 10, 12);
+    ADDE(11, 11, 9);
+
+    iCp2Mac0(10, 11);
+    STW(5, OFFSET(&psxRegs, &psxRegs.CP2C.r[31]), GetHWRegSpecial(PSXREGS));
+}
+
+// MAC0 = ZSF * (SZ[first] + ...), OTZ = limD(MAC0 >> 12)
+static void iAVSZ(u32 zsf, int first, int n) {
+    u32 *neg, *inside, *done;
+    int i, hw;
+
+    LHA(3, zsf, GetHWRegSpecial(PSXREGS));
+    RLWINM(4, GetCp2Reg32(first), 0, 16, 31);
+    for (i = 1; i < n; i++) {
+        RLWINM(5, GetCp2Reg32(first + i), 0, 16, 31);
+        ADD(4, 4, 5);
+    }
+    MULLW(6, 3, 4);
+    MULHW(7, 3, 4);
+
+    iCp2Mac0(6, 7);
+
+    // the shifted sum always fits into 32 bits
+    SRWI(8, 6, 12);
+    SLWI(9, 7, 20);
+    OR(8, 8, 9);
+
+    CMPWI(8, 0);
+    BLT_L(neg);
+    CMPLWI(8, 0xffff);
+    BLE_L(inside);
+    LI(8, 0);
+    ORI(8, 8, 0xffff);
+    ORIS(5, 5, 0x0004); // 1 << 18
+    B_L(done);
+    B_DST(neg);
+    LI(8, 0);
+    ORIS(5, 5, 0x0004);
+    B_DST(inside);
+    B_DST(done);
+
+    // OTZ only owns the low half
+    hw = GetCp2Reg32(7);
+    RLWINM(hw, hw, 0, 0, 15);
+    OR(PutCp2Reg32(7), hw, 8);
+
+    STW(5, OFFSET(&psxRegs, &psxRegs.CP2C.r[31]), GetHWRegSpecial(PSXREGS));
+}
+
+static void recAVSZ3() {
+    iAVSZ(OFFSET(&psxRegs, &psxRegs.CP2C.p[29].sw.l), 17, 3);
+}
+
+static void recAVSZ4() {
+    iAVSZ(OFFSET(&psxRegs, &psxRegs.CP2C.p[30].sw.l), 16, 4);
+}
+
 // GTE function callers
-CP2_FUNC(MFC2);
-CP2_FUNC(MTC2);
-CP2_FUNC(CFC2);
-CP2_FUNC(CTC2);
-CP2_FUNC(LWC2);
-CP2_FUNC(SWC2);
 CP2_FUNCNC(RTPS);
 CP2_FUNC(OP);
-CP2_FUNCNC(NCLIP);
 CP2_FUNC(DPCS);
 CP2_FUNC(INTPL);
 CP2_FUNC(MVMVA);
@@ -2927,8 +3372,6 @@ CP2_FUNCNC(NCT);
 CP2_FUNC(SQR);
 CP2_FUNC(DCPL);
 CP2_FUNCNC(DPCT);
-CP2_FUNCNC(AVSZ3);
-CP2_FUNCNC(AVSZ4);
 CP2_FUNCNC(RTPT);
 CP2_FUNC(GPF);
 CP2_FUNC(GPL);
@@ -3028,6 +3471,7 @@ void recRecompile() {
     }
     iRegs[0].k = 0;
     iRegs[0].state = ST_CONST;
+    memset(cp2Regs, -1, sizeof (cp2Regs));
 
     /* if ppcPtr reached the mem limit reset whole mem */
     if (((u32) ppcPtr - (u32) recMem) >= (RECMEM_SIZE - 0x10000)) // fix me. don't just assume 0x10000
@@ -3044,6 +3488,8 @@ void recRecompile() {
 
     pcold = pc = psxRegs.pc;
 
+    BuildPsxRegLiveness(pc);
+
     //where did 500 come from?
     for (count = 0; count < 500;) {
         p = (char *) PSXM(pc);
@@ -3064,6 +3510,8 @@ void recRecompile() {
         iRet();
     }
 
+    ClearPsxRegLiveness();
+
     invalidateCache((u32)(u8*)ptr, (u32)(u8*)ppcPtr);
 
 	if (do_disasm || force_disasm) {
@@ -132,6 +132,10 @@
 	{int _reg1 = (REG1), _reg2 = (REG2); int _dst=(REG_DST); \
         INSTR = (0x7C000414 | (_dst << 21) | (_reg1 << 16) |  (_reg2 << 11));}
 
+#define ADDC(REG_DST, REG1, REG2) \
+	{int _reg1 = (REG1), _reg2 = (REG2); int _dst=(REG_DST); \
+        INSTR = (0x7C000014 | (_dst << 21) | (_reg1 << 16) |  (_reg2 << 11));}
+
 #define ADDIC(REG_DST, REG_SRC, IMM) \
 	{int _src = (REG_SRC); int _dst=(REG_DST); \
         INSTR = (0x30000000 | (_dst << 21) | (_src << 16) | ((IMM) & 0xffff));}
@@ -445,6 +449,10 @@
         INSTR = (0x7C000734 | (_src << 21) | (_dst << 16));}
 
 
+#define CNTLZW(REG_DST, REG_SRC) \
+	{int _src = (REG_SRC); int _dst=(REG_DST); \
+        INSTR = (0x7C000034 | (_src << 21) | (_dst << 16));}
+
 /* floating point ops */
 #define FDIVS(FPR_DST, FPR1, FPR2) \
 	{INSTR = (0xEC000024 | (FPR_DST << 21) | (FPR1 << 16) | (FPR2 << 11));}
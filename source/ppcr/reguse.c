@@ -344,6 +344,117 @@ static int _nextPsxRegUse(u32 pc, int psxreg, int numInstr)
 }
 
 
+/* Block liveness: one backward pass (repeated for loops inside the window)
+ * over the recompiled block plus some lookahead gives, for every pc, the set
+ * of psx registers (GPRs, LO=32, HI=33) that may be read before they are
+ * written. Everything leaving the window is assumed live. */
+
+#define LIVE_ALL       0x3ffffffffULL
+#define LIVE_LOOKAHEAD 80
+#define LIVE_MAX       (500 + 1 + LIVE_LOOKAHEAD)
+
+static u32 liveStart = 0, liveCount = 0;
+static u64 liveIn[LIVE_MAX];
+static u64 liveUse[LIVE_MAX], liveDef[LIVE_MAX];
+static int liveType[LIVE_MAX];
+static u32 liveCode[LIVE_MAX];
+
+static void regUseMasks(u32 code, int use, u64 *r, u64 *w)
+{
+    *r = *w = 0;
+
+    if (REGUSE_UNKNOWN == use) {
+        *r = LIVE_ALL;
+        return;
+    }
+
+    if (use & REGUSE_RT_R) *r |= 1ULL << _fRt_(code);
+    if (use & REGUSE_RT_W) *w |= 1ULL << _fRt_(code);
+    if (use & REGUSE_RS_R) *r |= 1ULL << _fRs_(code);
+    if (use & REGUSE_RS_W) *w |= 1ULL << _fRs_(code);
+    if (use & REGUSE_RD_R) *r |= 1ULL << _fRd_(code);
+    if (use & REGUSE_RD_W) *w |= 1ULL << _fRd_(code);
+    if (use & REGUSE_R31_W) *w |= 1ULL << 31;
+    if (use & REGUSE_LO_R) *r |= 1ULL << 32;
+    if (use & REGUSE_LO_W) *w |= 1ULL << 32;
+    if (use & REGUSE_HI_R) *r |= 1ULL << 33;
+    if (use & REGUSE_HI_W) *w |= 1ULL << 33;
+}
+
+static inline u64 liveAt(u32 pc)
+{
+    u32 i = (pc - liveStart) >> 2;
+
+    return (i < liveCount) ? liveIn[i] : LIVE_ALL;
+}
+
+void BuildPsxRegLiveness(u32 startpc)
+{
+    u32 *ptr, code, pc, target;
+    int i, n, type, blockEnd = 0, changed;
+    u64 out, in;
+
+    liveStart = startpc;
+    liveCount = 0;
+
+    // decode the block (up to its branch and delay slot) and the lookahead
+    for (n = 0, pc = startpc; n < LIVE_MAX; n++, pc += 4) {
+        ptr = (u32*)PSXM(pc);
+        if (ptr == NULL) break;
+
+        code = SWAP32(*ptr);
+        liveCode[n] = code;
+        liveType[n] = getRegUse(code);
+        regUseMasks(code, liveType[n], &liveUse[n], &liveDef[n]);
+        liveIn[n] = 0;
+
+        type = liveType[n] & REGUSE_TYPEM;
+        if (!blockEnd && (type == REGUSE_BRANCH || type == REGUSE_JUMP ||
+                          type == REGUSE_JUMPR || type == REGUSE_SYS ||
+                          liveType[n] == REGUSE_UNKNOWN))
+            blockEnd = n + 1 + LIVE_LOOKAHEAD;
+        if (blockEnd && n + 1 >= blockEnd) { n++; break; }
+    }
+    liveCount = n;
+
+    // backward dataflow until stable (only backward branches need a 2nd pass)
+    do {
+        changed = 0;
+
+        for (i = n - 1; i >= 0; i--) {
+            pc = startpc + i * 4;
+            type = (i > 0) ? (liveType[i - 1] & REGUSE_TYPEM) : REGUSE_NONE;
+
+            out = ((u32)(i + 1) < liveCount) ? liveIn[i + 1] : LIVE_ALL;
+
+            // a delay slot may also be entered directly (branch target),
+            // so the fall through successor always stays in the set
+            if ((liveType[i] & REGUSE_TYPEM) == REGUSE_SYS) {
+                out = LIVE_ALL; // exception
+            } else if (type == REGUSE_BRANCH) {
+                target = _fImm_(liveCode[i - 1]) * 4 + pc;
+                out |= liveAt(target);
+            } else if (type == REGUSE_JUMP) {
+                target = _fTarget_(liveCode[i - 1]) * 4 + (pc & 0xf0000000);
+                out |= liveAt(target);
+            } else if (type == REGUSE_JUMPR) {
+                out = LIVE_ALL;
+            }
+
+            in = liveUse[i] | (out & ~liveDef[i]);
+            if (in != liveIn[i]) {
+                liveIn[i] = in;
+                changed = 1;
+            }
+        }
+    } while (changed);
+}
+
+void ClearPsxRegLiveness()
+{
+    liveCount = 0;
+}
+
 int nextPsxRegUse(u32 pc, int psxreg)
 {
 #if 1
@@ -353,6 +464,10 @@ int nextPsxRegUse(u32 pc, int psxreg)
 #ifdef SAME_CYCLE_MODE
 	return REGUSE_READ;
 #else
+	// inside the block being recompiled: answer from the liveness table
+	if (((pc - liveStart) >> 2) < liveCount && !(pc & 3))
+		return ((liveIn[(pc - liveStart) >> 2] >> psxreg) & 1) ? REGUSE_READ : REGUSE_WRITE;
+
 	return _nextPsxRegUse(pc, psxreg, 80);
 #endif
 #else
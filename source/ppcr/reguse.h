@@ -74,4 +74,8 @@ int useOfPsxReg(u32 code, int use, int psxreg) __attribute__ ((__pure__));;
 int nextPsxRegUse(u32 pc, int psxreg) __attribute__ ((__pure__));;
 int isPsxRegUsed(u32 pc, int psxreg) __attribute__ ((__pure__));;
 
+// per block liveness table, valid between these two calls
+void BuildPsxRegLiveness(u32 startpc);
+void ClearPsxRegLiveness();
+
 #endif /* __REGUSE_H__ */
@@ -0,0 +1,321 @@
+/*
+ * The HLE bios memory and string calls (psxbios.c) against the byte loops
+ * of the rom: memcpy, bcopy, memmove, memset, bzero, bcmp, strlen, strcpy
+ * and strcmp on random ram, with the ends of their ranges near where a ram
+ * mirror wraps, where the mirrors run out into unmapped memory, in the
+ * scratchpad and the parallel port, and copies that overlap themselves
+ * directly or through a mirror. The return value and all of ram have to
+ * come out the same. Then bytes a second for both on long runs.
+ *
+ *   biosmem [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "psxcommon.h"
+#include "psxmem.h"
+#include "r3000a.h"
+
+void psxBios_memcpy(void);
+void psxBios_bcopy(void);
+void psxBios_memmove(void);
+void psxBios_memset(void);
+void psxBios_bzero(void);
+void psxBios_bcmp(void);
+void psxBios_strlen(void);
+void psxBios_strcpy(void);
+void psxBios_strcmp(void);
+
+#define RAM			0x00230000	// psxM with the parallel port and scratchpad behind it
+
+enum { MEMCPY, BCOPY, MEMMOVE, MEMSET, BZERO, BCMP, STRLEN, STRCPY, STRCMP, CALLS };
+
+static const struct {
+	const char *name;
+	void (*hle)(void);
+} calls[CALLS] = {
+	{ "memcpy",  psxBios_memcpy },
+	{ "bcopy",   psxBios_bcopy },
+	{ "memmove", psxBios_memmove },
+	{ "memset",  psxBios_memset },
+	{ "bzero",   psxBios_bzero },
+	{ "bcmp",    psxBios_bcmp },
+	{ "strlen",  psxBios_strlen },
+	{ "strcpy",  psxBios_strcpy },
+	{ "strcmp",  psxBios_strcmp },
+};
+
+static u8 *start, *after;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+/*
+ * The rom's loops, a byte at a time through the lut, where an unmapped
+ * byte ends the call as it does for the bulk versions.
+ */
+
+static u8 byteAt(u32 addr) {
+	u8 *p = PSXM(addr);
+	return p != NULL ? *p : 0;
+}
+
+static void byteCopy(u32 dst, u32 src, u32 n) {
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		u8 *d = PSXM(dst + i), *s = PSXM(src + i);
+
+		if (d == NULL || s == NULL) break;
+		*d = *s;
+	}
+}
+
+static u32 refCall(int call, u32 a0, u32 a1, u32 a2) {
+	u8 *d, *s;
+	u32 i;
+
+	switch (call) {
+		case MEMCPY:
+			byteCopy(a0, a1, a2);
+			return a0;
+
+		case BCOPY:
+			byteCopy(a1, a0, a2);
+			return 0;
+
+		case MEMMOVE:
+			d = PSXM(a0); s = PSXM(a1);
+			if (s <= d && s + a2 > d) {
+				for (i = a2 + 1; i-- != 0; ) {		// one byte more, as the rom
+					d = PSXM(a0 + i); s = PSXM(a1 + i);
+					if (d != NULL && s != NULL) *d = *s;
+				}
+			} else
+				byteCopy(a0, a1, a2);
+			return a0;
+
+		case MEMSET:
+		case BZERO:
+			for (i = 0; i < (call == MEMSET ? a2 : a1); i++) {
+				if ((d = PSXM(a0 + i)) == NULL) break;
+				*d = call == MEMSET ? a1 : 0;
+			}
+			return call == MEMSET ? a0 : 0;
+
+		case BCMP:
+			if (a0 == 0 || a1 == 0) return 0;
+			for (i = 0; i < a2; i++) {
+				if (PSXM(a0 + i) == NULL || PSXM(a1 + i) == NULL) break;
+				if (byteAt(a0 + i) != byteAt(a1 + i))
+					return byteAt(a0 + i + 1) - byteAt(a1 + i + 1);	// the next byte, as the rom
+			}
+			return 0;
+
+		case STRLEN:
+			for (i = 0; PSXM(a0 + i) != NULL && byteAt(a0 + i) != 0; i++);
+			return i;
+
+		case STRCPY:
+			for (i = 0; ; i++) {
+				d = PSXM(a0 + i); s = PSXM(a1 + i);
+				if (d == NULL || s == NULL || (*d = *s) == 0) break;
+			}
+			return a0;
+
+		default:
+			for (i = 0; ; i++) {
+				if (PSXM(a0 + i) == NULL || PSXM(a1 + i) == NULL) return 0;
+				if (byteAt(a0 + i) != byteAt(a1 + i)) return byteAt(a0 + i) - byteAt(a1 + i);
+				if (byteAt(a0 + i) == 0) return 0;
+			}
+	}
+}
+
+static u32 hleCall(int call, u32 a0, u32 a1, u32 a2) {
+	psxRegs.GPR.n.a0 = a0;
+	psxRegs.GPR.n.a1 = a1;
+	psxRegs.GPR.n.a2 = a2;
+	psxRegs.GPR.n.v0 = 0;
+	calls[call].hle();
+	return psxRegs.GPR.n.v0;
+}
+
+/*
+ * An address: anywhere in the mirrored ram, in any segment, or close below
+ * where a mirror wraps, where the last one ends, the end of the scratchpad
+ * page or of the parallel port.
+ */
+static u32 address(u32 *seed) {
+	static const u32 seg[3] = { 0x00000000, 0x80000000, 0xa0000000 };
+	u32 x = rnd(seed), back = rnd(seed) % 512;
+
+	switch (x % 8) {
+		case 0: case 1: case 2:
+			return seg[x / 8 % 3] + rnd(seed) % 0x800000;
+		case 3: case 4:
+			return seg[x / 8 % 3] + ((x / 32 % 3 + 1) << 21) - back;
+		case 5:
+			return seg[x / 8 % 3] + 0x800000 - back;
+		case 6:
+			return x & 256 ? 0x1f800000 + rnd(seed) % 0x400 : 0x1f810000 - back;
+		default:
+			return 0x1f010000 - back;
+	}
+}
+
+static u32 length(u32 *seed) {
+	u32 x = rnd(seed);
+
+	return x % 16 == 0 ? rnd(seed) % 0x30000 : x % 16 == 1 ? 0 : rnd(seed) % 600;
+}
+
+// whether [a, a + n) and [b, b + n) share a host byte, for strcpy
+static int aliased(u32 a, u32 b, u32 n) {
+	static u8 mark[RAM];
+	u8 *p;
+	u32 i;
+	int hit = 0;
+
+	for (i = 0; i < n; i++)
+		if ((p = PSXM(a + i)) != NULL && p >= (u8 *)psxM && p < (u8 *)psxM + RAM)
+			mark[p - (u8 *)psxM] = 1;
+	for (i = 0; i < n && !hit; i++)
+		if ((p = PSXM(b + i)) != NULL && p >= (u8 *)psxM && p < (u8 *)psxM + RAM)
+			hit = mark[p - (u8 *)psxM];
+	for (i = 0; i < n; i++)
+		if ((p = PSXM(a + i)) != NULL && p >= (u8 *)psxM && p < (u8 *)psxM + RAM)
+			mark[p - (u8 *)psxM] = 0;
+	return hit;
+}
+
+// a1 made to start with the string at a0, ended somewhere after or not
+static void sameStrings(u32 a0, u32 a1, u32 *seed) {
+	u32 n = rnd(seed) % 300, i;
+	u8 *d;
+
+	for (i = 0; i < n && byteAt(a0 + i) != 0; i++)
+		if ((d = PSXM(a1 + i)) != NULL) *d = byteAt(a0 + i);
+	if (rnd(seed) % 2 && (d = PSXM(a1 + i)) != NULL)
+		*d = byteAt(a0 + i);
+}
+
+static double bench(int call, int hle, u32 a0, u32 a1, u32 a2, u32 bytes) {
+	double t = now();
+	int i;
+
+	for (i = 0; i < 200; i++)
+		hle ? hleCall(call, a0, a1, a2) : refCall(call, a0, a1, a2);
+	return 200.0 * bytes / (now() - t) / 1048576;
+}
+
+int main(int argc, char *argv[]) {
+	int n = argc > 1 ? atoi(argv[1]) : 5000, k, call, errors = 0;
+	u32 seed = 0x5eed, a0, a1, a2, want, got, i, done[CALLS], bad[CALLS];
+
+	start = malloc(RAM);
+	after = malloc(RAM);
+	if (start == NULL || after == NULL || psxMemInit() != 0)
+		return 1;
+
+	// strings of a few dozen bytes on average
+	for (i = 0; i < RAM; i++) {
+		start[i] = rnd(&seed);
+		if (rnd(&seed) % 48 == 0) start[i] = 0;
+	}
+	for (i = 0; i < 0x80000; i++) psxR[i] = rnd(&seed) | 1;
+
+	memset(done, 0, sizeof(done));
+	memset(bad, 0, sizeof(bad));
+	for (k = 0; k < n; k++) {
+		u32 setup = rnd(&seed);
+
+		call = rnd(&seed) % CALLS;
+		a0 = address(&seed);
+		a1 = address(&seed);
+		a2 = length(&seed);
+
+		switch (call) {
+			case MEMSET:
+				a1 = rnd(&seed) & 0xff;
+				break;
+			case BZERO:
+				a1 = a2;
+				break;
+			case MEMCPY: case BCOPY: case MEMMOVE: case BCMP:
+				// overlapping, in the same mirror or through another one
+				if (setup % 3 == 0)
+					a1 = a0 + (setup / 4 % 64) - 32 + (setup % 9 == 0 ? (setup / 256 % 4) << 21 : 0);
+				break;
+			case STRCPY:
+				if (aliased(a0, a1, 0x1000)) continue;
+				break;
+		}
+
+		memcpy(psxM, start, RAM);
+		if (call == STRCMP || (call == BCMP && setup % 2)) {
+			sameStrings(a1, a0, &seed);
+			memcpy(start, psxM, RAM);
+		}
+
+		want = refCall(call, a0, a1, a2);
+		memcpy(after, psxM, RAM);
+		memcpy(psxM, start, RAM);
+		got = hleCall(call, a0, a1, a2);
+
+		done[call]++;
+		if (got != want || memcmp(psxM, after, RAM) != 0) {
+			if (bad[call]++ < 3) {
+				for (i = 0; i < RAM && ((u8 *)psxM)[i] == after[i]; i++);
+				printf("  %s(%08x, %08x, %x): %x for %x", calls[call].name, a0, a1, a2, got, want);
+				if (i < RAM) printf(", ram differs at %x", i);
+				printf("\n");
+			}
+		}
+	}
+
+	for (call = 0; call < CALLS; call++) {
+		printf("%-8s %5u calls, %u differ\n", calls[call].name, done[call], bad[call]);
+		if (bad[call] || done[call] == 0)
+			errors++;
+	}
+
+	// 64k at a time in one mirror, the strings 16k long
+	memset(psxM, 'x', 0x200000);
+	psxM[0x14000] = psxM[0x34000] = psxM[0x54000] = 0;
+	printf("MB/s     byte loop   bulk\n");
+	for (call = 0; call < CALLS; call++) {
+		static const u32 args[CALLS][3] = {
+			{ 0x80100000, 0x80010000, 0x10000 },	// memcpy
+			{ 0x80010000, 0x80100000, 0x10000 },	// bcopy
+			{ 0x80010100, 0x80010000, 0x10000 },	// memmove, backwards
+			{ 0x80100000, 0x5a, 0x10000 },			// memset
+			{ 0x80100000, 0x10000, 0 },				// bzero
+			{ 0x80150000, 0x80170000, 0x10000 },	// bcmp, all equal
+			{ 0x80010000, 0, 0 },					// strlen
+			{ 0x80120000, 0x80030000, 0 },			// strcpy
+			{ 0x80030000, 0x80050000, 0 },			// strcmp, all equal
+		};
+		u32 bytes = call >= STRLEN ? 0x4000 : 0x10000;
+
+		printf("%-8s %9.0f %6.0f\n", calls[call].name,
+			bench(call, 0, args[call][0], args[call][1], args[call][2], bytes),
+			bench(call, 1, args[call][0], args[call][1], args[call][2], bytes));
+	}
+
+	free(start);
+	free(after);
+	return errors != 0;
+}
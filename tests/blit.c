@@ -0,0 +1,173 @@
+/*
+ * The soft gpu's output conversion (v_blit.c) against the one thread
+ * version it replaced (ref/blit.c): frames of random vram in 15 and 24 bit,
+ * at the widths games use, centered or not, from anywhere in vram, go
+ * through both onto surfaces poisoned the same. The surfaces have to come
+ * out the same byte for byte, with the lower band on the helper thread and
+ * without it, and the old version's output has to hash to what it always
+ * did. Then frames a second for the old version, one band and two.
+ *
+ *   blit [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// the cache hints and barriers are ppc asm: on the host they only have to
+// keep the compiler from moving memory accesses across them
+#define __volatile__(...) __volatile__("" : : : "memory")
+
+#include "../source/plugins/xenon_gfx/v_blit.c"
+
+#define BlitScreen32	refBlitScreen32
+#include "ref/blit.c"
+#undef BlitScreen32
+
+#undef __volatile__
+
+#define PITCH		(1024 * 4 + 128)	// a row of the widest texture, and some
+#define SURFACE		(PITCH * 512)
+#define GOLDEN		0x187942dd			// crc of the old version's surfaces over the frames
+
+int g_pPitch;
+
+static uint32_t rnd(uint32_t *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// a display mode: width, height, centering and depth
+typedef struct {
+	int w, h, x0, y0, rgb24;
+} Mode;
+
+static const Mode modes[] = {
+	{ 256, 240, 0, 0, 0 },
+	{ 320, 240, 0, 0, 0 },
+	{ 320, 240, 24, 16, 0 },		// centered both ways
+	{ 368, 240, 0, 0, 0 },
+	{ 512, 480, 0, 0, 0 },
+	{ 640, 480, 0, 0, 0 },
+	{ 640, 480, 0, 1, 0 },			// one odd line of centering
+	{ 320, 24, 0, 0, 0 },			// too few lines for two bands
+	{ 320, 240, 0, 0, 1 },			// mdec movies
+	{ 640, 480, 32, 8, 1 },
+};
+
+#define MODES	(int)(sizeof(modes) / sizeof(modes[0]))
+
+static void setMode(const Mode *m) {
+	PreviousPSXDisplay.Range.x0 = m->x0;
+	PreviousPSXDisplay.Range.x1 = m->w;
+	PreviousPSXDisplay.Range.y0 = m->y0;
+	PreviousPSXDisplay.DisplayMode.y = m->h;
+	PSXDisplay.RGB24 = m->rgb24;
+}
+
+static void frames(const Mode *m, int n, int which, uint8_t *surf) {
+	int i;
+
+	setMode(m);
+	for (i = 0; i < n; i++)
+		which ? BlitScreen32(surf, 0, 0) : refBlitScreen32(surf, 0, 0);
+}
+
+int main(int argc, char *argv[]) {
+	static const char *name[] = { "one band", "two bands" };
+	int n = argc > 1 ? atoi(argv[1]) : 200, mode, bands, k, cpus, errors = 0;
+	uint32_t seed = 0xb117, golden = 0, i, x, y, bad;
+	uint8_t *want, *got;
+	uint16_t *vram;
+	double t, tref, t1, t2;
+
+	// a line more than vram: a 24 bit row at the right edge reads past it
+	vram = malloc((1024 * 513) * 2);
+	want = memalign(128, SURFACE);
+	got = memalign(128, SURFACE);
+	if (vram == NULL || want == NULL || got == NULL)
+		return 1;
+	for (i = 0; i < 1024 * 513; i++)
+		vram[i] = rnd(&seed);
+	psxVuw = vram;
+	g_pPitch = PITCH;
+
+	for (bands = 0; bands < 2; bands++) {
+		if (bands)
+			StartBlitThread();
+
+		for (mode = 0; mode < MODES; mode++) {
+			const Mode *m = &modes[mode];
+
+			setMode(m);
+			bad = 0;
+			for (k = 0; k < 16; k++) {
+				// anywhere the display fits, and the corners
+				x = k == 0 ? 0 : k == 1 ? 1024 - m->w * (m->rgb24 ? 3 : 2) / 2 : rnd(&seed) % (1024 - m->w * (m->rgb24 ? 3 : 2) / 2 + 1);
+				y = k == 0 ? 0 : k == 1 ? 512 - m->h : rnd(&seed) % (512 - m->h + 1);
+
+				memset(want, 0x5a, SURFACE);
+				memset(got, 0x5a, SURFACE);
+				refBlitScreen32(want, x, y);
+				BlitScreen32(got, x, y);
+
+				if (bands == 0)
+					golden = crc32(golden, want, SURFACE);
+				if (memcmp(want, got, SURFACE) != 0) {
+					for (i = 0; want[i] == got[i]; i++);
+					if (bad++ < 3)
+						printf("  %dx%d at %u,%u: row %u, byte %u differs\n", m->w, m->h, x, y,
+							i / PITCH, i % PITCH);
+				}
+			}
+			if (bad) {
+				printf("%dx%d%s, %s: %u of 16 frames differ\n", m->w, m->h, m->rgb24 ? " 24 bit" : "",
+					name[bands], bad);
+				errors++;
+			}
+		}
+	}
+
+	printf("golden surface crc %08x\n", golden);
+	if (golden != GOLDEN) {
+		printf("  expected %08x: the frames or the old version changed\n", GOLDEN);
+		errors++;
+	}
+
+	// the modes without centering, over and over; on one cpu the helper only
+	// gets the time slices the caller spins away
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	printf("frames/s          before  one band  two bands\n");
+	for (mode = 0; mode < MODES; mode++) {
+		const Mode *m = &modes[mode];
+
+		if (m->x0 || m->y0 || m->h < 32)
+			continue;
+
+		t = now(); frames(m, n, 0, want); tref = now() - t;
+		blit_running = 0;
+		t = now(); frames(m, n, 1, got); t1 = now() - t;
+		blit_running = 1;
+		t = now(); frames(m, cpus > 1 ? n : 1, 1, got); t2 = now() - t;
+
+		printf("%3dx%3d%-7s %9.0f %9.0f", m->w, m->h, m->rgb24 ? " 24 bit" : "", n / tref, n / t1);
+		if (cpus > 1)
+			printf(" %10.0f\n", n / t2);
+		else
+			printf("  (one cpu)\n");
+	}
+
+	free(vram);
+	free(want);
+	free(got);
+	return errors != 0;
+}
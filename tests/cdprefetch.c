@@ -0,0 +1,245 @@
+/*
+ * The cd prefetch in front of slow storage: a CDR plugin that takes its
+ * time for every sector and much longer for a seek, read the way the
+ * emulated drive reads, at its pace. Every sector has to arrive intact, the
+ * plugin must never be entered by two threads at once, and the emu thread
+ * has to spend far less time waiting than when it reads the plugin itself.
+ * The Play of an audio track reads its subq first, that must not cost the
+ * audio window.
+ *
+ *   cdprefetch [sector us] [seek us] [pace us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "psxcommon.h"
+#include "plugins.h"
+#include "cdrom.h"
+#include "cdrprefetch.h"
+
+static int sectorUs = 300, seekUs = 10000, paceUs = 1000;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Storage: the sector after the last one costs sectorUs, anything else a
+ * seek. Sector contents depend on the lba and the kind of read.
+ */
+
+static unsigned char buf[CD_FRAMESIZE_RAW], sub[SUB_FRAMESIZE];
+static volatile int inside;
+static int last = -2, reentered;
+
+static void fill(unsigned char *p, int n, int lba, int audio) {
+	int i;
+
+	for (i = 0; i < n; i++)
+		p[i] = (lba * 7 + i * 13 + audio) >> (i & 3);
+}
+
+static void storage(int lba) {
+	if (__sync_fetch_and_add(&inside, 1) != 0)
+		reentered++;
+	usleep(lba == last + 1 ? sectorUs : seekUs);
+	last = lba;
+}
+
+static long CALLBACK slowReadTrack(unsigned char *time) {
+	int lba = (btoi(time[0]) * 60 + btoi(time[1])) * 75 + btoi(time[2]);
+
+	storage(lba);
+	fill(buf + 12, DATA_SIZE, lba, 0);
+	fill(sub, SUB_FRAMESIZE, lba, 1);
+	__sync_fetch_and_sub(&inside, 1);
+	return 0;
+}
+
+static unsigned char * CALLBACK slowGetBuffer(void) {
+	return buf + 12;
+}
+
+static unsigned char * CALLBACK slowGetBufferSub(void) {
+	return sub;
+}
+
+static long CALLBACK slowReadCDDA(unsigned char m, unsigned char s, unsigned char f, unsigned char *buffer) {
+	int lba = (m * 60 + s) * 75 + f;
+
+	storage(lba);
+	fill(buffer, CD_FRAMESIZE_RAW, lba, 2);
+	__sync_fetch_and_sub(&inside, 1);
+	return 0;
+}
+
+/*
+ * The drive: a seek, then one sector per paceUs. With prefetch off the
+ * sectors come from the plugin straight away, as they did before.
+ */
+
+typedef struct {
+	int sectors, bad;
+	double stall;
+} Run;
+
+static void msf(int lba, u8 *t) {
+	t[0] = lba / 75 / 60;
+	t[1] = lba / 75 % 60;
+	t[2] = lba % 75;
+}
+
+static int check(const unsigned char *p, int n, int lba, int audio) {
+	unsigned char want[CD_FRAMESIZE_RAW];
+
+	fill(want, n, lba, audio);
+	return p != NULL && memcmp(p, want, n) == 0;
+}
+
+static void readData(int prefetch, int lba, Run *r) {
+	u8 t[3], bcd[3];
+	unsigned char *data, *s;
+	double t0;
+
+	msf(lba, t);
+	bcd[0] = itob(t[0]); bcd[1] = itob(t[1]); bcd[2] = itob(t[2]);
+
+	t0 = now();
+	if (prefetch) {
+		cdrPrefetchRead(bcd);
+		data = cdrPrefetchBuffer();
+		s = cdrPrefetchSub();
+	} else {
+		CDR_readTrack(bcd);
+		data = CDR_getBuffer();
+		s = CDR_getBufferSub();
+	}
+	r->stall += now() - t0;
+
+	r->sectors++;
+	r->bad += !check(data, DATA_SIZE, lba, 0) || !check(s, SUB_FRAMESIZE, lba, 1);
+}
+
+static void readAudio(int prefetch, int lba, Run *r) {
+	unsigned char out[CD_FRAMESIZE_RAW];
+	u8 t[3];
+	double t0;
+
+	msf(lba, t);
+
+	t0 = now();
+	if (prefetch)
+		cdrPrefetchReadCDDA(t[0], t[1], t[2], out);
+	else
+		CDR_readCDDA(t[0], t[1], t[2], out);
+	r->stall += now() - t0;
+
+	r->sectors++;
+	r->bad += !check(out, CD_FRAMESIZE_RAW, lba, 2);
+}
+
+static void seek(int prefetch, int lba, int kind) {
+	u8 t[3];
+
+	msf(lba, t);
+	if (prefetch)
+		cdrPrefetchSeek(t, kind);
+	usleep(seekUs * 2);		// the emulated seek
+}
+
+// files read one after the other, then a cdda track played
+static void game(int prefetch, Run *data, Run *audio) {
+	static const int files[][2] = { { 1000, 300 }, { 50000, 200 }, { 1300, 300 } };
+	int i, n;
+
+	memset(data, 0, sizeof(*data));
+	memset(audio, 0, sizeof(*audio));
+	last = -2;
+
+	for (i = 0; i < 3; i++) {
+		seek(prefetch, files[i][0], PF_DATA);
+		for (n = 0; n < files[i][1]; n++) {
+			readData(prefetch, files[i][0] + n, data);
+			usleep(paceUs);
+		}
+	}
+
+	// Setloc, Play: the subq of the first sector, then the audio
+	seek(prefetch, 150000, PF_CDDA);
+	readData(prefetch, 150000, data);
+	for (n = 0; n < 300; n++) {
+		readAudio(prefetch, 150000 + n, audio);
+		usleep(paceUs);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	CdrPrefetchStats before, after;
+	Run data, audio, direct, directAudio;
+	int errors = 0, n;
+
+	if (argc > 1) sectorUs = atoi(argv[1]);
+	if (argc > 2) seekUs = atoi(argv[2]);
+	if (argc > 3) paceUs = atoi(argv[3]);
+
+	CDR_readTrack = slowReadTrack;
+	CDR_getBuffer = slowGetBuffer;
+	CDR_getBufferSub = slowGetBufferSub;
+	CDR_readCDDA = slowReadCDDA;
+
+	game(0, &direct, &directAudio);
+
+	cdrPrefetchReset();
+	game(1, &data, &audio);
+	cdrPrefetchGetStats(&after);
+	cdrPrefetchStop();
+
+	printf("storage %d us/sector, %d us/seek, drive %d us/sector\n", sectorUs, seekUs, paceUs);
+	printf("plugin:   %4d data %4d audio sectors, %7.1f ms stalled\n",
+		direct.sectors, directAudio.sectors, (direct.stall + directAudio.stall) * 1e3);
+	printf("prefetch: %4d data %4d audio sectors, %7.1f ms stalled, %d bad\n",
+		data.sectors, audio.sectors, (data.stall + audio.stall) * 1e3, data.bad + audio.bad);
+	cdrPrefetchReport();
+
+	if (direct.bad + directAudio.bad + data.bad + audio.bad) {
+		printf("sectors came back wrong\n");
+		errors++;
+	}
+	if (reentered) {
+		printf("the plugin was entered %d times while busy\n", reentered);
+		errors++;
+	}
+	if ((data.stall + audio.stall) * 4 > direct.stall + directAudio.stall) {
+		printf("prefetch stalls more than a quarter of the plugin reads\n");
+		errors++;
+	}
+
+	// the audio window outlived the subq read of Play: one seek for the
+	// track, the subq sector read on the side and all audio from the window
+	cdrPrefetchReset();
+	memset(&audio, 0, sizeof(audio));
+	cdrPrefetchGetStats(&before);
+	seek(1, 150000, PF_CDDA);
+	readData(1, 150000, &data);
+	for (n = 0; n < 100; n++) {
+		readAudio(1, 150000 + n, &audio);
+		usleep(paceUs);
+	}
+	cdrPrefetchGetStats(&after);
+	cdrPrefetchStop();
+	printf("play: %u seeks, %u hits, %u misses\n", after.seeks - before.seeks,
+		after.hits - before.hits, after.misses - before.misses);
+	if (after.seeks - before.seeks != 1 || after.misses - before.misses != 1 || after.hits - before.hits != 100) {
+		printf("the subq read of Play restarted the audio window\n");
+		errors++;
+	}
+
+	return errors != 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * The cd's data fifo and audio attenuation (cdrom.c). DMA3 against the
+ * byte loop it replaced: every sector mode, the index anywhere in the ring
+ * or left past its end by a mode change, sizes of an odd number of words,
+ * of none (a sector) and bigger than the ring, burst and not. Ram around
+ * the destination and the index have to come out the same. Then the
+ * AltiVec loops of cdrAttenuate, run on host/altivec.h, against the
+ * scalar ones: stereo and mono, matrices that pass through, mix and clip,
+ * buffers at every halfword alignment and of every short length. Then MB/s
+ * for both copies and samples a second for the scalar mix; the emulated
+ * vectors say nothing about a ppc and aren't timed.
+ *
+ *   cdrom [transfers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the AltiVec loops, on host/altivec.h
+#define __ALTIVEC__
+#define __BIG_ENDIAN__
+#include "../source/libpcsxcore/cdrom.c"
+
+#define RAM			0x200000
+#define GUARD		64			// bytes checked on both sides of a transfer
+#define SAMPLES		4032		// stereo samples of the longest xa sector
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+// psxDma3's copy as it was
+static void refDma3(u32 madr, u32 bcr) {
+	u32 cdsize = (bcr & 0xffff) * 4, i;
+	u8 *ptr;
+
+	if (cdsize == 0) {
+		switch (cdr.Mode & (MODE_SIZE_2340|MODE_SIZE_2328)) {
+			case MODE_SIZE_2340: cdsize = 2340; break;
+			case MODE_SIZE_2328: cdsize = 2328; break;
+			default:
+			case MODE_SIZE_2048: cdsize = 2048; break;
+		}
+	}
+
+	ptr = (u8 *)PSXM(madr);
+	for (i = 0; i < cdsize; ++i) {
+		ptr[i] = cdr.Transfer[cdr.transferIndex];
+		cdr.transferIndex++;
+		adjustTransferIndex();
+	}
+}
+
+static double bench(int hle, u32 bcr, int n) {
+	double t = now();
+	int i;
+
+	cdr.transferIndex = 0;
+	for (i = 0; i < n; i++)
+		hle ? psxDma3(0x80100000, bcr, 0x11000000) : refDma3(0x80100000, bcr);
+	return n * (bcr & 0xffff) * 4.0 / (now() - t) / 1048576;
+}
+
+int main(int argc, char *argv[]) {
+	static const struct {
+		const char *name;
+		u8 mode;
+	} modes[] = {
+		{ "2048", MODE_SIZE_2048 }, { "2328", MODE_SIZE_2328 }, { "2340", MODE_SIZE_2340 },
+		{ "both bits", MODE_SIZE_2340 | MODE_SIZE_2328 },		// the switch's default
+	};
+	static s16 ALIGNED_32 in[2 * SAMPLES + 16], want[2 * SAMPLES + 16], got[2 * SAMPLES + 16];
+	int n = argc > 1 ? atoi(argv[1]) : 20000, k, m, stereo, errors = 0;
+	u32 seed = 0xcd3, madr, bcr, size, start, index, i, done[4], bad[4];
+	u8 *around;
+	double t;
+
+	around = malloc(RAM);
+	if (around == NULL || psxMemInit() != 0)
+		return 1;
+	psxCpu = &psxInt;
+	for (i = 0; i < CD_FRAMESIZE_RAW; i++)
+		cdr.Transfer[i] = rnd(&seed);
+	cdr.Readed = 1;
+
+	memset(done, 0, sizeof(done));
+	memset(bad, 0, sizeof(bad));
+	for (k = 0; k < n; k++) {
+		u32 x = rnd(&seed), ring;
+
+		m = x % 4;
+		cdr.Mode = modes[m].mode | (rnd(&seed) & ~(MODE_SIZE_2340 | MODE_SIZE_2328));
+		ring = transferBufSize();
+
+		// an odd number of words, none, or more than the ring; the block count is ignored
+		size = x / 4 % 8 == 0 ? 0 : x / 4 % 8 == 1 ? 600 + rnd(&seed) % 1400 : rnd(&seed) % 600;
+		bcr = (rnd(&seed) & 0xffff0000) | size;
+		size = size ? size * 4 : m == 1 ? 2328 : m == 2 ? 2340 : 2048;
+
+		// one in four left past the end of a ring the mode just shrank
+		index = x / 32 % 4 == 0 && ring < 2340 ? ring + rnd(&seed) % (2340 - ring) : rnd(&seed) % ring;
+
+		start = GUARD + (rnd(&seed) % (RAM - size - 2 * GUARD) & ~3);
+		madr = 0x80000000 | start;
+
+		memset(psxM + start - GUARD, k, size + 2 * GUARD);
+		cdr.transferIndex = index;
+		refDma3(madr, bcr);
+		memcpy(around, psxM + start - GUARD, size + 2 * GUARD);
+		i = cdr.transferIndex;
+
+		memset(psxM + start - GUARD, k, size + 2 * GUARD);
+		cdr.transferIndex = index;
+		psxDma3(madr, bcr, x & 128 ? 0x11400100 : 0x11000000);
+
+		done[m]++;
+		if (cdr.transferIndex != i || memcmp(psxM + start - GUARD, around, size + 2 * GUARD) != 0) {
+			if (bad[m]++ < 3)
+				printf("  %s, index %u, %u bytes to %08x: index %u for %u\n", modes[m].name, index, size,
+					madr, cdr.transferIndex, i);
+		}
+	}
+	for (m = 0; m < 4; m++) {
+		printf("%-9s %5u transfers, %u differ\n", modes[m].name, done[m], bad[m]);
+		if (bad[m] || done[m] == 0)
+			errors++;
+	}
+
+	// every alignment against a 16 byte line, the short buffers at every length
+	for (stereo = 0; stereo < 2; stereo++) {
+		u32 calls = 0, differ = 0;
+
+		for (k = 0; k < 4000; k++) {
+			u32 x = rnd(&seed);
+			int ll = rnd(&seed) & 0xff, lr = rnd(&seed) & 0xff, rl = rnd(&seed) & 0xff, rr = rnd(&seed) & 0xff;
+			int off = x % 8, len = k % 2 ? k / 2 % 41 : x / 8 % 4 == 0 ? CD_FRAMESIZE_RAW / 4 : rnd(&seed) % SAMPLES;
+			int loud = x / 32 % 4 == 0;
+
+			switch (x / 128 % 8) {
+				case 0: ll = rr = 0x80; lr = rl = 0; break;		// passes through
+				case 1: ll = lr = rl = rr = 0x40; break;		// to mono
+				case 2: ll = lr = rl = rr = 0xff; break;		// clips what is loud
+				case 3: ll = lr = rl = rr = 0; break;
+			}
+			for (i = 0; i < 2 * SAMPLES + 16; i++)
+				in[i] = loud ? (rnd(&seed) & 1 ? 32767 : -32768) - (rnd(&seed) & 255) * (rnd(&seed) & 1 ? 1 : -1) : rnd(&seed);
+			memcpy(want, in, sizeof(in));
+			memcpy(got, in, sizeof(in));
+
+			if (stereo) {
+				attenuateStereo(want + off, len, ll, lr, rl, rr);
+				attenuateStereoVec(got + off, len, ll, lr, rl, rr);
+			} else {
+				attenuateMono(want + off, len, ll + rl);
+				attenuateMonoVec(got + off, len, ll + rl);
+			}
+
+			calls++;
+			if (memcmp(want, got, sizeof(want)) != 0) {
+				for (i = 0; want[i] == got[i]; i++);
+				if (differ++ < 3)
+					printf("  %s, %d samples at +%d, %02x %02x %02x %02x: sample %d is %d for %d\n",
+						stereo ? "stereo" : "mono", len, off * 2, ll, lr, rl, rr, (int)i - off, got[i], want[i]);
+			}
+		}
+		printf("%-9s %5u buffers, %u differ\n", stereo ? "stereo" : "mono", calls, differ);
+		if (differ)
+			errors++;
+	}
+
+	// a 2048 byte sector at a time
+	cdr.Mode = MODE_SIZE_2048;
+	printf("MB/s      byte loop   memcpy\n");
+	printf("dma3      %9.0f %8.0f\n", bench(0, 512, n), bench(1, 512, n));
+
+	t = now();
+	for (k = 0; k < 2000; k++)
+		attenuateStereo(in, SAMPLES, 0x60, 0x20, 0x20, 0x60);
+	printf("mix       %.0f M stereo samples/s, scalar\n", 2000.0 * SAMPLES / (now() - t) / 1e6);
+
+	free(around);
+	return errors != 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * The gpu thread's command ring (peopsxgl/cmd_ring.cpp) between two
+ * pthreads: a stress run on a small ring that checks every word arrives
+ * once, in order and in a packet of the right type, then the throughput
+ * on a ring the size of the gpu thread's. Last a consumer with nothing to
+ * do and a producer facing a full ring have to sleep through the wait
+ * instead of burning a core, and wake up soon after the other side moves.
+ *
+ *   cmdring [stress words] [bench words]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmd_ring.h"
+
+#define T_DATA		1		// payload words are (seq << 8) | type
+#define T_CALL		2		// no payload
+#define T_STOP		3
+
+static CmdRing ring;
+static uint32_t total;		// payload words to send
+static int batched;			// producer uses Begin/Append/Commit in pieces
+static uint32_t packetwords;	// 0: random packet sizes
+
+static uint32_t rnd(uint32_t *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+static void *producer(void *arg) {
+	static uint32_t data[4096];
+	uint32_t seed = 12345, seq = 0, n, i, calls = 0, piece;
+	uint32_t type;
+
+	while (seq < total) {
+		if (packetwords == 0 && rnd(&seed) % 8 == 0) {
+			CmdRingPush(&ring, T_CALL, NULL, 0);
+			calls++;
+			continue;
+		}
+
+		n = packetwords ? packetwords : rnd(&seed) % 4096 + 1;
+		if (n > total - seq) n = total - seq;
+		type = T_DATA + (rnd(&seed) & 0x10);	// 0x11 is data too, in other packets
+
+		for (i = 0; i < n; i++)
+			data[i] = ((seq + i) << 8) | type;
+		seq += n;
+
+		if (!batched) {
+			CmdRingPush(&ring, type, data, n);
+			continue;
+		}
+
+		CmdRingBegin(&ring, type);
+		for (i = 0; i < n; i += piece) {
+			piece = rnd(&seed) % 64 + 1;
+			if (piece > n - i) piece = n - i;
+			CmdRingAppend(&ring, &data[i], piece);
+		}
+		CmdRingCommit(&ring);
+	}
+
+	CmdRingPush(&ring, T_STOP, &calls, 1);
+	CmdRingDrain(&ring);
+	return NULL;
+}
+
+struct consumed {
+	uint32_t words, calls, packets;
+	int errors;
+};
+
+static void consume(struct consumed *c) {
+	uint32_t hdr, seq = 0, off, len, n, i, *p;
+
+	memset(c, 0, sizeof(*c));
+
+	for (;;) {
+		if (!CmdRingWaitData(&ring, 1000, &hdr))
+			continue;
+
+		len = CMDRING_LEN(hdr);
+		c->packets++;
+
+		switch (CMDRING_TYPE(hdr)) {
+			case T_CALL:
+				if (len != 0) c->errors++;
+				c->calls++;
+				break;
+
+			case T_STOP:
+				CmdRingSpan(&ring, 0, 1, &p);
+				if (*p != c->calls) {
+					printf("%u calls sent, %u arrived\n", *p, c->calls);
+					c->errors++;
+				}
+				CmdRingRetire(&ring, hdr);
+				return;
+
+			case T_DATA:
+			case T_DATA + 0x10:
+				for (off = 0; off < len; off += n) {
+					n = CmdRingSpan(&ring, off, len - off, &p);
+					for (i = 0; i < n; i++, seq++) {
+						if (p[i] != ((seq << 8) | CMDRING_TYPE(hdr))) {
+							if (c->errors++ < 5)
+								printf("word %u: got %08x\n", seq, p[i]);
+							seq = p[i] >> 8;
+						}
+					}
+				}
+				c->words += len;
+				break;
+
+			default:
+				printf("packet of unknown type %u\n", CMDRING_TYPE(hdr));
+				c->errors++;
+				break;
+		}
+
+		CmdRingRetire(&ring, hdr);
+	}
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define IDLE_US		200000
+
+static double moved;		// when the other side pushed or retired
+
+static void *latePush(void *arg) {
+	uint32_t word = 0;
+
+	usleep(IDLE_US);
+	moved = now();
+	CmdRingPush(&ring, T_DATA, &word, 1);
+	return NULL;
+}
+
+static void *lateRetire(void *arg) {
+	uint32_t hdr;
+
+	usleep(IDLE_US);
+	moved = now();
+	if (CmdRingWaitData(&ring, 1000, &hdr))
+		CmdRingRetire(&ring, hdr);
+	return NULL;
+}
+
+static int idle(uint32_t *buf) {
+	static uint32_t fill[8];
+	pthread_t thread;
+	double c, wake;
+	uint32_t hdr;
+	int errors = 0, i;
+
+	// the consumer waits a long time for one packet
+	CmdRingInit(&ring, buf, 1024);
+	pthread_create(&thread, NULL, latePush, NULL);
+	c = cpu();
+	while (!CmdRingWaitData(&ring, 50000, &hdr))
+		;
+	wake = now() - moved;
+	c = cpu() - c;
+	CmdRingRetire(&ring, hdr);
+	pthread_join(thread, NULL);
+
+	printf("idle consumer: %.1f ms cpu over %d ms, woke %.0f us after the push\n", c * 1e3, IDLE_US / 1000, wake * 1e6);
+	if (c * 1e6 > IDLE_US / 4 || wake > 0.01)
+		errors++;
+
+	// the producer waits for a full ring to drain
+	// (packets of at most 8 words here: seven fill all but one word)
+	CmdRingInit(&ring, buf, 64);
+	for (i = 0; i < 7; i++)
+		CmdRingPush(&ring, T_DATA, fill, 8);
+	pthread_create(&thread, NULL, lateRetire, NULL);
+	c = cpu();
+	CmdRingPush(&ring, T_DATA, fill, 8);
+	wake = now() - moved;
+	c = cpu() - c;
+	pthread_join(thread, NULL);
+
+	printf("blocked producer: %.1f ms cpu over %d ms, woke %.0f us after the retire\n", c * 1e3, IDLE_US / 1000, wake * 1e6);
+	if (c * 1e6 > IDLE_US / 4 || wake > 0.01)
+		errors++;
+
+	if (errors)
+		printf("  a waiting side does not sleep, or does not wake\n");
+	return errors != 0;
+}
+
+static int run(uint32_t *buf, uint32_t size, const char *name, int check) {
+	struct consumed c;
+	pthread_t thread;
+	double start, secs;
+
+	CmdRingInit(&ring, buf, size);
+
+	start = now();
+	pthread_create(&thread, NULL, producer, NULL);
+	consume(&c);
+	pthread_join(thread, NULL);
+	secs = now() - start;
+
+	printf("%s: %.1f Mwords/s, %.2f Mpackets/s, ", name, c.words / secs / 1e6, c.packets / secs / 1e6);
+	CmdRingReport(&ring, "ring");
+
+	if (c.words != total) {
+		printf("%u words sent, %u arrived\n", total, c.words);
+		c.errors++;
+	}
+	return check && c.errors != 0;
+}
+
+int main(int argc, char *argv[]) {
+	static uint32_t small[1024], big[128 * 1024];
+	uint32_t stress = argc > 1 ? strtoul(argv[1], NULL, 0) : 20000000;
+	uint32_t bench = argc > 2 ? strtoul(argv[2], NULL, 0) : 100000000;
+	static const uint32_t sizes[] = { 4, 64, 1024 };
+	char name[64];
+	int fail = 0, i;
+
+	// 1k words: wraps all the time, both sides wait on each other
+	total = stress;
+	packetwords = 0;
+	batched = 0;
+	fail |= run(small, 1024, "stress, pushes", 1);
+	batched = 1;
+	fail |= run(small, 1024, "stress, batches", 1);
+
+	total = bench;
+	batched = 0;
+	for (i = 0; i < 3; i++) {
+		packetwords = sizes[i];
+		sprintf(name, "bench, %u word packets", sizes[i]);
+		fail |= run(big, 128 * 1024, name, 1);
+	}
+
+	fail |= idle(small);
+
+	return fail;
+}
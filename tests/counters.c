@@ -0,0 +1,259 @@
+/*
+ * The root counters (psxcounters.c) against the ones that woke the cpu on
+ * every scanline (ref/psxcounters.c): the same trace of cpu blocks and
+ * counter programming goes through both, NTSC and PAL, with and without
+ * the VSync and RCnt fixes and the spu's async tick, the cycle starting
+ * near where it wraps or not. Counters 0-2 get random modes, targets and
+ * counts, often small enough to fire every few blocks. The irqs, the
+ * vblank edges, the laces, the spu ticks and every counter read have to
+ * come at the same cycle with the same value, and the hsyncs in the same
+ * order. Then the scheduler wakeups a frame for both, with the counters
+ * left alone and programmed.
+ *
+ *   counters [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../source/libpcsxcore/psxcounters.c"
+
+// ref/psxcounters.c, built with its names starting ref (see the Makefile)
+void refRcntInit();
+void refRcntUpdate();
+void refRcntWcount(u32 index, u32 value);
+void refRcntWmode(u32 index, u32 value);
+void refRcntWtarget(u32 index, u32 value);
+u32 refRcntRcount(u32 index);
+u32 refRcntRmode(u32 index);
+extern u32 refNextCounter, refNextsCounter;
+
+PcsxConfig Config;
+psxRegisters psxRegs;
+s8 *psxH;
+u8 *freezeMem;
+
+typedef struct {
+	const char *name;
+	void (*init)();
+	void (*update)();
+	void (*wcount)(u32, u32);
+	void (*wmode)(u32, u32);
+	void (*wtarget)(u32, u32);
+	u32 (*rcount)(u32);
+	u32 (*rmode)(u32);
+	u32 *next, *nexts;
+} Counters;
+
+static const Counters before = {
+	"before", refRcntInit, refRcntUpdate, refRcntWcount, refRcntWmode, refRcntWtarget,
+	refRcntRcount, refRcntRmode, &refNextCounter, &refNextsCounter
+};
+
+static const Counters now = {
+	"now", psxRcntInit, psxRcntUpdate, psxRcntWcount, psxRcntWmode, psxRcntWtarget,
+	psxRcntRcount, psxRcntRmode, &psxNextCounter, &psxNextsCounter
+};
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+/*
+ * What the rest of the psx sees. The hsyncs are a log of their own: lines
+ * that nothing watches are played back at the next event now, so they come
+ * later than an irq that used to follow them.
+ */
+
+enum { IRQ, VBLANK, LACE, SPU, RCOUNT, RMODE };
+
+static const char *kinds[] = { "irq", "vblank", "lace", "spu tick", "rcount", "rmode" };
+
+typedef struct {
+	u32 kind, value, cycle;
+} Event;
+
+typedef struct {
+	Event *events;
+	int *hsyncs;
+	int nevents, nhsyncs, sizeEvents, sizeHsyncs;
+	u32 frames, wakeups;
+} Trace;
+
+static Trace *trace;
+
+static void event(u32 kind, u32 value) {
+	if (trace->nevents == trace->sizeEvents) {
+		trace->sizeEvents = trace->sizeEvents ? trace->sizeEvents * 2 : 4096;
+		trace->events = realloc(trace->events, trace->sizeEvents * sizeof(Event));
+	}
+	trace->events[trace->nevents].kind = kind;
+	trace->events[trace->nevents].value = value;
+	trace->events[trace->nevents].cycle = psxRegs.cycle;
+	trace->nevents++;
+}
+
+static void CALLBACK hSync(int line) {
+	if (trace->nhsyncs == trace->sizeHsyncs) {
+		trace->sizeHsyncs = trace->sizeHsyncs ? trace->sizeHsyncs * 2 : 4096;
+		trace->hsyncs = realloc(trace->hsyncs, trace->sizeHsyncs * sizeof(int));
+	}
+	trace->hsyncs[trace->nhsyncs++] = line;
+}
+
+static void CALLBACK vBlank(int on) { event(VBLANK, on); }
+static void CALLBACK updateLace(void) { event(LACE, 0); trace->frames++; }
+static void CALLBACK spuAsync(uint32_t cycles) { event(SPU, cycles); }
+
+GPUhSync GPU_hSync = hSync;
+GPUvBlank GPU_vBlank = vBlank;
+GPUupdateLace GPU_updateLace = updateLace;
+SPUasync SPU_async;
+
+void EmuUpdate() { }
+void DebugVSync() { }
+
+// the cpu acks what the counters raised
+static void irqs(void) {
+	if (psxHu32ref(0x1070)) {
+		event(IRQ, SWAPu32(psxHu32ref(0x1070)));
+		psxHu32ref(0x1070) = 0;
+	}
+}
+
+static u32 mode(u32 *seed) {
+	static const u32 bits[] = {
+		RcCountToTarget, RcIrqOnTarget, RcIrqOnOverflow, RcIrqRegenerate,
+		Rc0PixelClock, Rc2OneEighthClock, Rc2Disable
+	};
+	u32 m = 0, i, x = rnd(seed);
+
+	for (i = 0; i < sizeof(bits) / sizeof(bits[0]); i++)
+		if (x >> i & 1 && (i != 6 || x % 16 == 0)) m |= bits[i];
+	return m;
+}
+
+/*
+ * Blocks of 1 to 400 cycles, the cpu checking the counters after each one
+ * as psxBranchTest does, and now and then a counter register access.
+ */
+static void run(const Counters *c, Trace *t, u32 seed, u32 frames, u32 start, int idle) {
+	u32 i, x, index;
+
+	memset(t, 0, sizeof(*t));
+	trace = t;
+	psxRegs.cycle = start;
+	psxHu32ref(0x1070) = 0;
+	c->init();
+	for (i = 0; i < 3; i++)
+		c->wmode(i, 0);
+
+	while (t->frames < frames) {
+		psxRegs.cycle += 1 + rnd(&seed) % 400;
+		if ((psxRegs.cycle - *c->nexts) >= *c->next) {
+			c->update();
+			t->wakeups++;
+		}
+		irqs();
+
+		x = rnd(&seed);
+		if (idle || x % 64)
+			continue;
+		index = x / 64 % 3;
+		switch (x / 256 % 8) {
+			case 0: case 1:
+				event(RCOUNT, index << 16 | c->rcount(index));
+				break;
+			case 2:
+				event(RMODE, index << 16 | c->rmode(index));
+				break;
+			case 3:
+				c->wmode(index, mode(&seed));
+				break;
+			case 4: case 5:
+				// a few cycles to most of the range
+				c->wtarget(index, x / 2048 % 4 ? rnd(&seed) % 64 : rnd(&seed) & 0xffff);
+				break;
+			default:
+				c->wcount(index, rnd(&seed) & (x & 0x10000 ? 0xffff : 0x3f));
+				break;
+		}
+		irqs();
+	}
+}
+
+int main(int argc, char *argv[]) {
+	static const char *modes[] = { "ntsc, idle", "pal, idle", "ntsc, programmed", "pal, programmed" };
+	u32 frames = argc > 1 ? atoi(argv[1]) : 60, config, seed = 0xc0de, i, events = 0, errors = 0;
+	double wakeups[4][2], shown[4];
+	Trace a, b;
+
+	psxH = calloc(1, 0x10000);
+	if (psxH == NULL)
+		return 1;
+	memset(wakeups, 0, sizeof(wakeups));
+	memset(shown, 0, sizeof(shown));
+
+	// video mode, the fixes, the spu tick, a cycle count about to wrap, counters programmed
+	for (config = 0; config < 64; config++) {
+		u32 start = config & 16 ? 0xffffffff - rnd(&seed) % (2 * PSXCLK) : rnd(&seed);
+		u32 s = rnd(&seed), row = (config & 1) | (config >> 4 & 2);
+		int idle = !(config & 32), bad = 0;
+
+		Config.PsxType = config & 1;
+		Config.VSyncWA = config >> 1 & 1;
+		Config.RCntFix = config >> 2 & 1;
+		SPU_async = config & 8 ? spuAsync : NULL;
+
+		run(&before, &a, s, frames, start, idle);
+		run(&now, &b, s, frames, start, idle);
+
+		for (i = 0; i < a.nevents && i < b.nevents; i++) {
+			Event *e = &a.events[i], *f = &b.events[i];
+
+			if (e->kind != f->kind || e->value != f->value || e->cycle != f->cycle) {
+				printf("  event %u: %s %x at %u, %s %x at %u before\n", i, kinds[f->kind], f->value,
+					f->cycle - start, kinds[e->kind], e->value, e->cycle - start);
+				bad = 1;
+				break;
+			}
+		}
+		if (!bad && a.nevents != b.nevents) {
+			printf("  %d events, %d before\n", b.nevents, a.nevents);
+			bad = 1;
+		}
+		// a lace ends both, on a line that is played out
+		for (i = 0; i < a.nhsyncs && i < b.nhsyncs && a.hsyncs[i] == b.hsyncs[i]; i++);
+		if (i < a.nhsyncs || i < b.nhsyncs) {
+			printf("  hsync %u: line %d, %d before\n", i, i < b.nhsyncs ? b.hsyncs[i] : -1,
+				i < a.nhsyncs ? a.hsyncs[i] : -1);
+			bad = 1;
+		}
+		if (bad)
+			printf("%s%s%s%s%s: differs\n", modes[row], Config.VSyncWA ? ", vsync fix" : "",
+				Config.RCntFix ? ", rcnt fix" : "", SPU_async ? ", spu tick" : "",
+				config & 16 ? ", wrapping" : "");
+
+		// the plain frames, without the fixes
+		if (!Config.VSyncWA && !Config.RCntFix) {
+			wakeups[row][0] += (double)a.wakeups / a.frames;
+			wakeups[row][1] += (double)b.wakeups / b.frames;
+			shown[row]++;
+		}
+		events += a.nevents + a.nhsyncs;
+		errors += bad;
+
+		free(a.events); free(a.hsyncs);
+		free(b.events); free(b.hsyncs);
+	}
+
+	printf("64 runs of %u frames, %u events, %u differ\n", frames, events, errors);
+	printf("wakeups a frame     before    now\n");
+	for (i = 0; i < 4; i++)
+		printf("%-17s %8.1f %6.1f\n", modes[i], wakeups[i][0] / shown[i], wakeups[i][1] / shown[i]);
+
+	free(psxH);
+	return errors != 0;
+}
@@ -0,0 +1,519 @@
+/*
+ * The cop2 moves and NCLIP/AVSZ3/AVSZ4 the ppc dynarec emits inline
+ * (pR3000A.c) against gte.c: blocks of up to 16 of MFC2, CFC2, MTC2, CTC2
+ * on every register, NCLIP, AVSZ3 and AVSZ4 get recompiled and run on a
+ * small ppc interpreter, over register files that are random or built to
+ * overflow MAC0 and OTZ. The same block goes through gte.c. The gprs and
+ * both cop2 register files have to come out the same: the sign and zero
+ * extension on read, the SXY fifo, IRGB into IR1-3, LZCR and the FLAG
+ * bits with their sum. Then the ppc code each op takes on its own.
+ *
+ *   cp2rec [blocks]
+ *
+ * Linked at a fixed address below 4GB (-no-pie), so that the pointers the
+ * dynarec keeps in 32 bits stay valid and the code runs on psxRegs itself.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+// libxenon's, and the cache flushes of recRecompile are ppc asm: none of
+// them is needed here
+void memdcbf(void *p, unsigned int len);
+void memicbi(void *p, unsigned int len);
+#define __volatile__(...) __volatile__("")
+
+#include "../source/ppcr/ppc.c"
+#include "../source/ppcr/reguse.c"
+#include "../source/ppcr/pR3000A.c"
+
+#undef __volatile__
+
+#define ORG			0x80010000
+#define MAXOPS		16
+#define STEPS		100000		// ppc instructions a block may take
+
+// what the rest of the dynarec brings on the Xenon, never reached here
+void returnPC(void) { abort(); }
+void recRun(void (*func)(), u32 hw1, u32 hw2) { abort(); }
+int disassemble(unsigned int a, unsigned int op) { return 0; }
+void memdcbf(void *p, unsigned int len) {}
+void memicbi(void *p, unsigned int len) {}
+int failsafeRec;
+void recInitDynaMemVM() {}
+void recDestroyDynaMemVM() {}
+void recCallDynaMemVM(int rs_reg, int rt_reg, memType type, int immed) { abort(); }
+
+void gteMFC2();
+void gteCFC2();
+void gteMTC2();
+void gteCTC2();
+void gteNCLIP();
+void gteAVSZ3();
+void gteAVSZ4();
+
+enum { OP_MFC2, OP_CFC2, OP_MTC2, OP_CTC2, OP_NCLIP, OP_AVSZ3, OP_AVSZ4, OPS };
+
+static const char *opName[OPS] = { "MFC2", "CFC2", "MTC2", "CTC2", "NCLIP", "AVSZ3", "AVSZ4" };
+
+static u32 ALIGNED_32 codeBuf[0x10000];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+/*
+ * The interpreter: the integer instructions the dynarec emits, big endian
+ * bit numbering as in the manuals. Loads and stores may only touch
+ * psxRegs, calls only go to gte.c.
+ */
+
+typedef struct {
+	u32 r[32], cr, ca, ctr, lr;
+	const char *fault;
+} Ppc;
+
+static int crBit(const Ppc *p, int bit) {
+	return p->cr >> (31 - bit) & 1;
+}
+
+static void setCr(Ppc *p, int field, s32 a, s32 b, int unsign) {
+	u32 c = unsign ? ((u32)a < (u32)b ? 8 : (u32)a > (u32)b ? 4 : 2) : (a < b ? 8 : a > b ? 4 : 2);
+
+	p->cr = (p->cr & ~(0xf << (28 - 4 * field))) | c << (28 - 4 * field);
+}
+
+static u32 mask(int mb, int me) {
+	u32 m = 0;
+	int i;
+
+	for (i = mb; ; i = (i + 1) & 31) {
+		m |= 0x80000000u >> i;
+		if (i == me) break;
+	}
+	return m;
+}
+
+static u8 *addr(Ppc *p, u32 ea, int size) {
+	if ((ea < (u32)(uintptr_t)&psxRegs || ea + size > (u32)(uintptr_t)(&psxRegs + 1)) &&
+		(ea < (u32)(uintptr_t)&target || ea + size > (u32)(uintptr_t)(&target + 1))) {
+		p->fault = "load or store outside psxRegs";
+		return NULL;
+	}
+	return (u8 *)(uintptr_t)ea;
+}
+
+static int call(Ppc *p, u32 target) {
+	static const struct { void (*fn)(); } known[] = {
+		{ gteMFC2 }, { gteCFC2 }, { gteMTC2 }, { gteCTC2 }, { gteSWC2 },
+	};
+	int i;
+
+	if (target == (u32)(uintptr_t)psxBranchTest)
+		return 0;		// the counters are not what gets tested
+	for (i = 0; i < (int)(sizeof(known) / sizeof(known[0])); i++)
+		if ((u32)(uintptr_t)known[i].fn == target) {
+			known[i].fn();
+			return 0;
+		}
+	p->fault = "call to something that is not gte.c";
+	return -1;
+}
+
+static int step(Ppc *p, const u32 **pcp) {
+	const u32 *pc = *pcp;
+	u32 ins = *pc, opcd = ins >> 26, xo = ins >> 1 & 0x3ff;
+	int d = ins >> 21 & 31, a = ins >> 16 & 31, b = ins >> 11 & 31, rc = ins & 1;
+	s32 simm = (s16)ins;
+	u32 uimm = ins & 0xffff, ra0 = a ? p->r[a] : 0, ea, res;
+	u8 *m;
+	u64 w;
+
+	*pcp = pc + 1;
+	switch (opcd) {
+		case 7:  p->r[d] = (s32)p->r[a] * simm; return 0;
+		case 10: setCr(p, d >> 2, p->r[a], uimm, 1); return 0;
+		case 11: setCr(p, d >> 2, p->r[a], simm, 0); return 0;
+		case 14: p->r[d] = ra0 + simm; return 0;
+		case 15: p->r[d] = ra0 + (simm << 16); return 0;
+		case 24: p->r[a] = p->r[d] | uimm; return 0;
+		case 25: p->r[a] = p->r[d] | uimm << 16; return 0;
+		case 26: p->r[a] = p->r[d] ^ uimm; return 0;
+		case 27: p->r[a] = p->r[d] ^ uimm << 16; return 0;
+		case 28: p->r[a] = p->r[d] & uimm; setCr(p, 0, p->r[a], 0, 0); return 0;
+		case 29: p->r[a] = p->r[d] & uimm << 16; setCr(p, 0, p->r[a], 0, 0); return 0;
+
+		case 21: case 23: {
+			int sh = opcd == 21 ? b : p->r[b] & 31;
+			u32 rot = sh ? p->r[d] << sh | p->r[d] >> (32 - sh) : p->r[d];
+
+			p->r[a] = rot & mask(ins >> 6 & 31, ins >> 1 & 31);
+			if (rc) setCr(p, 0, p->r[a], 0, 0);
+			return 0;
+		}
+
+		case 32: case 34: case 40: case 42:
+			ea = ra0 + simm;
+			if ((m = addr(p, ea, opcd == 32 ? 4 : opcd == 34 ? 1 : 2)) == NULL) return -1;
+			p->r[d] = opcd == 32 ? *(u32 *)m : opcd == 34 ? *m : opcd == 40 ? *(u16 *)m : (u32)*(s16 *)m;
+			return 0;
+		case 36: case 38: case 44:
+			ea = ra0 + simm;
+			if ((m = addr(p, ea, opcd == 36 ? 4 : opcd == 38 ? 1 : 2)) == NULL) return -1;
+			if (opcd == 36) *(u32 *)m = p->r[d];
+			else if (opcd == 38) *m = p->r[d];
+			else *(u16 *)m = p->r[d];
+			return 0;
+
+		case 18: {
+			s32 li = (s32)(ins << 6) >> 6 & ~3;
+
+			if (ins & 2) {
+				if ((u32)li == (u32)(uintptr_t)returnPC && !(ins & 1))
+					return 1;		// the end of the block
+				p->fault = "absolute branch";
+				return -1;
+			}
+			if (ins & 1)
+				return call(p, (u32)(uintptr_t)pc + li);
+			*pcp = (const u32 *)((const u8 *)pc + li);
+			return 0;
+		}
+		case 16: case 19: {
+			int bo = d, ok;
+
+			if (opcd == 19 && xo != 16 && xo != 528)
+				break;
+			if (!(bo & 4)) p->ctr--;
+			ok = ((bo & 4) || ((p->ctr != 0) ^ (bo >> 1 & 1))) &&
+				((bo & 16) || crBit(p, a) == (bo >> 3 & 1));
+			if (!ok) return 0;
+			if (opcd == 16) {
+				if (ins & 3) break;
+				*pcp = (const u32 *)((const u8 *)pc + (simm & ~3));
+				return 0;
+			}
+			if (xo == 528 && (ins & 1))
+				return call(p, p->ctr);
+			if (xo == 16 && !(ins & 1) && p->lr == (u32)(uintptr_t)returnPC)
+				return 1;			// the end of the block, returnPC too far for ba
+			break;
+		}
+
+		case 31:
+			switch (xo) {
+				case 0:   setCr(p, d >> 2, p->r[a], p->r[b], 0); return 0;
+				case 32:  setCr(p, d >> 2, p->r[a], p->r[b], 1); return 0;
+				case 24:  res = p->r[b] & 32 ? 0 : p->r[d] << (p->r[b] & 31); goto logical;
+				case 536: res = p->r[b] & 32 ? 0 : p->r[d] >> (p->r[b] & 31); goto logical;
+				case 792: {
+					int n = p->r[b] & 63;
+
+					res = n > 31 ? (u32)((s32)p->r[d] >> 31) : (u32)((s32)p->r[d] >> n);
+					p->ca = (s32)p->r[d] < 0 && (n > 31 ? p->r[d] << 1 != 0 : n && (p->r[d] << (32 - n)) != 0);
+					goto logical;
+				}
+				case 824:
+					res = (s32)p->r[d] >> b;
+					p->ca = (s32)p->r[d] < 0 && b && (p->r[d] << (32 - b)) != 0;
+					goto logical;
+				case 922: res = (s32)(s16)p->r[d]; goto logical;
+				case 954: res = (s32)(s8)p->r[d]; goto logical;
+				case 26:  res = p->r[d] ? __builtin_clz(p->r[d]) : 32; goto logical;
+				case 28:  res = p->r[d] & p->r[b]; goto logical;
+				case 60:  res = p->r[d] & ~p->r[b]; goto logical;
+				case 124: res = ~(p->r[d] | p->r[b]); goto logical;
+				case 316: res = p->r[d] ^ p->r[b]; goto logical;
+				case 444: res = p->r[d] | p->r[b]; goto logical;
+				case 476: res = ~(p->r[d] & p->r[b]); goto logical;
+				case 339: case 467: {
+					int spr = a | b << 5;
+
+					if (spr != 8 && spr != 9) break;
+					if (xo == 339) p->r[d] = spr == 8 ? p->lr : p->ctr;
+					else if (spr == 8) p->lr = p->r[d];
+					else p->ctr = p->r[d];
+					return 0;
+				}
+			}
+			if (ins & 0x400) {
+				p->fault = "overflow enabled arithmetic";
+				return -1;
+			}
+			switch (ins >> 1 & 0x1ff) {
+				case 266: res = p->r[a] + p->r[b]; break;
+				case 10:  w = (u64)p->r[a] + p->r[b]; res = w; p->ca = w >> 32; break;
+				case 138: w = (u64)p->r[a] + p->r[b] + p->ca; res = w; p->ca = w >> 32; break;
+				case 202: w = (u64)p->r[a] + p->ca; res = w; p->ca = w >> 32; break;
+				case 40:  res = p->r[b] - p->r[a]; break;
+				case 8:   w = (u64)(u32)~p->r[a] + p->r[b] + 1; res = w; p->ca = w >> 32; break;
+				case 136: w = (u64)(u32)~p->r[a] + p->r[b] + p->ca; res = w; p->ca = w >> 32; break;
+				case 104: res = -p->r[a]; break;
+				case 235: res = (u32)((s32)p->r[a] * (s64)(s32)p->r[b]); break;
+				case 75:  res = (u32)(((s64)(s32)p->r[a] * (s32)p->r[b]) >> 32); break;
+				case 11:  res = (u32)(((u64)p->r[a] * p->r[b]) >> 32); break;
+				default:
+					p->fault = "unknown instruction";
+					return -1;
+			}
+			p->r[d] = res;
+			if (rc) setCr(p, 0, res, 0, 0);
+			return 0;
+
+		logical:
+			p->r[a] = res;
+			if (rc) setCr(p, 0, res, 0, 0);
+			return 0;
+	}
+
+	p->fault = "unknown instruction";
+	return -1;
+}
+
+static const char *runPpc(const u32 *code, u32 *steps) {
+	Ppc p;
+	int i, r = 0;
+
+	memset(&p, 0, sizeof(p));
+	for (i = 0; i < 32; i++)
+		p.r[i] = 0xdead0000 | i;	// nothing may be read before it is set
+	p.r[HWRegisters[0].code] = (u32)(uintptr_t)&psxRegs;
+	p.r[HWRegisters[1].code] = (u32)(uintptr_t)&psxM;
+
+	for (*steps = 0; *steps < STEPS && r == 0; (*steps)++)
+		r = step(&p, &code);
+	if (r < 0)
+		return p.fault;
+	return r == 1 ? NULL : "the block does not end";
+}
+
+/*
+ * A block: the ops at ORG with jr ra behind them, recompiled the way
+ * recRecompile does it. The jump ends the block as in a game, every psx
+ * and cop2 register goes back to psxRegs before it.
+ */
+
+static u32 encode(int op, int rt, int rd) {
+	switch (op) {
+		case OP_MFC2:  return 0x48000000 | rt << 16 | rd << 11;
+		case OP_CFC2:  return 0x48400000 | rt << 16 | rd << 11;
+		case OP_MTC2:  return 0x48800000 | rt << 16 | rd << 11;
+		case OP_CTC2:  return 0x48c00000 | rt << 16 | rd << 11;
+		case OP_NCLIP: return 0x4a001406;
+		case OP_AVSZ3: return 0x4a58002d;
+		case OP_AVSZ4: return 0x4a68002e;
+	}
+	return 0;
+}
+
+static u32 *compile(const u32 *ops, int n) {
+	u32 *start;
+	int i;
+
+	for (i = 0; i < n; i++)
+		psxMu32ref(ORG + i * 4) = SWAP32(ops[i]);
+	psxMu32ref(ORG + n * 4) = SWAP32(0x03e00008);	// jr ra
+	psxMu32ref(ORG + n * 4 + 4) = 0;
+
+	UniqueRegAlloc = 1;
+	HWRegUseCount = 0;
+	memset(HWRegisters, 0, sizeof (HWRegisters));
+	for (i = 0; i < NUM_HW_REGISTERS; i++)
+		HWRegisters[i].code = cpuHWRegisters[NUM_HW_REGISTERS - i - 1];
+	HWRegisters[0].usage = HWUSAGE_SPECIAL | HWUSAGE_RESERVED | HWUSAGE_HARDWIRED;
+	HWRegisters[0].private = PSXREGS;
+	HWRegisters[1].usage = HWUSAGE_SPECIAL | HWUSAGE_RESERVED | HWUSAGE_HARDWIRED;
+	HWRegisters[1].private = PSXMEM;
+	for (i = 0; i < NUM_REGISTERS; i++) {
+		iRegs[i].state = ST_UNK;
+		iRegs[i].reg = -1;
+	}
+	iRegs[0].k = 0;
+	iRegs[0].state = ST_CONST;
+	memset(cp2Regs, -1, sizeof (cp2Regs));
+
+	ppcPtr = start = codeBuf;
+	pcold = pc = ORG;
+	branch = 0;
+	BuildPsxRegLiveness(pc);
+
+	for (i = 0; i <= n; i++) {
+		psxRegs.code = i < n ? ops[i] : 0x03e00008;
+		pc += 4;
+		recBSC[psxRegs.code >> 26]();
+	}
+	branch = 0;
+
+	ClearPsxRegLiveness();
+	return start;
+}
+
+static void interpret(const u32 *ops, const int *kinds, int n) {
+	static void (*const fn[OPS])() = {
+		gteMFC2, gteCFC2, gteMTC2, gteCTC2, gteNCLIP, gteAVSZ3, gteAVSZ4
+	};
+	int i;
+
+	for (i = 0; i < n; i++) {
+		psxRegs.code = ops[i];
+		fn[kinds[i]]();
+	}
+}
+
+// register files: random, or made for the cases that flag
+static void randomRegs(u32 *seed) {
+	static const u32 sz[] = { 0, 1, 0x5555, 0xfffe, 0xffff };
+	int i, kind = rnd(seed) % 6;
+
+	for (i = 1; i < 32; i++) psxRegs.GPR.r[i] = rnd(seed);
+	for (i = 0; i < 32; i++) psxRegs.CP2D.r[i] = rnd(seed);
+	for (i = 0; i < 32; i++) psxRegs.CP2C.r[i] = rnd(seed);
+
+	switch (kind) {
+		case 0:		// small screen coordinates and depths, nothing overflows
+			for (i = 12; i < 16; i++) psxRegs.CP2D.r[i] &= 0x03ff03ff;
+			for (i = 16; i < 20; i++) psxRegs.CP2D.r[i] &= 0x0fff;
+			psxRegs.CP2C.r[29] &= 0x00ff;
+			psxRegs.CP2C.r[30] &= 0x00ff;
+			break;
+		case 1:		// the corners of the screen: NCLIP past 32 bits either way
+			for (i = 12; i < 16; i++)
+				psxRegs.CP2D.r[i] = (rnd(seed) & 1 ? 0x7fff : 0x8000) | (rnd(seed) & 1 ? 0x7fff0000 : 0x80000000);
+			break;
+		case 2:		// LZCS and FLAG at their edges
+			psxRegs.GPR.r[rnd(seed) % 31 + 1] = 0;
+			psxRegs.GPR.r[rnd(seed) % 31 + 1] = 0xffffffff;
+			psxRegs.GPR.r[rnd(seed) % 31 + 1] = 0x80000000;
+			psxRegs.GPR.r[rnd(seed) % 31 + 1] = 1;
+			psxRegs.CP2C.r[31] = rnd(seed) % 4 ? 1u << (rnd(seed) % 20 + 12) : 0;
+			for (i = 0; i < 4; i++)		// and for CTC2 31
+				psxRegs.GPR.r[rnd(seed) % 31 + 1] = 1u << (rnd(seed) % 32);
+			break;
+		case 3:		// OTZ right at its limits: ZSF of +-1.0 and the sum on the edge
+			for (i = 16; i < 20; i++)
+				psxRegs.CP2D.r[i] = sz[rnd(seed) % 5];
+			psxRegs.CP2C.r[29] = rnd(seed) & 1 ? 0x1000 : 0xfffff000;
+			psxRegs.CP2C.r[30] = rnd(seed) & 1 ? 0x1000 : 0xfffff000;
+			break;
+	}
+}
+
+typedef struct {
+	u32 ops, words[OPS], count[OPS], flags[32];
+} Stats;
+
+// the FLAG bits a block set
+static void flagged(Stats *s, u32 before, u32 after) {
+	int i;
+
+	for (i = 0; i < 32; i++)
+		if (after & ~before & 1u << i) s->flags[i]++;
+}
+
+int main(int argc, char *argv[]) {
+	int blocks = argc > 1 ? atoi(argv[1]) : 20000, b, i, n, errors = 0, bad = 0;
+	u32 seed = 0xc0ffee, ops[MAXOPS], steps, *code, words;
+	psxRegisters start, want;
+	const char *fault;
+	Stats st;
+	double t;
+
+	if (psxMemInit() != 0)
+		return 1;
+	memset(&st, 0, sizeof(st));
+
+	t = now();
+	for (b = 0; b < blocks; b++) {
+		// half the moves on the registers that do more than move
+		static const int special[2][8] = {
+			{ 7, 8, 15, 15, 28, 29, 30, 31 },		// data
+			{ 4, 29, 30, 31, 31, 31, 20, 26 },		// control
+		};
+		int kinds[MAXOPS], rd;
+
+		n = rnd(&seed) % MAXOPS + 1;
+		for (i = 0; i < n; i++) {
+			int op = rnd(&seed) % (OPS + 3);
+
+			if (op >= OPS) op = op - OPS;		// more moves than commands
+			kinds[i] = op;
+			rd = rnd(&seed) % 2 ? rnd(&seed) % 32 : special[op & 1][rnd(&seed) % 8];
+			ops[i] = encode(op, rnd(&seed) % 8 ? rnd(&seed) % 31 + 1 : 0, rd);
+		}
+
+		randomRegs(&seed);
+		start = psxRegs;
+
+		interpret(ops, kinds, n);
+		want = psxRegs;
+		psxRegs = start;
+
+		code = compile(ops, n);
+		words = ppcPtr - code;
+		fault = runPpc(code, &steps);
+
+		psxRegs.code = want.code;
+		if (fault || memcmp(psxRegs.GPR.r, want.GPR.r, sizeof(want.GPR)) != 0 ||
+			memcmp(psxRegs.CP2D.r, want.CP2D.r, sizeof(want.CP2D)) != 0 ||
+			memcmp(psxRegs.CP2C.r, want.CP2C.r, sizeof(want.CP2C)) != 0) {
+			if (bad++ < 3) {
+				printf("  block %d:", b);
+				for (i = 0; i < n; i++) printf(" %08x", ops[i]);
+				printf("\n    %s\n", fault ? fault : "");
+				for (i = 0; i < 32; i++) {
+					if (psxRegs.GPR.r[i] != want.GPR.r[i])
+						printf("    r%d %08x, gte.c %08x\n", i, psxRegs.GPR.r[i], want.GPR.r[i]);
+					if (psxRegs.CP2D.r[i] != want.CP2D.r[i])
+						printf("    data %d %08x, gte.c %08x\n", i, psxRegs.CP2D.r[i], want.CP2D.r[i]);
+					if (psxRegs.CP2C.r[i] != want.CP2C.r[i])
+						printf("    control %d %08x, gte.c %08x\n", i, psxRegs.CP2C.r[i], want.CP2C.r[i]);
+				}
+			}
+			continue;
+		}
+
+		st.ops += n;
+		flagged(&st, start.CP2C.r[31], want.CP2C.r[31]);
+		if (n == 1) {
+			st.words[kinds[0]] += words;
+			st.count[kinds[0]]++;
+		}
+	}
+	t = now() - t;
+
+	code = compile(ops, 0);
+	words = ppcPtr - code;
+
+	printf("%d blocks, %u ops: %d differ from gte.c (%.1f s)\n", blocks, st.ops, bad, t);
+	printf("FLAG bits set by a block: 31 %u, 18 %u, 16 %u, 15 %u\n",
+		st.flags[31], st.flags[18], st.flags[16], st.flags[15]);
+	for (i = 0; i < OPS; i++)
+		if (st.count[i])
+			printf("  %-5s %5.1f ppc instructions, loads and stores of its registers included\n",
+				opName[i], (double)st.words[i] / st.count[i] - words);
+
+	if (bad) {
+		printf("  the inlined cop2 code does not do what gte.c does\n");
+		errors++;
+	}
+	if (!st.flags[31] || !st.flags[18] || !st.flags[16] || !st.flags[15]) {
+		printf("  the blocks do not reach every flag\n");
+		errors++;
+	}
+
+	psxMemShutdown();
+	return errors != 0;
+}
@@ -0,0 +1,434 @@
+/*
+ * The file browser's directory scan (newgui/fileop.cpp, dircache.cpp)
+ * against the one it replaced (ref/fileop.cpp), on directories made for it
+ * under /tmp: an empty one, a few hundred files and folders, some names
+ * only differing in case or starting with a dot, and a big one. What the
+ * worker thread hands over batch by batch has to end up sorted and the
+ * same as the old listing, with the last loaded file selected on the same
+ * page. Then the listing cache: a second visit shows everything at once,
+ * a file added behind an unchanged mtime (FAT leaves it alone) still turns
+ * up, and the game id, region and tracks of the disc images are read once
+ * and again when an image changes. Then, on the big directory, the time to
+ * the first page and to the whole listing: the old scan, the new one, the
+ * new one from its cache.
+ *
+ *   dirscan [entries]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <utime.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "filebrowser.h"
+#include "fileop.h"
+#include "dircache.h"
+#include "gui/gui.h"
+
+extern "C" {
+#include "../source/main/x_thread.h"
+}
+
+// ref/fileop.cpp, built with its names starting ref (see the Makefile)
+int refParseDirectory(bool waitParse, bool filter);
+extern int refSelectLoadedFile;
+
+extern "C" const char *PcsxrDir;
+const char *PcsxrDir;
+char appPath[MAXPATHLEN];
+char loadedFile[MAXPATHLEN];
+const devoptab_t *devoptab_list[STD_MAX];
+
+static int prompts;
+
+void ErrorPrompt(const char *msg) { prompts++; }
+int ErrorPromptRetry(const char *msg) { prompts++; return 0; }
+
+// the shared hardware threads, a joinable pthread each
+static pthread_t threads[6];
+static bool running[6];
+
+static void *task(void *f) {
+	((void (*)(void))f)();
+	return NULL;
+}
+
+int x_thread_create(int thread, void *f) {
+	if (pthread_create(&threads[thread], NULL, task, f) != 0)
+		return -1;
+	running[thread] = true;
+	return 0;
+}
+
+int x_thread_wait(int thread) {
+	if (running[thread])
+		pthread_join(threads[thread], NULL);
+	running[thread] = false;
+	return 0;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned rnd(unsigned *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+static char root[64], cache[128];
+
+static void touch(const char *dir, const char *name) {
+	char path[MAXPATHLEN];
+	int fd;
+
+	snprintf(path, sizeof(path), "%s%s", dir, name);
+	fd = open(path, O_CREAT | O_WRONLY, 0644);
+	if (fd >= 0)
+		close(fd);
+}
+
+static void put(const char *dir, const char *name, const void *data, size_t size) {
+	char path[MAXPATHLEN];
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s%s", dir, name);
+	f = fopen(path, "wb");
+	if (f) {
+		fwrite(data, 1, size, f);
+		fclose(f);
+	}
+}
+
+static void setTime(const char *dir, const char *name, time_t t) {
+	char path[MAXPATHLEN];
+	struct utimbuf u = { t, t };
+
+	snprintf(path, sizeof(path), "%s%s", dir, name);
+	utime(path, &u);
+}
+
+static int removeEntry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+	return remove(path);
+}
+
+// no listing cached, the next scan reads the directory
+static void forget(void) {
+	nftw((std::string(cache) + DIRCACHE_DIR).c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static void le32(u8 *p, u32 v) {
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+/*
+ * A disc whose SYSTEM.CNF boots id: the volume descriptor at 16, the root
+ * directory at 20, SYSTEM.CNF at 21. raw is where the user data starts in
+ * a 2352 byte sector, 0 for 2048 byte ones.
+ */
+static void disc(const char *dir, const char *name, const char *id, int raw) {
+	static const u8 sync[12] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+	static u8 img[24 * 2352];
+	int size = raw ? 2352 : 2048, i;
+	u8 *s;
+
+	memset(img, 0, sizeof(img));
+	for (i = 0; i < 24 && raw; i++) {
+		memcpy(img + i * size, sync, sizeof(sync));
+		img[i * size + 15] = raw == 24 ? 2 : 1;
+	}
+
+	s = img + 16 * size + raw;
+	s[0] = 1;
+	memcpy(s + 1, "CD001", 5);
+	le32(s + 156 + 2, 20);
+	le32(s + 156 + 10, 2048);
+
+	// "." and SYSTEM.CNF
+	s = img + 20 * size + raw;
+	s[0] = 34;
+	le32(s + 2, 20);
+	s[32] = 1;
+	s += 34;
+	s[0] = 46;
+	le32(s + 2, 21);
+	le32(s + 10, 64);
+	s[32] = 12;
+	memcpy(s + 33, "SYSTEM.CNF;1", 12);
+
+	snprintf((char *)img + 21 * size + raw, 64, "BOOT = cdrom:\\%s;1\r\nTCB = 4\r\n", id);
+	put(dir, name, img, 24 * size);
+}
+
+// the listing as it is now, "Up One Level" first
+struct Listing {
+	std::vector<BROWSERENTRY> entries;
+	int selIndex, pageIndex;
+};
+
+static void take(Listing *l) {
+	l->entries.assign(browserList, browserList + browser.numEntries);
+	l->selIndex = browser.selIndex;
+	l->pageIndex = browser.pageIndex;
+}
+
+static bool before(const BROWSERENTRY &a, const BROWSERENTRY &b) {
+	int c = FileSortCallback(&a, &b);
+
+	return c ? c < 0 : strcmp(a.filename, b.filename) < 0;
+}
+
+/*
+ * Names only differing in case sort equal, their order is up to qsort: so
+ * each listing has to be sorted, and the same once those are put in order.
+ */
+static const char *compare(const Listing &got, const Listing &want) {
+	std::vector<BROWSERENTRY> a = got.entries, b = want.entries;
+	size_t i;
+
+	for (i = 1; i < a.size(); i++)
+		if (FileSortCallback(&a[i - 1], &a[i]) > 0)
+			return "not sorted";
+	if (a.size() != b.size())
+		return "entries missing or too many";
+
+	std::sort(a.begin(), a.end(), before);
+	std::sort(b.begin(), b.end(), before);
+	for (i = 0; i < a.size(); i++)
+		if (strcmp(a[i].filename, b[i].filename) != 0 || strcmp(a[i].displayname, b[i].displayname) != 0 ||
+			a[i].isdir != b[i].isdir || a[i].icon != b[i].icon)
+			return "entries differ";
+	if (got.selIndex != want.selIndex || got.pageIndex != want.pageIndex)
+		return "another file selected";
+	return NULL;
+}
+
+static const BROWSERENTRY *find(const char *name) {
+	for (int i = 0; i < browser.numEntries; i++)
+		if (strcmp(browserList[i].filename, name) == 0)
+			return &browserList[i];
+	return NULL;
+}
+
+static void old(const char *dir, const char *loaded, Listing *l) {
+	snprintf(browser.dir, sizeof(browser.dir), "%s", dir);
+	snprintf(loadedFile, sizeof(loadedFile), "%s", loaded);
+	refSelectLoadedFile = 1;
+	refParseDirectory(false, true);
+	take(l);
+}
+
+// returns the entries shown when ParseDirectory returned, the first page
+static int scan(const char *dir, const char *loaded, Listing *l, double *first, double *total) {
+	double t = now();
+	int shown;
+
+	snprintf(browser.dir, sizeof(browser.dir), "%s", dir);
+	snprintf(loadedFile, sizeof(loadedFile), "%s", loaded);
+	selectLoadedFile = 1;
+	ParseDirectory(false, true);
+	shown = browser.numEntries;
+	if (first)
+		*first = now() - t;
+	while (UpdateParseThread())
+		usleep(100);
+	if (total)
+		*total = now() - t;
+	take(l);
+	return shown;
+}
+
+int main(int argc, char *argv[]) {
+	static const char *words[] = { "Final", "crash", "Tekken", "ape", "Gran", "Ridge", "silent", "Metal", "spyro", "Vib" };
+	int n = argc > 1 ? atoi(argv[1]) : 50000, errors = 0, i, shown;
+	char empty[128], few[128], big[128], name[64], pick[64] = "";
+	unsigned seed = 0xd1e5;
+	double first[3], total[3];
+	const BROWSERENTRY *e;
+	const char *why;
+	struct stat st;
+	Listing a, b;
+
+	snprintf(root, sizeof(root), "/tmp/dirscanXXXXXX");
+	if (mkdtemp(root) == NULL)
+		return 1;
+	snprintf(empty, sizeof(empty), "%s/empty/", root);
+	snprintf(few, sizeof(few), "%s/few/", root);
+	snprintf(big, sizeof(big), "%s/big/", root);
+	snprintf(cache, sizeof(cache), "%s/pcsxr/", root);
+	mkdir(empty, 0755);
+	mkdir(few, 0755);
+	mkdir(big, 0755);
+	mkdir(cache, 0755);
+	PcsxrDir = cache;
+
+	// folders, files, dot files, names twice in another case, and disc images
+	for (i = 0; i < 300; i++) {
+		unsigned x = rnd(&seed);
+
+		snprintf(name, sizeof(name), "%s%s %u%s", x % 16 == 0 ? "." : "", words[x / 16 % 10], x / 256 % 200,
+			x % 8 == 1 ? "" : x % 8 == 2 ? ".cue" : ".bin");
+		if (x % 8 == 1) {
+			char path[MAXPATHLEN];
+
+			snprintf(path, sizeof(path), "%s%s", few, name);
+			mkdir(path, 0755);
+		} else {
+			touch(few, name);
+		}
+		if (x % 32 == 3) {
+			for (char *c = name; *c; c++)
+				*c = *c >= 'a' && *c <= 'z' ? *c - 32 : *c;
+			touch(few, name);
+		}
+	}
+	touch(few, "crash 7.bin");
+	touch(few, "CRASH 7.bin");
+	disc(few, "Game A.iso", "SLUS_007.07", 0);
+	disc(few, "Game B.bin", "SCES_012.34", 24);
+	disc(few, "Game C.img.bin", "SLPM_860.01", 16);
+	{
+		static const char cue[] = "FILE \"sub\\Game B.bin\" BINARY\r\n  TRACK 01 MODE2/2352\r\n    INDEX 01 00:00:00\r\n"
+			"  TRACK 02 AUDIO\r\n    INDEX 01 40:00:00\r\n  TRACK 03 AUDIO\r\n    INDEX 01 42:00:00\r\n";
+
+		put(few, "Game B.cue", cue, sizeof(cue) - 1);
+	}
+	put(few, "broken.iso", "not a disc", 10);
+
+	for (i = 0; i < n; i++) {
+		unsigned x = rnd(&seed);
+
+		snprintf(name, sizeof(name), "%s %05u%s", words[x % 10], i, x / 16 % 25 == 0 ? ".bin" : ".mp3");
+		if (x / 16 % 50 == 1) {
+			char path[MAXPATHLEN];
+
+			snprintf(path, sizeof(path), "%s%s", big, name);
+			mkdir(path, 0755);
+		} else {
+			touch(big, name);
+			if (i >= n / 2 && pick[0] == 0)
+				strcpy(pick, name);
+		}
+	}
+
+	// the same listings, the last loaded file selected, before and after
+	{
+		static const struct {
+			const char *dir, *loaded;
+		} cases[] = {
+			{ empty, "" }, { few, "Game B.cue" }, { few, "CRASH 7.bin" }, { few, "crash 7.bin" }, { few, "none.bin" },
+		};
+
+		for (i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+			old(cases[i].dir, cases[i].loaded, &b);
+			forget();
+			scan(cases[i].dir, cases[i].loaded, &a, NULL, NULL);
+			if ((why = compare(a, b)) != NULL || (cases[i].loaded[0] && strcmp(cases[i].loaded, "none.bin") != 0 &&
+				strcmp(a.entries[a.selIndex].filename, cases[i].loaded) != 0)) {
+				printf("  %s, %s loaded: %s, %d entries for %d, %s selected\n", cases[i].dir + strlen(root),
+					cases[i].loaded, why ? why : "wrong file selected", (int)a.entries.size(), (int)b.entries.size(),
+					a.entries[a.selIndex].filename);
+				errors++;
+			}
+		}
+	}
+
+	// what the images hold
+	{
+		static const struct {
+			const char *name, *id;
+			char region;
+			int tracks;
+		} discs[] = {
+			{ "Game A.iso", "SLUS_007.07", 'U', 0 }, { "Game B.bin", "SCES_012.34", 'E', 0 },
+			{ "Game B.cue", "SCES_012.34", 'E', 3 }, { "Game C.img.bin", "SLPM_860.01", 'J', 0 },
+			{ "broken.iso", "", 0, 0 },
+		};
+
+		for (i = 0; i < (int)(sizeof(discs) / sizeof(discs[0])); i++) {
+			e = find(discs[i].name);
+			if (e == NULL || strcmp(e->gameid, discs[i].id) != 0 || e->region != discs[i].region ||
+				e->tracks != discs[i].tracks) {
+				printf("  %s: %s, region %c, %d tracks\n", discs[i].name, e ? e->gameid : "missing",
+					e && e->region ? e->region : '-', e ? e->tracks : -1);
+				errors++;
+			}
+		}
+	}
+
+	// unchanged, everything comes from the cache at once
+	old(few, "Game A.iso", &b);
+	shown = scan(few, "Game A.iso", &a, NULL, NULL);
+	if ((why = compare(a, b)) != NULL || shown != (int)b.entries.size()) {
+		printf("  cached: %s, %d of %d shown at first\n", why ? why : "the same", shown, (int)b.entries.size());
+		errors++;
+	}
+
+	// a file added, the mtime put back as FAT would have left it
+	stat(few, &st);
+	touch(few, "Added 1.bin");
+	setTime(few, "", st.st_mtime);
+	old(few, "Added 1.bin", &b);
+	scan(few, "Added 1.bin", &a, NULL, NULL);
+	if ((why = compare(a, b)) != NULL || find("Added 1.bin") == NULL) {
+		printf("  added behind the same mtime: %s\n", why ? why : "not listed");
+		errors++;
+	}
+
+	/*
+	 * Two images rewritten, the folder touched: those two are read again,
+	 * the cue sheet in front of one of them is not, it didn't change.
+	 */
+	disc(few, "Game A.iso", "SLPM_861.02", 0);
+	disc(few, "Game B.bin", "SCUS_944.55", 24);
+	setTime(few, "Game A.iso", st.st_mtime + 100);
+	setTime(few, "Game B.bin", st.st_mtime + 100);
+	setTime(few, "", st.st_mtime + 100);
+	scan(few, "", &a, NULL, NULL);
+	if ((e = find("Game A.iso")) == NULL || e->region != 'J' || (e = find("Game B.bin")) == NULL || e->region != 'U' ||
+		(e = find("Game B.cue")) == NULL || e->region != 'E' || e->tracks != 3) {
+		printf("  images changed: not read again, or the unchanged ones were\n");
+		errors++;
+	}
+
+	// the big one, without a cache and with
+	first[0] = now();
+	old(big, pick, &b);
+	first[0] = total[0] = now() - first[0];
+	forget();
+	shown = scan(big, pick, &a, &first[1], &total[1]);
+	if ((why = compare(a, b)) != NULL || shown > 1 + FILE_PAGESIZE) {
+		printf("  %d entries: %s, %d shown at first\n", n, why ? why : "the same", shown);
+		errors++;
+	}
+	shown = scan(big, pick, &a, &first[2], &total[2]);
+	if ((why = compare(a, b)) != NULL || shown != (int)b.entries.size()) {
+		printf("  %d entries, cached: %s, %d shown at first\n", n, why ? why : "the same", shown);
+		errors++;
+	}
+	if (prompts) {
+		printf("  %d prompts\n", prompts);
+		errors++;
+	}
+
+	printf("%d entries, %s selected: %s\n", (int)b.entries.size() - 1, pick, errors ? "differ" : "the same");
+	printf("ms            first page   all\n");
+	printf("old scan      %10.1f %5.0f\n", first[0] * 1e3, total[0] * 1e3);
+	printf("worker        %10.1f %5.0f\n", first[1] * 1e3, total[1] * 1e3);
+	printf("from cache    %10.1f %5.0f\n", first[2] * 1e3, total[2] * 1e3);
+
+	HaltParseThread();
+	nftw(root, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+	return errors != 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Fast forward at each multiplier, with the frame limiter on as on the
+ * Xbox: the emulated speed has to follow the multiplier as far as the host
+ * keeps up, and no more frames may be presented than the tv could show.
+ * Unlimited (0) runs as fast as it goes.
+ *
+ *   fastforward [-bios file] [-seconds s] <exe or image>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "psxcommon.h"
+#include "hostsys.h"
+
+extern int UseFrameLimit;
+extern float fFrameRateHz;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *name) {
+	fprintf(stderr, "usage: %s [-bios file] [-seconds s] <exe or image>\n", name);
+	exit(2);
+}
+
+int main(int argc, char *argv[]) {
+	static const int speeds[] = { 1, 2, 4, 8, 0 };
+	const char *bios = NULL, *file = NULL;
+	double seconds = 0.5, t, speed, shown, fastest;
+	int i, s, errors = 0;
+	u32 frames, n, swaps;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-bios") == 0 && i + 1 < argc) bios = argv[++i];
+		else if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+		else if (argv[i][0] == '-') usage(argv[0]);
+		else file = argv[i];
+	}
+	if (file == NULL) usage(argv[0]);
+
+	if (HostStart(file, bios) != 0) {
+		fprintf(stderr, "could not start %s\n", file);
+		return 1;
+	}
+
+	// a few frames for the display mode and the refresh rate to be set up
+	for (i = 0; i < 10; i++)
+		HostFrame();
+	UseFrameLimit = 1;
+
+	// unlimited first, it tells which multipliers the host can keep up with
+	fastest = 0;
+	for (s = sizeof(speeds) / sizeof(speeds[0]) - 1; s >= 0; s--) {
+		Config.FastForward = speeds[s];
+		EmuSetFastForward(speeds[s] != 1);
+
+		frames = speeds[s] ? (u32)(fFrameRateHz * speeds[s] * seconds) : (u32)(fastest * seconds);
+		if (frames == 0) frames = (u32)(fFrameRateHz * seconds * 16);
+
+		swaps = hostSwaps;
+		t = now();
+		for (n = 0; n < frames; n++)
+			HostFrame();
+		t = now() - t;
+		EmuSetFastForward(FALSE);
+
+		speed = frames / t / fFrameRateHz;
+		shown = (hostSwaps - swaps) / t;
+		if (speeds[s] == 0) fastest = frames / t;
+
+		printf("%dx: %5u frames in %6.3f s, %6.2fx psx speed, %5.1f frames/s shown\n",
+			speeds[s], frames, t, speed, shown);
+
+		// the limiter may lag a frame behind, the host refresh is 60 Hz
+		if (speeds[s] != 0 && fastest > fFrameRateHz * speeds[s] * 1.25 &&
+			(speed < speeds[s] * 0.9 || speed > speeds[s] * 1.1)) {
+			printf("  runs at %.2fx instead of %dx\n", speed, speeds[s]);
+			errors++;
+		}
+		if (speeds[s] != 1 && shown > 60 * 1.1 + 2 / t) {
+			printf("  shows more than the tv refresh\n");
+			errors++;
+		}
+	}
+
+	HostStop();
+	return errors != 0;
+}
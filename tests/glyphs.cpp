@@ -0,0 +1,383 @@
+/*
+ * The gui's text (newgui/FreeTypeGX.cpp) on its own font against the
+ * texture a glyph version it replaced (ref/FreeTypeGX.cpp). First the
+ * skyline packer alone: small, glyph sized and mixed rectangles until a
+ * page is full, none of them may leave the page or overlap another. Then
+ * strings of ascii, latin-1, characters the font lacks and ones outside
+ * the BMP, from 12 to 72 pixels so the big sizes take several atlas pages,
+ * over and over so most come from the layout cache, more of them than it
+ * holds, and two with the same hash. Both draw into a screen of their
+ * own: every glyph quad has to show the same texels at the same place as
+ * the glyph textures did, with every justification and alignment, and the
+ * width, offsets and characters printed have to agree. Then a menu frame
+ * of 300 strings measured and drawn, for both.
+ *
+ *   glyphs [font.ttf]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "FreeTypeGX.h"
+
+// ref/FreeTypeGX.h, with the names the Makefile builds it with
+#undef FREETYPEXE_H_
+#define FreeTypeGX refFreeTypeGX
+#define ftgxCharData_ refFtgxCharData_
+#define ftgxCharData refFtgxCharData
+#define ftgxDataOffset_ refFtgxDataOffset_
+#define ftgxDataOffset refFtgxDataOffset
+#define ftgxWhite refFtgxWhite
+#define InitFreeType refInitFreeType
+#define DeinitFreeType refDeinitFreeType
+#define ChangeFontSize refChangeFontSize
+#define ClearFontData refClearFontData
+#define charToWideChar refCharToWideChar
+#include "ref/FreeTypeGX.h"
+#undef FreeTypeGX
+#undef ftgxCharData_
+#undef ftgxCharData
+#undef ftgxDataOffset_
+#undef ftgxDataOffset
+#undef ftgxWhite
+#undef InitFreeType
+#undef DeinitFreeType
+#undef ChangeFontSize
+#undef ClearFontData
+#undef charToWideChar
+
+#define WIDTH		4096
+#define HEIGHT		512
+#define PAGE		512			// the packer's test page
+#define POOL		700			// strings, more than FTGX_LAYOUT_CACHE
+
+struct XenosDevice *g_pVideoDevice;
+
+/*
+ * The null backend. Textures are plain memory, draws take the brightest
+ * texel into a screen of their own, so the order glyphs come in doesn't
+ * matter. -1 draws nothing, for the timing.
+ */
+
+static uint8_t screen[2][HEIGHT][WIDTH];
+static int target, draws, unaligned, atlasPages;
+static int dirtyX0 = WIDTH, dirtyY0 = HEIGHT, dirtyX1, dirtyY1;
+
+XenosSurface *Xe_CreateTexture(struct XenosDevice *xe, unsigned int width, unsigned int height, unsigned int levels, int format, int tiled) {
+	XenosSurface *s = (XenosSurface *)calloc(1, sizeof(XenosSurface));
+
+	s->width = s->wpitch = width;
+	s->height = s->hpitch = height;
+	s->format = format;
+	s->base = calloc(width, height);
+	atlasPages += width == FTGX_ATLAS_SIZE && height == FTGX_ATLAS_SIZE;
+	return s;
+}
+
+void Xe_DestroyTexture(struct XenosDevice *xe, XenosSurface *surface) {
+	free(surface->base);
+	free(surface);
+}
+
+void *Xe_Surface_LockRect(struct XenosDevice *xe, XenosSurface *surface, int x, int y, int w, int h, int flags) {
+	return surface->base;
+}
+
+void Xe_Surface_Unlock(struct XenosDevice *xe, XenosSurface *surface) { }
+
+static void blit(XenosSurface *surf, int sx, int sy, int tx, int ty, int w, int h) {
+	int i, j;
+
+	for (j = 0; j < h; j++) {
+		const uint8_t *src = (const uint8_t *)surf->base + (ty + j) * surf->wpitch + tx;
+
+		if (sy + j < 0 || sy + j >= HEIGHT || ty + j >= surf->height)
+			continue;
+		for (i = 0; i < w && tx + i < surf->width; i++) {
+			uint8_t *dst = &screen[target][sy + j][sx + i];
+
+			if (sx + i >= 0 && sx + i < WIDTH && *dst < src[i])
+				*dst = src[i];
+		}
+	}
+	if (sx < dirtyX0) dirtyX0 = sx < 0 ? 0 : sx;
+	if (sy < dirtyY0) dirtyY0 = sy < 0 ? 0 : sy;
+	if (sx + w > dirtyX1) dirtyX1 = sx + w > WIDTH ? WIDTH : sx + w;
+	if (sy + h > dirtyY1) dirtyY1 = sy + h > HEIGHT ? HEIGHT : sy + h;
+}
+
+// a glyph texture, the whole of it
+void Menu_T(XenosSurface *surf, f32 texWidth, f32 texHeight, int16_t screenX, int16_t screenY, GXColor color) {
+	draws++;
+	if (target >= 0)
+		blit(surf, screenX, screenY, 0, 0, texWidth, texHeight);
+}
+
+// glyphs out of an atlas page, a texel to a pixel
+void Menu_TBatch(XenosSurface *surf, const TexQuad *quads, int count, GXColor color) {
+	int i;
+
+	draws++;
+	for (i = 0; i < count && target >= 0; i++) {
+		const TexQuad *q = &quads[i];
+		int tx = q->u0 * FTGX_ATLAS_SIZE, ty = q->v0 * FTGX_ATLAS_SIZE;
+
+		if (tx != q->u0 * FTGX_ATLAS_SIZE || ty != q->v0 * FTGX_ATLAS_SIZE || q->x != (int)q->x || q->y != (int)q->y ||
+			(q->u1 - q->u0) * FTGX_ATLAS_SIZE != q->width || (q->v1 - q->v0) * FTGX_ATLAS_SIZE != q->height)
+			unaligned++;
+		blit(surf, (int16_t)(int)q->x, (int16_t)(int)q->y, tx, ty, q->width, q->height);
+	}
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned rnd(unsigned *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+// getLayout's
+static uint32_t fnv(const std::wstring &s) {
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < s.size(); i++)
+		hash = (hash ^ (uint32_t)s[i]) * 16777619u;
+	return hash;
+}
+
+static std::wstring text(unsigned *seed) {
+	static const wchar_t other[] = { 0x131, 0x152, 0x161, 0x192, 0x2c6, 0x2013, 0x201c, 0x2026, 0x2122, 0xfb01 };
+	unsigned x = rnd(seed), len = x % 16 == 0 ? 0 : x % 8 == 1 ? 20 + x / 16 % 40 : 1 + x / 16 % 20, i;
+	std::wstring s;
+
+	for (i = 0; i < len; i++) {
+		x = rnd(seed);
+		switch (x % 32) {
+			case 0: s += (wchar_t)(0x4e00 + x / 32 % 0x5000); break;		// not in the font
+			case 1: s += (wchar_t)(0x410 + x / 32 % 64); break;
+			case 2: s += (wchar_t)(0x1f600 + x / 32 % 80); break;			// past the BMP
+			case 3: case 4: s += other[x / 32 % 10]; break;
+			case 5: case 6: case 7: s += (wchar_t)(0xa0 + x / 32 % 96); break;
+			default: s += (wchar_t)(0x20 + x / 32 % 95); break;
+		}
+	}
+	return s;
+}
+
+static int packer(void) {
+	static const char *kinds[] = { "small", "glyphs", "mixed" };
+	static uint8_t used[PAGE][PAGE];
+	unsigned seed = 0x9a7c, kind, page, errors = 0;
+	SkylinePacker p;
+
+	for (kind = 0; kind < 3; kind++) {
+		unsigned rects = 0, bad = 0;
+		double fill = 0;
+
+		for (page = 0; page < 40; page++) {
+			unsigned failed = 0, area = 0;
+
+			p.reset(PAGE, PAGE);
+			memset(used, 0, sizeof(used));
+			while (failed < 32) {
+				unsigned x0 = rnd(&seed), w, h, i, j, overlap = 0;
+				uint16_t x, y;
+
+				w = kind == 0 ? 1 + x0 % 16 : kind == 1 ? 2 + x0 % 40 : 1 + x0 % 200;
+				h = kind == 0 ? 1 + x0 / 256 % 20 : kind == 1 ? 10 + x0 / 256 % 40 : 1 + x0 / 256 % 200;
+				if (!p.insert(w, h, &x, &y)) {
+					failed++;
+					continue;
+				}
+				rects++;
+				if (x + w > PAGE || y + h > PAGE) {
+					if (bad++ < 3)
+						printf("  %s, %ux%u at %u,%u: off the page\n", kinds[kind], w, h, x, y);
+					continue;
+				}
+				for (j = y; j < y + h; j++)
+					for (i = x; i < x + w; i++)
+						overlap |= used[j][i]++;
+				if (overlap && bad++ < 3)
+					printf("  %s, %ux%u at %u,%u: overlaps\n", kinds[kind], w, h, x, y);
+				area += w * h;
+			}
+			fill += (double)area / (PAGE * PAGE);
+		}
+
+		// nothing fits in nothing
+		uint16_t x, y;
+		if (p.insert(0, 5, &x, &y) || p.insert(PAGE + 1, 1, &x, &y))
+			bad++;
+
+		printf("%-6s %6u rectangles, %u wrong, pages %.0f%% full\n", kinds[kind], rects, bad, fill * 100 / page);
+		if (bad || fill / page < 0.7)
+			errors++;
+	}
+	return errors;
+}
+
+static double bench(int ref, std::vector<std::wstring> &strings, int *calls) {
+	FreeTypeGX *now_ = NULL;
+	refFreeTypeGX *before = NULL;
+	double t;
+	int frame;
+	size_t i;
+
+	ChangeFontSize(20);
+	refChangeFontSize(20);
+	ref ? (void)(before = new refFreeTypeGX(20)) : (void)(now_ = new FreeTypeGX(20));
+
+	target = -1;
+	draws = 0;
+	t = now();
+	for (frame = 0; frame < 100; frame++) {
+		for (i = 0; i < strings.size(); i++) {
+			wchar_t *s = &strings[i][0];
+
+			if (ref) {
+				before->getWidth(s);
+				before->drawText(640, 40 + i, s, ftgxWhite, FTGX_JUSTIFY_CENTER | FTGX_ALIGN_MIDDLE);
+			} else {
+				now_->getWidth(s);
+				now_->drawText(640, 40 + i, s, ftgxWhite, FTGX_JUSTIFY_CENTER | FTGX_ALIGN_MIDDLE);
+			}
+		}
+	}
+	t = (now() - t) / frame;
+	*calls = draws / frame;
+
+	delete now_;
+	delete before;
+	return t * 1e6;
+}
+
+int main(int argc, char *argv[]) {
+	static const int sizes[] = { 12, 16, 20, 24, 30, 72 };
+	static const uint16_t justify[] = { FTGX_NULL, FTGX_JUSTIFY_LEFT, FTGX_JUSTIFY_CENTER, FTGX_JUSTIFY_RIGHT };
+	static const uint16_t align[] = {
+		FTGX_NULL, FTGX_ALIGN_TOP, FTGX_ALIGN_MIDDLE, FTGX_ALIGN_BOTTOM, FTGX_ALIGN_BASELINE,
+		FTGX_ALIGN_GLYPH_TOP, FTGX_ALIGN_GLYPH_MIDDLE, FTGX_ALIGN_GLYPH_BOTTOM
+	};
+	const char *path = argc > 1 ? argv[1] : "../source/newgui/fonts/font.ttf";
+	std::vector<std::wstring> pool, menu;
+	std::wstring a = L"yaczf", b = L"glbpp";
+	unsigned seed = 0xf0e1, i, errors = 0, compared = 0, differ = 0, pages[6];
+	int calls[2];
+	double us[2];
+	uint8_t *font;
+	long size;
+	FILE *f;
+
+	errors += packer();
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		printf("can't open %s\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	font = (uint8_t *)malloc(size);
+	if (fread(font, 1, size, f) != (size_t)size)
+		return 1;
+	fclose(f);
+	InitFreeType(font, size);
+	refInitFreeType(font, size);
+
+	// two strings that hash the same, found by counting through five letters
+	if (fnv(a) != fnv(b)) {
+		printf("  %ls and %ls don't collide\n", a.c_str(), b.c_str());
+		errors++;
+	}
+
+	for (i = 0; i < POOL; i++)
+		pool.push_back(text(&seed));
+
+	for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); z++) {
+		FreeTypeGX *now_ = new FreeTypeGX(sizes[z]);
+		refFreeTypeGX *before = new refFreeTypeGX(sizes[z]);
+
+		ChangeFontSize(sizes[z]);
+		refChangeFontSize(sizes[z]);
+
+		for (int k = 0; k < 3000; k++) {
+			unsigned x = rnd(&seed);
+			// mostly the strings of a menu, shown again and again
+			std::wstring s = x % 64 == 0 ? a : x % 64 == 1 ? b : pool[x / 64 % (k < 1500 ? 200 : POOL)];
+			std::wstring t = s;
+			uint16_t style = justify[x / 0x10000 % 4] | align[x / 0x40000 % 8];
+			int16_t px = 1024 + rnd(&seed) % 2048, py = 128 + rnd(&seed) % 256;
+			ftgxDataOffset o;
+			refFtgxDataOffset ro;
+			uint16_t width, refWidth, printed, refPrinted;
+			int bad = 0, row;
+
+			// the old one takes strings it may not change
+			width = now_->getWidth(s.c_str());
+			refWidth = before->getWidth(&t[0]);
+			now_->getOffset(s.c_str(), &o);
+			before->getOffset(&t[0], &ro);
+
+			target = 0;
+			printed = now_->drawText(px, py, s.c_str(), ftgxWhite, style);
+			target = 1;
+			refPrinted = before->drawText(px, py, &t[0], refFtgxWhite, style);
+
+			for (row = dirtyY0; row < dirtyY1; row++) {
+				if (memcmp(&screen[0][row][dirtyX0], &screen[1][row][dirtyX0], dirtyX1 - dirtyX0) != 0)
+					bad = 1;
+				memset(&screen[0][row][dirtyX0], 0, dirtyX1 - dirtyX0);
+				memset(&screen[1][row][dirtyX0], 0, dirtyX1 - dirtyX0);
+			}
+			dirtyX0 = WIDTH; dirtyY0 = HEIGHT; dirtyX1 = dirtyY1 = 0;
+
+			if (width != refWidth || printed != refPrinted || o.ascender != ro.ascender || o.descender != ro.descender ||
+				o.max != ro.max || o.min != ro.min || unaligned)
+				bad = 1;
+
+			compared++;
+			if (bad && differ++ < 3)
+				printf("  %dpx, %u characters, style %04x: width %u for %u, %u printed for %u, glyphs %d..%d for %d..%d%s\n",
+					sizes[z], (unsigned)s.size(), style, width, refWidth, printed, refPrinted, o.min, o.max, ro.min, ro.max,
+					unaligned ? ", quads off the texels" : "");
+			unaligned = 0;
+		}
+
+		pages[z] = atlasPages;
+		atlasPages = 0;
+		delete now_;
+		delete before;
+	}
+
+	printf("%u strings, %u differ, atlas pages", compared, differ);
+	for (i = 0; i < 6; i++)
+		printf(" %u at %dpx%s", pages[i], sizes[i], i < 5 ? "," : "\n");
+	if (differ || compared == 0 || pages[5] < 2)
+		errors++;
+
+	// a menu: 300 strings of a list, measured and drawn every frame
+	seed = 0x3e9;
+	for (i = 0; i < 300; i++)
+		menu.push_back(text(&seed));
+	us[0] = bench(1, menu, &calls[0]);
+	us[1] = bench(0, menu, &calls[1]);
+	printf("a frame of 300 strings   texture a glyph   atlas\n");
+	printf("us                       %15.0f %7.0f\n", us[0], us[1]);
+	printf("draw calls               %15d %7d\n", calls[0], calls[1]);
+
+	DeinitFreeType();
+	refDeinitFreeType();
+	free(font);
+	return errors != 0;
+}
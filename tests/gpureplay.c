@@ -0,0 +1,55 @@
+/*
+ * Replays a GPU trace (see gpurec.h) into the soft gpu on the host, for
+ * profiling the rasteriser and checking that a change renders the same:
+ *
+ *   gpureplay [-v] <trace>
+ *
+ * Prints the replay statistics and the vram checksum the trace ends with,
+ * with -v also the primitives, pixels and checksum of every frame.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "psxcommon.h"
+#include "plugins.h"
+#include "gpurec.h"
+#include "hard_plugins.h"
+
+int main(int argc, char *argv[]) {
+	GPUrecStats stats;
+	boolean verbose = FALSE;
+	const char *trace = NULL;
+	int i, ret;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-v") == 0) verbose = TRUE;
+		else trace = argv[i];
+	}
+	if (trace == NULL) {
+		fprintf(stderr, "usage: %s [-v] <trace>\n", argv[0]);
+		return 2;
+	}
+
+	// only the gpu is needed, straight from its table entries
+	GPU_writeStatus = (GPUwriteStatus)PEOPS_GPUwriteStatus;
+	GPU_writeData = (GPUwriteData)PEOPS_GPUwriteData;
+	GPU_writeDataMem = (GPUwriteDataMem)PEOPS_GPUwriteDataMem;
+	GPU_readData = (GPUreadData)PEOPS_GPUreadData;
+	GPU_readDataMem = (GPUreadDataMem)PEOPS_GPUreadDataMem;
+	GPU_updateLace = (GPUupdateLace)PEOPS_GPUupdateLace;
+	GPU_vBlank = (GPUvBlank)PEOPS_GPUvBlank;
+	GPU_freeze = (GPUfreeze)PEOPS_GPUfreeze;
+
+	if (PEOPS_GPUinit() != 0 || PEOPS_GPUopen(NULL, "gpureplay", NULL) < 0) {
+		fprintf(stderr, "the soft gpu did not start\n");
+		return 1;
+	}
+
+	ret = GPUrec_Replay(trace, verbose, &stats);
+
+	PEOPS_GPUclose();
+	PEOPS_GPUshutdown();
+
+	return ret == 0 ? 0 : 1;
+}
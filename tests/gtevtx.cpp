@@ -0,0 +1,250 @@
+/*
+ * The hw gpu's sub-pixel vertex store (peopsxgl/gte_accuracy.cpp) against
+ * the dense 4096x4096 array it replaced, over vertex streams the way a game
+ * sends them: the gte stores a frame's vertices while the gpu still looks
+ * up the frame before. Whatever was stored in the frame looked up or in the
+ * one before has to come back exactly as the array has it, anything older
+ * must not come back at all. Then the cost of a reset, a store and a
+ * lookup for both.
+ *
+ *   gtevtx [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "stdafx.h"
+#include "externals.h"
+#include "gte_accuracy.h"
+
+EXTERN void CALLBACK GPUaddVertex(short sx, short sy, long long fx, long long fy, long long fz);
+
+namespace xegpu {
+	XEGPU_CONFIG peops_cfg;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int rnd(unsigned int *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+/*
+ * The array as it was: the last vertex stored at each spot, kept until the
+ * plugin is opened again. The frame it was stored in is only kept here, to
+ * know what the store has to answer.
+ */
+
+typedef float (*dense_t)[0x800 * 2][2];
+
+static dense_t dense;
+static int *denseFrame;
+
+static void denseAdd(short sx, short sy, long long fx, long long fy, int frame) {
+	dense[sy + 0x800][sx + 0x800][0] = fx / 65536.0f;
+	dense[sy + 0x800][sx + 0x800][1] = fy / 65536.0f;
+	denseFrame[(sy + 0x800) * 0x1000 + sx + 0x800] = frame;
+}
+
+static int denseGet(short sx, short sy, float *fx, float *fy) {
+	if ((fabsf(dense[sy + 0x800][sx + 0x800][0] - sx) < 1.0) &&
+			(fabsf(dense[sy + 0x800][sx + 0x800][1] - sy) < 1.0)) {
+		*fx = dense[sy + 0x800][sx + 0x800][0];
+		*fy = dense[sy + 0x800][sx + 0x800][1];
+		return 1;
+	}
+	return 0;
+}
+
+static void denseReset(void) {
+	memset(dense, 0x00, 0x8000000);
+	memset(denseFrame, 0xff, 0x1000 * 0x1000 * sizeof(int));
+}
+
+/*
+ * Streams: a mesh of verts vertices that drifts a little every frame, moved
+ * elsewhere now and then; churn of them land somewhere new every frame.
+ * One in 16 stores is off by more than a pixel, which neither may return.
+ */
+
+typedef struct {
+	const char *name;
+	int verts, churn;
+	int exact;		// the table is big enough: no live vertex may be missed
+} Stream;
+
+typedef struct {
+	unsigned int lookups, hits, recent, missed, wrong, expired;
+} Result;
+
+typedef struct {
+	short x, y;
+} Vtx;
+
+static void frameVerts(Vtx *v, int n, int churn, int frame, unsigned int *seed) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (frame == 0 || i < churn || rnd(seed) % 256 == 0) {
+			v[i].x = (short)(rnd(seed) % 1024) - 256;
+			v[i].y = (short)(rnd(seed) % 768) - 256;
+		} else {
+			v[i].x += (short)(rnd(seed) % 3) - 1;
+			v[i].y += (short)(rnd(seed) % 3) - 1;
+		}
+	}
+}
+
+static void lookup(short sx, short sy, int frame, Result *r) {
+	float hx = 0, hy = 0, dx = 0, dy = 0;
+	int h = getGteVertex(sx, sy, &hx, &hy);
+	int d = denseGet(sx, sy, &dx, &dy);
+	int stored = denseFrame[(sy + 0x800) * 0x1000 + sx + 0x800];
+
+	r->lookups++;
+	r->hits += h;
+
+	if (d && stored >= frame - 1) {
+		// stored in this frame or the one before: has to be there as it is
+		r->recent++;
+		if (!h)
+			r->missed++;
+		else if (hx != dx || hy != dy)
+			r->wrong++;
+	} else if (h) {
+		// the array has nothing valid there, or only from frames ago
+		r->wrong++;
+	} else if (d) {
+		r->expired++;
+	}
+}
+
+static void run(const Stream *s, int frames, Result *r) {
+	Vtx *cur = (Vtx *)malloc(s->verts * sizeof(Vtx));
+	Vtx *prev = (Vtx *)malloc(s->verts * sizeof(Vtx));
+	unsigned int seed = 0x1234567 + s->verts;
+	long long fx, fy;
+	int f, i;
+
+	memset(r, 0, sizeof(*r));
+	denseReset();
+	resetGteVertices();
+
+	for (f = 0; f < frames; f++) {
+		memcpy(prev, cur, s->verts * sizeof(Vtx));
+		frameVerts(cur, s->verts, s->churn, f, &seed);
+
+		for (i = 0; i < s->verts; i++) {
+			fx = cur[i].x * 65536LL + rnd(&seed) % 65536;
+			fy = cur[i].y * 65536LL + rnd(&seed) % 65536;
+			if (rnd(&seed) % 16 == 0)
+				fx += 3 * 65536;
+			GPUaddVertex(cur[i].x, cur[i].y, fx, fy, 0);
+			denseAdd(cur[i].x, cur[i].y, fx, fy, f);
+
+			// the gpu a frame behind, and now and then from frames ago
+			if (f > 0)
+				lookup(prev[i].x, prev[i].y, f, r);
+			if (i % 8 == 0 && f > 0)
+				lookup((short)(rnd(&seed) % 1024) - 256, (short)(rnd(&seed) % 768) - 256, f, r);
+		}
+		for (i = 0; i < s->verts; i += 2)
+			lookup(cur[i].x, cur[i].y, f, r);
+
+		nextGteFrame();
+	}
+
+	free(cur);
+	free(prev);
+}
+
+static void bench(int n) {
+	unsigned int seed = 99, sink = 0;
+	double t, reset, denseReset_, add, get, dadd, dget;
+	float fx, fy;
+	short x, y;
+	int i;
+
+	t = now();
+	for (i = 0; i < 16; i++)
+		denseReset();
+	denseReset_ = (now() - t) / 16;
+	t = now();
+	for (i = 0; i < 16; i++)
+		resetGteVertices();
+	reset = (now() - t) / 16;
+
+	t = now();
+	for (i = 0; i < n; i++) {
+		x = (short)(i * 7 % 640); y = (short)(i * 13 % 480);
+		GPUaddVertex(x, y, x * 65536LL, y * 65536LL, 0);
+		if (i % 4000 == 3999) nextGteFrame();
+	}
+	add = (now() - t) / n;
+	t = now();
+	for (i = 0; i < n; i++) {
+		x = (short)(i * 7 % 640); y = (short)(i * 13 % 480);
+		denseAdd(x, y, x * 65536LL, y * 65536LL, 0);
+	}
+	dadd = (now() - t) / n;
+
+	t = now();
+	for (i = 0; i < n; i++)
+		sink += getGteVertex((short)(rnd(&seed) % 640), (short)(rnd(&seed) % 480), &fx, &fy);
+	get = (now() - t) / n;
+	t = now();
+	for (i = 0; i < n; i++)
+		sink += denseGet((short)(rnd(&seed) % 640), (short)(rnd(&seed) % 480), &fx, &fy);
+	dget = (now() - t) / n;
+
+	printf("reset: %9.1f us hash, %9.1f us array\n", reset * 1e6, denseReset_ * 1e6);
+	printf("store: %9.1f ns hash, %9.1f ns array\n", add * 1e9, dadd * 1e9);
+	printf("look:  %9.1f ns hash, %9.1f ns array%s\n", get * 1e9, dget * 1e9, sink == 1 ? " " : "");
+}
+
+int main(int argc, char *argv[]) {
+	static const Stream streams[] = {
+		{ "mesh",   1500,    0, 1 },
+		{ "churn",  1500, 1500, 1 },
+		{ "busy",   2500,  300, 1 },
+		{ "crowded", 6000, 600, 0 },
+	};
+	int frames = argc > 1 ? atoi(argv[1]) : 200, s, errors = 0;
+	Result r;
+
+	dense = (dense_t)malloc(0x8000000);
+	denseFrame = (int *)malloc(0x1000 * 0x1000 * sizeof(int));
+	if (dense == NULL || denseFrame == NULL)
+		return 1;
+	xegpu::peops_cfg.bGteAccuracy = true;
+
+	for (s = 0; s < (int)(sizeof(streams) / sizeof(streams[0])); s++) {
+		run(&streams[s], frames, &r);
+		printf("%-8s %5d verts: %8u lookups, %8u hits, %8u recent, %6u missed, %u wrong, %8u expired\n",
+			streams[s].name, streams[s].verts, r.lookups, r.hits, r.recent, r.missed, r.wrong, r.expired);
+
+		if (r.wrong || (streams[s].exact && r.missed)) {
+			printf("  the store does not answer as the array did\n");
+			errors++;
+		}
+		if (r.recent == 0 || r.expired == 0) {
+			printf("  the stream does not test anything\n");
+			errors++;
+		}
+	}
+
+	bench(4000000);
+
+	free(dense);
+	free(denseFrame);
+	return errors != 0;
+}
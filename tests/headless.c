@@ -0,0 +1,60 @@
+/*
+ * Runs a PS-X EXE or a cd image on the host with the interpreter, the soft
+ * gpu drawing into vram only, a silent spu and idle pads:
+ *
+ *   headless [-bios file] [-frames n] [-gputrace file]
+ *            [-record movie | -play movie] <exe or image>
+ *
+ * Without -bios the HLE bios is used. Prints the vram checksum at the end,
+ * the same one gpureplay prints for a trace taken with -gputrace. A movie
+ * starts from a save state next to it, taken once the program is loaded;
+ * played back, it drives the pads instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "psxcommon.h"
+#include "gpurec.h"
+#include "movie.h"
+#include "hostsys.h"
+
+static void usage(const char *name) {
+	fprintf(stderr, "usage: %s [-bios file] [-frames n] [-gputrace file] [-record movie | -play movie] <exe or image>\n", name);
+	exit(2);
+}
+
+int main(int argc, char *argv[]) {
+	const char *bios = NULL, *trace = NULL, *file = NULL, *record = NULL, *play = NULL;
+	u32 frames = 60, i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-bios") == 0 && i + 1 < argc) bios = argv[++i];
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc) frames = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-gputrace") == 0 && i + 1 < argc) trace = argv[++i];
+		else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc) record = argv[++i];
+		else if (strcmp(argv[i], "-play") == 0 && i + 1 < argc) play = argv[++i];
+		else if (argv[i][0] == '-') usage(argv[0]);
+		else file = argv[i];
+	}
+	if (file == NULL || (record != NULL && play != NULL)) usage(argv[0]);
+
+	if (HostStart(file, bios) != 0) {
+		fprintf(stderr, "could not start %s\n", file);
+		return 1;
+	}
+	if (record != NULL && Movie_Record(record, MOVIE_STATE) != 0) return 1;
+	if (play != NULL && Movie_Play(play) != 0) return 1;
+	if (trace != NULL && GPUrec_Start(trace) != 0) return 1;
+
+	for (i = 0; i < frames; i++)
+		HostFrame();
+
+	GPUrec_Stop();
+	Movie_Stop();
+	printf("%u frames, vram %08x\n", frames, HostVramChecksum());
+
+	HostStop();
+	return 0;
+}
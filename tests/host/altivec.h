@@ -0,0 +1,123 @@
+/*
+ * AltiVec on the host: what the vector loops under __ALTIVEC__ use, one
+ * element at a time, so that tests can run them against their scalar
+ * loops. Elements are numbered as on the ppc, from the lowest address. A
+ * vector keeps its bytes in reverse, so element i of any width is host
+ * element n - 1 - i, and a cast between vector types sees the bytes the
+ * way a big endian cpu does.
+ */
+
+#ifndef __HOST_ALTIVEC_H__
+#define __HOST_ALTIVEC_H__
+
+#include <stdint.h>
+
+#define vector	__attribute__((vector_size(16)))
+
+typedef vector signed short		__vss;
+typedef vector unsigned short	__vus;
+typedef vector signed int		__vsi;
+typedef vector unsigned int		__vui;
+
+#define __N(v)			(int)(sizeof(v) / sizeof((v)[0]))
+#define __E(v, i)		(v)[__N(v) - 1 - (i)]
+
+// lvx and stvx ignore the low 4 bits of the address
+#define __QUAD(off, p)	((void *)(((uintptr_t)(p) + (off)) & ~(uintptr_t)15))
+
+static inline __vss __vec_ld_s16(int off, const short *p) {
+	const short *q = __QUAD(off, p);
+	__vss v;
+	int i;
+
+	for (i = 0; i < 8; i++) __E(v, i) = q[i];
+	return v;
+}
+
+static inline void __vec_st_s16(__vss v, int off, short *p) {
+	short *q = __QUAD(off, p);
+	int i;
+
+	for (i = 0; i < 8; i++) q[i] = __E(v, i);
+}
+
+#define vec_ld(off, p)		__vec_ld_s16(off, p)
+#define vec_st(v, off, p)	__vec_st_s16(v, off, p)
+
+// a 5 bit signed immediate
+#define vec_splat_u32(x)	((__vui){ (x), (x), (x), (x) })
+
+#define vec_splat(v, n) ({ \
+	__typeof__(v) __v = (v), __r; \
+	int __i; \
+	for (__i = 0; __i < __N(__r); __i++) __E(__r, __i) = __E(__v, n); \
+	__r; \
+})
+
+// the even or odd halfwords, multiplied out to words
+static inline __vsi __vec_mul_s16(__vss a, __vss b, int odd) {
+	__vsi r;
+	int i;
+
+	for (i = 0; i < 4; i++) __E(r, i) = __E(a, 2 * i + odd) * __E(b, 2 * i + odd);
+	return r;
+}
+
+static inline __vui __vec_mul_u16(__vus a, __vus b, int odd) {
+	__vui r;
+	int i;
+
+	for (i = 0; i < 4; i++) __E(r, i) = (unsigned)__E(a, 2 * i + odd) * __E(b, 2 * i + odd);
+	return r;
+}
+
+#define vec_mule(a, b)	_Generic((a), __vss: __vec_mul_s16, __vus: __vec_mul_u16)(a, b, 0)
+#define vec_mulo(a, b)	_Generic((a), __vss: __vec_mul_s16, __vus: __vec_mul_u16)(a, b, 1)
+
+// modulo, as vadduwm
+static inline __vsi vec_add(__vsi a, __vsi b) {
+	return (__vsi)((__vui)a + (__vui)b);
+}
+
+static inline __vsi vec_sl(__vsi a, __vui s) {
+	__vsi r;
+	int i;
+
+	for (i = 0; i < 4; i++) __E(r, i) = (int)((unsigned)__E(a, i) << (__E(s, i) & 31));
+	return r;
+}
+
+static inline __vsi vec_sra(__vsi a, __vui s) {
+	__vsi r;
+	int i;
+
+	for (i = 0; i < 4; i++) __E(r, i) = __E(a, i) >> (__E(s, i) & 31);
+	return r;
+}
+
+static inline __vsi __vec_merge_s32(__vsi a, __vsi b, int half) {
+	__vsi r;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		__E(r, 2 * i) = __E(a, half + i);
+		__E(r, 2 * i + 1) = __E(b, half + i);
+	}
+	return r;
+}
+
+#define vec_mergeh(a, b)	__vec_merge_s32(a, b, 0)
+#define vec_mergel(a, b)	__vec_merge_s32(a, b, 2)
+
+static inline __vss vec_packs(__vsi a, __vsi b) {
+	__vss r;
+	int i, x;
+
+	for (i = 0; i < 8; i++) {
+		x = i < 4 ? __E(a, i) : __E(b, i - 4);
+		__E(r, i) = x < -32768 ? -32768 : x > 32767 ? 32767 : x;
+	}
+	return r;
+}
+
+#endif
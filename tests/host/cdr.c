@@ -0,0 +1,49 @@
+/*
+ * An empty drive, for programs that are loaded without a cd image.
+ */
+
+#include <string.h>
+
+#include "psxcommon.h"
+#include "plugins.h"
+
+static unsigned char buf[2352];
+
+long CALLBACK HOST_CDRinit(void) {
+	return 0;
+}
+
+long CALLBACK HOST_CDRshutdown(void) {
+	return 0;
+}
+
+long CALLBACK HOST_CDRopen(void) {
+	return 0;
+}
+
+long CALLBACK HOST_CDRclose(void) {
+	return 0;
+}
+
+long CALLBACK HOST_CDRgetTN(unsigned char *buffer) {
+	buffer[0] = 1;
+	buffer[1] = 1;
+	return 0;
+}
+
+long CALLBACK HOST_CDRgetTD(unsigned char track, unsigned char *buffer) {
+	memset(buffer, 0, 4);
+	return 0;
+}
+
+long CALLBACK HOST_CDRreadTrack(unsigned char *time) {
+	return -1;
+}
+
+unsigned char * CALLBACK HOST_CDRgetBuffer(void) {
+	return buf + 12;
+}
+
+unsigned char * CALLBACK HOST_CDRgetBufferSub(void) {
+	return NULL;
+}
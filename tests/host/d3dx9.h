@@ -0,0 +1,18 @@
+/*
+ * The types the hw gpu's Windows branch (peopsxgl/gpu_types.h) takes from
+ * Direct3D, with the few constants their headers use, enough for the parts of the plugin the host tests build.
+ */
+
+#ifndef __D3DX9_H__
+#define __D3DX9_H__
+
+typedef struct IDirect3DVertexBuffer9 IDirect3DVertexBuffer9;
+typedef struct IDirect3DIndexBuffer9 IDirect3DIndexBuffer9;
+typedef struct IDirect3DTexture9 IDirect3DTexture9;
+typedef struct IDirect3DPixelShader9 IDirect3DPixelShader9;
+typedef struct IDirect3DVertexShader9 IDirect3DVertexShader9;
+
+enum { D3DFMT_A8R8G8B8 = 21, D3DFMT_A1R5G5B5 = 25 };
+enum { D3DTADDRESS_CLAMP = 3 };
+
+#endif
@@ -0,0 +1,3 @@
+/*
+ * libxenon's debug helpers; nothing of them is used on the host.
+ */
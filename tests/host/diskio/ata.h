@@ -0,0 +1,3 @@
+/*
+ * libxenon's ATA driver; nothing of it is used on the host.
+ */
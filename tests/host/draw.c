@@ -0,0 +1,56 @@
+/*
+ * The soft gpu's display side (v_draw.c) on the host: the frames stay in
+ * vram, nothing is shown.
+ */
+
+#define _IN_DRAW
+
+#include <stdint.h>
+
+#include "externals.h"
+#include "gpu.h"
+#include "draw.h"
+
+int iResX;
+int iResY;
+long lLowerpart;
+BOOL bIsFirstFrame = TRUE;
+BOOL bCheckMask = FALSE;
+unsigned short sSetMask = 0;
+unsigned long lSetMask = 0;
+
+int iShowFPS = 0;
+int iWinSize;
+int iMaintainAspect = 0;
+int iUseNoStretchBlt = 0;
+int iFastFwd = 0;
+
+PSXPoint_t ptCursorPoint[8];
+unsigned short usCursorActive = 0;
+
+uint32_t dwGPUVersion = 0;
+int iGPUHeight = 512;
+int iGPUHeightMask = 511;
+int GlobalTextIL = 0;
+int iTileCheat = 0;
+
+// frames that would have reached the tv
+uint32_t hostSwaps = 0;
+
+void DoBufferSwap(void) {
+	hostSwaps++;
+}
+
+void DoClearScreenBuffer(void) {
+}
+
+void DoClearFrontBuffer(void) {
+}
+
+unsigned long ulInitDisplay(void) {
+    bIsFirstFrame = FALSE;
+    return 100;
+}
+
+void CloseDisplay(void) {
+}
@@ -0,0 +1,20 @@
+/*
+ * Forced into every file of the host build: what the Xenon toolchain
+ * provides without being asked for.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <sys/param.h>		// MAXPATHLEN
+#include <malloc.h>		// memalign, stdlib.h has it on libxenon
+#include <zlib.h>
+
+// cdriso.c has its own, the system zlib declares another one
+#define uncompress2 cdriso_uncompress2
+
+#include <strings.h>
+#define strnicmp strncasecmp
+#define stricmp strcasecmp
+
+#endif
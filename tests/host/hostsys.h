@@ -0,0 +1,30 @@
+/*
+ * What the host Sys* layer (host/sys.c) offers the tools.
+ */
+
+#ifndef __HOSTSYS_H__
+#define __HOSTSYS_H__
+
+#include "psxcommon.h"
+
+// psx vsyncs seen, the cpu stops at each of them, run ahead ones included
+extern u32 hostFrames;
+
+// frames the gpu presented, fast forward skips most of them
+extern u32 hostSwaps;
+
+// buttons held on the pads, active low as the pad sends them
+extern unsigned short hostPadButtons[2];
+
+// loads and opens the plugins and resets the psx: the program is a PS-X EXE
+// or a cd image, NULL for none
+int HostStart(const char *file, const char *bios);
+void HostStop(void);
+
+// emulates up to the next vsync, then the run ahead if Config.RunAhead
+// asks for one
+void HostFrame(void);
+
+u32 HostVramChecksum(void);
+
+#endif
@@ -0,0 +1,10 @@
+/*
+ * libxenon's controller state, only named by the gui headers.
+ */
+
+#ifndef __INPUT_INPUT_H__
+#define __INPUT_INPUT_H__
+
+struct controller_data_s;
+
+#endif
@@ -0,0 +1,10 @@
+/*
+ * libfat's mount call; the host's file system is already there.
+ */
+
+#ifndef __LIBFAT_FAT_H__
+#define __LIBFAT_FAT_H__
+
+bool fatInitDefault(void);
+
+#endif
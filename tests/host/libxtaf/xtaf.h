@@ -0,0 +1,10 @@
+/*
+ * The Xbox hard disk's mount call; the host's file system is already there.
+ */
+
+#ifndef __LIBXTAF_XTAF_H__
+#define __LIBXTAF_XTAF_H__
+
+int XTAFMount(void);
+
+#endif
@@ -0,0 +1,3 @@
+/*
+ * lwip's debug macros: the host shim (lwip/tcp.h) has none.
+ */
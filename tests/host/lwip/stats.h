@@ -0,0 +1,3 @@
+/*
+ * lwip's statistics: the host shim (lwip/tcp.h) keeps none.
+ */
@@ -0,0 +1,349 @@
+/*
+ * lwip's raw tcp api on POSIX sockets, see tcp.h. Writes are queued as lwip
+ * queues them, copied or only referenced, and go to the socket when it
+ * takes them; a copy == 0 write has to stay valid until then, as lwip
+ * needs it until the ack.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "lwip/tcp.h"
+
+#define MAXPCBS		64
+#define SOCKBUF		(64 * 1024)		// small enough that a client that stops reading stalls us
+
+typedef struct seg {
+	struct seg *next;
+	const char *data;
+	char *copy;
+	int len, off;
+} seg_t;
+
+struct tcp_pcb {
+	int fd, listening, closing, dead;
+	void *arg;
+	tcp_accept_fn accept;
+	tcp_recv_fn recv;
+	tcp_sent_fn sent;
+	tcp_poll_fn poll;
+	tcp_err_fn err;
+	u8_t interval;
+	double nextPoll;
+	seg_t *head, *tail;
+	int queued;
+};
+
+int lwipShimPort;
+int lwipShimPollMs = 500;
+int lwipShimLive, lwipShimConns;
+int lwipShimAborts, lwipShimResets;
+
+static struct tcp_pcb *pcbs[MAXPCBS];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void *mem_malloc(size_t size) {
+	void *p = malloc(size);
+
+	if (p) lwipShimLive++;
+	return p;
+}
+
+void mem_free(void *p) {
+	if (p) lwipShimLive--;
+	free(p);
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+	free(p);
+	return 1;
+}
+
+static struct tcp_pcb *newPcb(int fd) {
+	struct tcp_pcb *pcb;
+	int i;
+
+	for (i = 0; i < MAXPCBS && pcbs[i]; i++);
+	if (i == MAXPCBS || (pcb = calloc(1, sizeof(*pcb))) == NULL)
+		return NULL;
+	pcb->fd = fd;
+	pcbs[i] = pcb;
+	return pcb;
+}
+
+// the socket goes now, the pcb at the end of the step that may still use it
+static void endPcb(struct tcp_pcb *pcb, int reset) {
+	seg_t *s;
+
+	if (reset) {
+		struct linger l = { 1, 0 };
+		setsockopt(pcb->fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+	}
+	if (pcb->fd >= 0) {
+		close(pcb->fd);
+		if (!pcb->listening) lwipShimConns--;
+	}
+	pcb->fd = -1;
+	pcb->dead = 1;
+
+	while ((s = pcb->head) != NULL) {
+		pcb->head = s->next;
+		free(s->copy);
+		free(s);
+	}
+	pcb->tail = NULL;
+	pcb->queued = 0;
+}
+
+struct tcp_pcb *tcp_new(void) {
+	int fd = socket(AF_INET, SOCK_STREAM, 0), one = 1;
+	struct tcp_pcb *pcb;
+
+	if (fd < 0) return NULL;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if ((pcb = newPcb(fd)) == NULL) close(fd);
+	return pcb;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, struct ip_addr *ipaddr, u16_t port) {
+	struct sockaddr_in a;
+	socklen_t len = sizeof(a);
+
+	memset(&a, 0, sizeof(a));
+	a.sin_family = AF_INET;
+	a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	a.sin_port = 0;
+	if (bind(pcb->fd, (struct sockaddr *)&a, sizeof(a)) != 0 ||
+		getsockname(pcb->fd, (struct sockaddr *)&a, &len) != 0)
+		return ERR_MEM;
+	lwipShimPort = ntohs(a.sin_port);
+	return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb) {
+	if (listen(pcb->fd, 16) != 0)
+		return NULL;
+	fcntl(pcb->fd, F_SETFL, O_NONBLOCK);
+	pcb->listening = 1;
+	return pcb;
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept) { pcb->accept = accept; }
+void tcp_arg(struct tcp_pcb *pcb, void *arg) { pcb->arg = arg; }
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv) { pcb->recv = recv; }
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent) { pcb->sent = sent; }
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err) { pcb->err = err; }
+void tcp_setprio(struct tcp_pcb *pcb, u8_t prio) { }
+void tcp_recved(struct tcp_pcb *pcb, u16_t len) { }
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) {
+	pcb->poll = poll;
+	pcb->interval = interval;
+	pcb->nextPoll = now() + interval * lwipShimPollMs / 1e3;
+}
+
+u16_t tcp_sndbuf(struct tcp_pcb *pcb) {
+	return TCP_SND_BUF - pcb->queued;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *data, u16_t len, u8_t copy) {
+	seg_t *s;
+
+	if (pcb->dead || pcb->closing) return ERR_CLSD;
+	if (len > tcp_sndbuf(pcb)) return ERR_MEM;
+	if (len == 0) return ERR_OK;
+
+	if ((s = calloc(1, sizeof(*s))) == NULL) return ERR_MEM;
+	if (copy) {
+		if ((s->copy = malloc(len)) == NULL) { free(s); return ERR_MEM; }
+		memcpy(s->copy, data, len);
+		data = s->copy;
+	}
+	s->data = data;
+	s->len = len;
+
+	if (pcb->tail) pcb->tail->next = s; else pcb->head = s;
+	pcb->tail = s;
+	pcb->queued += len;
+	return ERR_OK;
+}
+
+// what is queued stays queued and goes out before the fin
+err_t tcp_close(struct tcp_pcb *pcb) {
+	pcb->closing = 1;
+	pcb->recv = NULL;
+	pcb->sent = NULL;
+	pcb->poll = NULL;
+	pcb->err = NULL;
+	if (pcb->head == NULL)
+		endPcb(pcb, 0);
+	return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb) {
+	tcp_err_fn err = pcb->err;
+
+	lwipShimAborts++;
+	endPcb(pcb, 1);
+	if (err)
+		err(pcb->arg, ERR_ABRT);
+}
+
+// the socket broke under us: lwip frees the pcb and tells the err callback
+static void resetPcb(struct tcp_pcb *pcb) {
+	tcp_err_fn err = pcb->closing ? NULL : pcb->err;
+
+	lwipShimResets++;
+	endPcb(pcb, 1);
+	if (err)
+		err(pcb->arg, ERR_RST);
+}
+
+static void doAccept(struct tcp_pcb *listener) {
+	int fd, one = 1, size = SOCKBUF;
+	struct tcp_pcb *pcb;
+
+	while ((fd = accept(listener->fd, NULL, NULL)) >= 0) {
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+		if ((pcb = newPcb(fd)) == NULL) {
+			close(fd);
+			continue;
+		}
+		lwipShimConns++;
+		if (listener->accept == NULL || listener->accept(listener->arg, pcb, ERR_OK) != ERR_OK)
+			endPcb(pcb, 1);
+	}
+}
+
+static void doSend(struct tcp_pcb *pcb) {
+	int acked = 0, n;
+	seg_t *s;
+
+	while ((s = pcb->head) != NULL) {
+		n = send(pcb->fd, s->data + s->off, s->len - s->off, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			resetPcb(pcb);
+			return;
+		}
+		s->off += n;
+		acked += n;
+		if (s->off < s->len) break;
+
+		pcb->head = s->next;
+		if (pcb->head == NULL) pcb->tail = NULL;
+		free(s->copy);
+		free(s);
+	}
+	pcb->queued -= acked;
+
+	if (pcb->closing) {
+		if (pcb->head == NULL) endPcb(pcb, 0);
+		return;
+	}
+	while (acked > 0 && pcb->sent && !pcb->dead) {
+		n = acked > 0xffff ? 0xffff : acked;
+		acked -= n;
+		pcb->sent(pcb->arg, pcb, n);
+	}
+}
+
+static void doRecv(struct tcp_pcb *pcb) {
+	struct pbuf *p;
+	int n;
+
+	if ((p = malloc(sizeof(*p) + 4096)) == NULL) return;
+	p->next = NULL;
+	p->payload = p + 1;
+
+	n = recv(pcb->fd, p->payload, 4096, MSG_DONTWAIT);
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		free(p);
+		return;
+	}
+	if (n < 0) {
+		free(p);
+		resetPcb(pcb);
+		return;
+	}
+	if (n == 0) {
+		free(p);
+		if (pcb->recv) pcb->recv(pcb->arg, pcb, NULL, ERR_OK);
+		else if (pcb->closing) endPcb(pcb, 0);
+		return;
+	}
+
+	p->len = p->tot_len = n;
+	if (pcb->recv) pcb->recv(pcb->arg, pcb, p, ERR_OK);
+	else pbuf_free(p);
+}
+
+void lwipShimStep(int ms) {
+	struct pollfd fds[MAXPCBS];
+	struct tcp_pcb *on[MAXPCBS];
+	double t;
+	int i, n = 0;
+
+	for (i = 0; i < MAXPCBS; i++) {
+		struct tcp_pcb *pcb = pcbs[i];
+
+		if (pcb == NULL || pcb->dead) continue;
+		fds[n].fd = pcb->fd;
+		fds[n].events = pcb->closing ? 0 : POLLIN;
+		if (pcb->head) fds[n].events |= POLLOUT;
+		fds[n].revents = 0;
+		on[n++] = pcb;
+	}
+	poll(fds, n, ms);
+
+	for (i = 0; i < n; i++) {
+		struct tcp_pcb *pcb = on[i];
+
+		if (pcb->dead) continue;
+		if (pcb->listening) {
+			if (fds[i].revents & POLLIN) doAccept(pcb);
+			continue;
+		}
+		if ((fds[i].revents & POLLOUT) && !pcb->dead) doSend(pcb);
+		if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && !pcb->dead) doRecv(pcb);
+	}
+
+	// lwip's coarse timer
+	t = now();
+	for (i = 0; i < MAXPCBS; i++) {
+		struct tcp_pcb *pcb = pcbs[i];
+
+		if (pcb == NULL || pcb->dead || pcb->poll == NULL || t < pcb->nextPoll) continue;
+		pcb->nextPoll = t + pcb->interval * lwipShimPollMs / 1e3;
+		pcb->poll(pcb->arg, pcb);
+	}
+
+	// what got queued in the callbacks goes out now rather than next step
+	for (i = 0; i < MAXPCBS; i++)
+		if (pcbs[i] && !pcbs[i]->dead && !pcbs[i]->listening && pcbs[i]->head)
+			doSend(pcbs[i]);
+
+	for (i = 0; i < MAXPCBS; i++) {
+		if (pcbs[i] && pcbs[i]->dead) {
+			free(pcbs[i]);
+			pcbs[i] = NULL;
+		}
+	}
+}
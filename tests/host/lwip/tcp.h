@@ -0,0 +1,85 @@
+/*
+ * lwip's raw tcp api on POSIX sockets (lwip/tcp.c), what source/httpd
+ * uses of it: a listening pcb on 127.0.0.1 and its connections, with every
+ * callback run from lwipShimStep() on the thread that calls it. The
+ * kernel taking bytes counts as their ack.
+ */
+
+#ifndef __LWIP_TCP_H__
+#define __LWIP_TCP_H__
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int8_t err_t;
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+
+#define ERR_OK		0
+#define ERR_MEM		-1
+#define ERR_ABRT	-4
+#define ERR_RST		-5
+#define ERR_CLSD	-6
+
+#define TCP_PRIO_MIN	1
+#define TCP_SND_BUF		(32 * 1024)
+
+struct ip_addr {
+	u32_t addr;
+};
+
+#define IP_ADDR_ANY		((struct ip_addr *)0)
+
+struct pbuf {
+	struct pbuf *next;
+	void *payload;
+	u16_t tot_len, len;
+};
+
+u8_t pbuf_free(struct pbuf *p);
+
+struct tcp_pcb;
+
+typedef err_t (*tcp_accept_fn)(void *arg, struct tcp_pcb *newpcb, err_t err);
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err);
+typedef err_t (*tcp_sent_fn)(void *arg, struct tcp_pcb *pcb, u16_t len);
+typedef err_t (*tcp_poll_fn)(void *arg, struct tcp_pcb *pcb);
+typedef void (*tcp_err_fn)(void *arg, err_t err);
+
+struct tcp_pcb *tcp_new(void);
+err_t tcp_bind(struct tcp_pcb *pcb, struct ip_addr *ipaddr, u16_t port);
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb);
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept);
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval);
+void tcp_setprio(struct tcp_pcb *pcb, u8_t prio);
+void tcp_recved(struct tcp_pcb *pcb, u16_t len);
+err_t tcp_write(struct tcp_pcb *pcb, const void *data, u16_t len, u8_t copy);
+u16_t tcp_sndbuf(struct tcp_pcb *pcb);
+err_t tcp_close(struct tcp_pcb *pcb);
+void tcp_abort(struct tcp_pcb *pcb);
+
+#define tcp_accepted(pcb)	((void)(pcb))
+
+void *mem_malloc(size_t size);
+void mem_free(void *p);
+
+// the port the listening pcb got, the one tcp_bind asks for is not used
+extern int lwipShimPort;
+// ms to a tcp_poll interval unit, lwip's coarse timer is 500
+extern int lwipShimPollMs;
+// mem_malloc blocks not freed, and connections not closed or aborted
+extern int lwipShimLive, lwipShimConns;
+// connections that ended in tcp_abort, or in the err callback for a reset
+extern int lwipShimAborts, lwipShimResets;
+
+// waits up to ms for the sockets, then runs what they and the timers call for
+void lwipShimStep(int ms);
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * libxenon's network glue: on the host lwip/tcp.h's shim stands in for
+ * the stack, and tftp boots are the test's.
+ */
+
+#ifndef __NETWORK_H__
+#define __NETWORK_H__
+
+int boot_tftp_url(const char *url);
+
+#endif
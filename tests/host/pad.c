@@ -0,0 +1,43 @@
+/*
+ * Pads driven by the host tools: a standard pad on each port holding
+ * whatever hostPadButtons says.
+ */
+
+#include <string.h>
+
+#include "psxcommon.h"
+#include "plugins.h"
+#include "hostsys.h"
+
+unsigned short hostPadButtons[2] = { 0xffff, 0xffff };
+
+long CALLBACK HOST_PADinit(long flags) {
+	return 0;
+}
+
+long CALLBACK HOST_PADshutdown(void) {
+	return 0;
+}
+
+long CALLBACK HOST_PADopen(unsigned long *Disp) {
+	return 0;
+}
+
+long CALLBACK HOST_PADclose(void) {
+	return 0;
+}
+
+static long readPort(int port, PadDataS *pad) {
+	memset(pad, 0, sizeof(PadDataS));
+	pad->controllerType = PSE_PAD_TYPE_STANDARD;
+	pad->buttonStatus = hostPadButtons[port];
+	return 0;
+}
+
+long CALLBACK HOST_PADreadPort1(PadDataS *pad) {
+	return readPort(0, pad);
+}
+
+long CALLBACK HOST_PADreadPort2(PadDataS *pad) {
+	return readPort(1, pad);
+}
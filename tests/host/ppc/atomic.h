@@ -0,0 +1,17 @@
+/*
+ * libxenon's spinlocks on the host.
+ */
+
+#ifndef __PPC_ATOMIC_H__
+#define __PPC_ATOMIC_H__
+
+static inline void lock(unsigned int *l) {
+	while (__sync_lock_test_and_set(l, 1))
+		;
+}
+
+static inline void unlock(unsigned int *l) {
+	__sync_lock_release(l);
+}
+
+#endif
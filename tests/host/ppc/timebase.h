@@ -0,0 +1,20 @@
+/*
+ * libxenon's timebase on the host: mftb() counts at PPC_TIMEBASE_FREQ.
+ */
+
+#ifndef __PPC_TIMEBASE_H__
+#define __PPC_TIMEBASE_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#define PPC_TIMEBASE_FREQ	50000000ULL
+
+static inline uint64_t mftb(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * PPC_TIMEBASE_FREQ + ts.tv_nsec / (1000000000 / PPC_TIMEBASE_FREQ);
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * A silent spu: keeps the registers and the sound ram, so that games see
+ * what they wrote and save states carry it, and mixes nothing.
+ */
+
+#include <string.h>
+
+#include "psxcommon.h"
+#include "plugins.h"
+
+static unsigned short regs[0x200 / 2];
+static unsigned short ram[0x80000 / 2];
+static unsigned long addr;
+
+long CALLBACK HOST_SPUinit(void) {
+	return 0;
+}
+
+long CALLBACK HOST_SPUshutdown(void) {
+	return 0;
+}
+
+long CALLBACK HOST_SPUopen(void) {
+	memset(regs, 0, sizeof(regs));
+	memset(ram, 0, sizeof(ram));
+	addr = 0;
+	return 0;
+}
+
+long CALLBACK HOST_SPUclose(void) {
+	return 0;
+}
+
+void CALLBACK HOST_SPUwriteRegister(unsigned long reg, unsigned short val) {
+	reg &= 0x3fe;
+	regs[reg >> 1] = val;
+
+	switch (reg) {
+		case 0x1a6: // transfer address
+			addr = (unsigned long)val << 3;
+			break;
+		case 0x1a8: // transfer fifo
+			ram[(addr & 0x7fffe) >> 1] = val;
+			addr += 2;
+			break;
+	}
+}
+
+unsigned short CALLBACK HOST_SPUreadRegister(unsigned long reg) {
+	reg &= 0x3fe;
+
+	// SPUSTAT mirrors the mode bits of SPUCNT, never busy
+	if (reg == 0x1ae)
+		return regs[0x1aa >> 1] & 0x3f;
+
+	return regs[reg >> 1];
+}
+
+void CALLBACK HOST_SPUwriteDMA(unsigned short val) {
+	ram[(addr & 0x7fffe) >> 1] = val;
+	addr += 2;
+}
+
+unsigned short CALLBACK HOST_SPUreadDMA(void) {
+	unsigned short val = ram[(addr & 0x7fffe) >> 1];
+
+	addr += 2;
+	return val;
+}
+
+void CALLBACK HOST_SPUwriteDMAMem(unsigned short *pusPSXMem, int iSize) {
+	while (iSize-- > 0)
+		HOST_SPUwriteDMA(*pusPSXMem++);
+}
+
+void CALLBACK HOST_SPUreadDMAMem(unsigned short *pusPSXMem, int iSize) {
+	while (iSize-- > 0)
+		*pusPSXMem++ = HOST_SPUreadDMA();
+}
+
+void CALLBACK HOST_SPUplayADPCMchannel(xa_decode_t *xap) {
+}
+
+void CALLBACK HOST_SPUregisterCallback(void (CALLBACK *callback)(void)) {
+}
+
+long CALLBACK HOST_SPUfreeze(uint32_t ulFreezeMode, SPUFreeze_t *pF) {
+	if (ulFreezeMode == 2) {
+		pF->Size = sizeof(SPUFreeze_t);
+		return 1;
+	}
+
+	if (ulFreezeMode == 1) {
+		memset(pF, 0, sizeof(SPUFreeze_t));
+		strcpy((char *)pF->PluginName, "HOSTSPU");
+		pF->Size = sizeof(SPUFreeze_t);
+		memcpy(pF->SPUPorts, regs, sizeof(regs));
+		memcpy(pF->SPURam, ram, sizeof(ram));
+		pF->SPUInfo = (unsigned char *)addr;
+		return 1;
+	}
+
+	memcpy(regs, pF->SPUPorts, sizeof(regs));
+	memcpy(ram, pF->SPURam, sizeof(ram));
+	addr = (unsigned long)pF->SPUInfo;
+	return 1;
+}
@@ -0,0 +1,312 @@
+/*
+ * The Sys* layer and the plugin table of the host tools, after
+ * source/main/sys.c: the soft gpu, a silent spu, scripted pads and, without
+ * a cd image, an empty drive.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "psxcommon.h"
+#include "r3000a.h"
+#include "misc.h"
+#include "plugins.h"
+#include "debug.h"
+#include "hard_plugins.h"
+#include "runahead.h"
+#include "hostsys.h"
+
+long CALLBACK HOST_SPUinit(void);
+long CALLBACK HOST_SPUshutdown(void);
+long CALLBACK HOST_SPUopen(void);
+long CALLBACK HOST_SPUclose(void);
+void CALLBACK HOST_SPUwriteRegister(unsigned long reg, unsigned short val);
+unsigned short CALLBACK HOST_SPUreadRegister(unsigned long reg);
+void CALLBACK HOST_SPUwriteDMA(unsigned short val);
+unsigned short CALLBACK HOST_SPUreadDMA(void);
+void CALLBACK HOST_SPUwriteDMAMem(unsigned short *pusPSXMem, int iSize);
+void CALLBACK HOST_SPUreadDMAMem(unsigned short *pusPSXMem, int iSize);
+void CALLBACK HOST_SPUplayADPCMchannel(xa_decode_t *xap);
+void CALLBACK HOST_SPUregisterCallback(void (CALLBACK *callback)(void));
+long CALLBACK HOST_SPUfreeze(uint32_t ulFreezeMode, SPUFreeze_t *pF);
+
+long CALLBACK HOST_PADinit(long flags);
+long CALLBACK HOST_PADshutdown(void);
+long CALLBACK HOST_PADopen(unsigned long *Disp);
+long CALLBACK HOST_PADclose(void);
+long CALLBACK HOST_PADreadPort1(PadDataS *pad);
+long CALLBACK HOST_PADreadPort2(PadDataS *pad);
+
+long CALLBACK HOST_CDRinit(void);
+long CALLBACK HOST_CDRshutdown(void);
+long CALLBACK HOST_CDRopen(void);
+long CALLBACK HOST_CDRclose(void);
+long CALLBACK HOST_CDRgetTN(unsigned char *buffer);
+long CALLBACK HOST_CDRgetTD(unsigned char track, unsigned char *buffer);
+long CALLBACK HOST_CDRreadTrack(unsigned char *time);
+unsigned char * CALLBACK HOST_CDRgetBuffer(void);
+unsigned char * CALLBACK HOST_CDRgetBufferSub(void);
+
+#define SPU_HOST_PLUGIN \
+{ "/SPU",      \
+13,         \
+{ { "SPUinit",  \
+HOST_SPUinit }, \
+{ "SPUshutdown",	\
+HOST_SPUshutdown}, \
+{ "SPUopen", \
+HOST_SPUopen}, \
+{ "SPUclose", \
+HOST_SPUclose}, \
+{ "SPUwriteRegister", \
+HOST_SPUwriteRegister}, \
+{ "SPUreadRegister", \
+HOST_SPUreadRegister}, \
+{ "SPUwriteDMA", \
+HOST_SPUwriteDMA}, \
+{ "SPUreadDMA", \
+HOST_SPUreadDMA}, \
+{ "SPUwriteDMAMem", \
+HOST_SPUwriteDMAMem}, \
+{ "SPUreadDMAMem", \
+HOST_SPUreadDMAMem}, \
+{ "SPUplayADPCMchannel", \
+HOST_SPUplayADPCMchannel}, \
+{ "SPUfreeze", \
+HOST_SPUfreeze}, \
+{ "SPUregisterCallback", \
+HOST_SPUregisterCallback} \
+} }
+
+#define PAD1_HOST_PLUGIN \
+{ "/PAD1",      \
+5,         \
+{ { "PADinit",  \
+HOST_PADinit }, \
+{ "PADshutdown",	\
+HOST_PADshutdown}, \
+{ "PADopen", \
+HOST_PADopen}, \
+{ "PADclose", \
+HOST_PADclose}, \
+{ "PADreadPort1", \
+HOST_PADreadPort1} \
+} \
+}
+
+#define PAD2_HOST_PLUGIN \
+{ "/PAD2",      \
+5,         \
+{ { "PADinit",  \
+HOST_PADinit }, \
+{ "PADshutdown",	\
+HOST_PADshutdown}, \
+{ "PADopen", \
+HOST_PADopen}, \
+{ "PADclose", \
+HOST_PADclose}, \
+{ "PADreadPort2", \
+HOST_PADreadPort2} \
+} \
+}
+
+#define CDR_HOST_PLUGIN \
+{ "/CDR",      \
+9,         \
+{ { "CDRinit",  \
+HOST_CDRinit }, \
+{ "CDRshutdown",	\
+HOST_CDRshutdown}, \
+{ "CDRopen", \
+HOST_CDRopen}, \
+{ "CDRclose", \
+HOST_CDRclose}, \
+{ "CDRgetTN", \
+HOST_CDRgetTN}, \
+{ "CDRgetTD", \
+HOST_CDRgetTD}, \
+{ "CDRreadTrack", \
+HOST_CDRreadTrack}, \
+{ "CDRgetBuffer", \
+HOST_CDRgetBuffer}, \
+{ "CDRgetBufferSub", \
+HOST_CDRgetBufferSub} \
+} }
+
+#define NUM_PLUGINS 5
+
+PluginTable plugins[NUM_PLUGINS] = {
+	SPU_HOST_PLUGIN,
+	GPU_PEOPS_PLUGIN,
+	CDR_HOST_PLUGIN,
+	PAD1_HOST_PLUGIN,
+	PAD2_HOST_PLUGIN,
+};
+
+u32 hostFrames = 0;
+
+int SysInit() {
+	if (EmuInit() == -1) return -1;
+
+	LoadMcds(Config.Mcd1, Config.Mcd2);
+
+	return 0;
+}
+
+void SysReset() {
+	EmuReset();
+}
+
+void SysClose() {
+	EmuShutdown();
+}
+
+void SysPrintf(const char *fmt, ...) {
+	va_list list;
+
+	va_start(list, fmt);
+	vprintf(fmt, list);
+	va_end(list);
+}
+
+void SysMessage(const char *fmt, ...) {
+	va_list list;
+
+	va_start(list, fmt);
+	vfprintf(stderr, fmt, list);
+	va_end(list);
+	fputc('\n', stderr);
+}
+
+void *SysLoadLibrary(const char *lib) {
+	int i;
+
+	for (i = 0; i < NUM_PLUGINS; i++)
+		if (strcmp(lib, plugins[i].lib) == 0)
+			return (void*)&plugins[i];
+	return NULL;
+}
+
+void *SysLoadSym(void *lib, const char *sym) {
+	PluginTable* plugin = (PluginTable*) lib;
+	int i;
+
+	for (i = 0; i < plugin->numSyms; i++)
+		if (plugin->syms[i].sym && !strcmp(sym, plugin->syms[i].sym))
+			return plugin->syms[i].pntr;
+	return NULL;
+}
+
+const char *SysLibError() {
+	return NULL;
+}
+
+void SysCloseLibrary(void *lib) {
+}
+
+void SysUpdate() {
+	hostFrames++;
+	cpuRunning = 0;
+}
+
+void SysRunGui() {
+	cpuRunning = 0;
+}
+
+void DebugVSync() {
+}
+
+void ProcessDebug() {
+}
+
+void DebugCheckBP(u32 address, enum breakpoint_types type) {
+}
+
+void systemPoll() {
+}
+
+static boolean IsExe(const char *file) {
+	char id[8];
+	FILE *f;
+	boolean exe;
+
+	f = fopen(file, "rb");
+	if (f == NULL) return FALSE;
+	exe = fread(id, 1, 8, f) == 8 && memcmp(id, "PS-X EXE", 8) == 0;
+	fclose(f);
+
+	return exe;
+}
+
+int HostStart(const char *file, const char *bios) {
+	const char *slash;
+	boolean exe = file == NULL || IsExe(file);
+
+	memset(&Config, 0, sizeof(PcsxConfig));
+	strcpy(Config.Net, "Disabled");
+	strcpy(Config.Cdr, "CDR");
+	strcpy(Config.Gpu, "GPUSW");
+	strcpy(Config.Spu, "SPU");
+	strcpy(Config.Pad1, "PAD1");
+	strcpy(Config.Pad2, "PAD2");
+	strcpy(Config.Mcd1, "/dev/null");
+	strcpy(Config.Mcd2, "/dev/null");
+	Config.Cpu = CPU_INTERPRETER;
+	Config.PsxAuto = 1;
+
+	if (bios == NULL) {
+		strcpy(Config.Bios, "HLE");
+	} else if ((slash = strrchr(bios, '/')) != NULL) {
+		snprintf(Config.BiosDir, sizeof(Config.BiosDir), "%.*s", (int)(slash - bios), bios);
+		strcpy(Config.Bios, slash + 1);
+	} else {
+		strcpy(Config.BiosDir, ".");
+		strcpy(Config.Bios, bios);
+	}
+
+	SetIsoFile(exe ? NULL : file);
+
+	if (LoadPlugins() != 0 || OpenPlugins() != 0 || SysInit() != 0)
+		return -1;
+	SysReset();
+
+	if (file == NULL)
+		return 0;
+
+	if (exe)
+		return Load(file);
+
+	if (CheckCdrom() != 0) {
+		SysMessage("%s is not a psx cd image", file);
+		return -1;
+	}
+	return LoadCdrom();
+}
+
+void HostStop(void) {
+	ClosePlugins();
+	SysClose();
+	ReleasePlugins();
+}
+
+void HostFrame(void) {
+	cpuRunning = 1;
+	psxCpu->Execute();
+	RunAheadFrame();
+}
+
+u32 HostVramChecksum(void) {
+	GPUFreeze_t *gpufP;
+	u32 crc;
+
+	gpufP = (GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	if (gpufP == NULL) return 0;
+
+	gpufP->ulFreezeVersion = 1;
+	GPU_freeze(1, gpufP);
+	crc = crc32(0, gpufP->psxVRam, sizeof(gpufP->psxVRam));
+	free(gpufP);
+
+	return crc;
+}
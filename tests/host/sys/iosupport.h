@@ -0,0 +1,18 @@
+/*
+ * The devoptab table of libxenon's newlib, for the gui's device list.
+ */
+
+#ifndef __SYS_IOSUPPORT_H__
+#define __SYS_IOSUPPORT_H__
+
+#define STD_MAX		16
+
+typedef struct {
+	const char *name;
+	int structSize;
+	void *write_r;
+} devoptab_t;
+
+extern const devoptab_t *devoptab_list[STD_MAX];
+
+#endif
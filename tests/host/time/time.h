@@ -0,0 +1,13 @@
+/*
+ * libxenon's delays on the host.
+ */
+
+#ifndef __TIME_TIME_H__
+#define __TIME_TIME_H__
+
+#include <unistd.h>
+
+#define udelay(u)	usleep(u)
+#define mdelay(m)	usleep((m) * 1000)
+
+#endif
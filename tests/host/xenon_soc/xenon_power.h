@@ -0,0 +1,19 @@
+/*
+ * libxenon's hardware threads on the host: a task gets a pthread of its
+ * own, the thread number and the stack are not needed.
+ */
+
+#ifndef __XENON_POWER_H__
+#define __XENON_POWER_H__
+
+#include <pthread.h>
+
+static inline int xenon_run_thread_task(int thread, void *stack, void *task) {
+	pthread_t t;
+
+	if (pthread_create(&t, NULL, (void *(*)(void *))task, NULL) != 0)
+		return -1;
+	return pthread_detach(t);
+}
+
+#endif
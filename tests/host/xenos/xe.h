@@ -0,0 +1,29 @@
+/*
+ * What the gui's font code takes from libxenon's xe.h: 8 bit textures in
+ * plain memory, rows of wpitch bytes, hpitch of them. The test that builds
+ * it provides Xe_CreateTexture and the rest.
+ */
+
+#ifndef __XENOS_XE_H__
+#define __XENOS_XE_H__
+
+#include <xetypes.h>
+
+enum { XE_FMT_8 = 2 };
+enum { XE_TEXADDR_WRAP = 0, XE_TEXADDR_CLAMP = 2 };
+enum { XE_LOCK_READ = 1, XE_LOCK_WRITE = 2 };
+
+struct XenosDevice;
+
+typedef struct XenosSurface {
+	int width, height, wpitch, hpitch;
+	int format, use_filtering, u_addressing, v_addressing;
+	void *base;
+} XenosSurface;
+
+struct XenosSurface *Xe_CreateTexture(struct XenosDevice *xe, unsigned int width, unsigned int height, unsigned int levels, int format, int tiled);
+void Xe_DestroyTexture(struct XenosDevice *xe, struct XenosSurface *surface);
+void *Xe_Surface_LockRect(struct XenosDevice *xe, struct XenosSurface *surface, int x, int y, int w, int h, int flags);
+void Xe_Surface_Unlock(struct XenosDevice *xe, struct XenosSurface *surface);
+
+#endif
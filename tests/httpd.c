@@ -0,0 +1,335 @@
+/*
+ * The http server (source/httpd/httpd.c) over loopback, on the host's lwip
+ * shim (host/lwip): the memory dumps stream as spans and have to arrive
+ * whole, as the psx memory was when the request came in, and the
+ * connection has to close after them. The static pages, 400 and 404, and
+ * a screenshot the handler waits on its encoder for. Then connections that
+ * go away: a client that resets halfway through a dump, one that stops
+ * reading until the server gives up on it, one that hangs up while its
+ * screenshot encodes. Every one of them has to run its handler's finish,
+ * so that nothing stays allocated and no capture stays owned. Then MB/s
+ * for dumps and requests a second for a page.
+ *
+ *   httpd [dumps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// its connection log stays quiet
+#define printf(...)	((void)0)
+#include "../source/httpd/httpd.c"
+#include "../source/httpd/vfs.c"
+#undef printf
+
+#define RAM			0x200000
+#define SHOT		300000		// bytes of the screenshot the encoder stub hands out
+
+signed char *psxM, *psxR, *psxH;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rnd(uint32_t *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+int boot_tftp_url(const char *url) {
+	return 0;
+}
+
+/*
+ * The encoder: one capture at a time, done on the third time it is asked
+ * for, the image counting up from the capture's number. Held, it is never
+ * done, for a client to hang up on.
+ */
+
+static void *shotOwner;
+static int shotAsks, shotStarted, shotDone, shotCancelled, shotHeld;
+
+int cScreenCaptureAsync(int format, void *owner) {
+	if (shotOwner != NULL)
+		return 0;
+	shotOwner = owner;
+	shotAsks = 0;
+	shotStarted++;
+	return 1;
+}
+
+int cScreenCaptureDone(void *owner, unsigned char **data, int *len) {
+	int i;
+
+	if (owner != shotOwner || ++shotAsks < 3 || shotHeld)
+		return 0;
+	if ((*data = malloc(SHOT)) == NULL)
+		return 0;
+	for (i = 0; i < SHOT; i++)
+		(*data)[i] = i + shotStarted;
+	*len = SHOT;
+	shotOwner = NULL;
+	shotDone++;
+	return 1;
+}
+
+void cScreenCaptureCancel(void *owner) {
+	if (owner == shotOwner) {
+		shotOwner = NULL;
+		shotCancelled++;
+	}
+}
+
+static char *find(char *p, int len, const char *s) {
+	int n = strlen(s);
+
+	for (; len >= n; p++, len--)
+		if (memcmp(p, s, n) == 0) return p;
+	return NULL;
+}
+
+/*
+ * A client, on a thread of its own while the main thread runs the server.
+ */
+
+enum { WHOLE, RESET, STALL, HANGUP };
+
+typedef struct {
+	const char *request;
+	int how;
+	unsigned char *scribble;	// changed once the headers are in
+	int scribbleLen;
+
+	int code, length, got, closed;
+	char *body;
+	volatile int fd, done;
+} Client;
+
+static volatile int aborts;		// the server's, for the stalled client to wait on
+
+static int connectServer(int rcvbuf) {
+	struct sockaddr_in a;
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (rcvbuf)
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	memset(&a, 0, sizeof(a));
+	a.sin_family = AF_INET;
+	a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	a.sin_port = htons(lwipShimPort);
+	if (connect(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static void *client(void *arg) {
+	Client *c = arg;
+	static char buf[RAM + 4096];
+	char *hdr;
+	int fd, n, size = 0, seen = aborts;
+
+	c->code = c->length = -1;
+	c->got = c->closed = 0;
+	c->body = NULL;
+	c->fd = fd = connectServer(c->how == STALL ? 4096 : 0);
+	if (fd < 0) {
+		c->done = 1;
+		return NULL;
+	}
+	send(fd, c->request, strlen(c->request), MSG_NOSIGNAL);
+
+	if (c->how == HANGUP) {
+		close(fd);
+		c->done = 1;
+		return NULL;
+	}
+	if (c->how == STALL)
+		while (aborts == seen) usleep(1000);
+
+	for (;;) {
+		n = recv(fd, buf + size, sizeof(buf) - size, 0);
+		if (n <= 0) {
+			c->closed = n == 0;
+			break;
+		}
+		size += n;
+
+		if (c->body == NULL && (hdr = find(buf, size, "\r\n\r\n")) != NULL) {
+			char *l = find(buf, hdr - buf, "Content-Length: ");
+
+			c->body = hdr + 4;
+			sscanf(buf, "HTTP/1.0 %d", &c->code);
+			if (l) c->length = atoi(l + 16);
+			if (c->scribble) {
+				for (n = 0; n < c->scribbleLen; n++) c->scribble[n] ^= 0xff;
+			}
+		}
+		if (c->how == RESET && size > 65536) {
+			struct linger lg = { 1, 0 };
+
+			setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+			break;
+		}
+	}
+	if (c->body) c->got = size - (c->body - buf);
+	close(fd);
+	c->done = 1;
+	return NULL;
+}
+
+// the server until the client is done and every connection is gone; a
+// client still waiting after that is cut off, so that it can be joined
+static int run(Client *c) {
+	pthread_t t;
+	double t0 = now();
+
+	c->done = 0;
+	c->fd = -1;
+	pthread_create(&t, NULL, client, c);
+	while (!c->done || lwipShimConns > 0) {
+		lwipShimStep(1);
+		aborts = lwipShimAborts;
+		if (now() - t0 > 20) {
+			printf("  %.*s: still going after 20s\n", (int)strcspn(c->request, "\r"), c->request);
+			if (c->fd >= 0) shutdown(c->fd, SHUT_RDWR);
+			break;
+		}
+	}
+	pthread_join(t, NULL);
+	return c->done && lwipShimConns == 0;
+}
+
+static int check(const char *what, int ok) {
+	if (!ok) printf("  %s\n", what);
+	return !ok;
+}
+
+int main(int argc, char *argv[]) {
+	static const struct {
+		const char *url;
+		int len;
+	} dumps[] = { { "/MEM/ram", RAM }, { "/MEM/bios", 0x80000 }, { "/MEM/scratch", 0x10000 } };
+	int n = argc > 1 ? atoi(argv[1]) : 20, errors = 0, i;
+	char request[256], *expect;
+	struct vfs_entry_s *page = search_file("/index.html");
+	uint32_t seed = 0x4771;
+	Client c;
+	double t;
+
+	psxM = malloc(RAM);
+	psxR = malloc(0x80000);
+	psxH = malloc(0x10000);
+	expect = malloc(RAM);
+	if (psxM == NULL || psxR == NULL || psxH == NULL || expect == NULL || page == NULL)
+		return 1;
+	for (i = 0; i < RAM; i++) psxM[i] = rnd(&seed);
+	for (i = 0; i < 0x80000; i++) psxR[i] = rnd(&seed);
+	for (i = 0; i < 0x10000; i++) psxH[i] = rnd(&seed);
+	strcpy(FUSES, "fuseset 00: c0ffffffffffffff\n");
+
+	lwipShimPollMs = 10;
+	httpd_start();
+	if (lwipShimPort == 0)
+		return 1;
+
+	memset(&c, 0, sizeof(c));
+	for (i = 0; i < 3; i++) {
+		unsigned char *mem = (unsigned char *)(i == 0 ? psxM : i == 1 ? psxR : psxH);
+
+		memcpy(expect, mem, dumps[i].len);
+		sprintf(request, "GET %s HTTP/1.0\r\n\r\n", dumps[i].url);
+		c.request = request;
+		c.how = WHOLE;
+		c.scribble = mem;
+		c.scribbleLen = dumps[i].len;
+		errors += check("the server does not finish", run(&c));
+		printf("%-13s %d, %d of %d bytes%s\n", dumps[i].url, c.code, c.got, c.length, c.closed ? ", closed" : "");
+		errors += check("not what the memory was at the request",
+			c.code == 200 && c.length == dumps[i].len && c.got == c.length && c.closed &&
+			memcmp(c.body, expect, c.length) == 0);
+		memcpy(mem, expect, dumps[i].len);
+	}
+	c.scribble = NULL;
+
+	c.request = "GET /index.html HTTP/1.0\r\nHost: xenon\r\n\r\n";
+	errors += check("the server does not finish", run(&c));
+	printf("/index.html   %d, %d bytes\n", c.code, c.got);
+	errors += check("not the page", c.code == 200 && c.got == page->len && memcmp(c.body, page->data, page->len) == 0);
+
+	c.request = "GET /FUSE HTTP/1.0\r\n\r\n";
+	errors += check("the server does not finish", run(&c));
+	printf("/FUSE         %d, %d bytes\n", c.code, c.got);
+	errors += check("not the fuses", c.code == 200 && c.got == (int)strlen(FUSES) && memcmp(c.body, FUSES, c.got) == 0);
+
+	c.request = "GET /nothing HTTP/1.0\r\n\r\n";
+	errors += check("the server does not finish", run(&c));
+	printf("/nothing      %d\n", c.code);
+	errors += check("not a 404", c.code == 404);
+
+	c.request = "GARBAGE\r\n\r\n";
+	errors += check("the server does not finish", run(&c));
+	printf("garbage       %d\n", c.code);
+	errors += check("not a 400", c.code == 400);
+
+	c.request = "GET /screen.png HTTP/1.0\r\n\r\n";
+	errors += check("the server does not finish", run(&c));
+	printf("/screen.png   %d, %d of %d bytes, %d captures done\n", c.code, c.got, c.length, shotDone);
+	for (i = 0; i < SHOT && c.body && c.got == SHOT && (unsigned char)c.body[i] == (unsigned char)(i + shotStarted); i++);
+	errors += check("not the capture", c.code == 200 && c.length == SHOT && i == SHOT && shotDone == 1);
+
+	// connections that end before their response does
+	errors += check("blocks left after the whole responses", lwipShimLive == 0);
+	c.request = "GET /MEM/ram HTTP/1.0\r\n\r\n";
+	c.how = RESET;
+	errors += check("the server does not finish", run(&c));
+	printf("reset         after %d bytes: %d resets, %d blocks left\n", c.got, lwipShimResets, lwipShimLive);
+	errors += check("the dump's finish did not run", lwipShimResets == 1 && lwipShimLive == 0);
+
+	c.how = STALL;
+	errors += check("the server does not finish", run(&c));
+	printf("stalled       after %d bytes: %d aborts, %d blocks left\n", c.got, lwipShimAborts, lwipShimLive);
+	errors += check("the server kept the stalled dump", lwipShimAborts == 1 && lwipShimLive == 0 && c.got < RAM);
+
+	c.request = "GET /screen.png HTTP/1.0\r\n\r\n";
+	c.how = HANGUP;
+	shotHeld = 1;
+	errors += check("the server does not finish", run(&c));
+	shotHeld = 0;
+	printf("hung up       %d captures cancelled, %d blocks left\n", shotCancelled, lwipShimLive);
+	errors += check("the capture stays owned", shotCancelled == 1 && shotOwner == NULL && lwipShimLive == 0);
+
+	// how fast, one connection after the other
+	c.request = "GET /MEM/ram HTTP/1.0\r\n\r\n";
+	c.how = WHOLE;
+	t = now();
+	for (i = 0; i < n; i++) {
+		run(&c);
+		if (c.got != RAM) break;
+	}
+	t = now() - t;
+	printf("dumps         %.0f MB/s\n", i * (RAM / 1048576.0) / t);
+	errors += check("a dump came short", i == n);
+
+	c.request = "GET /index.html HTTP/1.0\r\n\r\n";
+	t = now();
+	for (i = 0; i < 10 * n; i++) run(&c);
+	printf("pages         %.0f/s\n", 10 * n / (now() - t));
+
+	free(psxM);
+	free(psxR);
+	free(psxH);
+	free(expect);
+	return errors != 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * psxhw.c's handler tables against the switch they replaced (ref/psxhw.c):
+ * every width, read and write, at every address from 0x1f800ff0 to
+ * 0x1f803010, with the devices stubbed out. Both must return the same, call
+ * the same devices with the same arguments in the same order and leave the
+ * same psxH behind. Then the time both take for the registers games poll.
+ *
+ *   hwtable [accesses]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../source/libpcsxcore/psxhw.c"
+
+#define psxHwReset		swHwReset
+#define psxHwRead8		swHwRead8
+#define psxHwRead16		swHwRead16
+#define psxHwRead32		swHwRead32
+#define psxHwWrite8		swHwWrite8
+#define psxHwWrite16	swHwWrite16
+#define psxHwWrite32	swHwWrite32
+#define psxHwFreeze		swHwFreeze
+#include "ref/psxhw.c"
+#undef psxHwReset
+#undef psxHwRead8
+#undef psxHwRead16
+#undef psxHwRead32
+#undef psxHwWrite8
+#undef psxHwWrite16
+#undef psxHwWrite32
+#undef psxHwFreeze
+
+PcsxConfig Config;
+s8 *psxH;
+
+/*
+ * Devices: every call is logged, reads answer a value that depends on the
+ * call and on how many came before, so that the same sequence of calls
+ * gets the same answers.
+ */
+
+#define MAXCALLS	8
+
+typedef struct {
+	const char *fn;
+	u32 a, b, c;
+} Call;
+
+static Call calls[MAXCALLS];
+static int ncalls, timing;
+
+static u32 called(const char *fn, u32 a, u32 b, u32 c) {
+	u32 h = 2166136261u;
+	const char *p;
+
+	if (timing)
+		return a;	// only the dispatch gets measured
+
+	if (ncalls < MAXCALLS) {
+		calls[ncalls].fn = fn;
+		calls[ncalls].a = a;
+		calls[ncalls].b = b;
+		calls[ncalls].c = c;
+	}
+	ncalls++;
+
+	for (p = fn; *p; p++) h = (h ^ *p) * 16777619;
+	return h ^ (ncalls * 0x9e3779b9) ^ a;
+}
+
+#define READ0(type, name)		type name() { return called(#name, 0, 0, 0); }
+#define READ1(type, name)		type name(u32 a) { return called(#name, a, 0, 0); }
+#define WRITE1(type, name)		void name(type a) { called(#name, a, 0, 0); }
+#define WRITE2(name)			void name(u32 a, u32 b) { called(#name, a, b, 0); }
+#define DMA(name)				void name(u32 madr, u32 bcr, u32 chcr) { called(#name, madr, bcr, chcr); }
+
+READ0(unsigned char, cdrRead0)
+READ0(unsigned char, cdrRead1)
+READ0(unsigned char, cdrRead2)
+READ0(unsigned char, cdrRead3)
+WRITE1(unsigned char, cdrWrite0)
+WRITE1(unsigned char, cdrWrite1)
+WRITE1(unsigned char, cdrWrite2)
+WRITE1(unsigned char, cdrWrite3)
+void cdrReset() { called("cdrReset", 0, 0, 0); }
+
+READ0(unsigned char, sioRead8)
+READ0(unsigned short, sioReadStat16)
+READ0(unsigned short, sioReadMode16)
+READ0(unsigned short, sioReadCtrl16)
+READ0(unsigned short, sioReadBaud16)
+WRITE1(unsigned char, sioWrite8)
+WRITE1(unsigned short, sioWriteStat16)
+WRITE1(unsigned short, sioWriteMode16)
+WRITE1(unsigned short, sioWriteCtrl16)
+WRITE1(unsigned short, sioWriteBaud16)
+
+void psxRcntInit() { called("psxRcntInit", 0, 0, 0); }
+READ1(u32, psxRcntRcount)
+READ1(u32, psxRcntRmode)
+READ1(u32, psxRcntRtarget)
+WRITE2(psxRcntWcount)
+WRITE2(psxRcntWmode)
+WRITE2(psxRcntWtarget)
+
+void mdecInit() { called("mdecInit", 0, 0, 0); }
+READ0(u32, mdecRead0)
+READ0(u32, mdecRead1)
+WRITE1(u32, mdecWrite0)
+WRITE1(u32, mdecWrite1)
+
+READ0(int, gpuReadStatus)
+
+DMA(psxDma0)
+DMA(psxDma1)
+DMA(psxDma2)
+DMA(psxDma3)
+DMA(psxDma4)
+DMA(psxDma6)
+
+static uint32_t CALLBACK gpuReadData(void) { return called("GPU_readData", 0, 0, 0); }
+static void CALLBACK gpuWriteData(uint32_t v) { called("GPU_writeData", v, 0, 0); }
+static void CALLBACK gpuWriteStatus(uint32_t v) { called("GPU_writeStatus", v, 0, 0); }
+static unsigned short CALLBACK spuReadRegister(unsigned long a) { return called("SPU_readRegister", a, 0, 0); }
+static void CALLBACK spuWriteRegister(unsigned long a, unsigned short v) { called("SPU_writeRegister", a, v, 0); }
+
+GPUreadData GPU_readData = gpuReadData;
+GPUwriteData GPU_writeData = gpuWriteData;
+GPUwriteStatus GPU_writeStatus = gpuWriteStatus;
+SPUreadRegister SPU_readRegister = spuReadRegister;
+SPUwriteRegister SPU_writeRegister = spuWriteRegister;
+
+/*
+ * One access through both. The io page and the scratchpad below it start
+ * out the same, only 0x0000-0x3fff can be touched.
+ */
+
+#define HSIZE		0x4000
+
+static u8 start[HSIZE], after[HSIZE];
+
+typedef struct {
+	u32 ret;
+	int ncalls;
+	Call calls[MAXCALLS];
+} Result;
+
+static void run(int table, int width, int write, u32 addr, u32 value, Result *r) {
+	memcpy(psxH, start, HSIZE);
+	ncalls = 0;
+	r->ret = 0;
+
+	if (write) {
+		switch (width) {
+			case 1: table ? psxHwWrite8(addr, value) : swHwWrite8(addr, value); break;
+			case 2: table ? psxHwWrite16(addr, value) : swHwWrite16(addr, value); break;
+			default: table ? psxHwWrite32(addr, value) : swHwWrite32(addr, value); break;
+		}
+	} else {
+		switch (width) {
+			case 1: r->ret = table ? psxHwRead8(addr) : swHwRead8(addr); break;
+			case 2: r->ret = table ? psxHwRead16(addr) : swHwRead16(addr); break;
+			default: r->ret = table ? psxHwRead32(addr) : swHwRead32(addr); break;
+		}
+	}
+
+	r->ncalls = ncalls;
+	memcpy(r->calls, calls, sizeof(calls));
+}
+
+static int same(const Result *a, const Result *b) {
+	int i;
+
+	if (a->ret != b->ret || a->ncalls != b->ncalls)
+		return 0;
+	for (i = 0; i < a->ncalls && i < MAXCALLS; i++)
+		if (strcmp(a->calls[i].fn, b->calls[i].fn) != 0 || a->calls[i].a != b->calls[i].a ||
+			a->calls[i].b != b->calls[i].b || a->calls[i].c != b->calls[i].c)
+			return 0;
+	return 1;
+}
+
+static void show(const char *what, const Result *r) {
+	int i;
+
+	printf("  %s: %08x,", what, r->ret);
+	for (i = 0; i < r->ncalls && i < MAXCALLS; i++)
+		printf(" %s(%x, %x, %x)", r->calls[i].fn, r->calls[i].a, r->calls[i].b, r->calls[i].c);
+	printf("\n");
+}
+
+static u32 rnd(u32 *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// the registers a game polls or sets up all the time
+static const u32 hot[] = {
+	0x1f801070, 0x1f801074, 0x1f801814, 0x1f801810, 0x1f8010f4, 0x1f8010f0,
+	0x1f8010a8, 0x1f801100, 0x1f801110, 0x1f801120, 0x1f801800, 0x1f801040,
+	0x1f801044, 0x1f801c00, 0x1f801daa, 0x1f801dae,
+};
+
+static double bench(int table, int n) {
+	double t = now();
+	u32 sum = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		u32 addr = hot[i & 15];
+
+		if (addr >= 0x1f801c00 || addr == 0x1f801040 || addr == 0x1f801044)
+			sum += table ? psxHwRead16(addr) : swHwRead16(addr);
+		else if (addr == 0x1f801800)
+			sum += table ? psxHwRead8(addr) : swHwRead8(addr);
+		else
+			sum += table ? psxHwRead32(addr) : swHwRead32(addr);
+	}
+	t = now() - t;
+
+	if (sum == 1) printf(" ");
+	return t * 1e9 / n;
+}
+
+int main(int argc, char *argv[]) {
+	static const u32 values[] = { 0x00000000, 0xffffffff, 0x01000401, 0x8a5c3e17 };
+	static const char *name[] = { "read", "write" };
+	int n = argc > 1 ? atoi(argv[1]) : 20000000;
+	int cfg, width, write, v, errors = 0, checked = 0;
+	Result t, s;
+	u32 addr, seed = 1, i;
+
+	psxH = malloc(0x10000);
+	if (psxH == NULL)
+		return 1;
+	for (i = 0; i < HSIZE; i++)
+		start[i] = rnd(&seed);
+
+	for (cfg = 0; cfg < 2; cfg++) {
+		Config.Sio = Config.SpuIrq = cfg;
+
+		for (addr = 0x1f800ff0; addr < 0x1f803010; addr++)
+		for (width = 1; width <= 4; width <<= 1)
+		for (write = 0; write < 2; write++)
+		for (v = 0; v < (write ? 4 : 1); v++) {
+			run(1, width, write, addr, values[v], &t);
+			memcpy(after, psxH, HSIZE);
+			run(0, width, write, addr, values[v], &s);
+			checked++;
+
+			if (same(&t, &s) && memcmp(after, psxH, HSIZE) == 0)
+				continue;
+			if (errors++ < 10) {
+				printf("%s%d %08x %08x, Sio/SpuIrq %d:\n", name[write], width * 8, addr, values[v], cfg);
+				show("table ", &t);
+				show("switch", &s);
+				if (memcmp(after, psxH, HSIZE) != 0)
+					printf("  psxH differs\n");
+			}
+		}
+
+		ncalls = 0;
+		psxHwReset();
+		memcpy(after, psxH, HSIZE);
+		t.ncalls = ncalls;
+		ncalls = 0;
+		swHwReset();
+		checked++;
+		if (t.ncalls != ncalls || memcmp(after, psxH, HSIZE) != 0) {
+			printf("psxHwReset differs, Sio/SpuIrq %d\n", cfg);
+			errors++;
+		}
+	}
+	printf("%d accesses, %d differ\n", checked, errors);
+
+	memcpy(psxH, start, HSIZE);
+	timing = 1;
+	printf("polled registers: %.2f ns/access tables, %.2f ns/access switch\n",
+		bench(1, n), bench(0, n));
+
+	free(psxH);
+	return errors != 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * The dynarec's per block register liveness against a path search: every
+ * register the table reports dead at some pc must be written before it is
+ * read on all paths from there, through branches, delay slots and loops.
+ * Runs over random instruction streams and over the given PS-X EXEs, and
+ * compares the answers and their cost with the forward scan they replace.
+ *
+ *   liveness [programs] [exe...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the forward scan and the table are static
+#include "../source/ppcr/reguse.c"
+
+#define ORG			0x80010000
+#define MAXCODE		0x4000
+
+static u32 progStart, progEnd;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+static int isTransfer(u32 code) {
+	int type = getRegUse(code) & REGUSE_TYPEM;
+
+	return type == REGUSE_BRANCH || type == REGUSE_JUMP || type == REGUSE_JUMPR;
+}
+
+/*
+ * Path search: can psxreg be read before it gets written, starting at pc?
+ * Each pc is visited at most twice, as a plain instruction and as the delay
+ * slot of the transfer before it. Leaving the program, a jump to a register,
+ * a syscall and unknown opcodes count as a read.
+ */
+
+static u8 seen[MAXCODE][2];
+
+static int search(u32 startpc, int psxreg) {
+	static u32 stack[MAXCODE * 2];
+	u32 pc, code, prev;
+	int sp = 0, slot, use, type;
+
+	// pcs outside the program are pushed as they are, to be caught below
+	#define PUSH(pc, slot)	(stack[sp++] = (((pc) - progStart) << 1) | (slot))
+
+	memset(seen, 0, (progEnd - progStart) / 2);
+	PUSH(startpc, 0);
+
+	while (sp > 0) {
+		pc = progStart + ((stack[--sp] >> 1) & ~3);
+		slot = stack[sp] & 1;
+
+		if (pc < progStart || pc >= progEnd)
+			return 1;
+		if (seen[(pc - progStart) >> 2][slot]++)
+			continue;
+
+		code = PSXMu32(pc);
+		use = getRegUse(code);
+		if (use == REGUSE_UNKNOWN)
+			return 1;
+
+		use = useOfPsxReg(code, use, psxreg);
+		if (use & REGUSE_READ)
+			return 1;
+		if (use & REGUSE_WRITE)
+			continue;
+
+		type = getRegUse(code) & REGUSE_TYPEM;
+
+		if (slot) {
+			prev = PSXMu32(pc - 4);
+			switch (getRegUse(prev) & REGUSE_TYPEM) {
+				case REGUSE_BRANCH:
+					PUSH(pc + 4, 0);
+					PUSH(pc + _fImm_(prev) * 4, 0);
+					break;
+				case REGUSE_JUMP:
+					PUSH((_fTarget_(prev) << 2) | (pc & 0xf0000000), 0);
+					break;
+				default:		// jr / jalr
+					return 1;
+			}
+		} else if (type == REGUSE_SYS) {
+			return 1;
+		} else if (type == REGUSE_BRANCH || type == REGUSE_JUMP || type == REGUSE_JUMPR) {
+			PUSH(pc + 4, 1);
+		} else {
+			PUSH(pc + 4, 0);
+		}
+	}
+
+	#undef PUSH
+	return 0;
+}
+
+// the answer only depends on pc and register, so it is kept per program
+static u8 exact[MAXCODE][34];
+
+static int mayRead(u32 pc, int psxreg) {
+	u8 *e = &exact[(pc - progStart) >> 2][psxreg];
+
+	if (*e == 0xff)
+		*e = search(pc, psxreg);
+	return *e;
+}
+
+/*
+ * Random code: registers come mostly from a few, so that reads and writes of
+ * the same one meet often, branches go both ways within +-64 instructions
+ * and never sit in a delay slot.
+ */
+
+static int reg(u32 *seed) {
+	return (rnd(seed) & 3) ? rnd(seed) % 6 + 1 : rnd(seed) & 31;
+}
+
+#define R(rs, rt, rd, fn)	(((rs) << 21) | ((rt) << 16) | ((rd) << 11) | (fn))
+#define I(op, rs, rt, imm)	(((op) << 26) | ((rs) << 21) | ((rt) << 16) | ((imm) & 0xffff))
+
+static u32 randomCode(u32 *seed, int i, int n, int transfer) {
+	static const u8 alu[] = { 0x00, 0x02, 0x04, 0x21, 0x23, 0x24, 0x25, 0x27, 0x2a, 0x2b };
+	static const u8 imm[] = { 0x09, 0x0a, 0x0c, 0x0d, 0x0f, 0x20, 0x22, 0x23, 0x26, 0x28, 0x2b };
+	int rs = reg(seed), rt = reg(seed), rd = reg(seed), off;
+	u32 k = rnd(seed) % 100;
+
+	off = (int)(rnd(seed) % 128) - 64;
+	if (i + 1 + off < 0 || i + 1 + off >= n) off = -off;
+
+	if (transfer && k < 12)
+		return I(rnd(seed) % 4 + 4, rs, rt, off);			// beq bne blez bgtz
+	if (transfer && k < 15)
+		return I(1, rs, (rnd(seed) & 1) ? 0x10 | (k & 1) : k & 1, off);	// bltz bgez (al)
+	if (transfer && k < 17)
+		return ((2 + (k & 1)) << 26) | (((ORG >> 2) + rnd(seed) % n) & 0x3ffffff);	// j jal
+	if (transfer && k < 18)
+		return R(rs, 0, (k & 1) ? rd : 0, (k & 1) ? 0x09 : 0x08);	// jr jalr
+	if (transfer && k < 19)
+		return 0x0c;										// syscall
+
+	if (k < 45) return R(rs, rt, rd, alu[rnd(seed) % sizeof(alu)]) | ((rnd(seed) & 31) << 6);
+	if (k < 80) return I(imm[rnd(seed) % sizeof(imm)], rs, rt, rnd(seed));
+	if (k < 85) return R(rs, rt, 0, 0x18 + (k & 3));		// mult multu div divu
+	if (k < 92) return R(rs, 0, rd, 0x10 + (k & 3));		// mfhi mthi mflo mtlo
+	if (k < 94) return I(0x10, (k & 1) ? 4 : 0, rt, rd << 11);	// mfc0 mtc0
+	if (k < 96) return I(0x12, (k & 1) ? 4 : 0, rt, rd << 11);	// mfc2 mtc2
+	if (k < 98) return I((k & 1) ? 0x3a : 0x32, rs, rt, 0);	// lwc2 swc2
+	if (k < 99) return 0x4a000000 | (rnd(seed) & 0x3f);		// cop2 op
+	return 0;
+}
+
+static void load(const u32 *code, int n) {
+	int i;
+
+	memset(psxM, 0, 0x200000);
+	for (i = 0; i < n; i++)
+		*(u32 *)PSXM(ORG + i * 4) = SWAP32(code[i]);
+
+	progStart = ORG;
+	progEnd = ORG + n * 4;
+	memset(exact, 0xff, n * sizeof(exact[0]));
+}
+
+static int loadExe(const char *file) {
+	static u32 code[MAXCODE];
+	u8 head[0x800];
+	u32 addr, size;
+	FILE *f;
+	int n;
+
+	f = fopen(file, "rb");
+	if (f == NULL) {
+		perror(file);
+		return -1;
+	}
+	if (fread(head, 1, sizeof(head), f) != sizeof(head) || memcmp(head, "PS-X EXE", 8) != 0) {
+		printf("%s: not a PS-X EXE\n", file);
+		fclose(f);
+		return -1;
+	}
+	addr = head[0x18] | head[0x19] << 8 | head[0x1a] << 16 | head[0x1b] << 24;
+	size = head[0x1c] | head[0x1d] << 8 | head[0x1e] << 16 | head[0x1f] << 24;
+	if (addr != ORG || size > sizeof(code)) {
+		printf("%s: %08x+%x does not fit\n", file, addr, size);
+		fclose(f);
+		return -1;
+	}
+	n = fread(code, 4, size / 4, f);
+	fclose(f);
+
+	// little endian words, the trailing padding is left out
+	while (n > 0 && code[n - 1] == 0) n--;
+	load(code, n);
+	return n;
+}
+
+static struct {
+	u32 blocks, queries;
+	u32 unsound;		// dead in the table, read on some path
+	u32 tableDead, scanDead, exactDead;		// of the block pcs
+	double table, scan;
+	int sink;
+} st;
+
+/*
+ * One block from startpc. Every pc the table covers, lookahead included, is
+ * checked against the path search; the dynarec asks about the pcs up to the
+ * block's delay slot, and those are also put to the forward scan.
+ */
+static void checkBlock(u32 startpc) {
+	u32 pc, i, count, body;
+	int r, live, scan, sink = 0;
+	double t;
+
+	for (pc = startpc; pc < progEnd; pc += 4) {
+		if (isTransfer(PSXMu32(pc))) { pc += 4; break; }
+		if ((getRegUse(PSXMu32(pc)) & REGUSE_TYPEM) == REGUSE_SYS) break;
+	}
+	body = (pc + 4 - startpc) >> 2;
+
+	t = now();
+	BuildPsxRegLiveness(startpc);
+	for (pc = startpc, i = 0; i < body; i++, pc += 4)
+		for (r = 1; r < 34; r++)
+			sink += isPsxRegUsed(pc, r);
+	st.table += now() - t;
+
+	t = now();
+	for (pc = startpc, i = 0; i < body; i++, pc += 4)
+		for (r = 1; r < 34; r++)
+			sink += _nextPsxRegUse(pc, r, 80);
+	st.scan += now() - t;
+
+	st.blocks++;
+	st.sink += sink;
+
+	count = liveCount;
+	for (i = 0; i < count; i++) {
+		pc = startpc + i * 4;
+		if (pc >= progEnd) break;
+
+		for (r = 1; r < 34; r++) {
+			live = isPsxRegUsed(pc, r) != 0;
+
+			if (i < body) {
+				scan = _nextPsxRegUse(pc, r, 80);
+
+				st.queries++;
+				st.tableDead += !live;
+				st.scanDead += scan == REGUSE_WRITE;
+				st.exactDead += !mayRead(pc, r);
+			}
+
+			if (!live && mayRead(pc, r) && st.unsound++ < 5)
+				printf("block %08x: r%d is dead at %08x, but read later\n", startpc, r, pc);
+		}
+	}
+
+	ClearPsxRegLiveness();
+}
+
+// a block starts at the program's start, after each delay slot and at
+// each branch target
+static void checkProgram(void) {
+	u32 pc, code;
+
+	checkBlock(progStart);
+	for (pc = progStart; pc < progEnd; pc += 4) {
+		code = PSXMu32(pc);
+		if (!isTransfer(code)) continue;
+
+		if (pc + 8 < progEnd)
+			checkBlock(pc + 8);
+		if ((getRegUse(code) & REGUSE_TYPEM) == REGUSE_BRANCH) {
+			u32 target = pc + 4 + _fImm_(code) * 4;
+			if (target >= progStart && target < progEnd)
+				checkBlock(target);
+		}
+	}
+}
+
+static void report(const char *what) {
+	printf("%-20s %6u blocks %8u queries: dead %5.1f%% exact, %5.1f%% table, %5.1f%% scan, %u unsound\n",
+		what, st.blocks, st.queries,
+		100.0 * st.exactDead / st.queries, 100.0 * st.tableDead / st.queries,
+		100.0 * st.scanDead / st.queries, st.unsound);
+	printf("%-20s %6.2f us/block table, %6.2f us/block forward scans\n", "",
+		st.table * 1e6 / st.blocks, st.scan * 1e6 / st.blocks);
+}
+
+int main(int argc, char *argv[]) {
+	static u32 code[MAXCODE];
+	int programs = 200, unsound = 0, p, i, n, a = 1;
+	u32 seed = 1;
+
+	if (a < argc && argv[a][0] >= '0' && argv[a][0] <= '9')
+		programs = atoi(argv[a++]);
+
+	if (psxMemInit() != 0)
+		return 1;
+
+	for (p = 0; p < programs; p++) {
+		n = 64 + rnd(&seed) % 448;
+		for (i = 0; i < n; i++)
+			code[i] = randomCode(&seed, i, n, i == 0 || !isTransfer(code[i - 1]));
+		load(code, n);
+		checkProgram();
+	}
+	report("random");
+	unsound += st.unsound;
+
+	for (; a < argc; a++) {
+		memset(&st, 0, sizeof(st));
+		if (loadExe(argv[a]) < 0)
+			return 1;
+		checkProgram();
+		report(argv[a]);
+		unsound += st.unsound;
+	}
+
+	psxMemShutdown();
+	return unsound != 0;
+}
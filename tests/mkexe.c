@@ -0,0 +1,284 @@
+/*
+ * Writes the small PS-X EXEs the checks run, so that they need neither a
+ * bios nor a game:
+ *
+ *   mkexe <program> <out.exe>
+ *
+ * draw: every vsync fills the screen, draws a triangle with the cpu and a
+ *       rectangle with a dma chain, both moving, and reads GPUREAD back
+ * pad:  every vsync reads the first pad through the sio, folds the buttons
+ *       into a state word kept in ram and draws from that state
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define ORG			0x80010000
+#define MAXCODE		0x4000
+
+enum {
+	ZERO = 0, AT, V0, V1, A0, A1, A2, A3,
+	T0, T1, T2, T3, T4, T5, T6, T7,
+	S0, S1, S2, S3, S4, S5, S6, S7,
+	T8, T9, K0, K1, GP, SP, FP, RA
+};
+
+static uint32_t code[MAXCODE];
+static int pc;
+
+static void emit(uint32_t op) {
+	if (pc == MAXCODE) {
+		fprintf(stderr, "program too big\n");
+		exit(1);
+	}
+	code[pc++] = op;
+}
+
+#define RTYPE(rs, rt, rd, sa, fn)	emit(((rs) << 21) | ((rt) << 16) | ((rd) << 11) | ((sa) << 6) | (fn))
+#define ITYPE(op, rs, rt, imm)		emit(((op) << 26) | ((rs) << 21) | ((rt) << 16) | ((imm) & 0xffff))
+
+#define nop()				emit(0)
+#define sll(rd, rt, sa)		RTYPE(0, rt, rd, sa, 0x00)
+#define srl(rd, rt, sa)		RTYPE(0, rt, rd, sa, 0x02)
+#define addu(rd, rs, rt)	RTYPE(rs, rt, rd, 0, 0x21)
+#define and_(rd, rs, rt)	RTYPE(rs, rt, rd, 0, 0x24)
+#define or_(rd, rs, rt)		RTYPE(rs, rt, rd, 0, 0x25)
+#define xor_(rd, rs, rt)	RTYPE(rs, rt, rd, 0, 0x26)
+#define addiu(rt, rs, imm)	ITYPE(0x09, rs, rt, imm)
+#define andi(rt, rs, imm)	ITYPE(0x0c, rs, rt, imm)
+#define ori(rt, rs, imm)	ITYPE(0x0d, rs, rt, imm)
+#define lui(rt, imm)		ITYPE(0x0f, 0, rt, imm)
+#define lbu(rt, off, rs)	ITYPE(0x24, rs, rt, off)
+#define lw(rt, off, rs)		ITYPE(0x23, rs, rt, off)
+#define sb(rt, off, rs)		ITYPE(0x28, rs, rt, off)
+#define sh(rt, off, rs)		ITYPE(0x29, rs, rt, off)
+#define sw(rt, off, rs)		ITYPE(0x2b, rs, rt, off)
+
+// branches go back to a label taken with here(), the delay slot gets a nop
+#define here()				(pc)
+#define beq(rs, rt, label)	do { ITYPE(0x04, rs, rt, (label) - pc - 1); nop(); } while (0)
+#define bne(rs, rt, label)	do { ITYPE(0x05, rs, rt, (label) - pc - 1); nop(); } while (0)
+#define j(label)			do { emit((2 << 26) | (((ORG + (label) * 4) >> 2) & 0x3ffffff)); nop(); } while (0)
+
+static void li(int rt, uint32_t v) {
+	lui(rt, v >> 16);
+	ori(rt, rt, v & 0xffff);
+}
+
+// s0 holds 0x1f800000 in all programs
+#define IO(reg)				((reg) - 0x1f800000)
+
+static void io_write(uint32_t reg, uint32_t v) {
+	li(T0, v);
+	sw(T0, IO(reg), S0);
+}
+
+// spins until the vsync interrupt gets flagged and acknowledges it
+static void wait_vsync(void) {
+	int wait = here();
+
+	lw(T0, IO(0x1f801070), S0);
+	nop();
+	andi(T0, T0, 1);
+	beq(T0, ZERO, wait);
+	io_write(0x1f801070, ~1u);
+}
+
+#define GP0(v)		io_write(0x1f801810, v)
+#define GP1(v)		io_write(0x1f801814, v)
+
+static void draw(void) {
+	int frame;
+
+	lui(S0, 0x1f80);
+	li(S2, 0x80020000);		// dma chain
+
+	lw(T0, IO(0x1f8010f0), S0);
+	nop();
+	ori(T0, T0, 0x0800);	// gpu dma on
+	sw(T0, IO(0x1f8010f0), S0);
+
+	GP1(0x00000000);		// reset
+	GP1(0x03000000);		// display on
+	GP1(0x08000001);		// 320x240
+	GP1(0x04000002);		// dma to the gpu
+	GP0(0xe1000400);		// draw to the displayed area too
+	GP0(0xe3000000);		// drawing area 0,0 -
+	GP0(0xe403bd3f);		// 319,239
+	GP0(0xe5000000);		// no offset
+
+	// one packet, a 16x16 green rectangle, end of chain
+	li(T0, 0x03ffffff);
+	sw(T0, 0, S2);
+	li(T0, 0x6000ff00);
+	sw(T0, 4, S2);
+	li(T0, 0x00100010);
+	sw(T0, 12, S2);
+
+	addu(S1, ZERO, ZERO);	// frame counter
+
+	frame = here();
+	wait_vsync();
+	addiu(S1, S1, 1);
+
+	// fill the screen, red grows with the frame count
+	sll(T1, S1, 3);
+	andi(T1, T1, 0xff);
+	lui(T2, 0x0200);
+	or_(T1, T1, T2);
+	sw(T1, IO(0x1f801810), S0);
+	sw(ZERO, IO(0x1f801810), S0);
+	li(T1, 0x00f00140);
+	sw(T1, IO(0x1f801810), S0);
+
+	// blue triangle, its first vertex moves right
+	GP0(0x20ff0000);
+	andi(T1, S1, 0xff);
+	addiu(T1, T1, 10);
+	lui(T2, 10);
+	or_(T1, T1, T2);
+	sw(T1, IO(0x1f801810), S0);
+	GP0(0x00c80064);
+	GP0(0x003200c8);
+
+	// the rectangle moves down, then the chain goes out
+	andi(T1, S1, 0x7f);
+	sll(T1, T1, 16);
+	ori(T1, T1, 0x0032);
+	sw(T1, 8, S2);
+	sw(S2, IO(0x1f8010a0), S0);
+	sw(ZERO, IO(0x1f8010a4), S0);
+	io_write(0x1f8010a8, 0x01000401);
+
+	lw(T1, IO(0x1f801810), S0);	// GPUREAD
+	nop();
+
+	j(frame);
+}
+
+// one byte to the pad and its answer to rd
+static void sio_byte(int rd, uint32_t v) {
+	addiu(T0, ZERO, v);
+	sb(T0, IO(0x1f801040), S0);
+	lbu(rd, IO(0x1f801040), S0);
+	nop();
+}
+
+static void pad(void) {
+	int frame;
+
+	lui(S0, 0x1f80);
+	li(S2, 0x80030000);		// state word, then the last buttons
+
+	GP1(0x00000000);		// reset
+	GP1(0x03000000);		// display on
+	GP1(0x08000001);		// 320x240
+	GP0(0xe1000400);		// draw to the displayed area too
+	GP0(0xe3000000);		// drawing area 0,0 -
+	GP0(0xe403bd3f);		// 319,239
+	GP0(0xe5000000);		// no offset
+
+	addu(S3, ZERO, ZERO);	// state
+	sw(ZERO, 0, S2);
+
+	frame = here();
+	wait_vsync();
+
+	// port 1 selected, then read: 01 42 00 00 00, the last two are the buttons
+	addiu(T0, ZERO, 0x0002);
+	sh(T0, IO(0x1f80104a), S0);
+	sio_byte(T1, 0x01);
+	sio_byte(T1, 0x42);
+	sio_byte(T1, 0x00);
+	sio_byte(T4, 0x00);
+	sio_byte(T5, 0x00);
+	sll(T5, T5, 8);
+	or_(T4, T4, T5);
+	sw(T4, 4, S2);
+
+	// state = rotl(state, 1) ^ buttons
+	sll(T2, S3, 1);
+	srl(T3, S3, 31);
+	or_(S3, T2, T3);
+	xor_(S3, S3, T4);
+	sw(S3, 0, S2);
+
+	// fill the screen with a colour from the state, a rectangle where it says
+	andi(T1, S3, 0xff);
+	lui(T2, 0x0200);
+	or_(T1, T1, T2);
+	sw(T1, IO(0x1f801810), S0);
+	sw(ZERO, IO(0x1f801810), S0);
+	li(T1, 0x00f00140);
+	sw(T1, IO(0x1f801810), S0);
+
+	GP0(0x6000ff00);
+	srl(T1, S3, 8);
+	andi(T1, T1, 0x7f);
+	sll(T1, T1, 16);
+	andi(T2, S3, 0xff);
+	or_(T1, T1, T2);
+	sw(T1, IO(0x1f801810), S0);
+	GP0(0x00100010);
+
+	j(frame);
+}
+
+static const struct {
+	const char *name;
+	void (*emit)(void);
+} programs[] = {
+	{ "draw", draw },
+	{ "pad", pad },
+};
+
+static void put32(uint8_t *p, uint32_t v) {
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+int main(int argc, char *argv[]) {
+	uint8_t head[0x800];
+	uint32_t size;
+	FILE *f;
+	int i;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s <program> <out.exe>\n", argv[0]);
+		return 2;
+	}
+
+	for (i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+		if (strcmp(argv[1], programs[i].name) == 0) break;
+	if (i == sizeof(programs) / sizeof(programs[0])) {
+		fprintf(stderr, "no program %s\n", argv[1]);
+		return 2;
+	}
+	programs[i].emit();
+
+	size = (pc * 4 + 0x7ff) & ~0x7ff;
+
+	memset(head, 0, sizeof(head));
+	memcpy(head, "PS-X EXE", 8);
+	put32(head + 0x10, ORG);			// pc0
+	put32(head + 0x18, ORG);			// t_addr
+	put32(head + 0x1c, size);			// t_size
+	put32(head + 0x30, 0x801fff00);		// s_addr
+
+	f = fopen(argv[2], "wb");
+	if (f == NULL) {
+		perror(argv[2]);
+		return 1;
+	}
+	fwrite(head, 1, sizeof(head), f);
+	for (i = 0; i < size / 4; i++) {
+		uint8_t w[4];
+
+		put32(w, i < pc ? code[i] : 0);
+		fwrite(w, 1, 4, f);
+	}
+	fclose(f);
+
+	return 0;
+}
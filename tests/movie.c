@@ -0,0 +1,186 @@
+/*
+ * Input movies: the pad program runs with a scripted pad while a movie gets
+ * recorded, then again with the pads idle while it plays back. Every frame
+ * has to end where the recording had it and no state hash may differ. A
+ * movie with one button press changed has to be caught by the next hash.
+ * Then what recording and playing cost per frame.
+ *
+ *   movie [frames] <exe>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "psxcommon.h"
+#include "r3000a.h"
+#include "psxmem.h"
+#include "movie.h"
+#include "hostsys.h"
+
+#define STATE		0x80030000		// the pad program's state word
+#define FILENAME	"build/movie.pxm"
+#define TAMPER		100				// frame of the changed button press
+#define HASHES		60				// frames between hashes, as in movie.c
+
+typedef struct {
+	u32 state, pc, cycle;
+} Frame;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// the buttons held in frame n, active low, as in runahead.c
+static unsigned short script(u32 n) {
+	u32 h = (n / 3 + 1) * 2654435761u;
+
+	return ~((1 << (h >> 28)) | (1 << ((h >> 24) & 15)));
+}
+
+// mode 0: plain, 1: recording, 2: playing
+static int run(const char *file, int mode, u32 frames, Frame *f, MovieStats *stats, double *t) {
+	u32 i;
+
+	if (HostStart(file, NULL) != 0) {
+		fprintf(stderr, "could not start %s\n", file);
+		return -1;
+	}
+	if (mode == 1 && Movie_Record(FILENAME, MOVIE_STATE) != 0)
+		return -1;
+	if (mode == 2 && Movie_Play(FILENAME) != 0)
+		return -1;
+
+	*t = now();
+	for (i = 0; i < frames; i++) {
+		hostPadButtons[0] = mode == 2 ? 0xffff : script(i);
+		HostFrame();
+
+		f[i].state = psxMu32(STATE);
+		f[i].pc = psxRegs.pc;
+		f[i].cycle = psxRegs.cycle;
+	}
+	*t = now() - *t;
+
+	Movie_Stop();
+	Movie_GetStats(stats);
+	HostStop();
+	return 0;
+}
+
+/*
+ * Flips the buttons of the first poll at or after frame TAMPER. Returns the
+ * frame changed, 0 if there is none.
+ */
+static u32 tamper(void) {
+	u8 head[30], rec[4 + 1 + 1 + 255];
+	u32 frame = 0;
+	long pos;
+	FILE *f;
+	int type;
+
+	f = fopen(FILENAME, "r+b");
+	if (f == NULL || fread(head, 1, sizeof(head), f) != sizeof(head)) {
+		if (f) fclose(f);
+		return 0;
+	}
+
+	while ((type = fgetc(f)) == MOVIE_POLL || type == MOVIE_HASH) {
+		pos = ftell(f);
+		if (fread(rec, 1, type == MOVIE_POLL ? 6 : 8, f) != (type == MOVIE_POLL ? 6u : 8u))
+			break;
+		frame = rec[0] | rec[1] << 8 | rec[2] << 16 | (u32)rec[3] << 24;
+		if (type == MOVIE_HASH)
+			continue;
+
+		// 0x41 0x5a, then the two bytes of buttons
+		if (fread(rec + 6, 1, rec[5], f) != rec[5])
+			break;
+		if (frame >= TAMPER && rec[5] >= 4) {
+			rec[6 + rec[5] - 1] ^= 0x10;
+			fseek(f, pos + 6 + rec[5] - 1, SEEK_SET);
+			fputc(rec[6 + rec[5] - 1], f);
+			fclose(f);
+			return frame;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	MovieStats rec, play, plain;
+	Frame *recorded, *played;
+	u32 frames = 300, i, changed;
+	int errors = 0, bad = 0, a = 1;
+	double trec, tplay, tplain;
+
+	if (a < argc && argv[a][0] >= '0' && argv[a][0] <= '9')
+		frames = strtoul(argv[a++], NULL, 0);
+	if (a != argc - 1 || frames <= TAMPER + HASHES) {
+		fprintf(stderr, "usage: %s [frames > %d] <exe>\n", argv[0], TAMPER + HASHES);
+		return 2;
+	}
+
+	recorded = malloc(frames * sizeof(Frame));
+	played = malloc(frames * sizeof(Frame));
+	if (recorded == NULL || played == NULL)
+		return 1;
+
+	if (run(argv[a], 0, frames, played, &plain, &tplain) != 0 ||
+		run(argv[a], 1, frames, recorded, &rec, &trec) != 0 ||
+		run(argv[a], 2, frames, played, &play, &tplay) != 0)
+		return 1;
+
+	// the movie ends after the last poll, the frame it is in still plays
+	for (i = 0; i < play.frames && i < frames; i++) {
+		if (memcmp(&recorded[i], &played[i], sizeof(Frame)) == 0)
+			continue;
+		if (bad++ < 3)
+			printf("frame %u: state %08x/%08x pc %08x/%08x cycle %u/%u\n", i,
+				recorded[i].state, played[i].state, recorded[i].pc, played[i].pc,
+				recorded[i].cycle, played[i].cycle);
+	}
+
+	printf("plain:     %u frames, %.2f ms/frame\n", frames, tplain * 1e3 / frames);
+	printf("recording: %u frames, %.2f ms/frame, %u polls, %u hashes\n",
+		rec.frames, trec * 1e3 / frames, rec.polls, rec.hashes);
+	printf("playing:   %u frames, %.2f ms/frame, %u polls, %u hashes, %u desyncs, %d frames differ\n",
+		play.frames, tplay * 1e3 / frames, play.polls, play.hashes, play.desyncs, bad);
+
+	if (bad || play.desyncs) {
+		printf("  the movie did not play back what was recorded\n");
+		errors++;
+	}
+	if (rec.frames != frames || rec.hashes != frames / HASHES || rec.polls < frames - 1 ||
+		play.polls != rec.polls || play.hashes != rec.hashes || play.frames + 1 < frames) {
+		printf("  expected %u frames, one poll and one hash every %d of them\n", frames, HASHES);
+		errors++;
+	}
+
+	// one button press changed: the next hash after it has to notice
+	changed = tamper();
+	if (changed == 0) {
+		printf("no poll to change after frame %d\n", TAMPER);
+		errors++;
+	} else if (run(argv[a], 2, frames, played, &play, &tplay) != 0) {
+		return 1;
+	} else {
+		printf("changed the poll of frame %u: %u desyncs, the first at frame %u\n",
+			changed, play.desyncs, play.firstDesync);
+		if (play.desyncs == 0 || play.firstDesync != (changed / HASHES + 1) * HASHES) {
+			printf("  expected a desync at frame %u\n", (changed / HASHES + 1) * HASHES);
+			errors++;
+		}
+	}
+
+	remove(FILENAME);
+	remove(FILENAME ".sta");
+	free(recorded);
+	free(played);
+	return errors != 0;
+}
@@ -0,0 +1,347 @@
+/*
+ * Patches for a 16MB image: a PPF3 patch with undo data, an IPS patch with
+ * runs and a BPS patch with target copies, several MB each and overlapping
+ * themselves. Each gets loaded the way a game start does and every sector
+ * of the image run through CheckPPFCache, which has to give what applying
+ * the patch to the image byte by byte gives. Then the allocations of a
+ * load fail in turn (all of them, or 64 spread over a load that makes
+ * more): the patch has to end up dropped or loaded whole, never in part,
+ * and the next load has to work again. Along the way what loading and
+ * patching cost.
+ *
+ *   ppfpatch
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "psxcommon.h"
+#include "cdrom.h"
+#include "ppf.h"
+
+#define SECTORS		(16 * 1024 * 1024 / CD_FRAMESIZE_RAW)
+#define IMAGE		(SECTORS * CD_FRAMESIZE_RAW)
+#define NAME		"build/SLUS_123.45"
+
+static u8 *image, *patched;
+
+// the allocator, failing the call numbered failAt (from 1) when it is set
+static int allocs, failAt;
+
+void *__real_malloc(size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size) {
+	if (failAt && ++allocs == failAt) return NULL;
+	return __real_malloc(size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+	if (failAt && ++allocs == failAt) return NULL;
+	return __real_realloc(p, size);
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+static void put32(FILE *f, u32 v) {
+	fputc(v, f); fputc(v >> 8, f); fputc(v >> 16, f); fputc(v >> 24, f);
+}
+
+/*
+ * PPF3 with undo data: records of up to 255 bytes anywhere, the later one
+ * wins where they overlap.
+ */
+static long writePPF(const char *name, u32 seed) {
+	u8 data[255];
+	long size;
+	u32 pos, len, i, n;
+	FILE *f = fopen(name, "wb");
+
+	if (f == NULL) return -1;
+
+	fwrite("PPF30", 1, 5, f);
+	fputc(2, f);					// method: ppf3
+	for (i = 0; i < 50; i++) fputc(' ', f);	// description
+	fputc(0, f);					// image type
+	fputc(0, f);					// no block check
+	fputc(1, f);					// undo data
+	fputc(0, f);
+
+	for (n = 0; n < 30000; n++) {
+		len = rnd(&seed) % 255 + 1;
+		pos = rnd(&seed) % (IMAGE - len);
+		if (n % 4 == 0)				// crowd some sectors
+			pos = (rnd(&seed) % 64) * CD_FRAMESIZE_RAW * 8 + rnd(&seed) % CD_FRAMESIZE_RAW;
+
+		for (i = 0; i < len; i++) data[i] = rnd(&seed);
+
+		put32(f, pos);
+		put32(f, 0);
+		fputc(len, f);
+		fwrite(data, 1, len, f);
+		fwrite(image + pos, 1, len, f);	// undo: the bytes before patching
+
+		memcpy(patched + pos, data, len);
+	}
+
+	size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+/*
+ * IPS: 24-bit offsets, records up to 64k, every fourth a run of one byte.
+ */
+static long writeIPS(const char *name, u32 seed) {
+	static u8 data[0x10000];
+	long size;
+	u32 pos, len, i, n;
+	FILE *f = fopen(name, "wb");
+
+	if (f == NULL) return -1;
+
+	fwrite("PATCH", 1, 5, f);
+	for (n = 0; n < 200; n++) {
+		len = rnd(&seed) % 0xffff + 1;
+		pos = rnd(&seed) % (IMAGE - len);
+		if (pos == 0x454f46) pos++;	// would read as "EOF"
+
+		fputc(pos >> 16, f); fputc(pos >> 8, f); fputc(pos, f);
+		if (n % 4 == 3) {
+			u8 v = rnd(&seed);
+
+			fputc(0, f); fputc(0, f);
+			fputc(len >> 8, f); fputc(len, f); fputc(v, f);
+			memset(patched + pos, v, len);
+		} else {
+			for (i = 0; i < len; i++) data[i] = rnd(&seed);
+			fputc(len >> 8, f); fputc(len, f);
+			fwrite(data, 1, len, f);
+			memcpy(patched + pos, data, len);
+		}
+	}
+	fwrite("EOF", 1, 3, f);
+
+	size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+static void bpsNumber(u8 **p, u32 data) {
+	for (;;) {
+		u8 x = data & 0x7f;
+
+		data >>= 7;
+		if (data == 0) { *(*p)++ = 0x80 | x; break; }
+		*(*p)++ = x;
+		data--;
+	}
+}
+
+static void bpsOffset(u8 **p, s32 rel) {
+	bpsNumber(p, rel < 0 ? (u32)(-rel) << 1 | 1 : (u32)rel << 1);
+}
+
+/*
+ * BPS: the whole image front to back, unchanged runs as source reads or
+ * source copies in place, new bytes as target reads, and target copies of
+ * bytes an earlier target read produced, some of them overlapping their own
+ * output as runs do.
+ */
+static long writeBPS(const char *name, u32 seed) {
+	u8 *buf = malloc(8 * 1024 * 1024), *p = buf;
+	u32 out = 0, src = 0, tgt = 0, len, i, lastRead = 0, lastLen = 0;
+	long size;
+	FILE *f;
+
+	if (buf == NULL) return -1;
+
+	memcpy(p, "BPS1", 4); p += 4;
+	bpsNumber(&p, IMAGE);
+	bpsNumber(&p, IMAGE);
+	bpsNumber(&p, 0);
+
+	while (out < IMAGE) {
+		u32 kind = rnd(&seed) % 8;
+
+		len = rnd(&seed) % 8192 + 1;
+		if (len > IMAGE - out) len = IMAGE - out;
+
+		if (kind < 3) {				// unchanged
+			if (kind == 0) {
+				bpsNumber(&p, (len - 1) << 2 | 2);
+				bpsOffset(&p, (s32)(out - src));
+				src = out + len;
+			} else
+				bpsNumber(&p, (len - 1) << 2 | 0);
+		} else if (kind < 6 || lastLen == 0) {	// new bytes
+			bpsNumber(&p, (len - 1) << 2 | 1);
+			for (i = 0; i < len; i++) patched[out + i] = *p++ = rnd(&seed);
+			lastRead = out;
+			lastLen = len;
+		} else if (kind == 6) {		// an earlier target read again
+			u32 from = lastRead + rnd(&seed) % lastLen;
+
+			if (len > lastRead + lastLen - from) len = lastRead + lastLen - from;
+			bpsNumber(&p, (len - 1) << 2 | 3);
+			bpsOffset(&p, (s32)(from - tgt));
+			memmove(patched + out, patched + from, len);
+			tgt = from + len;
+		} else {					// a run: the byte just written, repeated
+			if (lastRead + lastLen != out) {
+				bpsNumber(&p, 0 << 2 | 1);
+				patched[out] = *p++ = rnd(&seed);
+				lastRead = out;
+				lastLen = 1;
+				out++;
+				if (len > IMAGE - out) len = IMAGE - out;
+				if (len == 0) break;
+			}
+			bpsNumber(&p, (len - 1) << 2 | 3);
+			bpsOffset(&p, (s32)(out - 1 - tgt));
+			for (i = 0; i < len; i++) patched[out + i] = patched[out - 1];
+			tgt = out - 1 + len;
+			lastLen += len;
+		}
+		out += len;
+	}
+
+	memset(p, 0, 8); p += 8;		// source and target crc, not checked
+	len = crc32(0L, buf, p - buf);
+	*p++ = len; *p++ = len >> 8; *p++ = len >> 16; *p++ = len >> 24;
+
+	f = fopen(name, "wb");
+	if (f == NULL) { free(buf); return -1; }
+	fwrite(buf, 1, p - buf, f);
+	size = ftell(f);
+	fclose(f);
+	free(buf);
+	return size;
+}
+
+// every sector through the cache, the sectors it changed compared
+static int apply(const u8 *expect, u32 *changed, double *t, int quiet) {
+	static u8 buf[DATA_SIZE];
+	u32 s, bad = 0, a;
+
+	*changed = 0;
+	*t = 0;
+	for (s = 0; s < SECTORS; s++) {
+		const u8 *sect = image + s * CD_FRAMESIZE_RAW + 12;
+		double t0;
+
+		memcpy(buf, sect, DATA_SIZE);
+		a = s + 150;
+		t0 = now();
+		CheckPPFCache(buf, itob(a / 4500), itob(a / 75 % 60), itob(a % 75));
+		*t += now() - t0;
+
+		if (memcmp(buf, sect, DATA_SIZE) != 0) (*changed)++;
+		if (memcmp(buf, expect + s * CD_FRAMESIZE_RAW + 12, DATA_SIZE) != 0 && bad++ < 3 && !quiet)
+			printf("  sector %u differs\n", s);
+	}
+	return bad;
+}
+
+int main(int argc, char *argv[]) {
+	static const struct {
+		const char *fmt, *ext;
+		long (*write)(const char *name, u32 seed);
+	} formats[] = {
+		{ "PPF3", ".ppf", writePPF },
+		{ "IPS",  ".ips", writeIPS },
+		{ "BPS",  ".bps", writeBPS },
+	};
+	char name[64];
+	double t, tload, tapply;
+	u32 i, f, seed = 0x5eed, changed, calls, k, step, dropped, whole;
+	long size;
+	int errors = 0, bad;
+
+	image = malloc(IMAGE);
+	patched = malloc(IMAGE);
+	if (image == NULL || patched == NULL)
+		return 1;
+	for (i = 0; i < IMAGE; i++) image[i] = rnd(&seed);
+
+	strcpy(Config.PatchesDir, "build");
+	strcpy(CdromId, "SLUS12345");
+
+	for (f = 0; f < 3; f++) {
+		for (i = 0; i < 3; i++) {
+			sprintf(name, NAME "%s", formats[i].ext);
+			remove(name);
+		}
+		sprintf(name, NAME "%s", formats[f].ext);
+
+		memcpy(patched, image, IMAGE);
+		size = formats[f].write(name, 0x1234 + f);
+		if (size < 0) {
+			printf("could not write %s\n", name);
+			return 1;
+		}
+
+		allocs = 0;
+		failAt = -1;		// count only
+		t = now();
+		BuildPPFCache();
+		tload = now() - t;
+		calls = allocs;
+		failAt = 0;
+
+		bad = apply(patched, &changed, &tapply, 0);
+		printf("%-4s %5.1f MB patch: %u sectors changed, %d wrong; load %.1f ms, %u allocations; patching %.0f ns/sector\n",
+			formats[f].fmt, size / 1048576.0, changed, bad, tload * 1e3, calls, tapply * 1e9 / SECTORS);
+		if (bad || changed < SECTORS / 10) {
+			printf("  the patched image is not what the patch says\n");
+			errors++;
+		}
+
+		// the allocations of the load failing in turn, then a good load again
+		step = calls / 64 + 1;
+		dropped = whole = 0;
+		for (k = 1; k <= calls; k = (k < calls && k + step > calls) ? calls : k + step) {
+			allocs = 0;
+			failAt = k;
+			BuildPPFCache();
+			failAt = 0;
+
+			if (apply(image, &changed, &t, 1) == 0)
+				dropped++;
+			else if (apply(patched, &changed, &t, 1) == 0)
+				whole++;		// only the trim at the end failed
+			else {
+				printf("  allocation %u of %u failing leaves the patch in part\n", k, calls);
+				errors++;
+				break;
+			}
+		}
+		printf("     %u loads with an allocation failing: %u patches dropped, %u loaded whole\n",
+			dropped + whole, dropped, whole);
+
+		BuildPPFCache();
+		if (apply(patched, &changed, &t, 0) != 0) {
+			printf("  no good load after a failed one\n");
+			errors++;
+		}
+
+		FreePPFCache();
+		remove(name);
+	}
+
+	free(image);
+	free(patched);
+	return errors != 0;
+}
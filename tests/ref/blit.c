@@ -0,0 +1,145 @@
+/***************************************************************************
+                          draw.c  -  description
+                             -------------------
+    begin                : Sun Oct 28 2001
+    copyright            : (C) 2001 by Pete Bernert
+    email                : BlackDove@addcom.de
+ ***************************************************************************/
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+// The output conversion as it was before the bands, one thread over the
+// whole frame: the golden output tests/blit.c checks v_blit.c against.
+
+#define R(x)    ((x << 19) & 0xf80000)
+#define B(x)    ((x << 6) & 0xf800)
+#define G(x)    ((x >> 7) & 0xf8)
+#define RGB(x)  (R(x)|B(x)|G(x))
+
+#define GCC_SPLIT_BLOCK __asm__ ("");
+#define SIZE_OF_BUFFERS   (512*32)        // 512 cache lines
+
+
+void BlitScreen32(unsigned char * _surf, int32_t x, int32_t y) {
+    uint8_t * __restrict  surf = _surf;
+    uint8_t * __restrict pD;
+    uint32_t * __restrict rdest;
+    uint32_t * __restrict destpix;
+
+    uint32_t startxy;
+    uint32_t lu;
+    uint16_t s,s0, s1, s2, s3, s4, s5, s6, s7;
+    uint32_t d0, d1, d2, d3, d4, d5, d6, d7;
+
+    uint16_t row, column;
+    uint16_t dx = PreviousPSXDisplay.Range.x1;
+    uint16_t dy = PreviousPSXDisplay.DisplayMode.y;
+
+    if (PreviousPSXDisplay.Range.y0) // centering needed?
+    {
+        memset(surf, 0, (PreviousPSXDisplay.Range.y0 >> 1) * g_pPitch);
+
+        dy -= PreviousPSXDisplay.Range.y0;
+        surf += (PreviousPSXDisplay.Range.y0 >> 1) * g_pPitch;
+
+        memset(surf + dy * g_pPitch,
+                0, ((PreviousPSXDisplay.Range.y0 + 1) >> 1) * g_pPitch);
+    }
+
+    if (PreviousPSXDisplay.Range.x0) {
+        for (column = 0; column < dy; column++) {
+            destpix = (uint32_t *) (surf + (column * g_pPitch));
+            memset(destpix, 0, PreviousPSXDisplay.Range.x0 << 2);
+        }
+        surf += PreviousPSXDisplay.Range.x0 << 2;
+    }
+
+    if (PSXDisplay.RGB24) {
+        for (column = 0; column < dy; column++) {
+            startxy = ((1024) * (column + y)) + x;
+            pD = (uint8_t *) &psxVuw[startxy];
+            destpix = (uint32_t *) (surf + (column * g_pPitch));
+            for (row = 0; row < dx; row++) {
+
+                lu = *((uint32_t *) pD);
+                destpix[row] =
+                        0xff000000 | (RED(lu) << 16) | (GREEN(lu) << 8) | (BLUE(lu));
+                pD += 3;
+
+            }
+        }
+    }
+
+    else {
+#if 1
+        for (column = 0; column < dy; column++) {
+            startxy = (1024 * (column + y)) + x;
+            destpix = (uint32_t *) (surf + (column * g_pPitch));
+
+            // Prefetch to give us a running start on the first 8 sets of cache lines
+            int loop;
+            for(loop=0; loop < 1024; loop += 128)
+                __asm__ __volatile__("dcbt 0,%0" : : "r" (&psxVuw[startxy]+loop));
+
+            __asm__ __volatile__("dcbz 0,%0" : : "r" (destpix));
+
+            for (row = 0; row < dx; row += 8) {
+                rdest = &destpix[row];
+
+                GCC_SPLIT_BLOCK
+
+                s0 = GETLE16(&psxVuw[startxy++]);
+                s1 = GETLE16(&psxVuw[startxy++]);
+                s2 = GETLE16(&psxVuw[startxy++]);
+                s3 = GETLE16(&psxVuw[startxy++]);
+                s4 = GETLE16(&psxVuw[startxy++]);
+                s5 = GETLE16(&psxVuw[startxy++]);
+                s6 = GETLE16(&psxVuw[startxy++]);
+                s7 = GETLE16(&psxVuw[startxy++]);
+
+                GCC_SPLIT_BLOCK
+
+                d0 = RGB(s0) | 0xff000000;
+                d1 = RGB(s1) | 0xff000000;
+                d2 = RGB(s2) | 0xff000000;
+                d3 = RGB(s3) | 0xff000000;
+                d4 = RGB(s4) | 0xff000000;
+                d5 = RGB(s5) | 0xff000000;
+                d6 = RGB(s6) | 0xff000000;
+                d7 = RGB(s7) | 0xff000000;
+
+                GCC_SPLIT_BLOCK
+
+                rdest[0] = d0;
+                rdest[1] = d1;
+                rdest[2] = d2;
+                rdest[3] = d3;
+                rdest[4] = d4;
+                rdest[5] = d5;
+                rdest[6] = d6;
+                rdest[7] = d7;
+            }
+        }
+#else
+        for(column=0;column<dy;column++)
+        {
+            startxy=((1024)*(column+y))+x;
+            for(row=0;row<dx;row++)
+            {
+                s=psxVuw[startxy++];
+                *((unsigned long *)((surf)+(column*g_pPitch)+row*4))=
+                ((((s<<19)&0xf80000)|((s<<6)&0xf800)|((s>>7)&0xf8))&0xffffff)|0xff000000;
+            }
+        }
+
+#endif
+    }
+
+}
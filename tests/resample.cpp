@@ -0,0 +1,127 @@
+/*
+ * The sound backend's resamplers without a sound card: feeds sines through
+ * both of them in the backend's chunks and measures THD+N against the ideal
+ * output and the throughput. Both have to give 48000 frames a second.
+ *
+ *   resample [seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <byteswap.h>
+
+#include "xr_resample.h"
+
+#define CHUNK	128		// frames per backend submit, RING_CHUNK
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// THD+N in dB of the left channel: the residual after a least squares fit
+// of a sine at the frequency the output should have, over the signal
+static double thdn(const int16_t *out, int n, double w) {
+	double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0, a, b, res = 0, sig = 0, s, c, e;
+	int i, skip = 64;	// filter start up
+
+	for (i = skip; i < n; i++) {
+		s = sin(w * i); c = cos(w * i);
+		ss += s * s; sc += s * c; cc += c * c;
+		ys += out[i * 2] * s; yc += out[i * 2] * c;
+	}
+	a = (ys * cc - yc * sc) / (ss * cc - sc * sc);
+	b = (yc * ss - ys * sc) / (ss * cc - sc * sc);
+
+	for (i = skip; i < n; i++) {
+		s = a * sin(w * i) + b * cos(w * i);
+		e = out[i * 2] - s;
+		res += e * e;
+		sig += s * s;
+	}
+	return 10 * log10(res / sig);
+}
+
+struct result {
+	int frames;
+	double thdn, mfps;
+};
+
+static void run(const int16_t *in, int frames, double hz, int polyphase, struct result *r) {
+	int16_t *out = (int16_t *)malloc((frames * 2 + 1024) * 4);
+	uint32_t *swapped = (uint32_t *)malloc((frames * 2 + 1024) * 4);
+	double start, secs;
+	int i, n, done = 0;
+
+	ResampleInit();
+	start = now();
+	for (i = 0; i < frames; i += CHUNK) {
+		n = frames - i < CHUNK ? frames - i : CHUNK;
+		if (polyphase) {
+			done += ResamplePolyphase(&in[i * 2], n, &swapped[done]);
+		} else {
+			done += ResampleLinear(&in[i * 2], n, &out[done * 2]);
+		}
+	}
+	secs = now() - start;
+
+	if (polyphase) {
+		// undo the swap for the little endian sound hw, left is the high half
+		for (i = 0; i < done; i++) {
+			uint32_t v = bswap_32(swapped[i]);
+			out[i * 2] = (int16_t)(v >> 16);
+			out[i * 2 + 1] = (int16_t)v;
+		}
+	}
+
+	r->frames = done;
+	r->mfps = frames / secs / 1e6;
+	// the output plays at 48k, whatever ratio the path really used
+	r->thdn = thdn(out, done, 2 * M_PI * hz / 44100.0 * frames / done);
+
+	free(out);
+	free(swapped);
+}
+
+int main(int argc, char *argv[]) {
+	static const double tones[] = { 1000, 10000 };
+	int seconds = argc > 1 ? atoi(argv[1]) : 10;
+	int frames = 44100 * seconds, i, t, fail = 0;
+	int16_t *in = (int16_t *)malloc(frames * 4);
+	struct result lin, poly;
+
+	for (t = 0; t < 2; t++) {
+		for (i = 0; i < frames; i++)
+			in[i * 2] = in[i * 2 + 1] = (int16_t)(16384 * sin(2 * M_PI * tones[t] * i / 44100.0));
+
+		run(in, frames, tones[t], 0, &lin);
+		run(in, frames, tones[t], 1, &poly);
+
+		printf("%5.0f Hz: linear %d frames, THD+N %6.1f dB, %6.1f Mframes/s\n",
+			tones[t], lin.frames, lin.thdn, lin.mfps);
+		printf("%5.0f Hz: polyphase %d frames, THD+N %6.1f dB, %6.1f Mframes/s\n",
+			tones[t], poly.frames, poly.thdn, poly.mfps);
+
+		if (abs(poly.frames - 48000 * seconds) > 1) {
+			printf("polyphase gives %d frames for %d s\n", poly.frames, seconds);
+			fail = 1;
+		}
+		// more would fill the hw fifo, a little with every chunk
+		if (abs(lin.frames - 48000 * seconds) > 1) {
+			printf("linear gives %d frames for %d s\n", lin.frames, seconds);
+			fail = 1;
+		}
+		if (poly.thdn > -70 || poly.thdn > lin.thdn - 10) {
+			printf("polyphase is not clean enough\n");
+			fail = 1;
+		}
+	}
+
+	free(in);
+	return fail;
+}
@@ -0,0 +1,149 @@
+/*
+ * Run ahead must not change what the psx does. The pad program runs with a
+ * scripted pad, once without run ahead and once with each of 1 to 3 frames
+ * of it. After every real frame the pad program's state word and the cpu
+ * have to be where the plain run had them, and every few frames all of
+ * ram, the io page and vram as well. Then what the snapshots and the frames
+ * thrown away cost per frame.
+ *
+ *   runahead [frames] <exe>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "psxcommon.h"
+#include "r3000a.h"
+#include "psxmem.h"
+#include "runahead.h"
+#include "hostsys.h"
+
+#define STATE		0x80030000		// state word, then the buttons it last read
+#define FULL		10				// frames between full compares
+
+typedef struct {
+	u32 state, buttons, pc, cycle;
+	u32 ram, hw, vram;				// every FULL frames
+} Frame;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// the buttons held in frame n, active low: a few at a time, changing often
+static unsigned short script(u32 n) {
+	u32 h = (n / 3 + 1) * 2654435761u;
+
+	return ~((1 << (h >> 28)) | (1 << ((h >> 24) & 15)));
+}
+
+static int run(const char *file, int ahead, u32 frames, Frame *f, double *t) {
+	u32 i;
+
+	if (HostStart(file, NULL) != 0) {
+		fprintf(stderr, "could not start %s\n", file);
+		return -1;
+	}
+	Config.RunAhead = ahead;
+
+	*t = now();
+	for (i = 0; i < frames; i++) {
+		hostPadButtons[0] = script(i);
+		HostFrame();
+
+		f[i].state = psxMu32(STATE);
+		f[i].buttons = psxMu32(STATE + 4);
+		f[i].pc = psxRegs.pc;
+		f[i].cycle = psxRegs.cycle;
+		if (i % FULL == FULL - 1) {
+			f[i].ram = crc32(0, (u8 *)psxM, 0x00200000);
+			f[i].hw = crc32(0, (u8 *)psxH, 0x00010000);
+			f[i].vram = HostVramChecksum();
+		} else {
+			f[i].ram = f[i].hw = f[i].vram = 0;
+		}
+	}
+	*t = now() - *t;
+
+	HostStop();
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	RunAheadStats before, after;
+	Frame *plain, *ahead;
+	u32 frames = 300, i;
+	int n, errors = 0, a = 1;
+	double tplain, t;
+
+	if (a < argc && argv[a][0] >= '0' && argv[a][0] <= '9')
+		frames = strtoul(argv[a++], NULL, 0);
+	if (a != argc - 1 || frames == 0) {
+		fprintf(stderr, "usage: %s [frames] <exe>\n", argv[0]);
+		return 2;
+	}
+
+	plain = malloc(frames * sizeof(Frame));
+	ahead = malloc(frames * sizeof(Frame));
+	if (plain == NULL || ahead == NULL)
+		return 1;
+
+	if (run(argv[a], 0, frames, plain, &tplain) != 0)
+		return 1;
+
+	// the program has to see the pad, or there is nothing to get wrong; it
+	// reads it after the first vsync, the first frame ends on that
+	for (i = 1; i < frames; i++) {
+		if (plain[i].buttons != script(i)) {
+			printf("frame %u: the program read %04x, the pad held %04x\n", i, plain[i].buttons, script(i));
+			errors++;
+			break;
+		}
+	}
+	printf("no run ahead: %u frames, %.2f ms/frame\n", frames, tplain * 1e3 / frames);
+
+	for (n = 1; n <= 3; n++) {
+		int bad = 0;
+
+		RunAheadGetStats(&before);
+		if (run(argv[a], n, frames, ahead, &t) != 0)
+			return 1;
+		RunAheadGetStats(&after);
+
+		for (i = 0; i < frames; i++) {
+			if (memcmp(&plain[i], &ahead[i], sizeof(Frame)) == 0)
+				continue;
+			if (bad++ < 3)
+				printf("run ahead %d, frame %u: state %08x/%08x pc %08x/%08x cycle %u/%u ram %08x/%08x hw %08x/%08x vram %08x/%08x\n",
+					n, i, plain[i].state, ahead[i].state, plain[i].pc, ahead[i].pc, plain[i].cycle, ahead[i].cycle,
+					plain[i].ram, ahead[i].ram, plain[i].hw, ahead[i].hw, plain[i].vram, ahead[i].vram);
+		}
+
+		after.frames -= before.frames;
+		after.hidden -= before.hidden;
+		after.aborted -= before.aborted;
+		after.snapus -= before.snapus;
+		after.runus -= before.runus;
+
+		printf("run ahead %d:  %u frames, %.2f ms/frame, %u thrown away, %u aborted, "
+			"%.1f us/frame snapshots, %.1f us/frame ahead, %d differ\n",
+			n, frames, t * 1e3 / frames, after.hidden, after.aborted,
+			(double)after.snapus / frames, (double)after.runus / frames, bad);
+
+		if (bad)
+			errors++;
+		if (after.frames != frames || after.hidden != frames * n || after.aborted != 0) {
+			printf("  expected %u run aheads of %d frames each\n", frames, n);
+			errors++;
+		}
+	}
+
+	free(plain);
+	free(ahead);
+	return errors != 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * The spu's block dma (a_dma.cpp) against the halfword loops it replaced
+ * (ref/a_dma.cpp): reads and writes of a few halfwords up to more than all
+ * of spu ram, from anywhere, many of them running into the end of ram, with
+ * the irq address on the first or the last halfword moved, just past the
+ * block or before it, or anywhere; irqs enabled or not, already hit or not.
+ * Spu ram, what was read, spuAddr, the status, the irq callbacks and the
+ * range handed to the adpcm cache have to come out the same. A block that
+ * starts at the end of ram now moves nothing, where the loops moved a
+ * halfword past it. Then MB/s for both.
+ *
+ *   spudma [transfers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../source/plugins/xenon_audio_repair/a_dma.cpp"
+
+// ref/a_dma.cpp, built with its names starting ref (see the Makefile)
+extern "C" void CALLBACK refSPUreadDMAMem(unsigned short *pusPSXMem, int iSize);
+extern "C" void CALLBACK refSPUwriteDMAMem(unsigned short *pusPSXMem, int iSize);
+
+#define RAM			0x80000
+#define SLACK		16			// halfwords, where the loops' one past the end lands
+#define GUARD		64			// bytes checked around a block
+#define MOST		(RAM / 2 + 0x1000)	// halfwords in the longest transfer
+
+unsigned short spuMem[RAM / 2 + SLACK];
+unsigned char *spuMemC = (unsigned char *)spuMem;
+unsigned char *pSpuIrq;
+unsigned short spuCtrl, spuStat;
+unsigned long spuAddr;
+int bIrqHit, iSpuAsyncWait;
+void (CALLBACK *irqCallback)(void);
+
+static int irqs, dirtyCalls;
+static unsigned long dirtyAddr, dirtyBytes;
+
+static void CALLBACK countIrq(void) { irqs++; }
+
+// as a_registers.cpp has it
+int Check_IRQ(int addr, int force) {
+	if (spuCtrl & CTRL_IRQ) {
+		if (bIrqHit == 0 && (force == 1 || pSpuIrq == spuMemC + addr)) {
+			if (irqCallback)
+				irqCallback();
+			bIrqHit = 1;
+			spuStat |= STAT_IRQ;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void ADPCMCacheInvalidate(unsigned long addr, unsigned long bytes) {
+	dirtyCalls++;
+	dirtyAddr = addr;
+	dirtyBytes = bytes;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned rnd(unsigned *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+// what a transfer leaves behind besides ram
+struct after {
+	unsigned long addr, dirtyAddr, dirtyBytes;
+	unsigned short stat;
+	int irqs, hit, dirtyCalls;
+};
+
+static struct after state(void) {
+	struct after a = { spuAddr, dirtyAddr, dirtyBytes, spuStat, irqs, bIrqHit, dirtyCalls };
+	return a;
+}
+
+static int same(const struct after *a, const struct after *b) {
+	return a->addr == b->addr && a->stat == b->stat && a->irqs == b->irqs && a->hit == b->hit &&
+		a->dirtyCalls == b->dirtyCalls && a->dirtyAddr == b->dirtyAddr && a->dirtyBytes == b->dirtyBytes;
+}
+
+static double bench(void (CALLBACK *dma)(unsigned short *, int), unsigned short *psx) {
+	double t = now();
+	int i;
+
+	for (i = 0; i < 2000; i++) {
+		spuAddr = 0x10000;
+		dma(psx, 0x8000);
+	}
+	return 2000 * 0x10000 / (now() - t) / 1048576;
+}
+
+int main(int argc, char *argv[]) {
+	static unsigned short psx[MOST + SLACK], wantPsx[MOST + SLACK];
+	static unsigned char save[RAM + 2 * SLACK], want[RAM + 2 * SLACK];
+	int n = argc > 1 ? atoi(argv[1]) : 20000, k, write, errors = 0;
+	unsigned seed = 0x5d3a, i, done[2] = { 0, 0 }, bad[2] = { 0, 0 }, atEnd[2] = { 0, 0 }, fired[2] = { 0, 0 };
+
+	for (i = 0; i < RAM / 2 + SLACK; i++) spuMem[i] = rnd(&seed);
+	irqCallback = countIrq;
+
+	for (k = 0; k < n; k++) {
+		unsigned x = rnd(&seed), start, size, moved, irq, lo, hi, stat, len;
+		struct after a, b;
+		int hit, ctrl;
+
+		write = x & 1;
+
+		// anywhere, where a register puts it, close to the end of ram or on it
+		switch (x / 2 % 8) {
+			case 0: case 1: case 2: start = rnd(&seed) % RAM & ~1; break;
+			case 3: case 4: start = rnd(&seed) % (RAM / 8) * 8; break;
+			case 5: case 6: start = RAM - 2 - 2 * (rnd(&seed) % 2048); break;
+			default: start = x / 16 % 4 ? RAM - 2 - 2 * (rnd(&seed) % 64) : RAM; break;
+		}
+		switch (x / 64 % 16) {
+			case 0: size = 0; break;
+			case 1: size = RAM / 2 + rnd(&seed) % 0x1000; break;
+			case 2: size = rnd(&seed) % (RAM / 2); break;
+			case 3: case 4: case 5: case 6: size = rnd(&seed) % 0x2000; break;
+			default: size = 1 + rnd(&seed) % 64; break;
+		}
+		moved = start < RAM && size > (RAM - start) / 2 ? (RAM - start) / 2 : start < RAM ? size : 0;
+
+		switch (x / 1024 % 8) {
+			case 0: irq = start; break;
+			case 1: irq = start + 2 * moved - 2; break;
+			case 2: irq = start + 2 * moved; break;
+			case 3: irq = start - 8; break;
+			default: irq = rnd(&seed) % (RAM / 8) * 8; break;
+		}
+		irq &= RAM - 1;
+		ctrl = (rnd(&seed) & ~CTRL_IRQ) | (x & 0x10000 ? 0 : CTRL_IRQ);
+		hit = x / 0x20000 % 4 == 0;
+		stat = rnd(&seed) & 0xffff;
+
+		// the window either of them may touch
+		lo = start >= GUARD ? start - GUARD : 0;
+		hi = start + 2 * (size < MOST ? size : MOST) + GUARD;
+		if (hi > RAM + 2 * SLACK) hi = RAM + 2 * SLACK;
+		memcpy(save, spuMemC + lo, hi - lo);
+		len = (size < MOST ? size : MOST) + SLACK;
+		for (i = 0; i < len; i++) psx[i] = write ? rnd(&seed) : 0xdead;
+
+		spuAddr = start; spuCtrl = ctrl; spuStat = stat; bIrqHit = hit; pSpuIrq = spuMemC + irq;
+		irqs = 0; dirtyCalls = 0; dirtyAddr = dirtyBytes = ~0ul;
+		write ? refSPUwriteDMAMem(psx, size) : refSPUreadDMAMem(psx, size);
+		a = state();
+		memcpy(want, spuMemC + lo, hi - lo);
+		memcpy(wantPsx, psx, len * 2);
+
+		memcpy(spuMemC + lo, save, hi - lo);
+		if (!write)
+			for (i = 0; i < len; i++) psx[i] = 0xdead;
+		spuAddr = start; spuCtrl = ctrl; spuStat = stat; bIrqHit = hit; pSpuIrq = spuMemC + irq;
+		irqs = 0; dirtyCalls = 0; dirtyAddr = dirtyBytes = ~0ul;
+		write ? SPUwriteDMAMem(psx, size) : SPUreadDMAMem(psx, size);
+		b = state();
+
+		done[write]++;
+		fired[write] += b.irqs;
+		if (start == RAM && size) {
+			// nothing moves, nothing is read, the status says the dma went through
+			atEnd[write]++;
+			if (b.addr == RAM && b.irqs == 0 && memcmp(spuMemC + lo, save, hi - lo) == 0 &&
+				(write || psx[0] == 0xdead))
+				continue;
+		} else if (same(&a, &b) && memcmp(spuMemC + lo, want, hi - lo) == 0 &&
+			memcmp(psx, wantPsx, len * 2) == 0)
+			continue;
+
+		if (bad[write]++ < 3)
+			printf("  %s of %x halfwords at %x, irq at %x%s%s: spuAddr %lx for %lx, %d irqs for %d\n",
+				write ? "write" : "read", size, start, irq, ctrl & CTRL_IRQ ? "" : " off", hit ? " hit" : "",
+				b.addr, a.addr, b.irqs, a.irqs);
+	}
+
+	for (write = 0; write < 2; write++) {
+		printf("%-6s %5u transfers, %u differ, %u irqs, %u at the end of ram\n", write ? "write" : "read",
+			done[write], bad[write], fired[write], atEnd[write]);
+		if (bad[write] || done[write] == 0 || fired[write] == 0)
+			errors++;
+	}
+
+	// 64k at a time
+	bIrqHit = 1;
+	printf("MB/s   halfword loop  memcpy\n");
+	printf("write  %13.0f %7.0f\n", bench(refSPUwriteDMAMem, psx), bench(SPUwriteDMAMem, psx));
+	printf("read   %13.0f %7.0f\n", bench(refSPUreadDMAMem, psx), bench(SPUreadDMAMem, psx));
+
+	return errors != 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * The hw gpu's sprite texture cache (peopsxgl/texture.cpp) over a texture
+ * trace: frames of 4-bit sprites from a few tpages and cluts, drawn the way
+ * SelectSubTextureS asks for them, with a vram upload over one of the pages
+ * now and then. Every draw is checked against the plain scan of the slot
+ * list the cache had before its hints: what the scan finds has to be a hit,
+ * and a hit has to come back with a slot that really holds that sprite.
+ * Then the cost of a lookup with the hints against the scan alone.
+ *
+ *   texcache [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "stdafx.h"
+#include "externals.h"
+using namespace xegpu;
+#include "texture.h"
+#include "texture_load.h"
+#include "GpuRenderer.h"
+
+// as in texture.cpp
+#define CLUTCHK		0x00060000
+#define CLUTSHIFT	17
+#define SOFFB		1024
+#define INCHECK(pos2,pos1) ((pos1._0<=pos2._0) && (pos1._1>=pos2._1) && (pos1._2<=pos2._2) && (pos1._3>=pos2._3))
+
+#define PAGES		8
+#define CLUTS		12
+#define SPRITES		(PAGES * CLUTS * 64)
+#define DRAWS		600		// sprites a frame
+#define UPLOAD		20		// frames between vram uploads
+
+namespace xegpu {
+	XEGPU_CONFIG peops_cfg;
+	unsigned char gl_ux[8], gl_vy[8];
+	int iUsePalTextures = 1;
+	short DrawSemiTrans;
+	GpuTex *gTexName;
+	short sxmin, sxmax, symin, symax;
+	unsigned short *psxVuw;
+	uint32_t dwGPUVersion;
+	int iGPUHeight = 512, iGPUHeightMask = 511;
+	OGLVertex vertex[4];
+
+	extern int GlobalTexturePage;
+	extern textureSubCacheEntryS *pscSubtexStore[3][MAXTPAGES_MAX];
+	extern unsigned short usLRUTexPage;
+}
+
+GpuRenderer gpuRenderer;
+void GpuRenderer::DestroyTexture(GpuTex *surf) {}
+void GpuRenderer::DisableTexture() {}
+void InvalidateWndTextureArea(int X, int Y, int W, int H) {}
+
+typedef struct {
+	int page;
+	uint32_t clut;
+	unsigned char u, v, w, h;
+} Sprite;
+
+typedef struct {
+	unsigned int draws, hits, uploads, full, lost, bad;
+} Result;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int rnd(unsigned int *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+// the uvs of a sprite and their bounds in gl_ux[4..7], as SelectSubTextureS sets them
+static void setUV(const Sprite *s) {
+	gl_ux[0] = gl_ux[3] = s->u;
+	gl_ux[1] = gl_ux[2] = s->u + s->w - 1;
+	gl_vy[0] = gl_vy[1] = s->v;
+	gl_vy[2] = gl_vy[3] = s->v + s->h - 1;
+	gl_ux[7] = s->u;
+	gl_ux[6] = s->u + s->w - 1;
+	gl_ux[5] = s->v;
+	gl_ux[4] = s->v + s->h - 1;
+	GlobalTexturePage = s->page;
+}
+
+static textureSubCacheEntryS *listOf(const Sprite *s) {
+	return pscSubtexStore[0][s->page] + ((s->clut & CLUTCHK) >> CLUTSHIFT) * SOFFB;
+}
+
+// the lookup as the cache did it before the hints
+static textureSubCacheEntryS *scan(const Sprite *s) {
+	textureSubCacheEntryS *tsg = listOf(s), *tsx = tsg + 1;
+	EXLong npos;
+	int i;
+
+	npos.l = GETLE32((uint32_t *) & gl_ux[4]);
+	for (i = tsg->pos.l; i > 0; i--, tsx++)
+		if (s->clut == tsx->ClutID && INCHECK(tsx->pos, npos))
+			return tsx;
+	return NULL;
+}
+
+// is there a slot of the sprite in texture iCache that moves the uvs as the cache did
+static int holds(const Sprite *s, unsigned short iCache) {
+	textureSubCacheEntryS *tsg = listOf(s), *tsx = tsg + 1;
+	unsigned char cx = s->u - gl_ux[0], cy = s->v - gl_vy[0];
+	EXLong npos;
+	int i;
+
+	npos.l = GETLE32((uint32_t *) & gl_ux[4]);
+	for (i = tsg->pos.l; i > 0; i--, tsx++)
+		if (s->clut == tsx->ClutID && INCHECK(tsx->pos, npos) && tsx->cTexID == iCache &&
+				(unsigned char)(tsx->pos._3 - tsx->posTX) == cx &&
+				(unsigned char)(tsx->pos._1 - tsx->posTY) == cy)
+			return 1;
+	return 0;
+}
+
+static void draw(const Sprite *s, Result *r) {
+	textureSubCacheEntryS *found;
+	unsigned short iCache = 0;
+	unsigned char *OPtr;
+
+	setUV(s);
+	found = scan(s);
+
+	OPtr = CheckTextureInSubSCache(0, s->clut, &iCache);
+	if (iCache == 0xffff) {
+		r->full++;
+		CompressTextureSpace();
+		setUV(s);
+		found = scan(s);
+		OPtr = CheckTextureInSubSCache(0, s->clut, &iCache);
+	}
+	usLRUTexPage = iCache;
+
+	r->draws++;
+	if (OPtr == NULL) {
+		r->hits++;
+		if (!holds(s, iCache))
+			r->bad++;
+	} else {
+		r->uploads++;
+		if (found)
+			r->lost++;
+		*OPtr = 0;
+	}
+}
+
+static void makeSprites(Sprite *sp) {
+	int p, c, i;
+
+	for (p = 0; p < PAGES; p++)
+		for (c = 0; c < CLUTS; c++)
+			for (i = 0; i < 64; i++) {
+				Sprite *s = &sp[(p * CLUTS + c) * 64 + i];
+				uint32_t clut = (480 + c) << 6 | (p * 16 >> 4);
+				uint32_t sum = (clut * 2654435761u) >> 18;
+
+				s->page = p;
+				s->clut = (clut & 0x7fff) | CLUTUSED | sum << 16;
+				s->u = (i & 7) * 32;
+				s->v = (i >> 3) * 32;
+				s->w = i % 3 ? 32 : 16;
+				s->h = i % 5 ? 32 : 24;
+			}
+}
+
+// a few hundred sprites a frame, mostly the same ones as the frame before
+static int pick(unsigned int *seed, int frame) {
+	unsigned int x = rnd(seed);
+	int base = (frame / 50) * 97;
+
+	if (x % 8)
+		return (base + (x >> 8) % (SPRITES / 6)) % SPRITES;
+	return (x >> 8) % SPRITES;
+}
+
+int main(int argc, char *argv[]) {
+	int frames = argc > 1 ? atoi(argv[1]) : 300, f, i, n, errors = 0;
+	unsigned int seed = 12345;
+	Sprite *sprites = (Sprite *)malloc(SPRITES * sizeof(Sprite));
+	int *trace;
+	double t, tcache, tscan;
+	unsigned short iCache;
+	Result r;
+
+	if (sprites == NULL)
+		return 1;
+	makeSprites(sprites);
+
+	peops_cfg.iTexGarbageCollection = 1;
+	InitializeTextureStore();
+
+	memset(&r, 0, sizeof(r));
+	for (f = 0; f < frames; f++) {
+		for (i = 0; i < DRAWS; i++)
+			draw(&sprites[pick(&seed, f)], &r);
+
+		if (f % UPLOAD == UPLOAD - 1) {
+			int p = rnd(&seed) % PAGES;
+
+			InvalidateTextureArea(p * 64 + 16, 64, 16, 64);
+		}
+	}
+
+	printf("%u draws: %u hits, %u uploads, %u times full, %u hits lost, %u bad slots\n",
+		r.draws, r.hits, r.uploads, r.full, r.lost, r.bad);
+	if (r.lost || r.bad) {
+		printf("  the cache does not answer as the scan did\n");
+		errors++;
+	}
+	if (r.hits < r.draws / 2 || r.uploads == 0) {
+		printf("  the trace does not test anything\n");
+		errors++;
+	}
+
+	// the same frame over and over, once it is all in the cache
+	n = DRAWS * 200;
+	trace = (int *)malloc(n * sizeof(int));
+	for (i = 0; i < n; i++)
+		trace[i] = pick(&seed, frames);
+	for (f = 0; f < 8 && r.uploads; f++) {
+		memset(&r, 0, sizeof(r));
+		for (i = 0; i < DRAWS; i++)
+			draw(&sprites[trace[i]], &r);
+	}
+
+	t = now();
+	for (i = 0; i < n; i++) {
+		setUV(&sprites[trace[i % DRAWS]]);
+		iCache = 0;
+		if (CheckTextureInSubSCache(0, sprites[trace[i % DRAWS]].clut, &iCache) != NULL)
+			errors++;
+	}
+	tcache = (now() - t) / n;
+
+	t = now();
+	for (i = 0; i < n; i++) {
+		setUV(&sprites[trace[i % DRAWS]]);
+		if (scan(&sprites[trace[i % DRAWS]]) == NULL)
+			errors++;
+	}
+	tscan = (now() - t) / n;
+
+	printf("lookup: %.1f ns with hints, %.1f ns scanning\n", tcache * 1e9, tscan * 1e9);
+
+	free(trace);
+	free(sprites);
+	return errors != 0;
+}
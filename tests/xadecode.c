@@ -0,0 +1,186 @@
+/*
+ * XA audio: streams of sectors in every coding (4 and 8 bit, mono and
+ * stereo, 37.8 and 18.9 kHz) with random filters, ranges and data, some
+ * units driven into the clamp. Each stream is decoded by the decoder as it
+ * was (ref/decode_xa.c) and by xa_decode_sector_to, the sectors at every
+ * offset from a 16 byte boundary and the pcm aligned or not. The pcm has
+ * to be the same sample for sample, and the old decoder's output has to
+ * hash to what it always did. Then sectors a second for both.
+ *
+ *   xadecode [sectors]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+#include "decode_xa.h"
+
+#define ADPCM_InitDecode	refInitDecode
+#define xa_decode_sector	refDecodeSector
+#define xa_decode_sector_to	refDecodeSectorTo
+#include "ref/decode_xa.c"
+#undef ADPCM_InitDecode
+#undef xa_decode_sector
+#undef xa_decode_sector_to
+
+#define SECTOR		2336		// subheader and form 2 data, as cdrom.c hands it over
+#define PCM			16384
+#define GOLDEN		0x4501f7c0	// crc of the old decoder's pcm over the streams
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u32 rnd(u32 *s) {
+	*s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+	return *s;
+}
+
+/*
+ * A sector of coding: 18 sound groups of a 16 byte header (the filter and
+ * range of each unit at 0-3 and 8-11, copied at 4-7 and 12-15) and 112
+ * bytes of data, quiet enough for the filters that feed back. One group
+ * in 32 gets the loudest nibbles at range 0 with the filters that
+ * overshoot most.
+ */
+static void makeSector(u8 *s, u8 coding, u32 *seed) {
+	int g, i;
+
+	memset(s, 0, SECTOR);
+	s[0] = s[4] = 1;						// file
+	s[1] = s[5] = 0;						// channel
+	s[2] = s[6] = SUB_SUB_RT | SUB_SUB_FORM | SUB_SUB_AUDIO;
+	s[3] = s[7] = coding;
+
+	for (g = 0; g < 18; g++) {
+		u8 *head = s + 8 + g * 128, *data = head + 16;
+		int loud = rnd(seed) % 32 == 0;
+
+		for (i = 0; i < 4; i++) {
+			u32 x = rnd(seed);
+			u8 fr = (x & 3) << 4 | (x & 2 ? 8 + (x >> 2) % 5 : (x >> 2) % 13);
+
+			if (x % 16 == 15) fr = (x & 3) << 4 | (13 + (x >> 4) % 3);
+			if (loud) fr = (2 + (x & 1)) << 4;
+			head[i] = head[i + 4] = fr;
+		}
+		for (i = 8; i < 12; i++)
+			head[i] = head[i + 4] = head[i - 8] ^ ((rnd(seed) & 1) << 4);
+
+		for (i = 0; i < 112; i++)
+			data[i] = loud ? (i & 4 ? 0x77 : 0x88) : rnd(seed);
+	}
+}
+
+static const char *codingName(u8 coding) {
+	static char name[32];
+
+	sprintf(name, "%d bit %s %.1f kHz", AUDIO_CODING_GET_BPS(coding) ? 8 : 4,
+		AUDIO_CODING_GET_STEREO(coding) ? "stereo" : "mono  ",
+		AUDIO_CODING_GET_FREQ(coding) ? 18.9 : 37.8);
+	return name;
+}
+
+int main(int argc, char *argv[]) {
+	static xa_decode_t ref, xa;
+	static u8 ALIGNED_32 buf[SECTOR + 16];
+	static short ALIGNED_32 pcm[PCM + 8];
+	int sectors = argc > 1 ? atoi(argv[1]) : 300, errors = 0;
+	u32 seed, c, s, n, i, golden = 0, bad, clamped;
+	u8 *stream, coding;
+	double t, tref, tnew;
+
+	stream = malloc(sectors * SECTOR);
+	if (stream == NULL || sectors < 1)
+		return 1;
+
+	for (c = 0; c < 8; c++) {
+		coding = (c & 1) | (c >> 1 & 1) << 2 | (c >> 2) << 4;
+		seed = 0xa5a5 + c;
+		for (s = 0; s < (u32)sectors; s++)
+			makeSector(stream + s * SECTOR, coding, &seed);
+
+		// sector s at offset s % 16, the pcm one sample off every other sector
+		bad = clamped = 0;
+		for (s = 0; s < (u32)sectors; s++) {
+			u8 *sect = buf + s % 16;
+			short *out = pcm + (s / 16 & 1);
+
+			memset(ref.pcm, 0x55, sizeof(ref.pcm));
+			memset(pcm, 0x55, sizeof(pcm));
+			memcpy(sect, stream + s * SECTOR, SECTOR);
+
+			if (refDecodeSector(&ref, sect, s == 0) != 0 ||
+				xa_decode_sector_to(&xa, sect, s == 0, out) != 0) {
+				printf("  sector %u does not decode\n", s);
+				errors++;
+				break;
+			}
+			n = ref.nsamples * (ref.stereo ? 2 : 1);
+			golden = crc32(golden, (const Bytef *)ref.pcm, n * sizeof(short));
+			for (i = 0; i < n; i++)
+				clamped += ref.pcm[i] == 32767 || ref.pcm[i] == -32768;
+
+			if (xa.nsamples != ref.nsamples || xa.stereo != ref.stereo || xa.freq != ref.freq ||
+				memcmp(out, ref.pcm, n * sizeof(short)) != 0 || memcmp(out + n, ref.pcm + n, 32) != 0) {
+				if (bad++ < 3)
+					printf("  %s: sector %u at offset %u differs\n", codingName(coding), s, s % 16);
+			}
+			if (xa.left.y0 != ref.left.y0 || xa.left.y1 != ref.left.y1 ||
+				xa.right.y0 != ref.right.y0 || xa.right.y1 != ref.right.y1) {
+				if (bad++ < 3)
+					printf("  %s: sector %u leaves another filter state\n", codingName(coding), s);
+			}
+		}
+
+		// xa_decode_sector is the same into xdp->pcm
+		memset(ref.pcm, 0x55, sizeof(ref.pcm));
+		memset(xa.pcm, 0x55, sizeof(xa.pcm));
+		memcpy(buf + 15, stream, SECTOR);
+		xa_decode_sector(&xa, buf + 15, 1);
+		refDecodeSector(&ref, buf + 15, 1);
+		if (memcmp(xa.pcm, ref.pcm, ref.nsamples * (ref.stereo ? 2 : 1) * sizeof(short)) != 0)
+			bad++;
+
+		printf("%s: %d sectors of %u samples, %u clamped, %u differ\n", codingName(coding),
+			sectors, ref.nsamples, clamped, bad);
+		if (bad)
+			errors++;
+		if (clamped == 0) {
+			printf("  nothing reaches the clamp\n");
+			errors++;
+		}
+
+		// both over the whole stream in place, for the 4 bit codings at 37.8 kHz
+		if (c < 2) {
+			t = now();
+			for (n = 0; n < 20; n++)
+				for (s = 0; s < (u32)sectors; s++)
+					refDecodeSector(&ref, stream + s * SECTOR, s == 0);
+			tref = now() - t;
+			t = now();
+			for (n = 0; n < 20; n++)
+				for (s = 0; s < (u32)sectors; s++)
+					xa_decode_sector_to(&xa, stream + s * SECTOR, s == 0, pcm);
+			tnew = now() - t;
+			printf("    %.0f sectors/s before, %.0f now\n", 20 * sectors / tref, 20 * sectors / tnew);
+		}
+	}
+
+	if (sectors == 300) {
+		printf("golden pcm crc %08x\n", golden);
+		if (golden != GOLDEN) {
+			printf("  expected %08x: the streams or the old decoder changed\n", GOLDEN);
+			errors++;
+		}
+	}
+
+	free(stream);
+	return errors != 0;
+}